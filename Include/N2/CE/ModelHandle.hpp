@@ -0,0 +1,117 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+
+#include "CX/Types.hpp"
+#include "CX/Status.hpp"
+#include "N2/CE/IProvider.hpp"
+#include "N2/CE/INetwork.hpp"
+#include "N2/NET/Network.hpp"
+#include "CX/C/Platform/Windows/windows.h"
+
+
+namespace N2
+{
+
+namespace CE
+{
+
+//RCU-style handle to the current version of a model (a NET network and the engine network initialized from it) for 
+//model rollouts under load: a new version is loaded and initialized next to the current one, then published with a 
+//pointer swap; evaluations keep the version they started on and the previous version is destroyed, by the publishing 
+//thread, once the last of them is done
+class ModelHandle
+{
+public:
+
+	struct Version
+	{
+		NET::Network    *pNetwork;
+		INetwork        *pCENetwork;
+		CX::UInt64      nNumber;            //1 for the first published version
+		volatile LONG   cRefs;              //one for the handle while the version is current, one per Acquire
+		HANDLE          hReleasedEvent;     //set when the last reference is released
+	};
+
+	ModelHandle();
+
+	~ModelHandle();
+
+	CX::Status Init(IProvider *pProvider);
+
+	//unpublishes and destroys the current version once the evaluations on it are done
+	CX::Status Uninit();
+
+	CX::Bool IsOK() const;
+
+	//loads a v2 model file (NET::ModelFormat::Load, or Map if bMap), initializes an engine network from it and 
+	//publishes it; returns once the previous version is destroyed
+	CX::Status Load(const CX::Char *szPath, CX::Bool bMap = CX::False);
+
+	//same as Load for a network loaded some other way; the handle takes ownership of pNetwork (even on failure)
+	CX::Status Publish(NET::Network *pNetwork);
+
+	//the current version (NULL if none), to be released after use; never waits for a publisher
+	Version *Acquire();
+
+	void Release(Version *pVersion);
+
+	//evaluates on the current version; concurrent calls need an engine whose Evaluate supports them
+	CX::Status Evaluate(CX::UInt32 cCount, CX::Float *inputs, CX::Float *outputs);
+
+	//0 if nothing was published
+	CX::UInt64 GetVersionNumber();
+
+private:
+
+	IProvider            *m_pProvider;
+	Version * volatile   m_pCurrent;
+	//readers between reading m_pCurrent and taking their reference, counted by the parity of the epoch they entered
+	volatile LONG        m_nEpoch;
+	volatile LONG        m_cReaders[2];
+	SRWLOCK              m_srwlPublish;
+	CX::UInt64           m_nLastNumber;
+
+	CX::Status CreateVersion(NET::Network *pNetwork, Version **ppVersion);
+
+	void DestroyVersion(Version *pVersion);
+
+	//publishes pVersion (NULL to unpublish) and returns the previous version once no reader can take a new reference 
+	//to it
+	Version *Swap(Version *pVersion);
+
+	//drops the reference of the handle and waits for the others
+	void Retire(Version *pVersion);
+
+};
+
+}//namespace CE
+
+}//namespace N2
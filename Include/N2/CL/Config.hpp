@@ -45,6 +45,9 @@ class Config : public CE::IConfig
 {
 public:
 
+	static const CX::UInt32   DEFAULT_QUEUES_COUNT  = 2;
+	static const CX::UInt32   DEFAULT_MAX_IN_FLIGHT = 2;
+
 	Config();
 
 	~Config();
@@ -53,9 +56,52 @@ public:
 
 	cl_device_id GetDeviceID() const;
 
+	//tile size of the tiled compute kernels (8, 16 or 32); 0 chooses one for the device
+	void SetTileSize(CX::UInt32 cTileSize = 0);
+
+	CX::UInt32 GetTileSize() const;
+
+	//batches filling a tile use the tiled compute kernels; False keeps the per-layer ones (to compare them)
+	void SetTiledCompute(CX::Bool bTiledCompute = CX::True);
+
+	CX::Bool GetTiledCompute() const;
+
+	//directory of the compiled program binaries cache; empty disables the cache
+	void SetCacheDir(const CX::Char *szCacheDir = "");
+
+	const CX::Char *GetCacheDir() const;
+
+	//networks build kernels specialized for their layers (used for batches smaller than a tile)
+	void SetGenerateKernels(CX::Bool bGenerateKernels = CX::True);
+
+	CX::Bool GetGenerateKernels() const;
+
+	//measures the work-group sizes of the compute and activate kernels on the first use of each layer shape (kept in 
+	//the cache directory, if any, for the next runs)
+	void SetAutoTune(CX::Bool bAutoTune = CX::True);
+
+	CX::Bool GetAutoTune() const;
+
+	//command queues shared by the networks of the provider; 0 => a single out-of-order queue
+	void SetQueuesCount(CX::UInt32 cQueues = DEFAULT_QUEUES_COUNT);
+
+	CX::UInt32 GetQueuesCount() const;
+
+	//batches of a network in flight at once (EvaluateAsync blocks on the oldest one past that)
+	void SetMaxInFlight(CX::UInt32 cMaxInFlight = DEFAULT_MAX_IN_FLIGHT);
+
+	CX::UInt32 GetMaxInFlight() const;
+
 private:
 
 	cl_device_id   n_devID;
+	CX::UInt32     m_cTileSize;
+	CX::Bool       m_bTiledCompute;
+	CX::String     m_sCacheDir;
+	CX::Bool       m_bGenerateKernels;
+	CX::Bool       m_bAutoTune;
+	CX::UInt32     m_cQueues;
+	CX::UInt32     m_cMaxInFlight;
 
 };
 
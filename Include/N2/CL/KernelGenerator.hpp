@@ -0,0 +1,93 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+
+#include "CX/Types.hpp"
+#include "CX/Status.hpp"
+#include "N2/NET/Network.hpp"
+
+
+namespace N2
+{
+
+namespace CL
+{
+
+//emits OpenCL source specialized for a network: for layer n a Layer<n> kernel (2-D range: next neuron x sample) 
+//with the neurons counts, the bias and the activation args as compile time constants, the dot product unrolled and 
+//the bias and the activation fused; softmax layers add a Layer<n>SoftMax kernel (1-D range over the samples)
+//Layer<n> args: prevNeurons, nextNeurons, weights[, biases]; Layer<n>SoftMax args: neurons
+//with a non zero cNetworkGroupSize a Network kernel runs all the layers in one launch, one work-group of 
+//cNetworkGroupSize work-items per sample (2 * GetMaxNeuronsCount floats of local memory)
+//Network args: inputs, outputs, weights0[, biases0], weights1[, biases1], ...
+class KernelGenerator
+{
+public:
+
+	//longer dot products are emitted as loops
+	static const CX::UInt32   MAX_UNROLLED_PREV_NEURONS = 64;
+
+	static CX::Status Generate(const NET::Network *pNetwork, CX::UInt32 cNetworkGroupSize, CX::String *psSource);
+
+	static void GetLayerKernelName(CX::UInt32 cLayer, CX::String *psName);
+
+	static void GetSoftMaxKernelName(CX::UInt32 cLayer, CX::String *psName);
+
+	static const CX::Char *GetNetworkKernelName();
+
+	//widest layer (inputs included)
+	static CX::UInt32 GetMaxNeuronsCount(const NET::Network *pNetwork);
+
+private:
+
+	KernelGenerator();
+
+	~KernelGenerator();
+
+	static CX::Status GenerateLayer(CX::UInt32 cLayer, const NET::Synapses *pSynapses, CX::String *psSource);
+
+	static CX::Status GenerateNetwork(const NET::Network *pNetwork, CX::UInt32 cGroupSize, CX::String *psSource);
+
+	//adds the weighted inputs and the bias of neuron idx to fValue
+	static void GenerateDotProduct(CX::UInt32 cLayer, const NET::Synapses *pSynapses, const CX::Char *szPrev, 
+	                               const CX::Char *szWeights, const CX::Char *szBiases, const CX::Char *szIndent, 
+	                               CX::String *psSource);
+
+	static CX::Status GenerateActivation(CX::UInt32 cLayer, const NET::Neurons *pNeurons, const CX::Char *szIndent, 
+	                                     CX::String *psSource);
+
+	//exact bit pattern, valid for any value
+	static void AppendFloat(CX::Float fValue, CX::String *psSource);
+
+};
+
+}//namespace CL
+
+}//namespace N2
@@ -56,16 +56,42 @@ public:
 
 	static CX::Size GetSourceLen(CX::Size cIndex);
 
+	//a non empty szCacheDir caches the program binary in that directory, keyed by the device, the driver, the build 
+	//options and the sources; a missing, stale or rejected binary falls back to building from sources
 	static CX::Status Build(cl::Device &device, cl::Context &context, cl::Program **ppProgram, 
-	                        CX::String *psBuildLog = NULL);
+	                        CX::String *psBuildLog = NULL, const CX::Char *szOptions = NULL, 
+	                        const CX::Char *szCacheDir = NULL);
+
+	//same as Build, for a source generated at runtime instead of the registered ones
+	static CX::Status BuildSource(cl::Device &device, cl::Context &context, const CX::Char *szSource, 
+	                              CX::Size cSourceLen, cl::Program **ppProgram, CX::String *psBuildLog = NULL, 
+	                              const CX::Char *szOptions = NULL, const CX::Char *szCacheDir = NULL);
+
+	//identifies the device, the driver and the build options
+	static CX::UInt64 GetDeviceKey(cl::Device &device, const CX::Char *szOptions);
+
+	//<szCacheDir>\N2_<nKey in hex>.<szExtension>
+	static void GetCachePath(const CX::Char *szCacheDir, CX::UInt64 nKey, const CX::Char *szExtension, 
+	                         CX::String *psPath);
 
 private:
 
+	static const CX::UInt32   CACHE_MAGIC   = 0x4243324E; //N2CB
+	static const CX::UInt32   CACHE_VERSION = 1;
+
 	struct Source
 	{
 		CX::String   sSource;
 	};
 
+	struct CacheHeader
+	{
+		CX::UInt32   nMagic;
+		CX::UInt32   nVersion;
+		CX::UInt64   nKey;
+		CX::UInt64   cbBinarySize;
+	};
+
 	typedef CX::Vector<Source>::Type   SourcesVector;
 
 	KernelSources();
@@ -76,6 +102,18 @@ private:
 
 	static CX::Status LoadSources(cl::Program::Sources *pSources);
 
+	static CX::Status BuildSources(cl::Device &device, cl::Context &context, const cl::Program::Sources &sources, 
+	                               cl::Program **ppProgram, CX::String *psBuildLog, const CX::Char *szOptions, 
+	                               const CX::Char *szCacheDir);
+
+	static CX::UInt64 Hash(CX::UInt64 nHash, const void *pData, CX::Size cbSize);
+
+	static CX::UInt64 GetCacheKey(cl::Device &device, const cl::Program::Sources &sources, const CX::Char *szOptions);
+
+	static CX::Status LoadBinary(const CX::Char *szPath, CX::UInt64 nKey, CX::String *psBinary);
+
+	static CX::Status SaveBinary(cl::Program *pProgram, const CX::Char *szPath, CX::UInt64 nKey);
+
 };
 
 }//namespace CL
@@ -0,0 +1,95 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+
+#include "CX/Types.hpp"
+#include "CX/Status.hpp"
+#include "CX/Vector.hpp"
+#include "N2/CE/IConfig.hpp"
+#include "N2/CL/Config.hpp"
+
+
+namespace N2
+{
+
+namespace CL
+{
+
+class MultiConfig : public CE::IConfig
+{
+public:
+
+	enum Partition
+	{
+		Partition_None,
+		Partition_Equally,    //sub-devices of SetPartition's cComputeUnits compute units each
+		Partition_NUMA,       //one sub-device per NUMA node
+		Partition_L3Cache,    //one sub-device per L3 cache
+	};
+
+	MultiConfig();
+
+	~MultiConfig();
+
+	//no devices => the device chosen by OpenCL::ChooseDeviceByTypeAndIndex
+	void AddDevice(cl_device_id nDevID);
+
+	void ClearDevices();
+
+	CX::UInt32 GetDevicesCount() const;
+
+	cl_device_id GetDevice(CX::UInt32 cIndex) const;
+
+	//applies to the devices that support fission (usually CPUs); the others (or if partitioning fails) are used whole
+	void SetPartition(Partition nPartition, CX::UInt32 cComputeUnits = 0);
+
+	Partition GetPartition() const;
+
+	CX::UInt32 GetPartitionComputeUnits() const;
+
+	//settings of each device provider (the device ID is ignored)
+	Config *GetConfig();
+
+	const Config *GetConfig() const;
+
+private:
+
+	typedef CX::Vector<cl_device_id>::Type   DevicesVector;
+
+	DevicesVector   m_vectorDevices;
+	Partition       m_nPartition;
+	CX::UInt32      m_cComputeUnits;
+	Config          m_config;
+
+};
+
+}//namespace CL
+
+}//namespace N2
@@ -0,0 +1,128 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+
+#include "CX/Types.hpp"
+#include "CX/Status.hpp"
+#include "CX/Vector.hpp"
+#include "N2/CE/INetwork.hpp"
+#include "N2/CL/Network.hpp"
+#include "N2/CL/OpenCL.hpp"
+
+
+namespace N2
+{
+
+namespace CL
+{
+
+class MultiProvider;
+
+//a CL network (with its own copy of the weights) on each device of the provider; Evaluate splits the batch into 
+//shards sized by the throughput measured on each device
+class MultiNetwork : public CE::INetwork
+{
+public:
+
+	//weight (in percents) of the last measurement in the throughput moving average
+	static const CX::UInt32   THROUGHPUT_UPDATE_PERCENT = 25;
+
+	MultiNetwork(MultiProvider *pProvider);
+
+	~MultiNetwork();
+
+	MultiProvider *GetProvider();
+
+	virtual CX::Status Init(NET::Network *pNetwork);
+
+	virtual CX::Status Uninit();
+
+	virtual CX::Bool IsOK() const;
+
+	virtual CX::UInt32 GetLayersCount() const;
+
+	virtual const NET::Network *GetNetwork() const;
+
+	virtual NET::Network *GetNetwork();
+
+	//the neurons of the first device
+	virtual const CE::INeurons *GetInputNeurons() const;
+
+	virtual CE::INeurons *GetInputNeurons();
+
+	virtual const CE::INeurons *GetOutputNeurons() const;
+
+	virtual CE::INeurons *GetOutputNeurons();
+
+	//all the devices
+	virtual CX::Status SyncToCE(CX::Bool bWait = CX::True, CX::UInt32 nSyncType = Sync_All);
+
+	//the first device (the weights are the same on all of them)
+	virtual CX::Status SyncFromCE(CX::Bool bWait = CX::True, CX::UInt32 nSyncType = Sync_All);
+
+	virtual CX::Size GetMemSize() const;
+
+	//assumes that weights are already transferred into device memory; the shards run concurrently and a batch larger 
+	//than what the devices can hold is evaluated in rounds
+	virtual CX::Status Evaluate(CX::UInt32 cCount, CX::Float *inputs, CX::Float *outputs);
+
+	CX::UInt32 GetShardsCount() const;
+
+	Network *GetShard(CX::UInt32 cIndex);
+
+	//samples per second measured on the shard's device (initially estimated from its compute units and clock)
+	CX::Double GetShardThroughput(CX::UInt32 cIndex) const;
+
+private:
+
+	struct Shard
+	{
+		Network      *pNetwork;
+		CX::Double   lfThroughput;
+		CX::UInt32   cMaxCount;
+		CX::UInt32   cCount;
+		CX::UInt32   cOffset;
+	};
+
+	typedef CX::Vector<Shard>::Type   ShardsVector;
+
+	MultiProvider   *m_pProvider;
+	NET::Network    *m_pNetwork;
+	ShardsVector    m_vectorShards;
+
+	//splits up to cCount samples over the shards proportionally to their throughput (capped to what each can hold); 
+	//returns the number of samples assigned
+	CX::UInt32 SplitBatch(CX::UInt32 cCount);
+
+};
+
+}//namespace CL
+
+}//namespace N2
@@ -0,0 +1,89 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+
+#include "CX/Types.hpp"
+#include "CX/Status.hpp"
+#include "CX/Vector.hpp"
+#include "N2/CE/IProvider.hpp"
+#include "N2/CL/Provider.hpp"
+#include "N2/CL/MultiConfig.hpp"
+#include "N2/CL/OpenCL.hpp"
+
+
+namespace N2
+{
+
+namespace CL
+{
+
+//one CL provider (context, queue and weights) per device or sub-device; networks created by it split each batch over 
+//all of them
+class MultiProvider : public CE::IProvider
+{
+public:
+
+	MultiProvider();
+
+	~MultiProvider();
+
+	virtual CE::IConfig *CreateConfig();
+
+	virtual CX::Status DestroyConfig(CE::IConfig *pConfig);
+
+	virtual CX::Status Init(const CE::IConfig *pConfig = NULL);
+
+	virtual CX::Status Uninit();
+
+	virtual CX::Bool IsOK() const;
+
+	virtual CE::INetwork *CreateNetwork();
+
+	virtual CX::Status DestroyNetwork(CE::INetwork *pNetwork);
+
+	CX::UInt32 GetProvidersCount() const;
+
+	Provider *GetProvider(CX::UInt32 cIndex);
+
+private:
+
+	typedef CX::Vector<Provider *>::Type   ProvidersVector;
+
+	ProvidersVector   m_vectorProviders;
+
+	//appends the sub-devices of pDevice (or pDevice itself if it cannot be partitioned) to pVectorDevices
+	static CX::Status PartitionDevice(cl::Device *pDevice, MultiConfig::Partition nPartition, 
+	                                  CX::UInt32 cComputeUnits, std::vector<cl::Device> *pVectorDevices);
+
+};
+
+}//namespace CL
+
+}//namespace N2
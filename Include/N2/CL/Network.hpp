@@ -31,10 +31,13 @@
 
 #include "CX/Types.hpp"
 #include "CX/Status.hpp"
+#include "CX/Vector.hpp"
 #include "N2/CE/INetwork.hpp"
 #include "N2/CL/Neurons.hpp"
 #include "N2/CL/Synapses.hpp"
 #include "N2/CL/OpenCL.hpp"
+#include "N2/CL/Tuner.hpp"
+#include "CX/C/Platform/Windows/windows.h"
 
 
 namespace N2
@@ -48,12 +51,36 @@ class Network : public CE::INetwork
 {
 public:
 
+	static const CX::UInt32   STREAM_SLOTS              = 3;
+	static const CX::UInt32   DEFAULT_STREAM_CHUNK_SIZE = 4096;
+	static const CX::Size     MIN_TENSOR_ALIGNMENT      = 64;
+
+	//a device tensor (a sub-buffer of the pool, or its own buffer if the pool could not be allocated) and its host 
+	//array, or a range of it (cbOffset and pData then point to the range, cbBufferOffset is its offset in pBuffer)
+	struct Tensor
+	{
+		cl::Buffer   *pBuffer;
+		CX::Size     cbOffset;
+		CX::Size     cbSize;
+		CX::Float    *pData;
+		CX::Bool     bRange;
+		CX::Size     cbBufferOffset;
+	};
+
+	typedef CX::Vector<Tensor>::Type   TensorsVector;
+
 	Network(Provider *pProvider);
 
 	~Network();
 
 	Provider *GetProvider();
 
+	//creates the queue with profiling enabled (the events returned by EvaluateAsync then carry timestamps); must be 
+	//called before Init
+	void SetProfiling(CX::Bool bProfiling);
+
+	CX::Bool GetProfiling() const;
+
 	virtual CX::Status Init(NET::Network *pNetwork);
 
 	virtual CX::Status Uninit();
@@ -83,33 +110,170 @@ public:
 	//assumes that weights are already transferred into device memory
 	virtual CX::Status Evaluate(CX::UInt32 cCount, CX::Float *inputs, CX::Float *outputs);
 
+	//enqueues the whole batch without blocking; pEvent completes when outputs are filled (wait on it or poll its 
+	//CL_EVENT_COMMAND_EXECUTION_STATUS); inputs and outputs must stay valid until then; concurrent callers are 
+	//serialized while enqueuing (the cached kernels args are shared)
+	//batches go to the provider's scheduler queues, each with its own buffers so they run concurrently with the 
+	//other batches and networks; past the provider's max in flight this blocks until the oldest batch completes 
+	//(networks with profiling enabled keep their own queue and run one batch at a time)
+	CX::Status EvaluateAsync(CX::UInt32 cCount, CX::Float *inputs, CX::Float *outputs, cl::Event *pEvent);
+
+	//zero-copy evaluation: write cCount samples into the region returned by MapInputs, then EvaluateMapped hands out 
+	//the outputs region, valid until Unmap; no copies are made on host unified memory devices
+	CX::Status MapInputs(CX::UInt32 cCount, CX::Float **pInputs);
+
+	CX::Status EvaluateMapped(CX::Float **pOutputs);
+
+	CX::Status Unmap();
+
+	//evaluates the samples in chunks, each slot with its own queue and buffers, so that uploading chunk n + 1, 
+	//computing chunk n and reading back chunk n - 1 overlap; chunks are capped to fit the device memory so cCount is 
+	//not limited by it; blocks until all the outputs are read back
+	CX::Status EvaluateStream(CX::UInt32 cCount, CX::Float *inputs, CX::Float *outputs, 
+	                          CX::UInt32 cChunkSize = DEFAULT_STREAM_CHUNK_SIZE);
+
+	//largest chunk for which all the stream slots fit in device memory next to the weights
+	CX::UInt32 GetMaxStreamChunkSize() const;
+
+	//cbSize bytes of the pool's synapses (weights and biases) or neurons region; pcbOffset receives the offset in the 
+	//pool (only called while the network is initialized)
+	CX::Status AllocTensor(CX::Bool bSynapses, CX::Size cbSize, cl::Buffer *pBuffer, CX::Size *pcbOffset);
+
+	//copies the tensors between their host arrays and the device; with the pool this is a map / unmap per run of 
+	//adjacent tensors (zero-copy on host unified memory devices), tensor ranges are written one by one
+	CX::Status SyncTensors(const TensorsVector &vectorTensors, CX::Bool bToCE, CX::Bool bWait);
+
+	CX::Status SyncSynapses(Synapses *pSynapses, CX::Bool bToCE, CX::Bool bWait);
+
+	CX::Status SyncNeurons(Neurons *pNeurons, CX::Bool bToCE, CX::Bool bWait);
+
 	cl::CommandQueue *GetQueue();
 
+	//build log of the generated layer kernels (if their build failed the generic kernels are used)
+	const CX::Char *GetBuildLog() const;
+
 protected:
 
 	friend class Provider;
 
 private:
 
+	//device buffers for a batch, grown on demand and reused by the next calls (the queue is in-order, or event is 
+	//waited for)
+	struct Batch
+	{
+		cl::CommandQueue          *pQueue;
+		cl::Event                 event;
+		CX::UInt32                cCapacity;
+		CX::UInt32                cMappedCount;
+		CX::Float                 *mappedInputs;
+		CX::Float                 *mappedOutputs;
+		cl::Buffer                inputs;
+		cl::Buffer                outputs;
+		std::vector<cl::Buffer>   hidden;
+	};
+
+	//one device allocation for all the tensors of the network: the synapses region (weights and biases of all the 
+	//layers) followed by the neurons region; tensors are aligned to the device base address alignment
+	struct Pool
+	{
+		cl::Buffer   buffer;
+		CX::Size     cbAlignment;
+		CX::Size     cbSynapsesSize;
+		CX::Size     cbSize;
+		CX::Size     cbSynapsesUsed;
+		CX::Size     cbNeuronsUsed;
+	};
+
 	Provider           *m_pProvider;
 	cl::CommandQueue   *m_pQueue;
+	Pool               m_pool;
 	NET::Network       *m_pNetwork;
 	Neurons            *m_pInputNeurons;
 	Neurons            *m_pOutputNeurons;
 	CX::Size           m_cbMemSize;
+	Batch              m_batch;
+	Batch              m_streams[STREAM_SLOTS];
+	CX::UInt32         m_cMaxStreamChunkSize;
+	cl::Program        *m_pProgram;
+	CX::String         m_sBuildLog;
+	//whole network kernel of the generated program (weights and biases bound); 0 group size if not available
+	cl::Kernel         m_kernelNetwork;
+	CX::UInt32         m_cNetworkGroupSize;
+	CX::Bool           m_bProfiling;
+	//batches in flight on the scheduler queues (NULL if the network uses its own queue)
+	Batch              *m_slots;
+	CX::UInt32         m_cSlots;
+	CX::UInt32         m_cNextSlot;
+	//guards the slots and the batch buffers (their mapping too); the cached kernels are shared by all the batches and 
+	//their args are set at enqueue time => every enqueue of the layers holds it
+	SRWLOCK            m_srwlSlots;
+	//last upload of the tensors (the batches and stream slots on the other queues wait for it), under m_srwlSlots
+	cl::Event          m_syncEvent;
+
+	//sizes the pool for the network; a network too large for a single device allocation gets a buffer per tensor
+	CX::Status CreatePool(NET::Network *pNetwork);
+
+	CX::Size AlignTensorSize(CX::Size cbSize) const;
+
+	//the tensors of the neurons and / or synapses of all the layers; bToCE => only the synapses ranges marked dirty
+	void GetTensors(CX::UInt32 nSyncType, CX::Bool bToCE, TensorsVector *pVectorTensors);
+
+	//bToCE => the ranges marked since the last upload (if known) and the synapses are considered synced
+	static void AddTensors(Synapses *pSynapses, CX::Bool bToCE, TensorsVector *pVectorTensors);
+
+	static void AddTensor(cl::Buffer *pBuffer, CX::Size cbOffset, CX::Float *data, CX::UInt32 cFirst, 
+	                      CX::UInt32 cCount, CX::Bool bRange, TensorsVector *pVectorTensors);
+
+	//after a failed upload everything is uploaded again
+	void ResetSyncedVersions();
+
+	static void AddTensors(Neurons *pNeurons, TensorsVector *pVectorTensors);
+
+	//must not be called while the batch buffers are mapped
+	CX::Status ReserveBatch(Batch *pBatch, CX::UInt32 cCount);
+
+	CX::Status EnqueueLayers(Batch *pBatch, CX::UInt32 cCount, std::vector<cl::Event> *pEvents);
+
+	//inputs upload, layers and outputs read back on the batch queue, then flushed
+	CX::Status EnqueueBatch(Batch *pBatch, CX::UInt32 cCount, CX::Float *inputs, CX::Float *outputs, 
+	                        cl::Event *pEvent);
+
+	//completion of the batches in flight on the scheduler queues (uploads of the tensors wait for them)
+	void GetInFlightEvents(std::vector<cl::Event> *pEvents);
+
+	CX::UInt32 ComputeMaxStreamChunkSize() const;
+
+	//builds the KernelGenerator program for this network and creates the layer kernels (and the whole network kernel 
+	//if the two local buffers of the widest layer fit the device)
+	CX::Status GenerateKernels();
+
+	CX::Status CreateNetworkKernel(CX::UInt32 cGroupSize);
+
+	//params of the provider's tuner for the shape, measured on its first use; the candidates run on zeroed scratch 
+	//buffers so the batch buffers are left alone (pNeurons is used by Kernel_Activate, pSynapses by the others)
+	CX::Status Tune(const Tuner::Shape &shape, Synapses *pSynapses, Neurons *pNeurons, Tuner::Params *pParams);
+
+	//sets the buffer (at cArg) and offset (at cArg + 1) args of a cached kernel
+	CX::Status SetNeuronsArgs(cl::Kernel *pKernel, CX::UInt32 cArg, cl::Buffer *neurons, CX::UInt32 cNeuronsOffset);
+
+	//each command waits for pEvents, which is then replaced with the event of the command
+
+	//2-D range (next neurons x samples); uses the tiled kernels for batches of at least one tile
+	CX::Status Compute(cl::CommandQueue *pQueue, Synapses *pSynapses, cl::Buffer *prevNeurons, 
+	                   cl::Buffer *nextNeurons, CX::UInt32 cCount, std::vector<cl::Event> *pEvents);
 
-	CX::Status Compute(cl::Buffer *prevNeurons, CX::UInt32 cPrevNeuronsOffset, CX::UInt32 cPrevNeuronsCount,
-	                   cl::Buffer *weights, 
-	                   cl::Buffer *nextNeurons, CX::UInt32 cNextNeuronsOffset, CX::UInt32 cNextNeuronsCount);
+	//1-D range over the neurons of all the samples (activations are element-wise)
+	CX::Status Activate(cl::CommandQueue *pQueue, Neurons *pNeurons, cl::Buffer *neurons, CX::UInt32 cCount, 
+	                    std::vector<cl::Event> *pEvents);
 
-	CX::Status ComputeWithBias(CX::Float fBias, 
-	                           cl::Buffer *prevNeurons, CX::UInt32 cPrevNeuronsOffset, CX::UInt32 cPrevNeuronsCount,
-	                           cl::Buffer *weights, cl::Buffer *biases, 
-	                           cl::Buffer *nextNeurons, CX::UInt32 cNextNeuronsOffset, CX::UInt32 cNextNeuronsCount);
+	//generated kernel: compute, bias and activation in a single launch (plus one for softmax)
+	CX::Status ComputeLayer(cl::CommandQueue *pQueue, Synapses *pSynapses, cl::Buffer *prevNeurons, 
+	                        cl::Buffer *nextNeurons, CX::UInt32 cCount, std::vector<cl::Event> *pEvents);
 
-	CX::Status Activate(cl::Buffer *nextNeurons, CX::UInt32 cNextNeuronsOffset, CX::UInt32 cNextNeuronsCount, 
-	                    const CX::Char *szActivation, NET::ActivationType nActivation, CX::UInt32 cActivationArgs, 
-	                    const CX::Float *activationArgs);
+	//generated kernel: all the layers in a single launch, one work-group per sample
+	CX::Status ComputeNetwork(cl::CommandQueue *pQueue, cl::Buffer *inputs, cl::Buffer *outputs, CX::UInt32 cCount, 
+	                          std::vector<cl::Event> *pEvents);
 
 };
 
@@ -95,7 +95,11 @@ protected:
 	NET::Neurons          *m_pNeurons;
 	Synapses              *m_pPrevSynapses;
 	Synapses              *m_pNextSynapses;
+	//sub-buffer of the network's pool
 	cl::Buffer            m_values;
+	CX::Size              m_cbValuesOffset;
+	//activation kernel with the activation args (the neurons count for softmax) bound at Init (none for identity)
+	cl::Kernel            m_kernelActivate;
 	CX::Size              m_cbMemSize;
 	const CX::Char       *m_szActivationFunction;
 
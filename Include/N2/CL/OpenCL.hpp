@@ -61,6 +61,10 @@ public:
 	//get the first GPU device; if none then first CPU; if none then first ACCELERATOR; if none then the first anything!
 	static CX::Status ChooseDeviceByTypeAndIndex(std::vector<cl::Device> *pVectorDevices, cl::Device *pDevice);
 
+	//device fission (OpenCL 1.2); pProperties is a 0 terminated list of CL_DEVICE_PARTITION_* properties
+	static CX::Status CreateSubDevices(cl::Device *pDevice, const cl_device_partition_property *pProperties, 
+	                                   std::vector<cl::Device> *pVectorSubDevices);
+
 private:
 
 	OpenCL();
@@ -33,6 +33,8 @@
 #include "CX/Status.hpp"
 #include "N2/CE/IProvider.hpp"
 #include "N2/CL/OpenCL.hpp"
+#include "N2/CL/Tuner.hpp"
+#include "N2/CL/Scheduler.hpp"
 
 
 namespace N2
@@ -71,6 +73,28 @@ public:
 
 	const CX::Char *GetBuildLog() const;
 
+	//tile size the tiled compute kernels were built with
+	CX::UInt32 GetTileSize() const;
+
+	CX::Bool GetTiledCompute() const;
+
+	//CPU and integrated devices share the host memory; buffers are then synced by map / unmap instead of copies
+	CX::Bool IsHostUnifiedMemory() const;
+
+	//program binaries cache directory (empty when disabled)
+	const CX::Char *GetCacheDir() const;
+
+	CX::Bool GetGenerateKernels() const;
+
+	//NULL if auto tuning is disabled
+	Tuner *GetTuner();
+
+	//queues the networks evaluate their batches on
+	Scheduler *GetScheduler();
+
+	//batches of each network in flight at once
+	CX::UInt32 GetMaxInFlight() const;
+
 private:
 
 	static CX::Status COMPUTE_NEURONS_REGISTERED_STATUS;
@@ -80,6 +104,17 @@ private:
 	cl::Context   *m_pContext;
 	cl::Program   *m_pProgram;
 	CX::String    m_sBuildLog;
+	CX::UInt32    m_cTileSize;
+	CX::Bool      m_bTiledCompute;
+	CX::Bool      m_bHostUnifiedMemory;
+	CX::String    m_sCacheDir;
+	CX::Bool      m_bGenerateKernels;
+	Tuner         *m_pTuner;
+	Scheduler     *m_pScheduler;
+	CX::UInt32    m_cMaxInFlight;
+
+	//largest tile whose work-group and local tiles fit the device; CPU devices prefer 16 (tiles stay in L1)
+	static CX::UInt32 ChooseTileSize(cl::Device &device);
 
 };
 
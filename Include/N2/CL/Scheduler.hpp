@@ -0,0 +1,108 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+
+#include "CX/Types.hpp"
+#include "CX/Status.hpp"
+#include "N2/CL/OpenCL.hpp"
+#include "CX/C/Platform/Windows/windows.h"
+
+
+namespace N2
+{
+
+namespace CL
+{
+
+//command queues of a provider shared by all its networks: in-order queues (each batch goes to the least busy one) or 
+//a single out-of-order queue (the batch commands are ordered by their events only); batches are admitted in arrival 
+//order while less than the device limit are in flight, so a network flooding the device can not starve the others
+class Scheduler
+{
+public:
+
+	//batches in flight on the device per queue before admission blocks
+	static const CX::UInt32   QUEUE_DEPTH = 4;
+
+	Scheduler();
+
+	~Scheduler();
+
+	//cQueues = 0 => a single out-of-order queue (a single in-order queue if the device does not support it)
+	CX::Status Init(cl::Device *pDevice, cl::Context *pContext, CX::UInt32 cQueues);
+
+	//waits for all the batches in flight
+	CX::Status Uninit();
+
+	CX::Bool IsOK() const;
+
+	CX::UInt32 GetQueuesCount() const;
+
+	CX::Bool IsOutOfOrder() const;
+
+	CX::UInt32 GetInFlightCount() const;
+
+	//blocks until the batch is admitted; the batch must then be enqueued on *ppQueue and passed to Submit or Release
+	CX::Status Acquire(cl::CommandQueue **ppQueue, CX::UInt32 *pcQueue);
+
+	//the batch is in flight until event completes
+	CX::Status Submit(CX::UInt32 cQueue, cl::Event *pEvent);
+
+	//the batch was not enqueued after all
+	void Release(CX::UInt32 cQueue);
+
+private:
+
+	struct Queue
+	{
+		Scheduler          *pScheduler;
+		cl::CommandQueue   *pQueue;
+		CX::UInt32         cIndex;
+		CX::UInt32         cInFlight;
+	};
+
+	Queue                *m_queues;
+	CX::UInt32           m_cQueues;
+	CX::Bool             m_bOutOfOrder;
+	CX::UInt32           m_cMaxInFlight;
+	CX::UInt32           m_cInFlight;
+	//arrival order of the batches waiting for admission
+	CX::UInt64           m_nNextTicket;
+	CX::UInt64           m_nServedTicket;
+	mutable SRWLOCK      m_srwlQueues;
+	CONDITION_VARIABLE   m_cvQueues;
+
+	static void CL_CALLBACK OnComplete(cl_event event, cl_int nStatus, void *pUserData);
+
+};
+
+}//namespace CL
+
+}//namespace N2
@@ -95,8 +95,28 @@ protected:
 
 	Network              *m_pNetwork;
 	NET::Synapses        *m_pSynapses;
+	//sub-buffers of the network's pool
 	cl::Buffer           m_weights;
 	cl::Buffer           m_biases;
+	CX::Size             m_cbWeightsOffset;
+	CX::Size             m_cbBiasesOffset;
+	//version of the NET synapses last uploaded (only the ranges marked since are uploaded by SyncToCE)
+	CX::UInt64           m_nSyncedVersion;
+	//Compute or ComputeWithBias with weights, biases and counts bound at Init; the neurons and samples args are set 
+	//at enqueue time, under the network's m_srwlSlots
+	cl::Kernel           m_kernelCompute;
+	//ComputeTiled or ComputeWithBiasTiled, same bound args
+	cl::Kernel           m_kernelComputeTiled;
+	CX::UInt32           m_cPrevNeuronsArg;
+	CX::UInt32           m_cNextNeuronsArg;
+	CX::UInt32           m_cSamplesCountArg;
+	//Layer<n> and Layer<n>SoftMax of the network's generated program (weights and biases bound), empty if none
+	cl::Kernel           m_kernelLayer;
+	cl::Kernel           m_kernelLayerSoftMax;
+
+	CX::Status CreateComputeKernel(NET::Synapses *pSynapses, const CX::Char *szName, cl::Kernel *pKernel);
+
+	CX::Status CreateLayerKernels(cl::Program *pProgram, CX::UInt32 cLayer);
 	Neurons              *m_pPrevNeurons;
 	Neurons              *m_pNextNeurons;
 	CX::Size             m_cbMemSize;
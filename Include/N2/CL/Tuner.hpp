@@ -0,0 +1,152 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+
+#include "CX/Types.hpp"
+#include "CX/Status.hpp"
+#include "CX/Vector.hpp"
+#include "CX/Map.hpp"
+#include "CX/C/Platform/Windows/windows.h"
+#include "N2/CL/OpenCL.hpp"
+
+
+namespace N2
+{
+
+namespace CL
+{
+
+//work-group sizes (and tiled or not) of the compute and activate kernels, measured on the first use of each layer 
+//shape on the device; the results are kept in <cache dir>\N2_<device key>.tune and reused by later runs
+//batch sizes are bucketed so variable batch sizes (and the partial chunks of streams and shards) share a few shapes
+class Tuner
+{
+public:
+
+	static const CX::UInt32   TUNE_MAGIC   = 0x5554324E; //N2TU
+	static const CX::UInt32   TUNE_VERSION = 2;
+	static const CX::UInt32   TUNE_RUNS    = 3;          //timed runs of each candidate (after one warm up run)
+	static const CX::UInt32   MAX_SAMPLES  = 1024;       //largest samples bucket, larger batches are tuned as it
+
+	enum Kernel
+	{
+		Kernel_Compute  = 1,
+		Kernel_Activate = 2,
+		Kernel_Layer    = 3,
+	};
+
+	struct Shape
+	{
+		CX::UInt32   nKernel;
+		CX::UInt32   cPrevNeuronsCount;
+		CX::UInt32   cNextNeuronsCount;
+		CX::UInt32   cSamplesCount;      //a bucket, see GetSamplesBucket
+
+		bool operator<(const Shape &shape) const;
+	};
+
+	//0 local sizes => cl::NullRange
+	struct Params
+	{
+		CX::UInt32   cLocalSize0;
+		CX::UInt32   cLocalSize1;
+		CX::UInt32   bTiled;
+	};
+
+	struct Candidate
+	{
+		cl::Kernel    *pKernel;
+		cl::NDRange   global;
+		cl::NDRange   local;
+		Params        params;
+	};
+
+	typedef CX::Vector<Candidate>::Type   CandidatesVector;
+
+	Tuner();
+
+	~Tuner();
+
+	//szOptions are the build options of the device program (the tile size is part of the tuned params)
+	CX::Status Init(cl::Device *pDevice, cl::Context *pContext, const CX::Char *szOptions, 
+	                const CX::Char *szCacheDir);
+
+	CX::Status Uninit();
+
+	CX::Bool Find(const Shape &shape, Params *pParams);
+
+	//runs the candidates (with their args already set, usually to scratch buffers of the shape) and records the 
+	//params of the fastest one for the shape
+	CX::Status Tune(const Shape &shape, const CandidatesVector &vectorCandidates, Params *pParams);
+
+	//powers of two dividing cGlobalSize, up to cMaxSize
+	static void GetLocalSizes(CX::UInt32 cGlobalSize, CX::Size cMaxSize, CX::Vector<CX::UInt32>::Type *pVectorSizes);
+
+	//next power of two of cCount, up to MAX_SAMPLES
+	static CX::UInt32 GetSamplesBucket(CX::UInt32 cCount);
+
+	//a local size tuned for the bucket may not divide the actual global size => the largest power of two up to 
+	//cLocalSize that does (0 stays 0)
+	static CX::UInt32 FitLocalSize(CX::UInt32 cLocalSize, CX::UInt32 cGlobalSize);
+
+private:
+
+	struct Header
+	{
+		CX::UInt32   nMagic;
+		CX::UInt32   nVersion;
+		CX::UInt64   nKey;
+		CX::UInt32   cRecords;
+		CX::UInt32   nReserved;
+	};
+
+	struct Record
+	{
+		Shape    shape;
+		Params   params;
+	};
+
+	typedef CX::Map<Shape, Params>::Type   ParamsMap;
+
+	cl::CommandQueue   *m_pQueue;
+	CX::UInt64         m_nKey;
+	CX::String         m_sPath;
+	ParamsMap          m_mapParams;
+	SRWLOCK            m_srwlParams;
+
+	CX::Status Load();
+
+	CX::Status Save();
+
+};
+
+}//namespace CL
+
+}//namespace N2
@@ -67,16 +67,7 @@ struct Activation
 	static const ActivationType   SoftExponential = 20;
 	static const ActivationType   SoftMax         = 21;
 
-	static const ActivationType   MAX_VALUE       = 13;
-
-	//ISRLU
-	//SELU
-	//PRELU
-	//ISRU
-	//ELU
-	//SRELU
-	//SoftExponential
-	//SoftMax;
+	static const ActivationType   MAX_VALUE       = 21;
 };
 
 }//namespace NET
@@ -34,6 +34,7 @@
 #include "CX/IO/IInputStream.hpp"
 #include "CX/IO/IOutputStream.hpp"
 #include "N2/NET/Network.hpp"
+#include "N2/NET/MappedFile.hpp"
 
 
 namespace N2
@@ -58,6 +59,11 @@ public:
 
 	static CX::Status LoadSynapses(Network *pNetwork, const CX::Char *szPath);
 
+	//zero-copy load: the weights and biases of the network point into a read-only mapping of the synapses file, kept 
+	//open by the network until Uninit (or the next load); pages are read on first use and shared by all the processes 
+	//mapping the file; SyncFromCE leaves the mapped synapses alone and writers must call Synapses::MakeWritable first
+	static CX::Status MapSynapses(Network *pNetwork, const CX::Char *szPath);
+
 	static CX::Status SaveSynapses(const Network *pNetwork, const CX::Char *szPath);
 
 private:
@@ -82,6 +88,17 @@ private:
 
 	static CX::Status Read(CX::IO::IInputStream *pInputStream, void *pData, CX::Size cbSize);
 
+	template <typename T>
+	static CX::Status Read(const MappedFile *pFile, CX::UInt64 *pcbOffset, T *pVal)
+	{
+		return Read(pFile, pcbOffset, pVal, sizeof(T));
+	}
+
+	static CX::Status Read(const MappedFile *pFile, CX::UInt64 *pcbOffset, void *pData, CX::Size cbSize);
+
+	//returns the address of cbSize bytes at *pcbOffset in the mapping and skips them
+	static CX::Status Skip(const MappedFile *pFile, CX::UInt64 *pcbOffset, CX::UInt64 cbSize, const void **ppData);
+
 };
 
 }//namespace NET
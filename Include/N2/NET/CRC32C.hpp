@@ -0,0 +1,73 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+
+#include "CX/Types.hpp"
+
+
+namespace N2
+{
+
+namespace NET
+{
+
+//CRC-32C (Castagnoli); SSE4.2 crc32 instructions when the CPU has them, a table otherwise (same results)
+class CRC32C
+{
+public:
+
+	//nCRC is the result for the previous bytes when computing it in pieces (0 for the first piece)
+	static CX::UInt32 Compute(const void *pData, CX::Size cbSize, CX::UInt32 nCRC = 0);
+
+	//the CRC of A followed by B from the CRCs of A and B (cbSize2 = size of B), so that pieces can be computed in 
+	//parallel
+	static CX::UInt32 Combine(CX::UInt32 nCRC1, CX::UInt32 nCRC2, CX::UInt64 cbSize2);
+
+	static CX::Bool HasHardwareSupport();
+
+private:
+
+	CRC32C();
+
+	~CRC32C();
+
+	static CX::UInt32 ComputeHardware(const CX::Byte *pData, CX::Size cbSize, CX::UInt32 nCRC);
+
+	static CX::UInt32 ComputeSoftware(const CX::Byte *pData, CX::Size cbSize, CX::UInt32 nCRC);
+
+	static CX::UInt32 MultiplyMatrix(const CX::UInt32 *matrix, CX::UInt32 nVector);
+
+	static void SquareMatrix(CX::UInt32 *square, const CX::UInt32 *matrix);
+
+};
+
+}//namespace NET
+
+}//namespace N2
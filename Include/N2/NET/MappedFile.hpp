@@ -0,0 +1,81 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+
+#include "CX/Types.hpp"
+#include "CX/Status.hpp"
+#include "CX/C/Platform/Windows/windows.h"
+
+
+namespace N2
+{
+
+namespace NET
+{
+
+//read-only view of a whole file; pages are read on first access and shared (page cache) by all the processes mapping 
+//the same file
+class MappedFile
+{
+public:
+
+	MappedFile();
+
+	~MappedFile();
+
+	CX::Status Open(const CX::Char *szPath);
+
+	CX::Status Close();
+
+	CX::Bool IsOK() const;
+
+	const CX::Byte *GetData() const;
+
+	CX::UInt64 GetSize() const;
+
+	//asks the system to read the pages of a range of a mapping in the background (no-op before Windows 8)
+	static void Prefetch(const void *pData, CX::Size cbSize);
+
+	//removes the pages of a range of a mapping from the working set; they stay in the file cache (standby) until the 
+	//memory is needed, so touching them again is cheap unless they were reclaimed
+	static void Evict(const void *pData, CX::Size cbSize);
+
+private:
+
+	HANDLE           m_hFile;
+	HANDLE           m_hMapping;
+	const CX::Byte   *m_pData;
+	CX::UInt64       m_cbSize;
+
+};
+
+}//namespace NET
+
+}//namespace N2
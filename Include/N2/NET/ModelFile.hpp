@@ -0,0 +1,150 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+
+#include "CX/Types.hpp"
+#include "CX/Status.hpp"
+#include "CX/Vector.hpp"
+#include "N2/NET/Layer.hpp"
+#include "N2/NET/MappedFile.hpp"
+
+
+namespace N2
+{
+
+namespace NET
+{
+
+//v2 model file: topology, weights and biases of a whole network in a single file
+//  header | section table | sections (each one at a multiple of ALIGNMENT, zero padded)
+//little endian; each section has its CRC-32C, the header has the one of the header (checksum zeroed) and the table
+class ModelFile
+{
+public:
+
+	static const CX::UInt32   MAGIC     = 0x324D324E;
+	static const CX::UInt32   VERSION   = 0x00000002;
+	static const CX::UInt32   ALIGNMENT = 64;
+
+	//sections of the layers are indexed by synapses (0 = between the input layer and the first hidden one)
+	enum SectionType
+	{
+		Section_Topology = 1,
+		Section_Weights  = 2,
+		Section_Biases   = 3,
+		//weights already in an engine specific layout, identified by nLayout (ignored by engines using another one)
+		Section_Packed   = 4,
+	};
+
+	//64 bytes
+	struct Header
+	{
+		CX::UInt32   nMagic;
+		CX::UInt32   nVersion;
+		CX::UInt32   nChecksum;
+		CX::UInt32   cSections;
+		CX::UInt64   cbFileSize;
+		CX::UInt32   nFlags;
+		CX::UInt32   cbAlignment;
+		CX::Byte     reserved[32];
+	};
+
+	//32 bytes
+	struct Section
+	{
+		CX::UInt32   nType;
+		CX::UInt32   cLayer;
+		CX::UInt64   cbOffset;
+		CX::UInt64   cbSize;
+		CX::UInt32   nChecksum;
+		CX::UInt32   nLayout;
+	};
+
+	//topology section: TopologyHeader followed by cLayers LayerRecord (the input layer is not included)
+	struct TopologyHeader
+	{
+		CX::UInt32   cInputNeurons;
+		CX::UInt32   cLayers;
+	};
+
+	//56 bytes
+	struct LayerRecord
+	{
+		CX::UInt32   cNeurons;
+		CX::UInt16   nActivation;
+		CX::UInt8    bHasBias;
+		CX::UInt8    nReserved;
+		CX::Float    fBias;
+		CX::UInt32   cActivationArgs;
+		CX::Float    activationArgs[Neurons::MAX_ACTIVATION_ARGS_COUNT];
+	};
+
+	typedef CX::Vector<Layer>::Type   LayersVector;
+
+	ModelFile();
+
+	~ModelFile();
+
+	//maps the file and validates the header and the section table (checksum, bounds, alignment); the checksums of the 
+	//sections are verified by VerifySection, so that only the sections used are read
+	CX::Status Open(const CX::Char *szPath);
+
+	CX::Status Close();
+
+	CX::Bool IsOK() const;
+
+	CX::UInt32 GetSectionsCount() const;
+
+	const Section *GetSection(CX::UInt32 cSection) const;
+
+	//NULL if there is no such section (nLayout only matters for Section_Packed)
+	const Section *FindSection(CX::UInt32 nType, CX::UInt32 cLayer, CX::UInt32 nLayout = 0) const;
+
+	const CX::Byte *GetSectionData(const Section *pSection) const;
+
+	CX::Status VerifySection(const Section *pSection) const;
+
+	//the topology section, verified and validated (for Network::Init)
+	CX::Status GetLayers(CX::UInt32 *pcInputNeurons, LayersVector *pVectorLayers) const;
+
+	//hands the mapping over to the caller (a network whose synapses point into it); the model file is then closed
+	MappedFile *DetachFile();
+
+private:
+
+	MappedFile      *m_pFile;
+	const Header    *m_pHeader;
+	const Section   *m_sections;
+
+};
+
+}//namespace NET
+
+}//namespace N2
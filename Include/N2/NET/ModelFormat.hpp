@@ -0,0 +1,114 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+
+#include "CX/Types.hpp"
+#include "CX/Status.hpp"
+#include "CX/Vector.hpp"
+#include "CX/IO/IOutputStream.hpp"
+#include "N2/NET/Network.hpp"
+#include "N2/NET/ModelFile.hpp"
+#include "N2/NET/ParallelCopy.hpp"
+
+
+namespace N2
+{
+
+namespace NET
+{
+
+//v2 single file format (see ModelFile); BinaryFormat keeps the v1 neurons and synapses files
+class ModelFormat
+{
+public:
+
+	//engine specific layout of the weights of a layer, stored next to them
+	struct PackedLayout
+	{
+		CX::UInt32   cLayer;
+		CX::UInt32   nLayout;
+		const void   *pData;
+		CX::Size     cbSize;
+	};
+
+	typedef CX::Vector<PackedLayout>::Type   PackedLayoutsVector;
+
+	//initializes the network from the topology and copies the weights and biases, verifying all the checksums; the 
+	//sections are read, copied and checksummed in chunks on cThreads threads (0 => one per logical processor)
+	static CX::Status Load(Network *pNetwork, const CX::Char *szPath, CX::UInt32 cThreads = 0);
+
+	//zero-copy load: the weights and biases (64 bytes aligned) are used in place from a read-only mapping of the file, 
+	//kept open by the network (see BinaryFormat::MapSynapses); bVerify reads the whole file to check the checksums, 
+	//otherwise only the topology is verified and the pages are read on first use; the weights are never copied, so 
+	//models larger than the memory can be mapped (see SWST::Config::SetStreamWeights to evaluate them)
+	static CX::Status Map(Network *pNetwork, const CX::Char *szPath, CX::Bool bVerify = CX::False, 
+	                      CX::UInt32 cThreads = 0);
+
+	static CX::Status Save(const Network *pNetwork, const CX::Char *szPath, 
+	                       const PackedLayoutsVector *pVectorPacked = NULL);
+
+private:
+
+	typedef CX::Vector<const ModelFile::Section *>::Type   SectionsVector;
+
+	ModelFormat();
+
+	~ModelFormat();
+
+	//initializes the network from the topology of the model file
+	static CX::Status InitNetwork(Network *pNetwork, const ModelFile *pFile, CX::Bool bAllocateWeights);
+
+	//the weights and biases (NULL if the layer has none) sections of the synapses cLayer in the model file
+	static CX::Status GetSynapsesData(const ModelFile *pFile, const Synapses *pSynapses, CX::UInt32 cLayer, 
+	                                  const ModelFile::Section **ppWeightsSection, 
+	                                  const ModelFile::Section **ppBiasesSection);
+
+	//pDest = NULL => checksum only
+	static void AddTask(const ModelFile *pFile, const ModelFile::Section *pSection, void *pDest, 
+	                    ParallelCopy::TasksVector *pVectorTasks, SectionsVector *pVectorSections);
+
+	static CX::Status VerifyTasks(const ParallelCopy::TasksVector *pVectorTasks, 
+	                              const SectionsVector *pVectorSections);
+
+	static void AddSection(CX::Vector<ModelFile::Section>::Type *pVectorSections, 
+	                       CX::Vector<const void *>::Type *pVectorData, CX::UInt32 nType, CX::UInt32 cLayer, 
+	                       CX::UInt32 nLayout, const void *pData, CX::Size cbSize);
+
+	static CX::UInt64 Align(CX::UInt64 cbSize);
+
+	static CX::Status Write(CX::IO::IOutputStream *pOutputStream, const void *pData, CX::Size cbSize);
+
+	static CX::Status WritePadding(CX::IO::IOutputStream *pOutputStream, CX::UInt64 cbSize);
+
+};
+
+}//namespace NET
+
+}//namespace N2
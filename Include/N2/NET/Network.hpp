@@ -46,6 +46,7 @@ namespace N2
 namespace NET
 {
 
+class MappedFile;
 class Network
 {
 public:
@@ -66,7 +67,9 @@ public:
 
 	~Network();
 
-	CX::Status Init(CX::UInt32 cInputNeuronsCount, CX::UInt32 cLayersCount, const Layer *layers);
+	//see Synapses::Init for bAllocateWeights
+	CX::Status Init(CX::UInt32 cInputNeuronsCount, CX::UInt32 cLayersCount, const Layer *layers, 
+	                CX::Bool bAllocateWeights = CX::True);
 
 	CX::Status Uninit();
 
@@ -187,10 +190,18 @@ public:
 
 private:
 
+	friend class BinaryFormat;
+	friend class ModelFormat;
+
 	CX::UInt32           m_cLayers;
 	Neurons              *m_pInputNeurons;
 	Neurons              *m_pOutputNeurons;
 	CX::Size             m_cbMemSize;
+	//model file the synapses point into (BinaryFormat::MapSynapses, ModelFormat::Map), closed after them
+	MappedFile           *m_pMappedFile;
+
+	//takes ownership of pMappedFile, closing the previous one
+	void SetMappedFile(MappedFile *pMappedFile);
 };
 
 }//namespace NET
@@ -82,6 +82,9 @@ public:
 
 	CX::Size GetMemSize() const;
 
+	//the args the engines read for nActivation (0 for an invalid one)
+	static CX::UInt32 GetMinActivationArgsCount(ActivationType nActivation);
+
 protected:
 
 	friend class Network;
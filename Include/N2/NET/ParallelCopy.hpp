@@ -0,0 +1,99 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+
+#include "CX/Types.hpp"
+#include "CX/Status.hpp"
+#include "CX/Vector.hpp"
+#include "CX/C/Platform/Windows/windows.h"
+
+
+namespace N2
+{
+
+namespace NET
+{
+
+//copies (and / or computes the CRC-32C of) arrays on several threads; the arrays are split in chunks whose checksums 
+//are combined, so that a single large layer is spread over all the threads too
+class ParallelCopy
+{
+public:
+
+	static const CX::Size    CHUNK_SIZE        = 4194304;
+	static const DWORD       THREAD_STACK_SIZE = 65536;
+
+	struct Task
+	{
+		void         *pDest;          //NULL => checksum only
+		const void   *pSource;
+		CX::Size     cbSize;
+		CX::Bool     bChecksum;
+		CX::UInt32   nChecksum;       //CRC-32C of the source (set by Run if bChecksum)
+	};
+
+	typedef CX::Vector<Task>::Type   TasksVector;
+
+	//cThreads = 0 => one per logical processor; the calling thread is one of them and no threads are created for a 
+	//single chunk
+	static CX::Status Run(TasksVector *pVectorTasks, CX::UInt32 cThreads = 0);
+
+private:
+
+	struct Chunk
+	{
+		CX::UInt32   cTask;
+		CX::Size     cbOffset;
+		CX::Size     cbSize;
+		CX::UInt32   nChecksum;
+	};
+
+	typedef CX::Vector<Chunk>::Type   ChunksVector;
+
+	struct Context
+	{
+		TasksVector     *pVectorTasks;
+		ChunksVector    *pVectorChunks;
+		volatile LONG   cNextChunk;
+	};
+
+	ParallelCopy();
+
+	~ParallelCopy();
+
+	static void RunChunks(Context *pContext);
+
+	static DWORD WINAPI WorkerThread(void *pArg);
+
+};
+
+}//namespace NET
+
+}//namespace N2
@@ -31,6 +31,7 @@
 
 #include "CX/Types.hpp"
 #include "CX/Status.hpp"
+#include "CX/Vector.hpp"
 
 
 namespace N2
@@ -44,12 +45,29 @@ class Synapses
 {
 public:
 
+	//marked ranges kept for the engines to catch up with; older ones are dropped (those engines then sync everything)
+	static const CX::UInt32   MAX_DIRTY_RANGES = 1024;
+
+	//version of the engine copies that were never synced (GetDirtyRanges returns False for it)
+	static const CX::UInt64   VERSION_NONE     = (CX::UInt64)-1;
+
+	struct DirtyRange
+	{
+		CX::Bool     bBiases;
+		CX::UInt32   cFirst;
+		CX::UInt32   cCount;
+	};
+
+	typedef CX::Vector<DirtyRange>::Type   DirtyRangesVector;
+
 	Synapses();
 
 	~Synapses();
 
+	//bAllocateWeights is False for synapses whose weights will be set by SetExternalStorage (mapped models larger 
+	//than the memory would otherwise be committed twice)
 	CX::Status Init(CX::UInt32 cPrevNeuronsCount, CX::UInt32 cNextNeuronsCount, CX::Bool bHasBias = CX::False, 
-	                CX::Float fBias = 1.0f);
+	                CX::Float fBias = 1.0f, CX::Bool bAllocateWeights = CX::True);
 
 	CX::Status Uninit();
 
@@ -85,6 +103,38 @@ public:
 
 	CX::Size GetMemSize() const;
 
+	//writers of the weights or biases (through GetWeights / GetBiases) mark the elements they changed; SyncToCE of 
+	//the engines then only copies the ranges marked since their last sync, and skips the synapses if there are none
+	void MarkWeightsDirty(CX::UInt32 cFirst, CX::UInt32 cCount);
+
+	void MarkBiasesDirty(CX::UInt32 cFirst, CX::UInt32 cCount);
+
+	//all the values changed (loaders, external storage); the engines then copy everything
+	void MarkAllDirty();
+
+	//incremented by each mark
+	CX::UInt64 GetVersion() const;
+
+	//the merged ranges marked after nVersion (none if nothing was marked since); False means everything has to be 
+	//synced: nVersion is VERSION_NONE or the ranges were dropped (MarkAllDirty, or the log was full)
+	CX::Bool GetDirtyRanges(CX::UInt64 nVersion, DirtyRangesVector *pVectorRanges) const;
+
+	//points the weights (and the biases, if not NULL) to memory owned by someone else (a mapped model file) which 
+	//must outlive the synapses or the next SetExternalStorage / MakeWritable; the arrays are then read-only
+	CX::Status SetExternalStorage(const CX::Float *weights, const CX::Float *biases);
+
+	//the weights or the biases are in external storage and must not be written
+	CX::Bool IsReadOnly() const;
+
+	//copies the external arrays into owned ones (nothing to do if they are already owned)
+	CX::Status MakeWritable();
+
+	//read-ahead of the external arrays (asynchronous) and their removal from the working set once used; the pages 
+	//stay in the file cache while there is memory for them; nothing to do for owned arrays
+	void Prefetch() const;
+
+	void Evict() const;
+
 protected:
 
 	friend class Network;
@@ -98,6 +148,24 @@ protected:
 	Neurons              *m_pPrevNeurons;
 	Neurons              *m_pNextNeurons;
 	CX::Size             m_cbMemSize;
+	CX::Bool             m_bExternalWeights;
+	CX::Bool             m_bExternalBiases;
+
+private:
+
+	struct VersionedRange
+	{
+		CX::UInt64   nVersion;
+		DirtyRange   range;
+	};
+
+	typedef CX::Vector<VersionedRange>::Type   VersionedRangesVector;
+
+	CX::UInt64              m_nVersion;
+	CX::UInt64              m_nDroppedVersion;
+	VersionedRangesVector   m_vectorDirtyRanges;
+
+	void MarkDirty(CX::Bool bBiases, CX::UInt32 cFirst, CX::UInt32 cCount, CX::UInt32 cTotal);
 
 };
 
@@ -0,0 +1,218 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+
+#include "CX/Types.hpp"
+#include "CX/Status.hpp"
+#include "CX/C/Platform/Windows/windows.h"
+
+
+namespace N2
+{
+
+namespace SWMT
+{
+
+//bounded lock-free multi-producer / multi-consumer queue (D. Vyukov); T must be trivially copyable
+template <typename T>
+class BoundedQueue
+{
+public:
+
+	static const CX::Size   CACHE_LINE_SIZE = 64;
+
+	BoundedQueue()
+	{
+		m_cells       = NULL;
+		m_nMask       = 0;
+		m_nEnqueuePos = 0;
+		m_nDequeuePos = 0;
+	}
+
+	~BoundedQueue()
+	{
+		Uninit();
+	}
+
+	//cCapacity must be a power of 2
+	CX::Status Init(CX::UInt32 cCapacity)
+	{
+		Uninit();
+
+		if (2 > cCapacity || 0 != (cCapacity & (cCapacity - 1)))
+		{
+			return CX::Status(CX::Status_InvalidArg, "Invalid arg at {1}:{2}", __FILE__, __LINE__);
+		}
+		if (NULL == (m_cells = (Cell *)CX::Mem::Alloc(sizeof(Cell) * cCapacity)))
+		{
+			return CX::Status(CX::Status_MemAllocFailed, "Failed to allocate {1} bytes at {2}:{3}", 
+			                  sizeof(Cell) * cCapacity, __FILE__, __LINE__);
+		}
+		for (CX::UInt32 i = 0; i < cCapacity; i++)
+		{
+			m_cells[i].nSeq = (LONG)i;
+		}
+		m_nMask       = (LONG)(cCapacity - 1);
+		m_nEnqueuePos = 0;
+		m_nDequeuePos = 0;
+
+		return CX::Status();
+	}
+
+	CX::Status Uninit()
+	{
+		if (NULL != m_cells)
+		{
+			CX::Mem::Free(m_cells);
+		}
+		m_cells       = NULL;
+		m_nMask       = 0;
+		m_nEnqueuePos = 0;
+		m_nDequeuePos = 0;
+
+		return CX::Status();
+	}
+
+	CX::UInt32 GetCapacity() const
+	{
+		return (CX::UInt32)m_nMask + 1;
+	}
+
+	//returns False if the queue is full
+	CX::Bool Push(const T &value)
+	{
+		Cell   *pCell;
+		LONG   nPos;
+		LONG   nPrevPos;
+		LONG   nDiff;
+
+		nPos = m_nEnqueuePos;
+		for (;;)
+		{
+			pCell = &m_cells[nPos & m_nMask];
+			nDiff = Diff(pCell->nSeq, nPos);
+			if (0 == nDiff)
+			{
+				if (nPos == (nPrevPos = InterlockedCompareExchange(&m_nEnqueuePos, Next(nPos, 1), nPos)))
+				{
+					break;
+				}
+				nPos = nPrevPos;
+			}
+			else
+			if (0 > nDiff)
+			{
+				return CX::False;
+			}
+			else
+			{
+				nPos = m_nEnqueuePos;
+			}
+		}
+		pCell->value = value;
+		InterlockedExchange(&pCell->nSeq, Next(nPos, 1));
+
+		return CX::True;
+	}
+
+	//returns False if the queue is empty
+	CX::Bool Pop(T *pValue)
+	{
+		Cell   *pCell;
+		LONG   nPos;
+		LONG   nPrevPos;
+		LONG   nDiff;
+
+		nPos = m_nDequeuePos;
+		for (;;)
+		{
+			pCell = &m_cells[nPos & m_nMask];
+			nDiff = Diff(pCell->nSeq, Next(nPos, 1));
+			if (0 == nDiff)
+			{
+				if (nPos == (nPrevPos = InterlockedCompareExchange(&m_nDequeuePos, Next(nPos, 1), nPos)))
+				{
+					break;
+				}
+				nPos = nPrevPos;
+			}
+			else
+			if (0 > nDiff)
+			{
+				return CX::False;
+			}
+			else
+			{
+				nPos = m_nDequeuePos;
+			}
+		}
+		*pValue = pCell->value;
+		InterlockedExchange(&pCell->nSeq, Next(nPos, m_nMask + 1));
+
+		return CX::True;
+	}
+
+private:
+
+	struct Cell
+	{
+		volatile LONG   nSeq;
+		T               value;
+	};
+
+	Cell            *m_cells;
+	LONG            m_nMask;
+	//producers and consumers update different cache lines
+	CX::Byte        m_padding1[CACHE_LINE_SIZE];
+	volatile LONG   m_nEnqueuePos;
+	CX::Byte        m_padding2[CACHE_LINE_SIZE];
+	volatile LONG   m_nDequeuePos;
+	CX::Byte        m_padding3[CACHE_LINE_SIZE];
+
+	BoundedQueue(const BoundedQueue &);
+
+	BoundedQueue &operator=(const BoundedQueue &);
+
+	//positions wrap around, so they are compared and advanced in unsigned arithmetic
+	static LONG Diff(LONG nA, LONG nB)
+	{
+		return (LONG)((ULONG)nA - (ULONG)nB);
+	}
+
+	static LONG Next(LONG nPos, LONG nCount)
+	{
+		return (LONG)((ULONG)nPos + (ULONG)nCount);
+	}
+
+};
+
+}//namespace SWMT
+
+}//namespace N2
@@ -52,9 +52,21 @@ public:
 
 	CX::UInt32 GetThreadsCount() const;
 
+	//pins each worker thread to a physical core, spreading the threads over the NUMA nodes
+	void SetPinThreads(CX::Bool bPinThreads);
+
+	CX::Bool GetPinThreads() const;
+
+	//keeps a copy of the weights on each NUMA node (implies thread pinning)
+	void SetReplicateWeights(CX::Bool bReplicateWeights);
+
+	CX::Bool GetReplicateWeights() const;
+
 private:
 
 	CX::UInt32   m_cThreads;
+	CX::Bool     m_bPinThreads;
+	CX::Bool     m_bReplicateWeights;
 
 };
 
@@ -43,94 +43,52 @@ class IKernel
 {
 public:
 
+	//[cBegin, cEnd) of the flattened index space given to Provider::RunKernel
+	struct Range
+	{
+		CX::UInt32   cReplica;      //weights replica local to the calling thread
+		CX::UInt32   cBegin;
+		CX::UInt32   cEnd;
+	};
+
 	virtual ~IKernel() { }
 
-	virtual void Run(CX::UInt32 cDims, const CX::UInt32 *dims, const CX::UInt32 *startIdxs, CX::UInt32 cCount)
+	//one call per thread and range; the per-element work is done by the implementation
+	virtual void Run(const Range &range) = 0;
+
+};
+
+//wraps a functor or lambda taking a const IKernel::Range &; the body is inlined into Run so the whole range can be 
+//optimized (and vectorized) by the compiler
+template <typename BODY>
+class Kernel : public IKernel
+{
+public:
+
+	BODY   body;
+
+	Kernel()
 	{
-		if (3 == cDims)
-		{
-			CX::UInt32   idxs[3] = { startIdxs[0], startIdxs[1], startIdxs[2] };
-
-			for (unsigned int k = 0; k < cCount; k++)
-			{
-				Run(cDims, idxs);
-				if (idxs[2] + 1 < dims[2])
-				{
-					idxs[2]++;
-				}
-				else
-				{
-					idxs[2] = 0;
-					if (idxs[1] + 1 < dims[1])
-					{
-						idxs[1]++;
-					}
-					else
-					{
-						idxs[1] = 0;
-						if (idxs[0] + 1 < dims[0])
-						{
-							idxs[0]++;
-						}
-						else
-						{
-							break;
-						}
-					}
-				}
-			}
-		}
-		else
-		if (2 == cDims)
-		{
-			CX::UInt32   idxs[2] = { startIdxs[0], startIdxs[1] };
-
-			for (unsigned int k = 0; k < cCount; k++)
-			{
-				Run(cDims, idxs);
-				if (idxs[1] + 1 < dims[1])
-				{
-					idxs[1]++;
-				}
-				else
-				{
-					idxs[1] = 0;
-					if (idxs[0] + 1 < dims[0])
-					{
-						idxs[0]++;
-					}
-					else
-					{
-						break;
-					}
-				}
-			}
-		}
-		else
-		{
-			CX::UInt32   idxs[1] = { startIdxs[0] };
-
-			for (unsigned int k = 0; k < cCount; k++)
-			{
-				Run(cDims, idxs);
-				if (idxs[0] + 1 < dims[0])
-				{
-					idxs[0]++;
-				}
-				else
-				{
-					break;
-				}
-			}
-		}
 	}
 
-	virtual void Run(CX::UInt32 cDims, const CX::UInt32 *idxs)
+	Kernel(const BODY &b)
+		: body(b)
 	{
 	}
 
+	virtual void Run(const Range &range)
+	{
+		body(range);
+	}
+
 };
 
+template <typename BODY>
+inline Kernel<BODY> MakeKernel(const BODY &body)
+{
+	return Kernel<BODY>(body);
+}
+
 }//namespace SWMT
 
 }//namespace N2
@@ -35,6 +35,7 @@
 #include "N2/SWMT/Neurons.hpp"
 #include "N2/SWMT/Synapses.hpp"
 #include "N2/SWMT/IKernel.hpp"
+#include "N2/SWMT/Provider.hpp"
 
 
 namespace N2
@@ -43,7 +44,6 @@ namespace N2
 namespace SWMT
 {
 
-class Provider;
 class Network : public CE::INetwork
 {
 public:
@@ -54,6 +54,11 @@ public:
 
 	Provider *GetProvider();
 
+	//priority of the kernels queued by Evaluate; Priority_Auto (default) => High for a single sample, Normal otherwise
+	void SetPriority(Provider::Priority nPriority);
+
+	Provider::Priority GetPriority() const;
+
 	virtual CX::Status Init(NET::Network *pNetwork);
 
 	virtual CX::Status Uninit();
@@ -86,6 +91,7 @@ public:
 protected:
 
 	friend class Provider;
+	friend class Pipeline;
 
 private:
 
@@ -94,47 +100,46 @@ private:
 	Neurons            *m_pInputNeurons;
 	Neurons            *m_pOutputNeurons;
 	CX::Size           m_cbMemSize;
+	Provider::Priority m_nPriority;
 
-	class ComputeKernel : public IKernel
+	//next = prev x weights, one axpy per previous neuron over the contiguous weights row so the inner loop vectorizes
+	class ComputeKernel
 	{
 	public:
 
 		CX::Float    *prevNeurons;
 		CX::UInt32   cPrevNeuronsOffset;
 		CX::UInt32   cPrevNeuronsCount;
-		CX::Float    *weights;
+		CX::Float    **weights;            //one per replica
 		CX::Float    *nextNeurons;
 		CX::UInt32   cNextNeuronsOffset;
 		CX::UInt32   cNextNeuronsCount;
 
-		virtual void Run(CX::UInt32 cDims, const CX::UInt32 *dims, const CX::UInt32 *startIdxs, CX::UInt32 cCount)
+		void operator()(const IKernel::Range &range) const
 		{
-			CX::UInt32   idxs[1] = { startIdxs[0] };
+			const CX::Float   *prev = prevNeurons + cPrevNeuronsOffset;
+			const CX::Float   *w    = weights[range.cReplica];
+			CX::Float         *next = nextNeurons + cNextNeuronsOffset;
 
-			for (unsigned int i = 0; i < cCount; i++)
+			for (CX::UInt32 i = range.cBegin; i < range.cEnd; i++)
 			{
-				CX::Float   fValue = 0.0f;
-
-				for (CX::UInt32 k = 0; k < cPrevNeuronsCount; k++)
-				{
-					fValue += prevNeurons[cPrevNeuronsOffset + k] * weights[k * cNextNeuronsCount + idxs[0]];
-				}
-				nextNeurons[cNextNeuronsOffset+ idxs[0]] = fValue;
+				next[i] = 0.0f;
+			}
+			for (CX::UInt32 k = 0; k < cPrevNeuronsCount; k++)
+			{
+				const CX::Float   fPrev = prev[k];
+				const CX::Float   *row  = w + k * cNextNeuronsCount;
 
-				if (idxs[0] + 1 < dims[0])
-				{
-					idxs[0]++;
-				}
-				else
+				for (CX::UInt32 i = range.cBegin; i < range.cEnd; i++)
 				{
-					break;
+					next[i] += fPrev * row[i];
 				}
 			}
 		}
 
 	};
 
-	class ComputeWithBiasKernel : public IKernel
+	class ComputeWithBiasKernel
 	{
 	public:
 
@@ -142,41 +147,38 @@ private:
 		CX::Float    *prevNeurons;
 		CX::UInt32   cPrevNeuronsOffset;
 		CX::UInt32   cPrevNeuronsCount;
-		CX::Float    *weights;
-		CX::Float    *biases;
+		CX::Float    **weights;            //one per replica
+		CX::Float    **biases;             //one per replica
 		CX::Float    *nextNeurons;
 		CX::UInt32   cNextNeuronsOffset;
 		CX::UInt32   cNextNeuronsCount;
 
-		virtual void Run(CX::UInt32 cDims, const CX::UInt32 *dims, const CX::UInt32 *startIdxs, CX::UInt32 cCount)
+		void operator()(const IKernel::Range &range) const
 		{
-			CX::UInt32   idxs[1] = { startIdxs[0] };
+			const CX::Float   *prev = prevNeurons + cPrevNeuronsOffset;
+			const CX::Float   *w    = weights[range.cReplica];
+			const CX::Float   *b    = biases[range.cReplica];
+			CX::Float         *next = nextNeurons + cNextNeuronsOffset;
 
-			for (CX::UInt32 i = 0; i < cCount; i++)
+			for (CX::UInt32 i = range.cBegin; i < range.cEnd; i++)
 			{
-				CX::Float   fValue = 0.0f;
-
-				for (CX::UInt32 k = 0; k < cPrevNeuronsCount; k++)
-				{
-					fValue += prevNeurons[cPrevNeuronsOffset + k] * weights[k * cNextNeuronsCount + idxs[0]];
-				}
-				fValue += fBias * biases[idxs[0]];
-				nextNeurons[cNextNeuronsOffset+ idxs[0]] = fValue;
+				next[i] = fBias * b[i];
+			}
+			for (CX::UInt32 k = 0; k < cPrevNeuronsCount; k++)
+			{
+				const CX::Float   fPrev = prev[k];
+				const CX::Float   *row  = w + k * cNextNeuronsCount;
 
-				if (idxs[0] + 1 < dims[0])
+				for (CX::UInt32 i = range.cBegin; i < range.cEnd; i++)
 				{
-					idxs[0]++;
-				}
-				else
-				{
-					break;
+					next[i] += fPrev * row[i];
 				}
 			}
 		}
 
 	};
 
-	class ActivateKernel : public IKernel
+	class ActivateKernel
 	{
 	public:
 
@@ -187,160 +189,213 @@ private:
 		CX::UInt32            cActivationArgs;
 		const CX::Float       *activationArgs;
 
-		virtual void Run(CX::UInt32 cDims, const CX::UInt32 *dims, const CX::UInt32 *startIdxs, CX::UInt32 cCount)
+		void operator()(const IKernel::Range &range) const
 		{
-			CX::UInt32   idxs[1] = { startIdxs[0] };
+			CX::Float   *next = nextNeurons + cNextNeuronsOffset;
 
-			for (CX::UInt32 i = 0; i < cCount; i++)
+			switch (nActivation)
 			{
-				switch (nActivation)
+				case NET::Activation::Identity : break;
+				case NET::Activation::Sigmoid : 
 				{
-					case NET::Activation::Identity : break;
-					case NET::Activation::Sigmoid : 
-					{
-						CX::Float   fValue = nextNeurons[cNextNeuronsOffset + idxs[0]];
-
-						nextNeurons[cNextNeuronsOffset + idxs[0]] = 1.0f / (1.0f + exp(-fValue));
-					}
-					break;
-					case NET::Activation::BinaryStep :
-					{
-						CX::Float   fValue = nextNeurons[cNextNeuronsOffset + idxs[0]];
-
-						if (0.0f > fValue)
-						{
-							nextNeurons[cNextNeuronsOffset + idxs[0]] = 0.0f;
-						}
-						else
-						{
-							nextNeurons[cNextNeuronsOffset + idxs[0]] = 1.0f;
-						}
-					}
-					break;
-					case NET::Activation::TanH :
+					for (CX::UInt32 i = range.cBegin; i < range.cEnd; i++)
 					{
-						CX::Float   fValue = nextNeurons[cNextNeuronsOffset + idxs[0]];
-
-						nextNeurons[cNextNeuronsOffset + idxs[0]] = tanh(fValue);
+						next[i] = 1.0f / (1.0f + exp(-next[i]));
 					}
-					break;
-					case NET::Activation::ArcTan :
+				}
+				break;
+				case NET::Activation::BinaryStep :
+				{
+					for (CX::UInt32 i = range.cBegin; i < range.cEnd; i++)
 					{
-						CX::Float   fValue = nextNeurons[cNextNeuronsOffset + idxs[0]];
-
-						nextNeurons[cNextNeuronsOffset + idxs[0]] = atan(fValue);
+						next[i] = (0.0f > next[i]) ? 0.0f : 1.0f;
 					}
-					break;;
-					case NET::Activation::SoftSign :
+				}
+				break;
+				case NET::Activation::TanH :
+				{
+					for (CX::UInt32 i = range.cBegin; i < range.cEnd; i++)
 					{
-						CX::Float   fValue = nextNeurons[cNextNeuronsOffset + idxs[0]];
-
-						if (0.0f > fValue)
-						{
-							nextNeurons[cNextNeuronsOffset + idxs[0]] = fValue / (1.0f + -fValue);
-						}
-						else
-						{
-							nextNeurons[cNextNeuronsOffset + idxs[0]] = fValue / (1.0f + fValue);
-						}
+						next[i] = tanh(next[i]);
 					}
-					break;
-					case NET::Activation::RELU :
+				}
+				break;
+				case NET::Activation::ArcTan :
+				{
+					for (CX::UInt32 i = range.cBegin; i < range.cEnd; i++)
 					{
-						CX::Float   fValue = nextNeurons[cNextNeuronsOffset + idxs[0]];
-
-						if (0.0f > fValue)
-						{
-							nextNeurons[cNextNeuronsOffset + idxs[0]] = 0.0f;
-						}
-						else
-						{
-							nextNeurons[cNextNeuronsOffset + idxs[0]] = fValue;
-						}
+						next[i] = atan(next[i]);
 					}
-					break;
-					case NET::Activation::LeakyRELU :
+				}
+				break;
+				case NET::Activation::SoftSign :
+				{
+					for (CX::UInt32 i = range.cBegin; i < range.cEnd; i++)
 					{
+						next[i] = next[i] / (1.0f + fabs(next[i]));
 					}
-					break;
-					case NET::Activation::SoftPlus :
+				}
+				break;
+				case NET::Activation::RELU :
+				{
+					for (CX::UInt32 i = range.cBegin; i < range.cEnd; i++)
 					{
+						next[i] = (0.0f > next[i]) ? 0.0f : next[i];
 					}
-					break;
-					case NET::Activation::BentIdentity :
+				}
+				break;
+				case NET::Activation::LeakyRELU :
+				{
+					for (CX::UInt32 i = range.cBegin; i < range.cEnd; i++)
 					{
+						next[i] = 0.01f * next[i];
 					}
-					break;
-					case NET::Activation::Sinusoid :
+				}
+				break;
+				case NET::Activation::SoftPlus :
+				{
+					for (CX::UInt32 i = range.cBegin; i < range.cEnd; i++)
 					{
+						next[i] = log(1.0f + next[i]);
 					}
-					break;
-					case NET::Activation::SINC :
+				}
+				break;
+				case NET::Activation::BentIdentity :
+				{
+					for (CX::UInt32 i = range.cBegin; i < range.cEnd; i++)
 					{
+						next[i] = (sqrt(next[i] * next[i] + 1.0f) - 1.0f) / 2.0f + next[i];
 					}
-					break;
-					case NET::Activation::Gaussian :
+				}
+				break;
+				case NET::Activation::Sinusoid :
+				{
+					for (CX::UInt32 i = range.cBegin; i < range.cEnd; i++)
 					{
+						next[i] = sin(next[i]);
 					}
-					break;
-					case NET::Activation::ISRU :
+				}
+				break;
+				case NET::Activation::SINC :
+				{
+					for (CX::UInt32 i = range.cBegin; i < range.cEnd; i++)
 					{
+						next[i] = (0.0f == next[i]) ? 1.0f : sin(next[i]) / next[i];
 					}
-					break;
-					case NET::Activation::PRELU :
+				}
+				break;
+				case NET::Activation::Gaussian :
+				{
+					for (CX::UInt32 i = range.cBegin; i < range.cEnd; i++)
 					{
+						next[i] = exp(- next[i] * next[i]);
 					}
-					break;
-					case NET::Activation::ELU :
+				}
+				break;
+				case NET::Activation::ISRU :
+				{
+					for (CX::UInt32 i = range.cBegin; i < range.cEnd; i++)
 					{
+						next[i] = next[i] / sqrt(1.0f + activationArgs[0] * next[i] * next[i]);
 					}
-					break;
-					case NET::Activation::SELU :
+				}
+				break;
+				case NET::Activation::PRELU :
+				{
+					for (CX::UInt32 i = range.cBegin; i < range.cEnd; i++)
 					{
+						next[i] = (0.0f > next[i]) ? activationArgs[0] * next[i] : next[i];
 					}
-					break;
-					case NET::Activation::SRELU :
+				}
+				break;
+				case NET::Activation::ELU :
+				{
+					for (CX::UInt32 i = range.cBegin; i < range.cEnd; i++)
 					{
+						next[i] = (0.0f > next[i]) ? activationArgs[0] * (exp(next[i]) - 1.0f) : next[i];
 					}
-					break;
-					case NET::Activation::ISRLU :
+				}
+				break;
+				case NET::Activation::SELU :
+				{
+					for (CX::UInt32 i = range.cBegin; i < range.cEnd; i++)
 					{
+						next[i] = (0.0f > next[i]) ? activationArgs[1] * activationArgs[0] * (exp(next[i]) - 1.0f) : 
+						                             activationArgs[1] * next[i];
 					}
-					break;
-					case NET::Activation::SoftExponential :
+				}
+				break;
+				case NET::Activation::SRELU :
+				{
+					for (CX::UInt32 i = range.cBegin; i < range.cEnd; i++)
 					{
+						if (next[i] <= activationArgs[0])
+						{
+							next[i] = activationArgs[0] + activationArgs[1] * (next[i] - activationArgs[0]);
+						}
+						else
+						if (next[i] >= activationArgs[2])
+						{
+							next[i] = activationArgs[2] + activationArgs[3] * (next[i] - activationArgs[2]);
+						}
 					}
-					break;
-					case NET::Activation::SoftMax :
+				}
+				break;
+				case NET::Activation::ISRLU :
+				{
+					for (CX::UInt32 i = range.cBegin; i < range.cEnd; i++)
 					{
+						next[i] = (0.0f > next[i]) ? next[i] / sqrt(1.0f + activationArgs[0] * next[i] * next[i]) : 
+						                             next[i];
 					}
-					break;
 				}
-	
-				if (idxs[0] + 1 < dims[0])
+				break;
+				case NET::Activation::SoftExponential :
 				{
-					idxs[0]++;
+					for (CX::UInt32 i = range.cBegin; i < range.cEnd; i++)
+					{
+						if (0.0f > activationArgs[0])
+						{
+							next[i] = -log(1.0f - activationArgs[0] * (next[i] + activationArgs[0])) / activationArgs[0];
+						}
+						else
+						if (0.0f < activationArgs[0])
+						{
+							next[i] = (exp(activationArgs[0] * next[i]) - 1.0f) / activationArgs[0] + activationArgs[0];
+						}
+					}
 				}
-				else
+				break;
+				case NET::Activation::SoftMax :
 				{
-					break;
+					//the sum spans the whole sample, Network::Activate normalizes it on the calling thread
 				}
+				break;
 			}
 		}
 
 	};
 
+	//compute + activate for one sample
+	CX::Status EvaluateLayer(Synapses *pSynapses, 
+	                         CX::Float *prevNeurons, CX::UInt32 cPrevNeuronsOffset, 
+	                         CX::Float *nextNeurons, CX::UInt32 cNextNeuronsOffset, 
+	                         Provider::Priority nPriority, CX::UInt32 cGroup);
+
 	CX::Status Compute(CX::Float *prevNeurons, CX::UInt32 cPrevNeuronsOffset, CX::UInt32 cPrevNeuronsCount,
-	                   CX::Float *weights, 
-	                   CX::Float *nextNeurons, CX::UInt32 cNextNeuronsOffset, CX::UInt32 cNextNeuronsCount);
+	                   CX::Float **weights, 
+	                   CX::Float *nextNeurons, CX::UInt32 cNextNeuronsOffset, CX::UInt32 cNextNeuronsCount, 
+	                   Provider::Priority nPriority, CX::UInt32 cGroup);
 
 	CX::Status ComputeWithBias(CX::Float fBias, 
 	                           CX::Float *prevNeurons, CX::UInt32 cPrevNeuronsOffset, CX::UInt32 cPrevNeuronsCount,
-	                           CX::Float *weights, CX::Float *biases, 
-	                           CX::Float *nextNeurons, CX::UInt32 cNextNeuronsOffset, CX::UInt32 cNextNeuronsCount);
+	                           CX::Float **weights, CX::Float **biases, 
+	                           CX::Float *nextNeurons, CX::UInt32 cNextNeuronsOffset, CX::UInt32 cNextNeuronsCount, 
+	                           Provider::Priority nPriority, CX::UInt32 cGroup);
 
 	CX::Status Activate(CX::Float *nextNeurons, CX::UInt32 cNextNeuronsOffset, CX::UInt32 cNextNeuronsCount, 
-	                    NET::ActivationType nActivation, CX::UInt32 cActivationArgs, const CX::Float *activationArgs);
+	                    NET::ActivationType nActivation, CX::UInt32 cActivationArgs, const CX::Float *activationArgs, 
+	                    Provider::Priority nPriority, CX::UInt32 cGroup);
 
 };
 
@@ -87,6 +87,7 @@ public:
 protected:
 
 	friend class Network;
+	friend class Pipeline;
 
 	Network               *m_pNetwork;
 	NET::Neurons          *m_pNeurons;
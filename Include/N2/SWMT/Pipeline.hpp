@@ -0,0 +1,179 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+
+#include "CX/Types.hpp"
+#include "CX/Status.hpp"
+#include "N2/SWMT/Network.hpp"
+#include "N2/SWMT/Provider.hpp"
+#include "N2/SWMT/BoundedQueue.hpp"
+#include "CX/C/Platform/Windows/windows.h"
+
+
+namespace N2
+{
+
+namespace SWMT
+{
+
+//streaming evaluation: the layers are split into stages of contiguous layers with about the same FLOPs, each stage 
+//runs on its own reserved group of provider threads and micro-batches flow between stages through bounded queues
+class Pipeline
+{
+public:
+
+	static const CX::UInt32   DEFAULT_MICRO_BATCH_SIZE = 16;
+	static const CX::UInt32   DEFAULT_QUEUE_DEPTH      = 4;
+
+	struct StageStats
+	{
+		CX::UInt32   cFirstLayer;           //index of the first synapses of the stage
+		CX::UInt32   cLayersCount;
+		CX::UInt32   cThreads;
+		CX::UInt64   cMicroBatches;
+		CX::UInt64   cSamples;
+		CX::Double   lfBusyTime;            //seconds spent computing
+		CX::Double   lfInputStallTime;      //seconds spent waiting for a micro-batch from the previous stage
+		CX::Double   lfOutputStallTime;     //seconds spent waiting for room in the next stage queue
+	};
+
+	Pipeline();
+
+	~Pipeline();
+
+	//cStages = 0 => as many stages as the provider threads allow (at most one per layer)
+	//the network must stay initialized and must not be evaluated directly while the pipeline is initialized
+	CX::Status Init(Network *pNetwork, CX::UInt32 cStages = 0, 
+	                CX::UInt32 cMicroBatchSize = DEFAULT_MICRO_BATCH_SIZE, 
+	                CX::UInt32 cQueueDepth = DEFAULT_QUEUE_DEPTH);
+
+	CX::Status Uninit();
+
+	CX::Bool IsOK() const;
+
+	CX::UInt32 GetStagesCount() const;
+
+	CX::UInt32 GetMicroBatchSize() const;
+
+	//queues cCount samples and returns once they are all queued (blocks while all micro-batch slots are in flight); 
+	//inputs and outputs must stay valid until Wait returns
+	CX::Status Submit(CX::UInt32 cCount, CX::Float *inputs, CX::Float *outputs);
+
+	//waits for all the submitted samples; returns the first stage failure since the previous Wait (the later stages 
+	//skip a failed micro-batch and the outputs of all the samples submitted since then must not be used)
+	CX::Status Wait();
+
+	CX::Status GetStageStats(CX::UInt32 cStage, StageStats *pStats) const;
+
+	CX::Status ResetStats();
+
+private:
+
+	struct Layer
+	{
+		Synapses    *pSynapses;
+		CX::Float   *values;              //single sample scratch, used when the layer is inside a stage
+	};
+
+	struct Slot
+	{
+		CX::UInt32   cCount;
+		CX::Float    *inputs;
+		CX::Float    *outputs;
+		CX::Float    **boundaries;         //values of the last layer of each stage but the last one
+		CX::Bool     bFailed;              //a stage failed, the next ones skip the micro-batch
+	};
+
+	typedef BoundedQueue<CX::UInt32>   SlotsQueue;
+
+	struct Stage
+	{
+		Pipeline          *pPipeline;
+		CX::UInt32        cIndex;
+		CX::UInt32        cFirstLayer;
+		CX::UInt32        cLayersCount;
+		CX::UInt32        cGroup;
+		CX::UInt32        cThreads;
+		SlotsQueue        queue;             //input micro-batches
+		HANDLE            hSemaphore;        //count of input micro-batches
+		HANDLE            hSpaceSemaphore;   //count of free queue entries (the queue depth at most)
+		HANDLE            hThread;
+		//written only by the stage thread
+		volatile CX::UInt64   cMicroBatches;
+		volatile CX::UInt64   cSamples;
+		volatile CX::Int64    cBusyTicks;
+		volatile CX::Int64    cInputStallTicks;
+		volatile CX::Int64    cOutputStallTicks;
+
+		Stage()
+		{
+			hSemaphore      = NULL;
+			hSpaceSemaphore = NULL;
+			hThread         = NULL;
+			cGroup          = Provider::SHARED_GROUP;
+		}
+	};
+
+	Network              *m_pNetwork;
+	Layer                *m_layers;
+	CX::UInt32           m_cLayers;
+	Stage                *m_stages;
+	CX::UInt32           m_cStages;
+	Slot                 *m_slots;
+	CX::UInt32           m_cSlots;
+	CX::UInt32           m_cMicroBatchSize;
+	SlotsQueue           m_freeSlots;
+	HANDLE               m_hFreeSemaphore;
+	HANDLE               m_hStopEvent;
+	SRWLOCK              m_srwlInFlight;
+	CONDITION_VARIABLE   m_cvInFlight;
+	CX::UInt32           m_cInFlight;
+	CX::Status           m_status;          //first failure since the previous Wait, guarded by m_srwlInFlight
+	CX::Int64            m_cTicksPerSecond;
+
+	CX::Status SplitLayers(CX::UInt32 cStages);
+
+	CX::Status RunStage(Stage *pStage, Slot *pSlot);
+
+	void FailSlot(CX::UInt32 cSlot, const CX::Status &status);
+
+	void CompleteSlot(CX::UInt32 cSlot);
+
+	static CX::UInt32 GetQueueCapacity(CX::UInt32 cCount);
+
+	static CX::Int64 GetTicks();
+
+	static DWORD WINAPI StageThread(void *pArg);
+
+};
+
+}//namespace SWMT
+
+}//namespace N2
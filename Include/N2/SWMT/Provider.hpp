@@ -33,6 +33,8 @@
 #include "CX/Status.hpp"
 #include "N2/CE/IProvider.hpp"
 #include "N2/SWMT/IKernel.hpp"
+#include "N2/SWMT/Topology.hpp"
+#include "N2/SWMT/BoundedQueue.hpp"
 #include "CX/C/Platform/Windows/windows.h"
 
 
@@ -46,8 +48,29 @@ class Provider : public CE::IProvider
 {
 public:
 
-	static const DWORD   MAX_DIMS          = 3;
-	static const DWORD   THREAD_STACK_SIZE = 65536;
+	static const DWORD   MAX_DIMS             = 3;
+	static const DWORD   THREAD_STACK_SIZE    = 65536;
+	static const DWORD   CACHE_LINE_SIZE      = 64;
+	//also a multiple of the SIMD width (AVX = 8 floats, AVX-512 = 16 floats)
+	static const DWORD   ITEMS_PER_CACHE_LINE = CACHE_LINE_SIZE / sizeof(CX::Float);
+	//kernels that can be in flight at the same time (over all callers)
+	static const DWORD   MAX_JOBS             = 64;
+	static const DWORD   QUEUE_CAPACITY       = 1024;
+	//reserved thread groups (group 0 is the shared pool)
+	static const DWORD   MAX_GROUPS           = 16;
+	static const DWORD   SHARED_GROUP         = 0;
+
+	enum Priority
+	{
+		Priority_High   = 0,
+		Priority_Normal = 1,
+		Priority_Low    = 2,
+		//resolved by the caller (SWMT::Network uses High for single sample evaluations and Normal otherwise)
+		Priority_Auto   = 3,
+	};
+
+	static const DWORD   PRIORITIES_COUNT     = 3;
+	static const LONG    MAX_SEMAPHORE_COUNT  = 0x7FFFFFFF;
 
 	Provider();
 
@@ -69,29 +92,110 @@ public:
 
 	CX::UInt32 GetThreadsCount() const;
 
-	CX::Status RunKernel(IKernel *pKernel, CX::UInt32 cDims, const CX::UInt32 *dims);
+	//number of NUMA nodes the worker threads are spread over (1 when threads are not pinned)
+	CX::UInt32 GetNodesCount() const;
+
+	//number of weights replicas a network must keep (1 when weights are not replicated)
+	CX::UInt32 GetReplicasCount() const;
+
+	//outputs is the address written by item 0 (items must be written contiguously); when given, the ranges handed to 
+	//the threads start and end on cache line boundaries of outputs so no two threads write to the same line
+	//can be called concurrently from several threads; the ranges are queued and higher priority ranges are picked first
+	//cGroup selects a reserved group (see ReserveGroup) whose threads are the only ones running the kernel
+	CX::Status RunKernel(IKernel *pKernel, CX::UInt32 cDims, const CX::UInt32 *dims, const CX::Float *outputs = NULL, 
+	                     Priority nPriority = Priority_Normal, CX::UInt32 cGroup = SHARED_GROUP);
+
+	//runs the kernel once per replica, on a worker thread local to that replica (the range is [replica, replica + 1))
+	CX::Status RunPerReplica(IKernel *pKernel);
+
+	//moves cThreads threads out of the shared pool into a new group; at least one thread always stays shared
+	CX::Status ReserveGroup(CX::UInt32 cThreads, CX::UInt32 *pcGroup);
+
+	//the group must be idle; its threads go back to the shared pool
+	CX::Status ReleaseGroup(CX::UInt32 cGroup);
+
+	CX::UInt32 GetGroupThreadsCount(CX::UInt32 cGroup) const;
 
 private:
 
-	struct Entry
+	struct alignas(CACHE_LINE_SIZE) Entry
+	{
+		Provider        *pProvider;
+		CX::UInt32      cNode;
+		CX::UInt32      cReplica;
+		DWORD_PTR       nAffinityMask;
+		volatile LONG   nGroup;
+		HANDLE          hWakeEvent;           //set when nGroup changes
+	};
+
+	//one RunKernel / RunPerReplica call; slots are recycled through m_freeJobs
+	struct alignas(CACHE_LINE_SIZE) Job
+	{
+		IKernel         *pKernel;
+		volatile LONG   cPendingTasks;
+		HANDLE          hDoneEvent;
+	};
+
+	struct Task
+	{
+		CX::UInt32   cJob;
+		CX::UInt32   cBegin;
+		CX::UInt32   cEnd;
+	};
+
+	typedef BoundedQueue<Task>         TasksQueue;
+	typedef BoundedQueue<CX::UInt32>   JobsQueue;
+
+	struct Node
+	{
+		TasksQueue   queues[PRIORITIES_COUNT];      //can be stolen by the other nodes
+		TasksQueue   localQueue;                    //run only by the threads of this node
+		HANDLE       hLocalSemaphore;
+
+		Node()
+		{
+			hLocalSemaphore = NULL;
+		}
+	};
+
+	struct Group
 	{
-		IKernel      *pKernel;
-		HANDLE       *phStopEvent;
-		HANDLE       *phStartEvent;
-		HANDLE       *phFinishEvent;
-		CX::UInt32   cDims;
-		CX::UInt32   dims[MAX_DIMS];
-		CX::UInt32   idxs[MAX_DIMS];
-		CX::UInt32   cCount;
+		TasksQueue   queues[PRIORITIES_COUNT];
+		HANDLE       hSemaphore;
+		CX::UInt32   cThreads;
+
+		Group()
+		{
+			hSemaphore = NULL;
+			cThreads   = 0;
+		}
 	};
 
-	SRWLOCK      m_srwlThreads;
-	HANDLE       *m_stopEvents;
-	HANDLE       *m_startEvents;
-	HANDLE       *m_finishEvents;
+	HANDLE       m_hStopEvent;
+	HANDLE       m_hSemaphore;                    //count of tasks in the stealable queues
 	HANDLE       *m_threads;
 	Entry        *m_entries;
+	Node         *m_nodes;
+	Group        *m_groups;
+	SRWLOCK      m_srwlGroups;
+	Job          *m_jobs;
+	JobsQueue    m_freeJobs;
 	CX::UInt32   m_cThreads;
+	Topology     m_topology;
+	CX::UInt32   m_cNodes;
+	CX::UInt32   m_cReplicas;
+
+	CX::Status PlaceThreads(CX::Bool bPinThreads, CX::Bool bReplicateWeights);
+
+	CX::UInt32 AcquireJob(IKernel *pKernel, CX::UInt32 cTasks);
+
+	void WaitJob(CX::UInt32 cJob);
+
+	void RunTask(CX::UInt32 cReplica, const Task &task);
+
+	CX::Bool PopTask(CX::UInt32 cNode, Task *pTask);
+
+	CX::Bool PopGroupTask(CX::UInt32 cGroup, Task *pTask);
 
 	static DWORD WINAPI WorkerThread(void *pArg);
 
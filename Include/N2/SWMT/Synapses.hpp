@@ -34,6 +34,7 @@
 #include "N2/CE/INeurons.hpp"
 #include "N2/CE/ISynapses.hpp"
 #include "N2/NET/Synapses.hpp"
+#include "N2/SWMT/IKernel.hpp"
 
 
 namespace N2
@@ -91,14 +92,36 @@ public:
 protected:
 
 	friend class Network;
+	friend class Pipeline;
+
+	class ReplicateKernel
+	{
+	public:
+
+		CX::Float         **replicas;
+		const CX::Float   *values;
+		CX::Size          cOffset;
+		CX::Size          cbSize;
+
+		void operator()(const IKernel::Range &range) const
+		{
+			for (CX::UInt32 i = range.cBegin; i < range.cEnd; i++)
+			{
+				memcpy(replicas[i] + cOffset, values + cOffset, cbSize);
+			}
+		}
+
+	};
 
 	Network              *m_pNetwork;
 	NET::Synapses        *m_pSynapses;
-	CX::Float            *m_weights;
-	CX::Float            *m_biases;
+	CX::UInt32           m_cReplicas;
+	CX::Float            **m_weights;      //one copy per replica
+	CX::Float            **m_biases;       //one copy per replica
 	Neurons              *m_pPrevNeurons;
 	Neurons              *m_pNextNeurons;
 	CX::Size             m_cbMemSize;
+	CX::UInt64           m_nSyncedVersion;
 
 };
 
@@ -0,0 +1,93 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+
+#include "CX/Types.hpp"
+#include "CX/Status.hpp"
+#include "CX/Vector.hpp"
+#include "CX/C/Platform/Windows/windows.h"
+
+
+namespace N2
+{
+
+namespace SWMT
+{
+
+//NUMA nodes and physical cores of the current processor group (up to 64 logical processors)
+class Topology
+{
+public:
+
+	struct Core
+	{
+		CX::UInt32   cNode;
+		DWORD_PTR    nMask;
+	};
+
+	struct Node
+	{
+		CX::UInt32   cFirstCore;
+		CX::UInt32   cCoresCount;
+		DWORD_PTR    nMask;
+	};
+
+	Topology();
+
+	~Topology();
+
+	CX::Status Init();
+
+	CX::Status Uninit();
+
+	CX::UInt32 GetNodesCount() const;
+
+	const Node *GetNode(CX::UInt32 cNode) const;
+
+	CX::UInt32 GetCoresCount() const;
+
+	//cores are sorted by node
+	const Core *GetCore(CX::UInt32 cCore) const;
+
+	const Core *GetNodeCore(CX::UInt32 cNode, CX::UInt32 cCore) const;
+
+private:
+
+	typedef CX::Vector<Core>::Type   CoresVector;
+	typedef CX::Vector<Node>::Type   NodesVector;
+
+	CoresVector   m_vectorCores;
+	NodesVector   m_vectorNodes;
+
+};
+
+}//namespace SWMT
+
+}//namespace N2
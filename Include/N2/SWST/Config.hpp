@@ -48,6 +48,17 @@ public:
 
 	~Config();
 
+	//the weights of mapped models (NET::ModelFormat::Map) are used in place instead of being copied; Evaluate then 
+	//runs the batch one layer at a time, reading the next layer ahead and evicting the done one, so models larger 
+	//than the memory can be evaluated (pages that do not fit are read again on each batch)
+	void SetStreamWeights(CX::Bool bStreamWeights);
+
+	CX::Bool GetStreamWeights() const;
+
+private:
+
+	CX::Bool   m_bStreamWeights;
+
 };
 
 }//namespace SWST
@@ -93,6 +93,10 @@ private:
 	Neurons            *m_pInputNeurons;
 	Neurons            *m_pOutputNeurons;
 	CX::Size           m_cbMemSize;
+	CX::Bool           m_bStreamed;
+
+	//layer by layer over the whole batch, for networks with streamed synapses (Config::SetStreamWeights)
+	CX::Status EvaluateStreamed(CX::UInt32 cCount, CX::Float *inputs, CX::Float *outputs);
 
 	CX::Status Compute(CX::Float *prevNeurons, CX::UInt32 cPrevNeuronsOffset, CX::UInt32 cPrevNeuronsCount,
 	                   CX::Float *weights, 
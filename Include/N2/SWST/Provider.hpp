@@ -62,8 +62,12 @@ public:
 
 	virtual CX::Status DestroyNetwork(CE::INetwork *pNetwork);
 
+	CX::Bool GetStreamWeights() const;
+
 private:
 
+	CX::Bool   m_bStreamWeights;
+
 };
 
 }//namespace SWST
@@ -99,6 +99,15 @@ protected:
 	Neurons              *m_pPrevNeurons;
 	Neurons              *m_pNextNeurons;
 	CX::Size             m_cbMemSize;
+	CX::UInt64           m_nSyncedVersion;
+	//no copy: the mapped NET arrays are used in place (Config::SetStreamWeights)
+	CX::Bool             m_bStreamed;
+
+	CX::Status CopyFrom(const NET::Synapses *pSynapses);
+
+	CX::Float *GetComputeWeights();
+
+	CX::Float *GetComputeBiases();
 
 };
 
@@ -121,6 +121,102 @@ def SaveBinarySynapses(model, filename):
 	return True
 
 
+CRC32C_TABLE = []
+for i in range(256):
+	value = i
+	for j in range(8):
+		value = (value >> 1) ^ (0x82F63B78 if value & 1 else 0)
+	CRC32C_TABLE.append(value)
+
+
+def CRC32C(data):
+	try:
+		import crc32c # much faster, if installed
+		return crc32c.crc32c(data)
+	except ImportError:
+		value = 0xFFFFFFFF
+		for byte in data:
+			value = (value >> 8) ^ CRC32C_TABLE[(value ^ byte) & 0xFF]
+		return value ^ 0xFFFFFFFF
+
+
+# v2 model file (NET::ModelFile): header | section table | sections at 64 bytes aligned offsets
+def SaveModel(model, filename):
+	ALIGNMENT = 64
+
+	inpcfg = model.get_layer(index=0).get_config()
+	topology = struct.pack("<II", inpcfg['batch_input_shape'][1], len(model.layers))
+	sections = [] # (type, layer, data)
+	for index, layer in enumerate(model.layers):
+		cfg = layer.get_config()
+		if 'float32' != cfg['dtype']:
+			return False
+
+		# NET::Activation values and args
+		args = []
+		if 'linear' == cfg['activation']:
+			act = 1
+		elif 'sigmoid' == cfg['activation']:
+			act = 2
+		elif 'tanh' == cfg['activation']:
+			act = 4
+		elif 'softsign' == cfg['activation']:
+			act = 6
+		elif 'relu' == cfg['activation']:
+			act = 7
+		elif 'softplus' == cfg['activation']:
+			act = 9
+		elif 'elu' == cfg['activation']:
+			act = 16
+			args = [1.0]
+		elif 'selu' == cfg['activation']:
+			act = 17
+			args = [1.6732632423543772, 1.0507009873554805]
+		elif 'softmax' == cfg['activation']:
+			act = 21
+		else:
+			return False
+
+		weights = layer.get_weights()
+		if cfg['use_bias'] and 2 != len(weights):
+			return False
+		if not cfg['use_bias'] and 1 != len(weights):
+			return False
+
+		topology += struct.pack("<IHBBfI", cfg['units'], act, 1 if cfg['use_bias'] else 0, 0, 
+		                        1.0 if cfg['use_bias'] else 0.0, len(args))
+		topology += struct.pack("<10f", *(args + [0.0] * (10 - len(args))))
+		sections.append((2, index, numpy.ascontiguousarray(weights[0], dtype='<f4').tobytes()))
+		if cfg['use_bias']:
+			sections.append((3, index, numpy.ascontiguousarray(weights[1], dtype='<f4').tobytes()))
+	sections.insert(0, (1, 0, topology))
+
+	table = b''
+	offsets = []
+	offset = (64 + 32 * len(sections) + ALIGNMENT - 1) // ALIGNMENT * ALIGNMENT
+	for (type, index, data) in sections:
+		offsets.append(offset)
+		table += struct.pack("<IIQQII", type, index, offset, len(data), CRC32C(data), 0)
+		end = offset + len(data)
+		offset = (end + ALIGNMENT - 1) // ALIGNMENT * ALIGNMENT
+
+	header = struct.pack("<IIIIQII32x", 0x324D324E, 2, 0, len(sections), end, 0, ALIGNMENT)
+	checksum = CRC32C(header + table)
+	header = struct.pack("<IIIIQII32x", 0x324D324E, 2, checksum, len(sections), end, 0, ALIGNMENT)
+
+	file = open(filename, "wb")
+	file.write(header)
+	file.write(table)
+	written = len(header) + len(table)
+	for (section, offset) in zip(sections, offsets):
+		file.write(bytes(offset - written))
+		file.write(section[2])
+		written = offset + len(section[2])
+	file.close()
+
+	return True
+
+
 def SaveCodeNeurons(model, filename):
 	file = open(filename, "w")
 
@@ -0,0 +1,316 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "N2/CE/ModelHandle.hpp"
+#include "N2/NET/ModelFormat.hpp"
+
+
+using namespace CX;
+
+
+namespace N2
+{
+
+namespace CE
+{
+
+ModelHandle::ModelHandle()
+{
+	m_pProvider   = NULL;
+	m_pCurrent    = NULL;
+	m_nEpoch      = 0;
+	m_cReaders[0] = 0;
+	m_cReaders[1] = 0;
+	m_nLastNumber = 0;
+	InitializeSRWLock(&m_srwlPublish);
+}
+
+ModelHandle::~ModelHandle()
+{
+	Uninit();
+}
+
+Status ModelHandle::Init(IProvider *pProvider)
+{
+	if (NULL == pProvider || !pProvider->IsOK())
+	{
+		return Status(Status_InvalidArg, "Invalid arg at {1}:{2}", __FILE__, __LINE__);
+	}
+
+	Uninit();
+
+	m_pProvider = pProvider;
+
+	return Status();
+}
+
+Status ModelHandle::Uninit()
+{
+	Version   *pVersion;
+
+	AcquireSRWLockExclusive(&m_srwlPublish);
+	pVersion = Swap(NULL);
+	ReleaseSRWLockExclusive(&m_srwlPublish);
+	if (NULL != pVersion)
+	{
+		Retire(pVersion);
+	}
+	m_pProvider   = NULL;
+	m_nLastNumber = 0;
+
+	return Status();
+}
+
+Bool ModelHandle::IsOK() const
+{
+	return (NULL != m_pProvider);
+}
+
+Status ModelHandle::Load(const Char *szPath, Bool bMap/* = False*/)
+{
+	if (NULL == m_pProvider)
+	{
+		return Status(Status_NotInitialized, "Not initialized at {1}:{2}", __FILE__, __LINE__);
+	}
+
+	NET::Network   *pNetwork;
+	Status         status;
+
+	if (NULL == (pNetwork = new (std::nothrow) NET::Network()))
+	{
+		return Status(Status_MemAllocFailed, "Failed to allocate network at {1}:{2}", __FILE__, __LINE__);
+	}
+	if (bMap)
+	{
+		status = NET::ModelFormat::Map(pNetwork, szPath);
+	}
+	else
+	{
+		status = NET::ModelFormat::Load(pNetwork, szPath);
+	}
+	if (!status)
+	{
+		delete pNetwork;
+
+		return status;
+	}
+
+	return Publish(pNetwork);
+}
+
+Status ModelHandle::Publish(NET::Network *pNetwork)
+{
+	if (NULL == m_pProvider)
+	{
+		delete pNetwork;
+
+		return Status(Status_NotInitialized, "Not initialized at {1}:{2}", __FILE__, __LINE__);
+	}
+
+	Version   *pVersion;
+	Version   *pPrevVersion;
+	Status    status;
+
+	//the slow part (engine network init) is done while the current version keeps serving
+	if (!(status = CreateVersion(pNetwork, &pVersion)))
+	{
+		return status;
+	}
+	AcquireSRWLockExclusive(&m_srwlPublish);
+	m_nLastNumber++;
+	pVersion->nNumber = m_nLastNumber;
+	pPrevVersion      = Swap(pVersion);
+	ReleaseSRWLockExclusive(&m_srwlPublish);
+	if (NULL != pPrevVersion)
+	{
+		Retire(pPrevVersion);
+	}
+
+	return Status();
+}
+
+ModelHandle::Version *ModelHandle::Acquire()
+{
+	Version   *pVersion;
+	LONG      nEpoch;
+
+	//the epoch is checked again once counted: a reader counted in an epoch that already ended retries in the new one
+	for (;;)
+	{
+		nEpoch = m_nEpoch;
+		InterlockedIncrement(&m_cReaders[nEpoch & 1]);
+		if (nEpoch == m_nEpoch)
+		{
+			break;
+		}
+		InterlockedDecrement(&m_cReaders[nEpoch & 1]);
+	}
+	if (NULL != (pVersion = m_pCurrent))
+	{
+		InterlockedIncrement(&pVersion->cRefs);
+	}
+	InterlockedDecrement(&m_cReaders[nEpoch & 1]);
+
+	return pVersion;
+}
+
+void ModelHandle::Release(Version *pVersion)
+{
+	if (0 == InterlockedDecrement(&pVersion->cRefs))
+	{
+		SetEvent(pVersion->hReleasedEvent);
+	}
+}
+
+Status ModelHandle::Evaluate(UInt32 cCount, Float *inputs, Float *outputs)
+{
+	Version   *pVersion;
+	Status    status;
+
+	if (NULL == (pVersion = Acquire()))
+	{
+		return Status(Status_NotInitialized, "No model published at {1}:{2}", __FILE__, __LINE__);
+	}
+	status = pVersion->pCENetwork->Evaluate(cCount, inputs, outputs);
+	Release(pVersion);
+
+	return status;
+}
+
+UInt64 ModelHandle::GetVersionNumber()
+{
+	Version   *pVersion;
+	UInt64    nNumber;
+
+	if (NULL == (pVersion = Acquire()))
+	{
+		return 0;
+	}
+	nNumber = pVersion->nNumber;
+	Release(pVersion);
+
+	return nNumber;
+}
+
+Status ModelHandle::CreateVersion(NET::Network *pNetwork, Version **ppVersion)
+{
+	Version   *pVersion;
+	Status    status;
+
+	if (NULL == (pVersion = new (std::nothrow) Version()))
+	{
+		delete pNetwork;
+
+		return Status(Status_MemAllocFailed, "Failed to allocate version at {1}:{2}", __FILE__, __LINE__);
+	}
+	pVersion->pNetwork       = pNetwork;
+	pVersion->pCENetwork     = NULL;
+	pVersion->nNumber        = 0;
+	pVersion->cRefs          = 1;
+	pVersion->hReleasedEvent = NULL;
+	for (;;)
+	{
+		if (NULL == (pVersion->hReleasedEvent = CreateEvent(NULL, FALSE, FALSE, NULL)))
+		{
+			status = Status(Status_OperationFailed, "Failed to create event with error {1} at {2}:{3}", 
+			                (int)GetLastError(), __FILE__, __LINE__);
+
+			break;
+		}
+		if (NULL == (pVersion->pCENetwork = m_pProvider->CreateNetwork()))
+		{
+			status = Status(Status_MemAllocFailed, "Failed to create network at {1}:{2}", __FILE__, __LINE__);
+
+			break;
+		}
+		if (!(status = pVersion->pCENetwork->Init(pNetwork)))
+		{
+			break;
+		}
+
+		break;
+	}
+	if (!status)
+	{
+		DestroyVersion(pVersion);
+
+		return status;
+	}
+	*ppVersion = pVersion;
+
+	return Status();
+}
+
+void ModelHandle::DestroyVersion(Version *pVersion)
+{
+	//the engine network uses the NET one
+	if (NULL != pVersion->pCENetwork)
+	{
+		m_pProvider->DestroyNetwork(pVersion->pCENetwork);
+	}
+	if (NULL != pVersion->pNetwork)
+	{
+		delete pVersion->pNetwork;
+	}
+	if (NULL != pVersion->hReleasedEvent)
+	{
+		CloseHandle(pVersion->hReleasedEvent);
+	}
+	delete pVersion;
+}
+
+ModelHandle::Version *ModelHandle::Swap(Version *pVersion)
+{
+	Version   *pPrevVersion;
+	LONG      nEpoch;
+
+	pPrevVersion = (Version *)InterlockedExchangePointer((void * volatile *)&m_pCurrent, pVersion);
+	//grace period: readers that may have read the previous pointer without having its reference yet are all counted 
+	//in the epoch ending here; the next ones can only read the new pointer (their sections are a few instructions long)
+	nEpoch = InterlockedIncrement(&m_nEpoch) - 1;
+	while (0 != m_cReaders[nEpoch & 1])
+	{
+		SwitchToThread();
+	}
+
+	return pPrevVersion;
+}
+
+void ModelHandle::Retire(Version *pVersion)
+{
+	//the evaluations started on the version finish on it
+	if (0 != InterlockedDecrement(&pVersion->cRefs))
+	{
+		WaitForSingleObject(pVersion->hReleasedEvent, INFINITE);
+	}
+	DestroyVersion(pVersion);
+}
+
+}//namespace CE
+
+}//namespace N2
@@ -37,7 +37,13 @@ namespace CL
 
 Config::Config()
 {
-	n_devID = NULL;
+	n_devID            = NULL;
+	m_cTileSize        = 0;
+	m_bTiledCompute    = CX::True;
+	m_bGenerateKernels = CX::True;
+	m_bAutoTune        = CX::False;
+	m_cQueues          = DEFAULT_QUEUES_COUNT;
+	m_cMaxInFlight     = DEFAULT_MAX_IN_FLIGHT;
 }
 
 Config::~Config()
@@ -54,6 +60,76 @@ cl_device_id Config::GetDeviceID() const
 	return n_devID;
 }
 
+void Config::SetTileSize(CX::UInt32 cTileSize/* = 0*/)
+{
+	m_cTileSize = cTileSize;
+}
+
+CX::UInt32 Config::GetTileSize() const
+{
+	return m_cTileSize;
+}
+
+void Config::SetTiledCompute(CX::Bool bTiledCompute/* = CX::True*/)
+{
+	m_bTiledCompute = bTiledCompute;
+}
+
+CX::Bool Config::GetTiledCompute() const
+{
+	return m_bTiledCompute;
+}
+
+void Config::SetCacheDir(const CX::Char *szCacheDir/* = ""*/)
+{
+	m_sCacheDir = (NULL != szCacheDir ? szCacheDir : "");
+}
+
+const CX::Char *Config::GetCacheDir() const
+{
+	return m_sCacheDir.c_str();
+}
+
+void Config::SetGenerateKernels(CX::Bool bGenerateKernels/* = CX::True*/)
+{
+	m_bGenerateKernels = bGenerateKernels;
+}
+
+CX::Bool Config::GetGenerateKernels() const
+{
+	return m_bGenerateKernels;
+}
+
+void Config::SetAutoTune(CX::Bool bAutoTune/* = CX::True*/)
+{
+	m_bAutoTune = bAutoTune;
+}
+
+CX::Bool Config::GetAutoTune() const
+{
+	return m_bAutoTune;
+}
+
+void Config::SetQueuesCount(CX::UInt32 cQueues/* = DEFAULT_QUEUES_COUNT*/)
+{
+	m_cQueues = cQueues;
+}
+
+CX::UInt32 Config::GetQueuesCount() const
+{
+	return m_cQueues;
+}
+
+void Config::SetMaxInFlight(CX::UInt32 cMaxInFlight/* = DEFAULT_MAX_IN_FLIGHT*/)
+{
+	m_cMaxInFlight = cMaxInFlight;
+}
+
+CX::UInt32 Config::GetMaxInFlight() const
+{
+	return m_cMaxInFlight;
+}
+
 }//namespace CL
 
 }//namespace N2
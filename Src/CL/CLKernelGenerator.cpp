@@ -0,0 +1,464 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "N2/CL/KernelGenerator.hpp"
+#include "N2/NET/Activation.hpp"
+#include "CX/Print.hpp"
+
+
+using namespace CX;
+
+
+namespace N2
+{
+
+namespace CL
+{
+
+template <typename... Args>
+static void Append(String *psSource, const Char *szFormat, Args... args)
+{
+	String   sText;
+
+	Print(&sText, szFormat, args...);
+	*psSource += sText;
+}
+
+KernelGenerator::KernelGenerator()
+{
+}
+
+KernelGenerator::~KernelGenerator()
+{
+}
+
+Status KernelGenerator::Generate(const NET::Network *pNetwork, UInt32 cNetworkGroupSize, String *psSource)
+{
+	const NET::Neurons    *pNeurons;
+	const NET::Synapses   *pSynapses;
+	UInt32                cLayer;
+	Status                status;
+
+	if (NULL == pNetwork || !pNetwork->IsOK() || NULL == psSource)
+	{
+		return Status(Status_InvalidArg, "Invalid arg at {1}:{2}", __FILE__, __LINE__);
+	}
+
+	psSource->clear();
+	*psSource += "//generated by N2::CL::KernelGenerator\n";
+
+	cLayer    = 0;
+	pNeurons  = pNetwork->GetInputNeurons();
+	pSynapses = pNeurons->GetNextSynapses();
+	while (NULL != pSynapses)
+	{
+		if (!(status = GenerateLayer(cLayer, pSynapses, psSource)))
+		{
+			return status;
+		}
+		cLayer++;
+		pSynapses = pSynapses->GetNextNeurons()->GetNextSynapses();
+	}
+	if (0 < cNetworkGroupSize)
+	{
+		if (!(status = GenerateNetwork(pNetwork, cNetworkGroupSize, psSource)))
+		{
+			return status;
+		}
+	}
+
+	return Status();
+}
+
+void KernelGenerator::GetLayerKernelName(UInt32 cLayer, String *psName)
+{
+	psName->clear();
+	Print(psName, "Layer{1}", cLayer);
+}
+
+void KernelGenerator::GetSoftMaxKernelName(UInt32 cLayer, String *psName)
+{
+	psName->clear();
+	Print(psName, "Layer{1}SoftMax", cLayer);
+}
+
+const Char *KernelGenerator::GetNetworkKernelName()
+{
+	return "Network";
+}
+
+UInt32 KernelGenerator::GetMaxNeuronsCount(const NET::Network *pNetwork)
+{
+	const NET::Neurons   *pNeurons = pNetwork->GetInputNeurons();
+	UInt32               cMaxNeurons = 0;
+
+	for (;;)
+	{
+		if (cMaxNeurons < pNeurons->GetNeuronsCount())
+		{
+			cMaxNeurons = pNeurons->GetNeuronsCount();
+		}
+		if (NULL == pNeurons->GetNextSynapses())
+		{
+			break;
+		}
+		pNeurons = pNeurons->GetNextSynapses()->GetNextNeurons();
+	}
+
+	return cMaxNeurons;
+}
+
+Status KernelGenerator::GenerateLayer(UInt32 cLayer, const NET::Synapses *pSynapses, String *psSource)
+{
+	const NET::Neurons   *pNextNeurons = pSynapses->GetNextNeurons();
+	String               sName;
+	Status               status;
+
+	GetLayerKernelName(cLayer, &sName);
+
+	Append(psSource, "\n#define LAYER{1}_PREV_NEURONS   {2}\n", cLayer, pSynapses->GetPrevNeuronsCount());
+	Append(psSource, "#define LAYER{1}_NEXT_NEURONS   {2}\n", cLayer, pSynapses->GetNextNeuronsCount());
+	if (pSynapses->HasBias())
+	{
+		Append(psSource, "#define LAYER{1}_BIAS           ", cLayer);
+		AppendFloat(pSynapses->GetBias(), psSource);
+		*psSource += "\n";
+	}
+	for (UInt32 i = 0; i < pNextNeurons->GetActivationArgsCount(); i++)
+	{
+		Append(psSource, "#define LAYER{1}_ARG{2}           ", cLayer, i);
+		AppendFloat(pNextNeurons->GetActivationArgs()[i], psSource);
+		*psSource += "\n";
+	}
+
+	Append(psSource, "\nvoid kernel {1}(const global float *prevNeurons, global float *nextNeurons, "
+	                 "const global float *weights{2})\n", sName, pSynapses->HasBias() ? 
+	                 ", const global float *biases" : "");
+	*psSource += "{\n";
+	*psSource += "\tunsigned int   idx     = get_global_id(0);\n";
+	*psSource += "\tunsigned int   cSample = get_global_id(1);\n";
+	*psSource += "\tfloat          fValue  = 0.0f;\n\n";
+	Append(psSource, "\tprevNeurons += cSample * LAYER{1}_PREV_NEURONS;\n", cLayer);
+	GenerateDotProduct(cLayer, pSynapses, "prevNeurons", "weights", "biases", "\t", psSource);
+	if (!(status = GenerateActivation(cLayer, pNextNeurons, "\t", psSource)))
+	{
+		return status;
+	}
+	Append(psSource, "\tnextNeurons[cSample * LAYER{1}_NEXT_NEURONS + idx] = fValue;\n", cLayer);
+	*psSource += "}\n";
+
+	//the sum spans all the neurons of a sample => a second launch, one work-item per sample
+	if (NET::Activation::SoftMax == pNextNeurons->GetActivation())
+	{
+		GetSoftMaxKernelName(cLayer, &sName);
+		Append(psSource, "\nvoid kernel {1}(global float *neurons)\n", sName);
+		*psSource += "{\n";
+		*psSource += "\tunsigned int   cSample = get_global_id(0);\n";
+		*psSource += "\tfloat          fExpSum = 0.0f;\n\n";
+		Append(psSource, "\tneurons += cSample * LAYER{1}_NEXT_NEURONS;\n", cLayer);
+		Append(psSource, "\tfor (unsigned int k = 0; k < LAYER{1}_NEXT_NEURONS; k++)\n", cLayer);
+		*psSource += "\t{\n";
+		*psSource += "\t\tfExpSum += exp(neurons[k]);\n";
+		*psSource += "\t}\n";
+		Append(psSource, "\tfor (unsigned int k = 0; k < LAYER{1}_NEXT_NEURONS; k++)\n", cLayer);
+		*psSource += "\t{\n";
+		*psSource += "\t\tneurons[k] = exp(neurons[k]) / fExpSum;\n";
+		*psSource += "\t}\n";
+		*psSource += "}\n";
+	}
+
+	return Status();
+}
+
+//one work-group per sample; the layer outputs ping-pong between two local buffers, work-item i computes the neurons 
+//i, i + NETWORK_GROUP_SIZE, ... of each layer and a barrier separates the layers
+Status KernelGenerator::GenerateNetwork(const NET::Network *pNetwork, UInt32 cGroupSize, String *psSource)
+{
+	const NET::Synapses   *pSynapses;
+	const NET::Neurons    *pNextNeurons;
+	UInt32                cLayer;
+	Bool                  bSoftMax = False;
+	Status                status;
+
+	Append(psSource, "\n#define NETWORK_GROUP_SIZE    {1}\n", cGroupSize);
+	Append(psSource, "#define NETWORK_MAX_NEURONS   {1}\n", GetMaxNeuronsCount(pNetwork));
+
+	Append(psSource, "\nvoid kernel __attribute__((reqd_work_group_size(NETWORK_GROUP_SIZE, 1, 1))) {1}(\n", 
+	       GetNetworkKernelName());
+	*psSource += "                    const global float *inputs, global float *outputs";
+	cLayer    = 0;
+	pSynapses = pNetwork->GetInputNeurons()->GetNextSynapses();
+	while (NULL != pSynapses)
+	{
+		Append(psSource, ", \n                    const global float *weights{1}", cLayer);
+		if (pSynapses->HasBias())
+		{
+			Append(psSource, ", const global float *biases{1}", cLayer);
+		}
+		if (NET::Activation::SoftMax == pSynapses->GetNextNeurons()->GetActivation())
+		{
+			bSoftMax = True;
+		}
+		cLayer++;
+		pSynapses = pSynapses->GetNextNeurons()->GetNextSynapses();
+	}
+	*psSource += ")\n";
+	*psSource += "{\n";
+	*psSource += "\tlocal float    neurons0[NETWORK_MAX_NEURONS];\n";
+	*psSource += "\tlocal float    neurons1[NETWORK_MAX_NEURONS];\n";
+	*psSource += "\tunsigned int   lid     = get_local_id(0);\n";
+	*psSource += "\tunsigned int   cSample = get_group_id(0);\n";
+	if (bSoftMax)
+	{
+		*psSource += "\tfloat          fExpSum;\n";
+	}
+	*psSource += "\tfloat          fValue;\n\n";
+	*psSource += "\tinputs += cSample * LAYER0_PREV_NEURONS;\n";
+	*psSource += "\tfor (unsigned int idx = lid; idx < LAYER0_PREV_NEURONS; idx += NETWORK_GROUP_SIZE)\n";
+	*psSource += "\t{\n";
+	*psSource += "\t\tneurons0[idx] = inputs[idx];\n";
+	*psSource += "\t}\n";
+	*psSource += "\tbarrier(CLK_LOCAL_MEM_FENCE);\n";
+
+	cLayer    = 0;
+	pSynapses = pNetwork->GetInputNeurons()->GetNextSynapses();
+	for (;;)
+	{
+		String   sPrev;
+		String   sNext;
+		String   sWeights;
+		String   sBiases;
+
+		pNextNeurons = pSynapses->GetNextNeurons();
+		Print(&sPrev, "neurons{1}", cLayer % 2);
+		Print(&sNext, "neurons{1}", (cLayer + 1) % 2);
+		Print(&sWeights, "weights{1}", cLayer);
+		Print(&sBiases, "biases{1}", cLayer);
+
+		Append(psSource, "\t//layer {1}\n", cLayer);
+		Append(psSource, "\tfor (unsigned int idx = lid; idx < LAYER{1}_NEXT_NEURONS; idx += NETWORK_GROUP_SIZE)\n", 
+		       cLayer);
+		*psSource += "\t{\n";
+		*psSource += "\t\tfValue = 0.0f;\n";
+		GenerateDotProduct(cLayer, pSynapses, sPrev.c_str(), sWeights.c_str(), sBiases.c_str(), "\t\t", psSource);
+		if (!(status = GenerateActivation(cLayer, pNextNeurons, "\t\t", psSource)))
+		{
+			return status;
+		}
+		Append(psSource, "\t\t{1}[idx] = fValue;\n", sNext);
+		*psSource += "\t}\n";
+		*psSource += "\tbarrier(CLK_LOCAL_MEM_FENCE);\n";
+		//every work-item computes the sum, the barrier keeps the normalization from overwriting its inputs
+		if (NET::Activation::SoftMax == pNextNeurons->GetActivation())
+		{
+			*psSource += "\tfExpSum = 0.0f;\n";
+			Append(psSource, "\tfor (unsigned int k = 0; k < LAYER{1}_NEXT_NEURONS; k++)\n", cLayer);
+			*psSource += "\t{\n";
+			Append(psSource, "\t\tfExpSum += exp({1}[k]);\n", sNext);
+			*psSource += "\t}\n";
+			*psSource += "\tbarrier(CLK_LOCAL_MEM_FENCE);\n";
+			Append(psSource, "\tfor (unsigned int idx = lid; idx < LAYER{1}_NEXT_NEURONS; idx += NETWORK_GROUP_SIZE)\n", 
+			       cLayer);
+			*psSource += "\t{\n";
+			Append(psSource, "\t\t{1}[idx] = exp({1}[idx]) / fExpSum;\n", sNext);
+			*psSource += "\t}\n";
+			*psSource += "\tbarrier(CLK_LOCAL_MEM_FENCE);\n";
+		}
+		if (NULL == pNextNeurons->GetNextSynapses())
+		{
+			Append(psSource, "\toutputs += cSample * LAYER{1}_NEXT_NEURONS;\n", cLayer);
+			Append(psSource, "\tfor (unsigned int idx = lid; idx < LAYER{1}_NEXT_NEURONS; idx += NETWORK_GROUP_SIZE)\n", 
+			       cLayer);
+			*psSource += "\t{\n";
+			Append(psSource, "\t\toutputs[idx] = {1}[idx];\n", sNext);
+			*psSource += "\t}\n";
+
+			break;
+		}
+		cLayer++;
+		pSynapses = pNextNeurons->GetNextSynapses();
+	}
+	*psSource += "}\n";
+
+	return Status();
+}
+
+void KernelGenerator::GenerateDotProduct(UInt32 cLayer, const NET::Synapses *pSynapses, const Char *szPrev, 
+                                         const Char *szWeights, const Char *szBiases, const Char *szIndent, 
+                                         String *psSource)
+{
+	UInt32   cPrevNeurons = pSynapses->GetPrevNeuronsCount();
+
+	if (MAX_UNROLLED_PREV_NEURONS >= cPrevNeurons)
+	{
+		for (UInt32 k = 0; k < cPrevNeurons; k++)
+		{
+			Append(psSource, "{1}fValue += {2}[{3}] * {4}[{3} * LAYER{5}_NEXT_NEURONS + idx];\n", szIndent, szPrev, k, 
+			       szWeights, cLayer);
+		}
+	}
+	else
+	{
+		Append(psSource, "{1}#pragma unroll 8\n", szIndent);
+		Append(psSource, "{1}for (unsigned int k = 0; k < LAYER{2}_PREV_NEURONS; k++)\n", szIndent, cLayer);
+		Append(psSource, "{1}{\n", szIndent);
+		Append(psSource, "{1}\tfValue += {2}[k] * {3}[k * LAYER{4}_NEXT_NEURONS + idx];\n", szIndent, szPrev, 
+		       szWeights, cLayer);
+		Append(psSource, "{1}}\n", szIndent);
+	}
+	if (pSynapses->HasBias())
+	{
+		Append(psSource, "{1}fValue += LAYER{2}_BIAS * {3}[idx];\n", szIndent, cLayer, szBiases);
+	}
+}
+
+//same formulas as Activate.cl
+Status KernelGenerator::GenerateActivation(UInt32 cLayer, const NET::Neurons *pNeurons, const Char *szIndent, 
+                                           String *psSource)
+{
+	NET::ActivationType   nActivation = pNeurons->GetActivation();
+	const Char            *szFormat   = NULL;
+
+	if (NET::Activation::Identity > nActivation || NET::Activation::SoftMax < nActivation)
+	{
+		return Status(Status_InvalidArg, "Invalid activation {1} at {2}:{3}", nActivation, __FILE__, __LINE__);
+	}
+	if (NET::Neurons::GetMinActivationArgsCount(nActivation) > pNeurons->GetActivationArgsCount())
+	{
+		return Status(Status_InvalidArg, "Activation {1} needs {2} args at {3}:{4}", nActivation, 
+		              NET::Neurons::GetMinActivationArgsCount(nActivation), __FILE__, __LINE__);
+	}
+	//{1} is the indent, {2} the layer
+	switch (nActivation)
+	{
+		case NET::Activation::Identity:
+		case NET::Activation::SoftMax:
+		break;
+		case NET::Activation::Sigmoid:
+			szFormat = "{1}fValue = 1.0f / (1.0f + exp(-fValue));\n";
+		break;
+		case NET::Activation::BinaryStep:
+			szFormat = "{1}fValue = (0.0f > fValue) ? 0.0f : 1.0f;\n";
+		break;
+		case NET::Activation::TanH:
+			szFormat = "{1}fValue = tanh(fValue);\n";
+		break;
+		case NET::Activation::ArcTan:
+			szFormat = "{1}fValue = atan(fValue);\n";
+		break;
+		case NET::Activation::SoftSign:
+			szFormat = "{1}fValue = fValue / (1.0f + fabs(fValue));\n";
+		break;
+		case NET::Activation::RELU:
+			szFormat = "{1}fValue = (0.0f > fValue) ? 0.0f : fValue;\n";
+		break;
+		case NET::Activation::LeakyRELU:
+			szFormat = "{1}fValue = 0.01f * fValue;\n";
+		break;
+		case NET::Activation::SoftPlus:
+			szFormat = "{1}fValue = log(1.0f + fValue);\n";
+		break;
+		case NET::Activation::BentIdentity:
+			szFormat = "{1}fValue = (sqrt(fValue * fValue + 1.0f) - 1.0f) / 2.0f + fValue;\n";
+		break;
+		case NET::Activation::Sinusoid:
+			szFormat = "{1}fValue = sin(fValue);\n";
+		break;
+		case NET::Activation::SINC:
+			szFormat = "{1}fValue = (0.0f == fValue) ? 1.0f : sin(fValue) / fValue;\n";
+		break;
+		case NET::Activation::Gaussian:
+			szFormat = "{1}fValue = exp(- fValue * fValue);\n";
+		break;
+		case NET::Activation::ISRU:
+			szFormat = "{1}fValue = fValue / sqrt(1.0f + LAYER{2}_ARG0 * fValue * fValue);\n";
+		break;
+		case NET::Activation::PRELU:
+			szFormat = "{1}fValue = (0.0f > fValue) ? LAYER{2}_ARG0 * fValue : fValue;\n";
+		break;
+		case NET::Activation::ELU:
+			szFormat = "{1}fValue = (0.0f > fValue) ? LAYER{2}_ARG0 * (exp(fValue) - 1.0f) : fValue;\n";
+		break;
+		case NET::Activation::SELU:
+			szFormat = "{1}fValue = (0.0f > fValue) ? LAYER{2}_ARG1 * LAYER{2}_ARG0 * (exp(fValue) - 1.0f) : "
+			           "LAYER{2}_ARG1 * fValue;\n";
+		break;
+		case NET::Activation::SRELU:
+			szFormat = "{1}if (fValue <= LAYER{2}_ARG0)\n"
+			           "{1}{\n"
+			           "{1}\tfValue = LAYER{2}_ARG0 + LAYER{2}_ARG1 * (fValue - LAYER{2}_ARG0);\n"
+			           "{1}}\n"
+			           "{1}else\n"
+			           "{1}if (fValue >= LAYER{2}_ARG2)\n"
+			           "{1}{\n"
+			           "{1}\tfValue = LAYER{2}_ARG2 + LAYER{2}_ARG3 * (fValue - LAYER{2}_ARG2);\n"
+			           "{1}}\n";
+		break;
+		case NET::Activation::ISRLU:
+			szFormat = "{1}fValue = (0.0f > fValue) ? fValue / sqrt(1.0f + LAYER{2}_ARG0 * fValue * fValue) : "
+			           "fValue;\n";
+		break;
+		case NET::Activation::SoftExponential:
+			//the branch on alpha is taken here
+			if (0.0f > pNeurons->GetActivationArgs()[0])
+			{
+				szFormat = "{1}fValue = -log(1.0f - LAYER{2}_ARG0 * (fValue + LAYER{2}_ARG0)) / LAYER{2}_ARG0;\n";
+			}
+			else
+			if (0.0f < pNeurons->GetActivationArgs()[0])
+			{
+				szFormat = "{1}fValue = (exp(LAYER{2}_ARG0 * fValue) - 1.0f) / LAYER{2}_ARG0 + LAYER{2}_ARG0;\n";
+			}
+		break;
+	}
+	if (NULL != szFormat)
+	{
+		Append(psSource, szFormat, szIndent, cLayer);
+	}
+
+	return Status();
+}
+
+void KernelGenerator::AppendFloat(Float fValue, String *psSource)
+{
+	static const Char   HEX[] = "0123456789ABCDEF";
+	UInt32              nBits;
+	Char                szBits[9];
+
+	memcpy(&nBits, &fValue, sizeof(nBits));
+	for (int i = 0; i < 8; i++)
+	{
+		szBits[i] = HEX[(nBits >> (28 - 4 * i)) & 0xF];
+	}
+	szBits[8] = 0;
+	Append(psSource, "as_float(0x{1}u)", szBits);
+}
+
+}//namespace CL
+
+}//namespace N2
@@ -28,6 +28,9 @@
 
 #include "N2/CL/KernelSources.hpp"
 #include "CX/IO/FileInputStream.hpp"
+#include "CX/IO/FileOutputStream.hpp"
+#include "CX/Print.hpp"
+#include "CX/C/Platform/Windows/windows.h"
 
 
 using namespace CX;
@@ -146,8 +149,173 @@ Status KernelSources::LoadSources(cl::Program::Sources *pSources)
 	return Status();
 }
 
+UInt64 KernelSources::Hash(UInt64 nHash, const void *pData, Size cbSize)
+{
+	const Byte   *pPos = (const Byte *)pData;
+
+	//FNV-1a
+	for (Size i = 0; i < cbSize; i++)
+	{
+		nHash ^= pPos[i];
+		nHash *= 0x100000001B3ULL;
+	}
+
+	return nHash;
+}
+
+UInt64 KernelSources::GetDeviceKey(cl::Device &device, const Char *szOptions)
+{
+	std::string   sInfo;
+	UInt64        nKey = 0xCBF29CE484222325ULL;
+
+	//the terminating zeros separate the fields
+	sInfo = device.getInfo<CL_DEVICE_NAME>();
+	nKey  = Hash(nKey, sInfo.c_str(), sInfo.size() + 1);
+	sInfo = device.getInfo<CL_DEVICE_VENDOR>();
+	nKey  = Hash(nKey, sInfo.c_str(), sInfo.size() + 1);
+	sInfo = device.getInfo<CL_DEVICE_VERSION>();
+	nKey  = Hash(nKey, sInfo.c_str(), sInfo.size() + 1);
+	sInfo = device.getInfo<CL_DRIVER_VERSION>();
+	nKey  = Hash(nKey, sInfo.c_str(), sInfo.size() + 1);
+	if (NULL != szOptions)
+	{
+		nKey = Hash(nKey, szOptions, cx_strlen(szOptions));
+	}
+	nKey = Hash(nKey, "", 1);
+
+	return nKey;
+}
+
+UInt64 KernelSources::GetCacheKey(cl::Device &device, const cl::Program::Sources &sources, const Char *szOptions)
+{
+	UInt64   nKey = GetDeviceKey(device, szOptions);
+
+	for (auto iter = sources.begin(); iter != sources.end(); ++iter)
+	{
+		nKey = Hash(nKey, &iter->second, sizeof(iter->second));
+		nKey = Hash(nKey, iter->first, iter->second);
+	}
+
+	return nKey;
+}
+
+void KernelSources::GetCachePath(const Char *szCacheDir, UInt64 nKey, const Char *szExtension, String *psPath)
+{
+	static const Char   HEX[] = "0123456789ABCDEF";
+	Char                szKey[17];
+
+	for (int i = 0; i < 16; i++)
+	{
+		szKey[i] = HEX[(nKey >> (60 - 4 * i)) & 0xF];
+	}
+	szKey[16] = 0;
+	Print(psPath, "{1}\\N2_{2}.{3}", szCacheDir, szKey, szExtension);
+}
+
+Status KernelSources::LoadBinary(const Char *szPath, UInt64 nKey, String *psBinary)
+{
+	IO::FileInputStream   fis(szPath);
+	CacheHeader           header;
+	UInt64                cbFileSize;
+	Size                  cbAckSize;
+	Status                status;
+
+	if (!fis.IsOK())
+	{
+		return Status(Status_OpenFailed, "Failed to open '{1}' at {2}:{3}", szPath, __FILE__, __LINE__);
+	}
+	if (!(status = fis.GetSize(&cbFileSize)))
+	{
+		return status;
+	}
+	if (!(status = fis.Read(&header, sizeof(header), &cbAckSize)))
+	{
+		return status;
+	}
+	if (sizeof(header) != cbAckSize || CACHE_MAGIC != header.nMagic || CACHE_VERSION != header.nVersion || 
+	    nKey != header.nKey || 0 == header.cbBinarySize || cbFileSize != sizeof(header) + header.cbBinarySize)
+	{
+		return Status(Status_InvalidArg, "Invalid cached binary '{1}' at {2}:{3}", szPath, __FILE__, __LINE__);
+	}
+	psBinary->resize((Size)header.cbBinarySize);
+	if (!(status = fis.Read(&(*psBinary)[0], psBinary->size(), &cbAckSize)))
+	{
+		return status;
+	}
+	if (psBinary->size() != cbAckSize)
+	{
+		return Status(Status_ReadFailed, "Failed to read '{1}' at {2}:{3}", szPath, __FILE__, __LINE__);
+	}
+
+	return Status();
+}
+
+Status KernelSources::SaveBinary(cl::Program *pProgram, const Char *szPath, UInt64 nKey)
+{
+	CacheHeader   header;
+	String        sBinary;
+	String        sTmpPath;
+	size_t        cbBinarySize = 0;
+	Byte          *pBinary;
+	Size          cbAckSize;
+	Status        status;
+
+	//the program is built for a single device => a single binary
+	if (CL_SUCCESS != clGetProgramInfo((*pProgram)(), CL_PROGRAM_BINARY_SIZES, sizeof(cbBinarySize), &cbBinarySize, 
+	                                   NULL) || 0 == cbBinarySize)
+	{
+		return Status(Status_OperationFailed, "Failed to get program binary size at {1}:{2}", __FILE__, __LINE__);
+	}
+	sBinary.resize(cbBinarySize);
+	pBinary = (Byte *)&sBinary[0];
+	if (CL_SUCCESS != clGetProgramInfo((*pProgram)(), CL_PROGRAM_BINARIES, sizeof(pBinary), &pBinary, NULL))
+	{
+		return Status(Status_OperationFailed, "Failed to get program binary at {1}:{2}", __FILE__, __LINE__);
+	}
+
+	header.nMagic       = CACHE_MAGIC;
+	header.nVersion     = CACHE_VERSION;
+	header.nKey         = nKey;
+	header.cbBinarySize = cbBinarySize;
+
+	//written under a process unique name and then renamed so concurrent processes never see a partial file
+	Print(&sTmpPath, "{1}.{2}.tmp", szPath, (UInt32)GetCurrentProcessId());
+	{
+		IO::FileOutputStream   fos(sTmpPath.c_str());
+
+		if (!fos.IsOK())
+		{
+			return Status(Status_CreateFailed, "Failed to create '{1}' at {2}:{3}", sTmpPath, __FILE__, __LINE__);
+		}
+		if ((status = fos.Write(&header, sizeof(header), &cbAckSize)) && sizeof(header) == cbAckSize)
+		{
+			if ((status = fos.Write(sBinary.data(), sBinary.size(), &cbAckSize)) && sBinary.size() != cbAckSize)
+			{
+				status = Status(Status_WriteFailed, "Failed to write '{1}' at {2}:{3}", sTmpPath, __FILE__, __LINE__);
+			}
+		}
+		else
+		if (status)
+		{
+			status = Status(Status_WriteFailed, "Failed to write '{1}' at {2}:{3}", sTmpPath, __FILE__, __LINE__);
+		}
+	}
+	if (status && !MoveFileExA(sTmpPath.c_str(), szPath, MOVEFILE_REPLACE_EXISTING))
+	{
+		status = Status(Status_OperationFailed, "Failed to rename '{1}' with error {2} at {3}:{4}", sTmpPath, 
+		                (int)GetLastError(), __FILE__, __LINE__);
+	}
+	if (!status)
+	{
+		DeleteFileA(sTmpPath.c_str());
+	}
+
+	return status;
+}
+
 Status KernelSources::Build(cl::Device &device, cl::Context &context, cl::Program **ppProgram, 
-                            String *psBuildLog/* = NULL*/)
+                            String *psBuildLog/* = NULL*/, const Char *szOptions/* = NULL*/, 
+                            const Char *szCacheDir/* = NULL*/)
 {
 	cl::Program::Sources    sources;
 	Status                  status;
@@ -160,11 +328,65 @@ Status KernelSources::Build(cl::Device &device, cl::Context &context, cl::Progra
 	{
 		return Status(Status_NotInitialized, "No sources registered at {1}:{2}", __FILE__, __LINE__);
 	}
+
+	return BuildSources(device, context, sources, ppProgram, psBuildLog, szOptions, szCacheDir);
+}
+
+Status KernelSources::BuildSource(cl::Device &device, cl::Context &context, const Char *szSource, Size cSourceLen, 
+                                  cl::Program **ppProgram, String *psBuildLog/* = NULL*/, 
+                                  const Char *szOptions/* = NULL*/, const Char *szCacheDir/* = NULL*/)
+{
+	cl::Program::Sources    sources;
+
+	if ((Size)-1 == cSourceLen)
+	{
+		cSourceLen = cx_strlen(szSource);
+	}
+	if (0 == cSourceLen || MAX_SOURCE_LEN < (UInt64)cSourceLen)
+	{
+		return Status(Status_InvalidArg, "Invalid source length {1} at {2}:{3}", cSourceLen, __FILE__,__LINE__);
+	}
+	sources.push_back({ szSource, cSourceLen });
+
+	return BuildSources(device, context, sources, ppProgram, psBuildLog, szOptions, szCacheDir);
+}
+
+Status KernelSources::BuildSources(cl::Device &device, cl::Context &context, const cl::Program::Sources &sources, 
+                                   cl::Program **ppProgram, String *psBuildLog, const Char *szOptions, 
+                                   const Char *szCacheDir)
+{
+	String   sCachePath;
+	UInt64   nKey = 0;
+
+	if (NULL != szCacheDir && 0 != *szCacheDir)
+	{
+		String   sBinary;
+
+		nKey = GetCacheKey(device, sources, szOptions);
+		GetCachePath(szCacheDir, nKey, "bin", &sCachePath);
+		if (LoadBinary(sCachePath.c_str(), nKey, &sBinary))
+		{
+			cl::Program::Binaries   binaries;
+			cl_int                  nError = CL_SUCCESS;
+
+			binaries.push_back({ sBinary.data(), sBinary.size() });
+			if (NULL != (*ppProgram = new (std::nothrow) cl::Program(context, { device }, binaries, NULL, &nError)))
+			{
+				if (CL_SUCCESS == nError && CL_SUCCESS == (*ppProgram)->build({ device }, szOptions))
+				{
+					return Status();
+				}
+				//stale or rejected by the driver => rebuild from sources
+				delete *ppProgram;
+				*ppProgram = NULL;
+			}
+		}
+	}
 	if (NULL == (*ppProgram = new (std::nothrow) cl::Program(context, sources)))
 	{
 		return Status(Status_ReadFailed, "Failed to create program at {1}:{2}", __FILE__, __LINE__);
 	}
-	if (CL_SUCCESS != (*ppProgram)->build({ device }))
+	if (CL_SUCCESS != (*ppProgram)->build({ device }, szOptions))
 	{
 		if (NULL != psBuildLog)
 		{
@@ -175,6 +397,11 @@ Status KernelSources::Build(cl::Device &device, cl::Context &context, cl::Progra
 
 		return Status(Status_OperationFailed, "Failed to build program at {1}:{2}", __FILE__, __LINE__);
 	}
+	//the cache is only an optimization => failing to update it is not an error
+	if (!sCachePath.empty())
+	{
+		SaveBinary(*ppProgram, sCachePath.c_str(), nKey);
+	}
 
 	return Status();
 }
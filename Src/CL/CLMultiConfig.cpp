@@ -0,0 +1,104 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "N2/CL/MultiConfig.hpp"
+
+
+using namespace CX;
+
+
+namespace N2
+{
+
+namespace CL
+{
+
+MultiConfig::MultiConfig()
+{
+	m_nPartition    = Partition_None;
+	m_cComputeUnits = 0;
+}
+
+MultiConfig::~MultiConfig()
+{
+}
+
+void MultiConfig::AddDevice(cl_device_id nDevID)
+{
+	m_vectorDevices.push_back(nDevID);
+}
+
+void MultiConfig::ClearDevices()
+{
+	m_vectorDevices.clear();
+}
+
+UInt32 MultiConfig::GetDevicesCount() const
+{
+	return (UInt32)m_vectorDevices.size();
+}
+
+cl_device_id MultiConfig::GetDevice(UInt32 cIndex) const
+{
+	if (cIndex >= (UInt32)m_vectorDevices.size())
+	{
+		return NULL;
+	}
+
+	return m_vectorDevices[cIndex];
+}
+
+void MultiConfig::SetPartition(Partition nPartition, UInt32 cComputeUnits/* = 0*/)
+{
+	m_nPartition    = nPartition;
+	m_cComputeUnits = cComputeUnits;
+}
+
+MultiConfig::Partition MultiConfig::GetPartition() const
+{
+	return m_nPartition;
+}
+
+UInt32 MultiConfig::GetPartitionComputeUnits() const
+{
+	return m_cComputeUnits;
+}
+
+Config *MultiConfig::GetConfig()
+{
+	return &m_config;
+}
+
+const Config *MultiConfig::GetConfig() const
+{
+	return &m_config;
+}
+
+}//namespace CL
+
+}//namespace N2
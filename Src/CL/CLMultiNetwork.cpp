@@ -0,0 +1,393 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "N2/CL/MultiNetwork.hpp"
+#include "N2/CL/MultiProvider.hpp"
+#include "N2/CL/Provider.hpp"
+
+
+using namespace CX;
+
+
+namespace N2
+{
+
+namespace CL
+{
+
+MultiNetwork::MultiNetwork(MultiProvider *pProvider)
+{
+	m_pProvider = pProvider;
+	m_pNetwork  = NULL;
+}
+
+MultiNetwork::~MultiNetwork()
+{
+	Uninit();
+}
+
+MultiProvider *MultiNetwork::GetProvider()
+{
+	return m_pProvider;
+}
+
+Status MultiNetwork::Init(NET::Network *pNetwork)
+{
+	Uninit();
+
+	Provider     *pProvider;
+	cl::Device   *pDevice;
+	Shard        shard;
+	Status       status;
+
+	for (UInt32 i = 0; i < m_pProvider->GetProvidersCount(); i++)
+	{
+		pProvider = m_pProvider->GetProvider(i);
+		if (NULL == (shard.pNetwork = new (std::nothrow) Network(pProvider)))
+		{
+			status = Status(Status_MemAllocFailed, "Failed to allocate network at {1}:{2}", __FILE__, __LINE__);
+
+			break;
+		}
+		//the shards are timed from the events of their queues
+		shard.pNetwork->SetProfiling(True);
+		if (!(status = shard.pNetwork->Init(pNetwork)))
+		{
+			delete shard.pNetwork;
+
+			break;
+		}
+		pDevice = pProvider->GetDevice();
+		//only the ratios between the shards matter until the first measurements
+		shard.lfThroughput = (Double)pDevice->getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>() * 
+		                     (Double)pDevice->getInfo<CL_DEVICE_MAX_CLOCK_FREQUENCY>();
+		if (0.0 >= shard.lfThroughput)
+		{
+			shard.lfThroughput = 1.0;
+		}
+		shard.cMaxCount    = shard.pNetwork->GetMaxStreamChunkSize();
+		shard.cCount       = 0;
+		shard.cOffset      = 0;
+		m_vectorShards.push_back(shard);
+	}
+	if (status && m_vectorShards.empty())
+	{
+		status = Status(Status_NotInitialized, "Provider not initialized at {1}:{2}", __FILE__, __LINE__);
+	}
+	if (!status)
+	{
+		Uninit();
+
+		return status;
+	}
+	m_pNetwork = pNetwork;
+
+	return Status();
+}
+
+Status MultiNetwork::Uninit()
+{
+	for (ShardsVector::iterator iter = m_vectorShards.begin(); iter != m_vectorShards.end(); ++iter)
+	{
+		delete iter->pNetwork;
+	}
+	m_vectorShards.clear();
+	m_pNetwork = NULL;
+
+	return Status();
+}
+
+Bool MultiNetwork::IsOK() const
+{
+	return (NULL != m_pNetwork);
+}
+
+UInt32 MultiNetwork::GetLayersCount() const
+{
+	if (m_vectorShards.empty())
+	{
+		return 0;
+	}
+
+	return m_vectorShards[0].pNetwork->GetLayersCount();
+}
+
+const NET::Network *MultiNetwork::GetNetwork() const
+{
+	return m_pNetwork;
+}
+
+NET::Network *MultiNetwork::GetNetwork()
+{
+	return m_pNetwork;
+}
+
+const CE::INeurons *MultiNetwork::GetInputNeurons() const
+{
+	if (m_vectorShards.empty())
+	{
+		return NULL;
+	}
+
+	return m_vectorShards[0].pNetwork->GetInputNeurons();
+}
+
+CE::INeurons *MultiNetwork::GetInputNeurons()
+{
+	if (m_vectorShards.empty())
+	{
+		return NULL;
+	}
+
+	return m_vectorShards[0].pNetwork->GetInputNeurons();
+}
+
+const CE::INeurons *MultiNetwork::GetOutputNeurons() const
+{
+	if (m_vectorShards.empty())
+	{
+		return NULL;
+	}
+
+	return m_vectorShards[0].pNetwork->GetOutputNeurons();
+}
+
+CE::INeurons *MultiNetwork::GetOutputNeurons()
+{
+	if (m_vectorShards.empty())
+	{
+		return NULL;
+	}
+
+	return m_vectorShards[0].pNetwork->GetOutputNeurons();
+}
+
+Status MultiNetwork::SyncToCE(Bool bWait/* = True*/, UInt32 nSyncType/* = Sync_All*/)
+{
+	if (NULL == m_pNetwork)
+	{
+		return Status(Status_NotInitialized, "Not initialized at {1}:{2}", __FILE__, __LINE__);
+	}
+
+	Status   status;
+
+	for (ShardsVector::iterator iter = m_vectorShards.begin(); iter != m_vectorShards.end(); ++iter)
+	{
+		if (!(status = iter->pNetwork->SyncToCE(bWait, nSyncType)))
+		{
+			return status;
+		}
+	}
+
+	return Status();
+}
+
+Status MultiNetwork::SyncFromCE(Bool bWait/* = True*/, UInt32 nSyncType/* = Sync_All*/)
+{
+	if (NULL == m_pNetwork)
+	{
+		return Status(Status_NotInitialized, "Not initialized at {1}:{2}", __FILE__, __LINE__);
+	}
+
+	return m_vectorShards[0].pNetwork->SyncFromCE(bWait, nSyncType);
+}
+
+Size MultiNetwork::GetMemSize() const
+{
+	Size   cbMemSize = sizeof(MultiNetwork);
+
+	for (ShardsVector::const_iterator iter = m_vectorShards.begin(); iter != m_vectorShards.end(); ++iter)
+	{
+		cbMemSize += iter->pNetwork->GetMemSize();
+	}
+
+	return cbMemSize;
+}
+
+Status MultiNetwork::Evaluate(UInt32 cCount, Float *inputs, Float *outputs)
+{
+	if (NULL == m_pNetwork)
+	{
+		return Status(Status_NotInitialized, "Not initialized at {1}:{2}", __FILE__, __LINE__);
+	}
+	if (0 == cCount || NULL == inputs || NULL == outputs)
+	{
+		return Status(Status_InvalidArg, "Invalid arg at {1}:{2}", __FILE__, __LINE__);
+	}
+	if (1 == m_vectorShards.size())
+	{
+		return m_vectorShards[0].pNetwork->Evaluate(cCount, inputs, outputs);
+	}
+
+	std::vector<cl::Event>   vectorEvents(m_vectorShards.size());
+	Shard                    *pShard;
+	UInt32                   cInputs  = m_pNetwork->GetInputNeurons()->GetNeuronsCount();
+	UInt32                   cOutputs = m_pNetwork->GetOutputNeurons()->GetNeuronsCount();
+	UInt32                   cDone    = 0;
+	UInt32                   cRound;
+	UInt32                   cEnqueued;
+	cl_ulong                 nQueued;
+	cl_ulong                 nEnd;
+	Double                   lfThroughput;
+	cl_int                   nError;
+	Status                   status;
+
+	while (cDone < cCount)
+	{
+		if (0 == (cRound = SplitBatch(cCount - cDone)))
+		{
+			return Status(Status_OperationFailed, "Failed to split batch at {1}:{2}", __FILE__, __LINE__);
+		}
+		for (cEnqueued = 0; cEnqueued < (UInt32)m_vectorShards.size(); cEnqueued++)
+		{
+			pShard = &m_vectorShards[cEnqueued];
+			if (0 == pShard->cCount)
+			{
+				continue;
+			}
+			if (!(status = pShard->pNetwork->EvaluateAsync(pShard->cCount, 
+			                                               inputs + (Size)(cDone + pShard->cOffset) * cInputs, 
+			                                               outputs + (Size)(cDone + pShard->cOffset) * cOutputs, 
+			                                               &vectorEvents[cEnqueued])))
+			{
+				break;
+			}
+		}
+		//the shards already enqueued are waited for even on failure (they still use inputs and outputs)
+		for (UInt32 i = 0; i < cEnqueued; i++)
+		{
+			pShard = &m_vectorShards[i];
+			if (0 == pShard->cCount)
+			{
+				continue;
+			}
+			if (CL_SUCCESS != (nError = vectorEvents[i].wait()))
+			{
+				if (status)
+				{
+					status = Status(Status_OperationFailed, "Failed to evaluate shard {1} with error {2} at {3}:{4}", 
+					                i, nError, __FILE__, __LINE__);
+				}
+
+				continue;
+			}
+			//the read back is queued right after the upload and compute commands of the shard, so the time from its 
+			//queued to its end timestamp is the time of the whole shard
+			nQueued = vectorEvents[i].getProfilingInfo<CL_PROFILING_COMMAND_QUEUED>(&nError);
+			if (CL_SUCCESS != nError)
+			{
+				continue;
+			}
+			nEnd = vectorEvents[i].getProfilingInfo<CL_PROFILING_COMMAND_END>(&nError);
+			if (CL_SUCCESS != nError || nEnd <= nQueued)
+			{
+				continue;
+			}
+			lfThroughput         = (Double)pShard->cCount * 1000000000.0 / (Double)(nEnd - nQueued);
+			pShard->lfThroughput += (lfThroughput - pShard->lfThroughput) * THROUGHPUT_UPDATE_PERCENT / 100.0;
+		}
+		if (!status)
+		{
+			return status;
+		}
+		cDone += cRound;
+	}
+
+	return Status();
+}
+
+UInt32 MultiNetwork::GetShardsCount() const
+{
+	return (UInt32)m_vectorShards.size();
+}
+
+Network *MultiNetwork::GetShard(UInt32 cIndex)
+{
+	if (cIndex >= (UInt32)m_vectorShards.size())
+	{
+		return NULL;
+	}
+
+	return m_vectorShards[cIndex].pNetwork;
+}
+
+Double MultiNetwork::GetShardThroughput(UInt32 cIndex) const
+{
+	if (cIndex >= (UInt32)m_vectorShards.size())
+	{
+		return 0.0;
+	}
+
+	return m_vectorShards[cIndex].lfThroughput;
+}
+
+UInt32 MultiNetwork::SplitBatch(UInt32 cCount)
+{
+	Double   lfTotal   = 0.0;
+	UInt32   cAssigned = 0;
+	UInt32   cOffset   = 0;
+	UInt32   cShard;
+
+	for (ShardsVector::iterator iter = m_vectorShards.begin(); iter != m_vectorShards.end(); ++iter)
+	{
+		lfTotal += iter->lfThroughput;
+	}
+	for (ShardsVector::iterator iter = m_vectorShards.begin(); iter != m_vectorShards.end(); ++iter)
+	{
+		cShard = (UInt32)((Double)cCount * iter->lfThroughput / lfTotal);
+		if (cShard > iter->cMaxCount)
+		{
+			cShard = iter->cMaxCount;
+		}
+		iter->cCount  = cShard;
+		cAssigned    += cShard;
+	}
+	//what the rounding (or the caps) left goes to the shards that still have room
+	for (ShardsVector::iterator iter = m_vectorShards.begin(); iter != m_vectorShards.end() && cAssigned < cCount; 
+	     ++iter)
+	{
+		cShard = iter->cMaxCount - iter->cCount;
+		if (cShard > cCount - cAssigned)
+		{
+			cShard = cCount - cAssigned;
+		}
+		iter->cCount += cShard;
+		cAssigned    += cShard;
+	}
+	for (ShardsVector::iterator iter = m_vectorShards.begin(); iter != m_vectorShards.end(); ++iter)
+	{
+		iter->cOffset  = cOffset;
+		cOffset       += iter->cCount;
+	}
+
+	return cAssigned;
+}
+
+}//namespace CL
+
+}//namespace N2
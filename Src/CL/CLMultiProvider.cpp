@@ -0,0 +1,258 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "N2/CL/MultiProvider.hpp"
+#include "N2/CL/MultiNetwork.hpp"
+
+
+using namespace CX;
+
+
+namespace N2
+{
+
+namespace CL
+{
+
+MultiProvider::MultiProvider()
+{
+}
+
+MultiProvider::~MultiProvider()
+{
+	Uninit();
+}
+
+CE::IConfig *MultiProvider::CreateConfig()
+{
+	return new (std::nothrow) MultiConfig();
+}
+
+Status MultiProvider::DestroyConfig(CE::IConfig *pConfig)
+{
+	MultiConfig *pMultiConfig = dynamic_cast<MultiConfig *>(pConfig);
+
+	if (NULL == pMultiConfig)
+	{
+		return Status(Status_InvalidArg, "Invalid arg at {1}:{2}", __FILE__, __LINE__);
+	}
+	delete pMultiConfig;
+
+	return Status();
+}
+
+Status MultiProvider::Init(const CE::IConfig *pConfig/* = NULL*/)
+{
+	const MultiConfig         *pMultiConfig = NULL;
+	std::vector<cl::Device>   vectorDevices;
+	std::vector<cl::Device>   vectorSubDevices;
+	Provider                  *pProvider;
+	Config                    config;
+	Status                    status;
+
+	if (NULL != pConfig)
+	{
+		if (NULL == (pMultiConfig = dynamic_cast<const MultiConfig *>(pConfig)))
+		{
+			return Status(Status_InvalidArg, "Invalid arg at {1}:{2}", __FILE__, __LINE__);
+		}
+		config = *pMultiConfig->GetConfig();
+	}
+
+	Uninit();
+
+	for (;;)
+	{
+		if (NULL == pMultiConfig || 0 == pMultiConfig->GetDevicesCount())
+		{
+			cl::Device   device;
+
+			if (!(status = OpenCL::ChooseDeviceByTypeAndIndex(&device)))
+			{
+				break;
+			}
+			vectorDevices.push_back(device);
+		}
+		else
+		{
+			for (UInt32 i = 0; i < pMultiConfig->GetDevicesCount(); i++)
+			{
+				//the wrapper releases the device when destroyed
+				clRetainDevice(pMultiConfig->GetDevice(i));
+				vectorDevices.push_back(cl::Device(pMultiConfig->GetDevice(i)));
+			}
+		}
+		for (auto iter = vectorDevices.begin(); iter != vectorDevices.end(); ++iter)
+		{
+			if (NULL == pMultiConfig)
+			{
+				vectorSubDevices.push_back(*iter);
+			}
+			else
+			if (!(status = PartitionDevice(&*iter, pMultiConfig->GetPartition(), 
+			                               pMultiConfig->GetPartitionComputeUnits(), &vectorSubDevices)))
+			{
+				break;
+			}
+		}
+		if (!status)
+		{
+			break;
+		}
+		for (auto iter = vectorSubDevices.begin(); iter != vectorSubDevices.end(); ++iter)
+		{
+			if (NULL == (pProvider = new (std::nothrow) Provider()))
+			{
+				status = Status(Status_MemAllocFailed, "Failed to allocate provider at {1}:{2}", __FILE__, __LINE__);
+
+				break;
+			}
+			config.SetDeviceID((*iter)());
+			//the provider wraps the device ID and releases it on uninit
+			clRetainDevice((*iter)());
+			if (!(status = pProvider->Init(&config)))
+			{
+				delete pProvider;
+
+				break;
+			}
+			m_vectorProviders.push_back(pProvider);
+		}
+
+		break;
+	}
+	if (!status)
+	{
+		Uninit();
+	}
+
+	return status;
+}
+
+Status MultiProvider::Uninit()
+{
+	for (ProvidersVector::iterator iter = m_vectorProviders.begin(); iter != m_vectorProviders.end(); ++iter)
+	{
+		delete *iter;
+	}
+	m_vectorProviders.clear();
+
+	return Status();
+}
+
+Bool MultiProvider::IsOK() const
+{
+	return !m_vectorProviders.empty();
+}
+
+CE::INetwork *MultiProvider::CreateNetwork()
+{
+	if (m_vectorProviders.empty())
+	{
+		return NULL;
+	}
+
+	return new (std::nothrow) MultiNetwork(this);
+}
+
+Status MultiProvider::DestroyNetwork(CE::INetwork *pNetwork)
+{
+	MultiNetwork *pMultiNetwork = dynamic_cast<MultiNetwork *>(pNetwork);
+
+	if (NULL == pMultiNetwork)
+	{
+		return Status(Status_InvalidArg, "Invalid arg at {1}:{2}", __FILE__, __LINE__);
+	}
+
+	delete pMultiNetwork;
+
+	return Status();
+}
+
+UInt32 MultiProvider::GetProvidersCount() const
+{
+	return (UInt32)m_vectorProviders.size();
+}
+
+Provider *MultiProvider::GetProvider(UInt32 cIndex)
+{
+	if (cIndex >= (UInt32)m_vectorProviders.size())
+	{
+		return NULL;
+	}
+
+	return m_vectorProviders[cIndex];
+}
+
+Status MultiProvider::PartitionDevice(cl::Device *pDevice, MultiConfig::Partition nPartition, UInt32 cComputeUnits, 
+                                      std::vector<cl::Device> *pVectorDevices)
+{
+	std::vector<cl::Device>        vectorSubDevices;
+	cl_device_partition_property   properties[3];
+
+	switch (nPartition)
+	{
+		case MultiConfig::Partition_Equally:
+			if (0 == cComputeUnits)
+			{
+				return Status(Status_InvalidArg, "Invalid partition compute units at {1}:{2}", __FILE__, __LINE__);
+			}
+			properties[0] = CL_DEVICE_PARTITION_EQUALLY;
+			properties[1] = (cl_device_partition_property)cComputeUnits;
+		break;
+		case MultiConfig::Partition_NUMA:
+			properties[0] = CL_DEVICE_PARTITION_BY_AFFINITY_DOMAIN;
+			properties[1] = CL_DEVICE_AFFINITY_DOMAIN_NUMA;
+		break;
+		case MultiConfig::Partition_L3Cache:
+			properties[0] = CL_DEVICE_PARTITION_BY_AFFINITY_DOMAIN;
+			properties[1] = CL_DEVICE_AFFINITY_DOMAIN_L3_CACHE;
+		break;
+		default:
+			pVectorDevices->push_back(*pDevice);
+
+			return Status();
+	}
+	properties[2] = 0;
+	//devices without fission (most GPUs) or with a single domain of the requested kind are used whole
+	if (1 < pDevice->getInfo<CL_DEVICE_PARTITION_MAX_SUB_DEVICES>() && 
+	    OpenCL::CreateSubDevices(pDevice, properties, &vectorSubDevices))
+	{
+		pVectorDevices->insert(pVectorDevices->end(), vectorSubDevices.begin(), vectorSubDevices.end());
+	}
+	else
+	{
+		pVectorDevices->push_back(*pDevice);
+	}
+
+	return Status();
+}
+
+}//namespace CL
+
+}//namespace N2
@@ -28,6 +28,9 @@
 
 #include "N2/CL/Network.hpp"
 #include "N2/CL/Provider.hpp"
+#include "N2/CL/KernelSources.hpp"
+#include "N2/CL/KernelGenerator.hpp"
+#include <algorithm>
 
 
 using namespace CX;
@@ -39,14 +42,43 @@ namespace N2
 namespace CL
 {
 
+//by offset in the pool
+static bool CompareTensors(const Network::Tensor &a, const Network::Tensor &b)
+{
+	return a.cbOffset < b.cbOffset;
+}
+
 Network::Network(Provider *pProvider)
 {
-	m_pProvider      = pProvider;
-	m_pQueue         = NULL;
-	m_pNetwork       = NULL;
-	m_pInputNeurons  = NULL;
-	m_pOutputNeurons = NULL;
-	m_cbMemSize      = 0;
+	m_pProvider           = pProvider;
+	m_pQueue              = NULL;
+	m_pNetwork            = NULL;
+	m_pInputNeurons       = NULL;
+	m_pOutputNeurons      = NULL;
+	m_cbMemSize           = 0;
+	m_pool.cbAlignment    = 0;
+	m_pool.cbSynapsesSize = 0;
+	m_pool.cbSize         = 0;
+	m_pool.cbSynapsesUsed = 0;
+	m_pool.cbNeuronsUsed  = 0;
+	m_batch.cCapacity     = 0;
+	m_batch.cMappedCount  = 0;
+	m_batch.mappedInputs  = NULL;
+	m_batch.mappedOutputs = NULL;
+	m_batch.pQueue        = NULL;
+	m_cMaxStreamChunkSize = 0;
+	m_pProgram            = NULL;
+	m_cNetworkGroupSize   = 0;
+	m_bProfiling          = False;
+	m_slots               = NULL;
+	m_cSlots              = 0;
+	m_cNextSlot           = 0;
+	InitializeSRWLock(&m_srwlSlots);
+	for (UInt32 i = 0; i < STREAM_SLOTS; i++)
+	{
+		m_streams[i].pQueue    = NULL;
+		m_streams[i].cCapacity = 0;
+	}
 }
 
 Network::~Network()
@@ -59,6 +91,16 @@ Provider *Network::GetProvider()
 	return m_pProvider;
 }
 
+void Network::SetProfiling(Bool bProfiling)
+{
+	m_bProfiling = bProfiling;
+}
+
+Bool Network::GetProfiling() const
+{
+	return m_bProfiling;
+}
+
 Status Network::Init(NET::Network *pNetwork)
 {
 	Uninit();
@@ -73,7 +115,8 @@ Status Network::Init(NET::Network *pNetwork)
 	m_cbMemSize = sizeof(Network);
 	for (;;)
 	{
-		if (NULL == (m_pQueue = new (std::nothrow) cl::CommandQueue(*m_pProvider->GetContext(), 0, &nError)))
+		if (NULL == (m_pQueue = new (std::nothrow) cl::CommandQueue(*m_pProvider->GetContext(), 
+		                                                   m_bProfiling ? CL_QUEUE_PROFILING_ENABLE : 0, &nError)))
 		{
 			status = Status(Status_MemAllocFailed, "Failed to allocate queue at {1}:{2}", __FILE__, __LINE__);
 
@@ -85,6 +128,30 @@ Status Network::Init(NET::Network *pNetwork)
 
 			break;
 		}
+		if (!(status = CreatePool(pNetwork)))
+		{
+			break;
+		}
+		//the timestamps of a profiled network must be its own => no shared queues
+		if (!m_bProfiling && NULL != m_pProvider->GetScheduler())
+		{
+			if (NULL == (m_slots = new (std::nothrow) Batch[m_pProvider->GetMaxInFlight()]))
+			{
+				status = Status(Status_MemAllocFailed, "Failed to allocate batches at {1}:{2}", __FILE__, __LINE__);
+
+				break;
+			}
+			m_cSlots    = m_pProvider->GetMaxInFlight();
+			m_cNextSlot = 0;
+			for (UInt32 i = 0; i < m_cSlots; i++)
+			{
+				m_slots[i].pQueue        = NULL;
+				m_slots[i].cCapacity     = 0;
+				m_slots[i].cMappedCount  = 0;
+				m_slots[i].mappedInputs  = NULL;
+				m_slots[i].mappedOutputs = NULL;
+			}
+		}
 
 		pNETNeurons = pNetwork->GetInputNeurons();
 
@@ -154,7 +221,19 @@ Status Network::Init(NET::Network *pNetwork)
 		{
 			break;
 		}
-		m_pNetwork      = pNetwork;
+		m_batch.pQueue        = m_pQueue;
+		m_cMaxStreamChunkSize = ComputeMaxStreamChunkSize();
+		m_pNetwork            = pNetwork;
+		//the pool starts with the host values, in a single transfer
+		if (!(status = SyncToCE(True, Sync_All)))
+		{
+			break;
+		}
+		//the generic kernels cover everything, a network without generated kernels still works
+		if (m_pProvider->GetGenerateKernels())
+		{
+			GenerateKernels();
+		}
 
 		break;
 	}
@@ -168,10 +247,39 @@ Status Network::Init(NET::Network *pNetwork)
 
 Status Network::Uninit()
 {
+	//the batches in flight still use the slot buffers
+	if (NULL != m_slots)
+	{
+		for (UInt32 i = 0; i < m_cSlots; i++)
+		{
+			if (NULL != m_slots[i].event())
+			{
+				m_slots[i].event.wait();
+			}
+		}
+		delete [] m_slots;
+	}
+	m_slots     = NULL;
+	m_cSlots    = 0;
+	m_cNextSlot = 0;
+	m_syncEvent = cl::Event();
 	if (NULL != m_pQueue)
 	{
+		Unmap();
 		delete m_pQueue;
 	}
+	for (UInt32 i = 0; i < STREAM_SLOTS; i++)
+	{
+		if (NULL != m_streams[i].pQueue)
+		{
+			delete m_streams[i].pQueue;
+		}
+		m_streams[i].pQueue    = NULL;
+		m_streams[i].cCapacity = 0;
+		m_streams[i].inputs    = cl::Buffer();
+		m_streams[i].outputs   = cl::Buffer();
+		m_streams[i].hidden.clear();
+	}
 
 	Neurons    *pNeurons;
 	Synapses   *pSynapses;
@@ -190,11 +298,33 @@ Status Network::Uninit()
 		}
 	}
 
-	m_pQueue         = NULL;
-	m_pNetwork       = NULL;
-	m_pInputNeurons  = NULL;
-	m_pOutputNeurons = NULL;
-	m_cbMemSize      = 0;
+	m_pQueue              = NULL;
+	m_pNetwork            = NULL;
+	m_pInputNeurons       = NULL;
+	m_pOutputNeurons      = NULL;
+	m_cbMemSize           = 0;
+	m_batch.cCapacity     = 0;
+	m_batch.cMappedCount  = 0;
+	m_batch.mappedInputs  = NULL;
+	m_batch.mappedOutputs = NULL;
+	m_batch.inputs        = cl::Buffer();
+	m_batch.outputs       = cl::Buffer();
+	m_batch.hidden.clear();
+	m_batch.pQueue        = NULL;
+	m_cMaxStreamChunkSize = 0;
+	m_pool.buffer         = cl::Buffer();
+	m_pool.cbAlignment    = 0;
+	m_pool.cbSynapsesSize = 0;
+	m_pool.cbSize         = 0;
+	m_pool.cbSynapsesUsed = 0;
+	m_pool.cbNeuronsUsed  = 0;
+	if (NULL != m_pProgram)
+	{
+		delete m_pProgram;
+	}
+	m_pProgram            = NULL;
+	m_kernelNetwork       = cl::Kernel();
+	m_cNetworkGroupSize   = 0;
 
 	return Status();
 }
@@ -251,41 +381,16 @@ Status Network::SyncToCE(Bool bWait/* = True*/, UInt32 nSyncType/* = Sync_All*/)
 		return Status(Status_NotInitialized, "Not initialized at {1}:{2}", __FILE__, __LINE__);
 	}
 
-	Synapses   *pSynapses;
-	Neurons    *pNeurons;
+	TensorsVector   vectorTensors;
+	Status          status;
 
-	pNeurons = m_pInputNeurons;
-	while (NULL != pNeurons)
-	{
-		if (Sync_Neurons == (nSyncType & Sync_Neurons))
-		{
-			pNeurons->SyncToCE(False);
-		}
-		pSynapses = pNeurons->m_pNextSynapses;
-		if (NULL != pSynapses)
-		{
-			break;
-		}
-		else
-		{
-			if (Sync_Synapse == (nSyncType & Sync_Synapse))
-			{
-				pSynapses ->SyncToCE(False);
-			}
-			pNeurons = pSynapses->m_pNextNeurons;
-		}
-	}
-	if (bWait)
+	GetTensors(nSyncType, True, &vectorTensors);
+	if (!(status = SyncTensors(vectorTensors, True, bWait)))
 	{
-		cl_int   nError;
-
-		if (CL_SUCCESS != (nError = m_pQueue->finish()))
-		{
-			return Status(Status_OperationFailed, "Failed to sync at {1}:{2}", __FILE__, __LINE__);
-		}
+		ResetSyncedVersions();
 	}
 
-	return Status();
+	return status;
 }
 
 Status Network::SyncFromCE(Bool bWait/* = True*/, UInt32 nSyncType/* = Sync_All*/)
@@ -295,41 +400,11 @@ Status Network::SyncFromCE(Bool bWait/* = True*/, UInt32 nSyncType/* = Sync_All*
 		return Status(Status_NotInitialized, "Not initialized at {1}:{2}", __FILE__, __LINE__);
 	}
 
-	Synapses   *pSynapses;
-	Neurons    *pNeurons;
-
-	pNeurons = m_pInputNeurons;
-	while (NULL != pNeurons)
-	{
-		if (Sync_Neurons == (nSyncType & Sync_Neurons))
-		{
-			pNeurons->SyncFromCE(False);
-		}
-		pSynapses = pNeurons->m_pNextSynapses;
-		if (NULL == pSynapses)
-		{
-			break;
-		}
-		else
-		{
-			if (Sync_Synapse == (nSyncType & Sync_Synapse))
-			{
-				pSynapses ->SyncFromCE(False);
-			}
-			pNeurons = pSynapses->m_pNextNeurons;
-		}
-	}
-	if (bWait)
-	{
-		cl_int   nError;
+	TensorsVector   vectorTensors;
 
-		if (CL_SUCCESS != (nError = m_pQueue->finish()))
-		{
-			return Status(Status_OperationFailed, "Failed to sync at {1}:{2}", __FILE__, __LINE__);
-		}
-	}
+	GetTensors(nSyncType, False, &vectorTensors);
 
-	return Status();
+	return SyncTensors(vectorTensors, False, bWait);
 }
 
 Size Network::GetMemSize() const
@@ -340,276 +415,1423 @@ Size Network::GetMemSize() const
 //assumes that weights are already transferred into device memory
 Status Network::Evaluate(UInt32 cCount, Float *inputs, Float *outputs)
 {
-	if (0 == m_pNetwork)
+	cl::Event   event;
+	cl_int      nError;
+	Status      status;
+
+	//batches that do not fit in device memory go through the chunked path
+	if (cCount > m_cMaxStreamChunkSize && 0 != m_cMaxStreamChunkSize)
 	{
-		return Status(Status_NotInitialized, "Not initialized at {1}:{2}", __FILE__, __LINE__);
+		return EvaluateStream(cCount, inputs, outputs);
 	}
-	if (0 == cCount)
+	if (!(status = EvaluateAsync(cCount, inputs, outputs, &event)))
 	{
-		return Status(Status_InvalidArg, "Invalid arg at {1}:{2}", __FILE__, __LINE__);
+		return status;
 	}
-
-	Synapses           *pSynapses;
-	cl::Buffer         *prevNeurons;
-	UInt32             cPrevNeuronsOffset;
-	cl::Buffer         *nextNeurons;
-	UInt32             cNextNeuronsOffset;
-	UInt32             cInputsOffset;
-	UInt32             cOutputsOffset;
-	cl_int             nError;
-	Status             status;
-
-	cl::Buffer         bufInputs(*m_pProvider->GetContext(), CL_MEM_READ_WRITE, 
-	                             sizeof(Float) * cCount * m_pInputNeurons->GetNeuronsCount(), NULL, &nError);
-	if (CL_SUCCESS != nError)
+	if (CL_SUCCESS != (nError = event.wait()))
 	{
-		return Status(Status_OperationFailed, "Failed to init inputs buffer at {1}:{2}", __FILE__, __LINE__);
+		return Status(Status_OperationFailed, "Failed to read outputs buffer with error {1} at {2}:{3}", nError, 
+		              __FILE__, __LINE__);
 	}
 
-	cl::Buffer         bufOutputs(*m_pProvider->GetContext(), CL_MEM_READ_WRITE, 
-	                              sizeof(Float) * cCount * m_pOutputNeurons->GetNeuronsCount(), NULL, &nError);
-	if (CL_SUCCESS != nError)
-	{
-		return Status(Status_OperationFailed, "Failed to init outputs buffer at {1}:{2}", __FILE__, __LINE__);
-	}
+	return Status();
+}
 
-	if (CL_SUCCESS != (nError = m_pQueue->enqueueWriteBuffer(bufInputs, CL_FALSE, 0, 
-	                                             sizeof(Float) * cCount * m_pInputNeurons->GetNeuronsCount(), inputs)))
+Status Network::EvaluateAsync(UInt32 cCount, Float *inputs, Float *outputs, cl::Event *pEvent)
+{
+	if (0 == m_pNetwork)
 	{
-		return Status(Status_OperationFailed, "Failed to write inputs buffer at {1}:{2}", __FILE__, __LINE__);
+		return Status(Status_NotInitialized, "Not initialized at {1}:{2}", __FILE__, __LINE__);
 	}
-	if (CL_SUCCESS != (nError = m_pQueue->enqueueWriteBuffer(bufOutputs, CL_FALSE, 0, 
-	                                             sizeof(Float) * cCount * m_pOutputNeurons->GetNeuronsCount(), outputs)))
+	if (0 == cCount || NULL == pEvent)
 	{
-		return Status(Status_OperationFailed, "Failed to write outputs buffer at {1}:{2}", __FILE__, __LINE__);
+		return Status(Status_InvalidArg, "Invalid arg at {1}:{2}", __FILE__, __LINE__);
 	}
 
-	cInputsOffset  = 0;
-	cOutputsOffset = 0;
-	for (UInt32 i = 0; i < cCount; i++)
+	Scheduler   *pScheduler = m_pProvider->GetScheduler();
+	Batch       *pBatch;
+	UInt32      cQueue;
+	Status      status;
+
+	//the kernels args are set at enqueue time => one batch is enqueued at a time
+	AcquireSRWLockExclusive(&m_srwlSlots);
+	if (NULL == m_slots)
 	{
-		pSynapses = m_pInputNeurons->m_pNextSynapses;
-		while (NULL != pSynapses)
+		if (NULL != m_batch.mappedInputs || NULL != m_batch.mappedOutputs)
 		{
-			if (pSynapses->m_pPrevNeurons == m_pInputNeurons)
-			{
-				prevNeurons        = &bufInputs;
-				cPrevNeuronsOffset = cInputsOffset;
-			}
-			else
-			{
-				prevNeurons        = &pSynapses->m_pPrevNeurons->m_values;
-				cPrevNeuronsOffset = 0;
-			}
-			if (pSynapses->m_pNextNeurons == m_pOutputNeurons)
-			{
-				nextNeurons        = &bufOutputs;
-				cNextNeuronsOffset = cOutputsOffset;
-			}
-			else
-			{
-				nextNeurons        = &pSynapses->m_pNextNeurons->m_values;
-				cNextNeuronsOffset = 0;
-			}
-			if (!pSynapses->HasBias())
-			{
-				if (!(status = Compute(prevNeurons, cPrevNeuronsOffset, pSynapses->m_pPrevNeurons->GetNeuronsCount(), 
-				                       &pSynapses->m_weights, 
-				                       nextNeurons, cNextNeuronsOffset, pSynapses->m_pNextNeurons->GetNeuronsCount())))
-				{
-					break;
-				}
-			}
-			else
-			{
-				if (!(status = ComputeWithBias(pSynapses->GetBias(), 
-				                            prevNeurons, cPrevNeuronsOffset, pSynapses->m_pPrevNeurons->GetNeuronsCount(), 
-				                            &pSynapses->m_weights, &pSynapses->m_biases, 
-				                            nextNeurons, cNextNeuronsOffset, pSynapses->m_pNextNeurons->GetNeuronsCount())))
-				{
-					break;
-				}
-			}
-
-			if (!(status = Activate(nextNeurons, cNextNeuronsOffset, pSynapses->m_pNextNeurons->GetNeuronsCount(), 
-			                        pSynapses->m_pNextNeurons->GetActivationFunction(), 
-			                        pSynapses->m_pNextNeurons->GetActivation(), 
-			                        pSynapses->m_pNextNeurons->GetActivationArgsCount(), 
-			                        pSynapses->m_pNextNeurons->GetActivationArgs())))
-			{
-				break;
-			}
-
-			pSynapses = pSynapses->m_pNextNeurons->m_pNextSynapses;
+			status = Status(Status_OperationFailed, "Batch buffers are mapped at {1}:{2}", __FILE__, __LINE__);
 		}
-		if (!status)
+		else
 		{
-			break;
+			status = EnqueueBatch(&m_batch, cCount, inputs, outputs, pEvent);
 		}
-		cInputsOffset += m_pInputNeurons->GetNeuronsCount();
-		cOutputsOffset += m_pOutputNeurons->GetNeuronsCount();
-	}
-	if (!status)
-	{
+		ReleaseSRWLockExclusive(&m_srwlSlots);
+
 		return status;
 	}
-	if (CL_SUCCESS != (nError = m_pQueue->enqueueReadBuffer(bufOutputs, CL_FALSE, 0, 
-	                                             sizeof(Float) * cCount * m_pOutputNeurons->GetNeuronsCount(), outputs)))
+	//the oldest slot: with all of them in flight this is where the network is capped (a failure of that batch was 
+	//reported to its own caller through its event)
+	pBatch = &m_slots[m_cNextSlot];
+	if (NULL != pBatch->event())
 	{
-		return Status(Status_OperationFailed, "Failed to read outputs buffer at {1}:{2}", __FILE__, __LINE__);
+		pBatch->event.wait();
+		pBatch->event = cl::Event();
 	}
-	if (CL_SUCCESS != (nError = m_pQueue->finish()))
+	if ((status = pScheduler->Acquire(&pBatch->pQueue, &cQueue)))
 	{
-		return Status(Status_OperationFailed, "Failed to read outputs buffer at {1}:{2}", __FILE__, __LINE__);
+		if ((status = EnqueueBatch(pBatch, cCount, inputs, outputs, pEvent)))
+		{
+			pBatch->event = *pEvent;
+			m_cNextSlot   = (m_cNextSlot + 1) % m_cSlots;
+			status        = pScheduler->Submit(cQueue, pEvent);
+		}
+		else
+		{
+			pScheduler->Release(cQueue);
+		}
 	}
+	ReleaseSRWLockExclusive(&m_srwlSlots);
 
-	return Status();
-}
-
-cl::CommandQueue *Network::GetQueue()
-{
-	return m_pQueue;
+	return status;
 }
 
-Status Network::Compute(cl::Buffer *prevNeurons, UInt32 cPrevNeuronsOffset, UInt32 cPrevNeuronsCount,
-                        cl::Buffer *weights, 
-                        cl::Buffer *nextNeurons, UInt32 cNextNeuronsOffset, UInt32 cNextNeuronsCount)
+Status Network::EnqueueBatch(Batch *pBatch, UInt32 cCount, Float *inputs, Float *outputs, cl::Event *pEvent)
 {
-	cl_int   nError;
-
-	cl::Kernel   kernelCompute = cl::Kernel(*m_pProvider->GetProgram(), "Compute");
+	std::vector<cl::Event>    vectorEvents;
+	cl::Event                 event;
+	cl_int                    nError;
+	Status                    status;
 
-	if (CL_SUCCESS != (nError = kernelCompute.setArg(0, *prevNeurons)))
-	{
-		return Status(Status_OperationFailed, "setArg failed with error {1} at {2}:{3}", nError, __FILE__, __LINE__);
-	}
-	if (CL_SUCCESS != (nError = kernelCompute.setArg(1, cPrevNeuronsOffset)))
-	{
-		return Status(Status_OperationFailed, "setArg failed with error {1} at {2}:{3}", nError, __FILE__, __LINE__);
-	}
-	if (CL_SUCCESS != (nError = kernelCompute.setArg(2, cPrevNeuronsCount)))
+	if (!(status = ReserveBatch(pBatch, cCount)))
 	{
-		return Status(Status_OperationFailed, "setArg failed with error {1} at {2}:{3}", nError, __FILE__, __LINE__);
+		return status;
 	}
-	if (CL_SUCCESS != (nError = kernelCompute.setArg(3, *weights)))
+	//the weights uploaded on the network's queue (a no-op wait on that same queue)
+	if (NULL != m_syncEvent())
 	{
-		return Status(Status_OperationFailed, "setArg failed with error {1} at {2}:{3}", nError, __FILE__, __LINE__);
+		vectorEvents.push_back(m_syncEvent);
 	}
-	if (CL_SUCCESS != (nError = kernelCompute.setArg(4, *nextNeurons)))
+	if (CL_SUCCESS != (nError = pBatch->pQueue->enqueueWriteBuffer(pBatch->inputs, CL_FALSE, 0, 
+	                                             sizeof(Float) * cCount * m_pInputNeurons->GetNeuronsCount(), inputs, 
+	                                             vectorEvents.empty() ? NULL : &vectorEvents, &event)))
 	{
-		return Status(Status_OperationFailed, "setArg failed with error {1} at {2}:{3}", nError, __FILE__, __LINE__);
+		return Status(Status_OperationFailed, "Failed to write inputs buffer at {1}:{2}", __FILE__, __LINE__);
 	}
-	if (CL_SUCCESS != (nError = kernelCompute.setArg(5, cNextNeuronsOffset)))
+	vectorEvents.clear();
+	vectorEvents.push_back(event);
+	if (!(status = EnqueueLayers(pBatch, cCount, &vectorEvents)))
 	{
-		return Status(Status_OperationFailed, "setArg failed with error {1} at {2}:{3}", nError, __FILE__, __LINE__);
+		return status;
 	}
-	if (CL_SUCCESS != (nError = kernelCompute.setArg(6, cNextNeuronsCount)))
+	if (CL_SUCCESS != (nError = pBatch->pQueue->enqueueReadBuffer(pBatch->outputs, CL_FALSE, 0, 
+	                                             sizeof(Float) * cCount * m_pOutputNeurons->GetNeuronsCount(), outputs, 
+	                                             &vectorEvents, &event)))
 	{
-		return Status(Status_OperationFailed, "setArg failed with error {1} at {2}:{3}", nError, __FILE__, __LINE__);
+		return Status(Status_OperationFailed, "Failed to read outputs buffer at {1}:{2}", __FILE__, __LINE__);
 	}
-	if (CL_SUCCESS != (nError = m_pQueue->enqueueNDRangeKernel(kernelCompute, cl::NullRange, 
-	                                                           cl::NDRange(cNextNeuronsCount))))
+	//the batch is submitted to the device here; the host does not wait for it
+	if (CL_SUCCESS != (nError = pBatch->pQueue->flush()))
 	{
-		return Status(Status_OperationFailed, "enqueueNDRangeKernel failed with error {1} at {2}:{3}", nError, __FILE__, 
-		              __LINE__);
+		return Status(Status_OperationFailed, "Failed to flush queue with error {1} at {2}:{3}", nError, 
+		              __FILE__, __LINE__);
 	}
+	*pEvent = event;
 
 	return Status();
 }
 
-Status Network::ComputeWithBias(Float fBias, 
-                                cl::Buffer *prevNeurons, UInt32 cPrevNeuronsOffset, UInt32 cPrevNeuronsCount,
-                                cl::Buffer *weights, cl::Buffer *biases, 
-                                cl::Buffer *nextNeurons, UInt32 cNextNeuronsOffset, UInt32 cNextNeuronsCount)
+void Network::GetInFlightEvents(std::vector<cl::Event> *pEvents)
 {
-	cl_int   nError;
-
-	cl::Kernel   kernelCompute = cl::Kernel(*m_pProvider->GetProgram(), "ComputeWithBias");
-
-	if (CL_SUCCESS != (nError = kernelCompute.setArg(0, fBias)))
-	{
-		return Status(Status_OperationFailed, "setArg failed with error {1} at {2}:{3}", nError, __FILE__, __LINE__);
-	}
-	if (CL_SUCCESS != (nError = kernelCompute.setArg(1, *prevNeurons)))
-	{
-		return Status(Status_OperationFailed, "setArg failed with error {1} at {2}:{3}", nError, __FILE__, __LINE__);
-	}
-	if (CL_SUCCESS != (nError = kernelCompute.setArg(2, cPrevNeuronsOffset)))
+	AcquireSRWLockExclusive(&m_srwlSlots);
+	for (UInt32 i = 0; i < m_cSlots; i++)
 	{
-		return Status(Status_OperationFailed, "setArg failed with error {1} at {2}:{3}", nError, __FILE__, __LINE__);
+		if (NULL != m_slots[i].event())
+		{
+			pEvents->push_back(m_slots[i].event);
+		}
 	}
-	if (CL_SUCCESS != (nError = kernelCompute.setArg(3, cPrevNeuronsCount)))
+	ReleaseSRWLockExclusive(&m_srwlSlots);
+}
+
+Status Network::EvaluateStream(UInt32 cCount, Float *inputs, Float *outputs, 
+                              UInt32 cChunkSize/* = DEFAULT_STREAM_CHUNK_SIZE*/)
+{
+	if (0 == m_pNetwork)
 	{
-		return Status(Status_OperationFailed, "setArg failed with error {1} at {2}:{3}", nError, __FILE__, __LINE__);
+		return Status(Status_NotInitialized, "Not initialized at {1}:{2}", __FILE__, __LINE__);
 	}
-	if (CL_SUCCESS != (nError = kernelCompute.setArg(4, *weights)))
+	if (0 == cCount || NULL == inputs || NULL == outputs)
 	{
-		return Status(Status_OperationFailed, "setArg failed with error {1} at {2}:{3}", nError, __FILE__, __LINE__);
+		return Status(Status_InvalidArg, "Invalid arg at {1}:{2}", __FILE__, __LINE__);
 	}
-	if (CL_SUCCESS != (nError = kernelCompute.setArg(5, *biases)))
+
+	UInt32                   cInputs  = m_pInputNeurons->GetNeuronsCount();
+	UInt32                   cOutputs = m_pOutputNeurons->GetNeuronsCount();
+	Batch                    *pStream;
+	UInt32                   cOffset;
+	UInt32                   cChunk;
+	UInt32                   cSamples;
+	std::vector<cl::Event>   vectorEvents;
+	cl::Event                event;
+	cl_int                   nError;
+	Status                   status;
+
+	if (0 == cChunkSize || cChunkSize > m_cMaxStreamChunkSize)
 	{
-		return Status(Status_OperationFailed, "setArg failed with error {1} at {2}:{3}", nError, __FILE__, __LINE__);
+		cChunkSize = m_cMaxStreamChunkSize;
 	}
-	if (CL_SUCCESS != (nError = kernelCompute.setArg(6, *nextNeurons)))
+	if (cChunkSize > cCount)
 	{
-		return Status(Status_OperationFailed, "setArg failed with error {1} at {2}:{3}", nError, __FILE__, __LINE__);
+		cChunkSize = cCount;
 	}
-	if (CL_SUCCESS != (nError = kernelCompute.setArg(7, cNextNeuronsOffset)))
+	//the kernels args are set at enqueue time (shared with EvaluateAsync), the queues are only waited for once the 
+	//lock is released
+	AcquireSRWLockExclusive(&m_srwlSlots);
+	for (UInt32 i = 0; i < STREAM_SLOTS && status; i++)
 	{
-		return Status(Status_OperationFailed, "setArg failed with error {1} at {2}:{3}", nError, __FILE__, __LINE__);
+		if (NULL == m_streams[i].pQueue)
+		{
+			if (NULL == (m_streams[i].pQueue = new (std::nothrow) cl::CommandQueue(*m_pProvider->GetContext(), 
+			                                                                        *m_pProvider->GetDevice(), 0, 
+			                                                                        &nError)))
+			{
+				status = Status(Status_MemAllocFailed, "Failed to allocate queue at {1}:{2}", __FILE__, __LINE__);
+
+				break;
+			}
+			if (CL_SUCCESS != nError)
+			{
+				delete m_streams[i].pQueue;
+				m_streams[i].pQueue = NULL;
+				status              = Status(Status_OperationFailed, "Failed to create queue at {1}:{2}", 
+				                             __FILE__, __LINE__);
+
+				break;
+			}
+		}
+		status = ReserveBatch(&m_streams[i], cChunkSize);
 	}
-	if (CL_SUCCESS != (nError = kernelCompute.setArg(8, cNextNeuronsCount)))
+	if (!status)
 	{
-		return Status(Status_OperationFailed, "setArg failed with error {1} at {2}:{3}", nError, __FILE__, __LINE__);
+		ReleaseSRWLockExclusive(&m_srwlSlots);
+
+		return status;
 	}
-	if (CL_SUCCESS != (nError = m_pQueue->enqueueNDRangeKernel(kernelCompute, cl::NullRange, 
-	                                                           cl::NDRange(cNextNeuronsCount))))
+
+	//chunk n runs on slot n % STREAM_SLOTS; the in-order slot queue holds it back until chunk n - STREAM_SLOTS 
+	//was read back, while the other slots keep the device busy
+	cChunk = 0;
+	for (cOffset = 0; cOffset < cCount; cOffset += cSamples)
 	{
-		return Status(Status_OperationFailed, "enqueueNDRangeKernel failed with error {1} at {2}:{3}", nError, __FILE__, 
-		              __LINE__);
+		pStream  = &m_streams[cChunk % STREAM_SLOTS];
+		cSamples = (cCount - cOffset < cChunkSize) ? cCount - cOffset : cChunkSize;
+		vectorEvents.clear();
+		//the first chunk of each slot waits for the last upload of the tensors on the network's queue (the next 
+		//chunks of the slot are behind it on the in-order queue)
+		if (STREAM_SLOTS > cChunk && NULL != m_syncEvent())
+		{
+			vectorEvents.push_back(m_syncEvent);
+		}
+		cChunk++;
+		if (CL_SUCCESS != (nError = pStream->pQueue->enqueueWriteBuffer(pStream->inputs, CL_FALSE, 0, 
+		                                                    sizeof(Float) * cSamples * cInputs, 
+		                                                    inputs + (Size)cOffset * cInputs, 
+		                                                    vectorEvents.empty() ? NULL : &vectorEvents, &event)))
+		{
+			status = Status(Status_OperationFailed, "Failed to write inputs buffer at {1}:{2}", __FILE__, __LINE__);
+
+			break;
+		}
+		vectorEvents.push_back(event);
+		if (!(status = EnqueueLayers(pStream, cSamples, &vectorEvents)))
+		{
+			break;
+		}
+		if (CL_SUCCESS != (nError = pStream->pQueue->enqueueReadBuffer(pStream->outputs, CL_FALSE, 0, 
+		                                                   sizeof(Float) * cSamples * cOutputs, 
+		                                                   outputs + (Size)cOffset * cOutputs, &vectorEvents)))
+		{
+			status = Status(Status_OperationFailed, "Failed to read outputs buffer at {1}:{2}", __FILE__, __LINE__);
+
+			break;
+		}
+		if (CL_SUCCESS != (nError = pStream->pQueue->flush()))
+		{
+			status = Status(Status_OperationFailed, "Failed to flush queue with error {1} at {2}:{3}", nError, 
+			                __FILE__, __LINE__);
+
+			break;
+		}
 	}
-	if (CL_SUCCESS != (nError = m_pQueue->finish()))
+	ReleaseSRWLockExclusive(&m_srwlSlots);
+	//the queues still reference the caller's memory, wait for them even on failure
+	for (UInt32 i = 0; i < STREAM_SLOTS; i++)
 	{
-		return Status(Status_OperationFailed, "Finish failed with error {1} at {2}:{3}", nError, __FILE__, __LINE__);
+		if (CL_SUCCESS != (nError = m_streams[i].pQueue->finish()) && status)
+		{
+			status = Status(Status_OperationFailed, "Finish failed with error {1} at {2}:{3}", nError, 
+			                __FILE__, __LINE__);
+		}
 	}
 
-	return Status();
+	return status;
 }
 
-Status Network::Activate(cl::Buffer *nextNeurons, UInt32 cNextNeuronsOffset, UInt32 cNextNeuronsCount, 
-                         const Char *szActivation, NET::ActivationType nActivation, UInt32 cActivationArgs, 
-                         const Float *activationArgs)
+UInt32 Network::GetMaxStreamChunkSize() const
 {
-	if (NET::Activation::Identity == nActivation)
-	{
-		return Status();
-	}
-
-	cl_int       nError;
-	cl::Kernel   kernelActivate = cl::Kernel(*m_pProvider->GetProgram(), szActivation);
+	return m_cMaxStreamChunkSize;
+}
 
-	if (CL_SUCCESS != (nError = kernelActivate.setArg(0, *nextNeurons)))
+Status Network::MapInputs(UInt32 cCount, Float **pInputs)
+{
+	if (0 == m_pNetwork)
 	{
-		return Status(Status_OperationFailed, "setArg failed with error {1} at {2}:{3}", nError, __FILE__, __LINE__);
+		return Status(Status_NotInitialized, "Not initialized at {1}:{2}", __FILE__, __LINE__);
 	}
-	if (CL_SUCCESS != (nError = kernelActivate.setArg(1, cNextNeuronsOffset)))
+	if (0 == cCount || NULL == pInputs)
 	{
-		return Status(Status_OperationFailed, "setArg failed with error {1} at {2}:{3}", nError, __FILE__, __LINE__);
+		return Status(Status_InvalidArg, "Invalid arg at {1}:{2}", __FILE__, __LINE__);
 	}
-	for (UInt32 i = 0; i < cActivationArgs; i++)
+
+	cl_int   nError;
+	Status   status;
+
+	//m_batch is also checked and enqueued by EvaluateAsync
+	AcquireSRWLockExclusive(&m_srwlSlots);
+	for (;;)
 	{
-		if (CL_SUCCESS != (nError = kernelActivate.setArg(i + 2, activationArgs[i])))
+		if (NULL != m_batch.mappedInputs || NULL != m_batch.mappedOutputs)
 		{
-			return Status(Status_OperationFailed, "setArg failed with error {1} ({2}) at {3}:{4}", nError, i, __FILE__, 
-			              __LINE__);
+			status = Status(Status_OperationFailed, "Batch buffers are mapped at {1}:{2}", __FILE__, __LINE__);
+
+			break;
+		}
+		if (!(status = ReserveBatch(&m_batch, cCount)))
+		{
+			break;
+		}
+		m_batch.mappedInputs = (Float *)m_pQueue->enqueueMapBuffer(m_batch.inputs, CL_TRUE, 
+		                                             CL_MAP_WRITE_INVALIDATE_REGION, 0, 
+		                                             sizeof(Float) * cCount * m_pInputNeurons->GetNeuronsCount(), 
+		                                             NULL, NULL, &nError);
+		if (CL_SUCCESS != nError)
+		{
+			m_batch.mappedInputs = NULL;
+			status               = Status(Status_OperationFailed, "Failed to map inputs buffer with error {1} at {2}:{3}", 
+			                              nError, __FILE__, __LINE__);
+
+			break;
+		}
+		m_batch.cMappedCount = cCount;
+		*pInputs             = m_batch.mappedInputs;
+
+		break;
+	}
+	ReleaseSRWLockExclusive(&m_srwlSlots);
+
+	return status;
+}
+
+Status Network::EvaluateMapped(Float **pOutputs)
+{
+	if (0 == m_pNetwork)
+	{
+		return Status(Status_NotInitialized, "Not initialized at {1}:{2}", __FILE__, __LINE__);
+	}
+	if (NULL == pOutputs)
+	{
+		return Status(Status_InvalidArg, "Invalid arg at {1}:{2}", __FILE__, __LINE__);
+	}
+
+	std::vector<cl::Event>    vectorEvents;
+	cl::Event                 event;
+	cl_int                    nError;
+	Status                    status;
+
+	AcquireSRWLockExclusive(&m_srwlSlots);
+	for (;;)
+	{
+		if (NULL == m_batch.mappedInputs)
+		{
+			status = Status(Status_OperationFailed, "Inputs are not mapped at {1}:{2}", __FILE__, __LINE__);
+
+			break;
+		}
+		if (CL_SUCCESS != (nError = m_pQueue->enqueueUnmapMemObject(m_batch.inputs, m_batch.mappedInputs, NULL, 
+		                                                            &event)))
+		{
+			status = Status(Status_OperationFailed, "Failed to unmap inputs buffer with error {1} at {2}:{3}", nError, 
+			                __FILE__, __LINE__);
+
+			break;
+		}
+		m_batch.mappedInputs = NULL;
+		vectorEvents.push_back(event);
+		if (!(status = EnqueueLayers(&m_batch, m_batch.cMappedCount, &vectorEvents)))
+		{
+			break;
+		}
+		m_batch.mappedOutputs = (Float *)m_pQueue->enqueueMapBuffer(m_batch.outputs, CL_TRUE, CL_MAP_READ, 0, 
+		                                    sizeof(Float) * m_batch.cMappedCount * m_pOutputNeurons->GetNeuronsCount(), 
+		                                    &vectorEvents, NULL, &nError);
+		if (CL_SUCCESS != nError)
+		{
+			m_batch.mappedOutputs = NULL;
+			status                = Status(Status_OperationFailed, "Failed to map outputs buffer with error {1} at {2}:{3}", 
+			                               nError, __FILE__, __LINE__);
+
+			break;
+		}
+		*pOutputs = m_batch.mappedOutputs;
+
+		break;
+	}
+	ReleaseSRWLockExclusive(&m_srwlSlots);
+
+	return status;
+}
+
+Status Network::Unmap()
+{
+	if (0 == m_pNetwork)
+	{
+		return Status(Status_NotInitialized, "Not initialized at {1}:{2}", __FILE__, __LINE__);
+	}
+
+	cl_int   nError;
+	Status   status;
+
+	AcquireSRWLockExclusive(&m_srwlSlots);
+	for (;;)
+	{
+		if (NULL != m_batch.mappedInputs)
+		{
+			if (CL_SUCCESS != (nError = m_pQueue->enqueueUnmapMemObject(m_batch.inputs, m_batch.mappedInputs)))
+			{
+				status = Status(Status_OperationFailed, "Failed to unmap inputs buffer with error {1} at {2}:{3}", nError, 
+				                __FILE__, __LINE__);
+
+				break;
+			}
+			m_batch.mappedInputs = NULL;
+		}
+		if (NULL != m_batch.mappedOutputs)
+		{
+			if (CL_SUCCESS != (nError = m_pQueue->enqueueUnmapMemObject(m_batch.outputs, m_batch.mappedOutputs)))
+			{
+				status = Status(Status_OperationFailed, "Failed to unmap outputs buffer with error {1} at {2}:{3}", 
+				                nError, __FILE__, __LINE__);
+
+				break;
+			}
+			m_batch.mappedOutputs = NULL;
+		}
+		m_batch.cMappedCount = 0;
+
+		break;
+	}
+	ReleaseSRWLockExclusive(&m_srwlSlots);
+
+	return status;
+}
+
+Status Network::CreatePool(NET::Network *pNetwork)
+{
+	NET::Neurons    *pNETNeurons;
+	NET::Synapses   *pNETSynapses;
+	cl::Device      *pDevice = m_pProvider->GetDevice();
+	cl_int          nError;
+
+	//sub-buffer origins must be aligned to the device base address alignment (given in bits)
+	m_pool.cbAlignment = pDevice->getInfo<CL_DEVICE_MEM_BASE_ADDR_ALIGN>() / 8;
+	if (MIN_TENSOR_ALIGNMENT > m_pool.cbAlignment)
+	{
+		m_pool.cbAlignment = MIN_TENSOR_ALIGNMENT;
+	}
+	m_pool.cbSynapsesSize = 0;
+	m_pool.cbSize         = 0;
+	pNETNeurons           = pNetwork->GetInputNeurons();
+	while (NULL != pNETNeurons)
+	{
+		m_pool.cbSize += AlignTensorSize(sizeof(Float) * pNETNeurons->GetNeuronsCount());
+		if (NULL == (pNETSynapses = pNETNeurons->GetNextSynapses()))
+		{
+			break;
+		}
+		m_pool.cbSynapsesSize += AlignTensorSize(sizeof(Float) * pNETSynapses->GetWeightsCount());
+		if (pNETSynapses->HasBias())
+		{
+			m_pool.cbSynapsesSize += AlignTensorSize(sizeof(Float) * pNETSynapses->GetBiasesCount());
+		}
+		pNETNeurons = pNETSynapses->GetNextNeurons();
+	}
+	m_pool.cbSize         += m_pool.cbSynapsesSize;
+	m_pool.cbSynapsesUsed = 0;
+	m_pool.cbNeuronsUsed  = m_pool.cbSynapsesSize;
+	if ((UInt64)m_pool.cbSize > pDevice->getInfo<CL_DEVICE_MAX_MEM_ALLOC_SIZE>())
+	{
+		return Status();
+	}
+	//CPU and integrated devices: host memory the runtime can map without copies
+	m_pool.buffer = cl::Buffer(*m_pProvider->GetContext(), 
+	                           CL_MEM_READ_WRITE | (m_pProvider->IsHostUnifiedMemory() ? CL_MEM_ALLOC_HOST_PTR : 0), 
+	                           m_pool.cbSize, NULL, &nError);
+	if (CL_SUCCESS != nError)
+	{
+		m_pool.buffer = cl::Buffer();
+	}
+
+	return Status();
+}
+
+Size Network::AlignTensorSize(Size cbSize) const
+{
+	return (cbSize + m_pool.cbAlignment - 1) / m_pool.cbAlignment * m_pool.cbAlignment;
+}
+
+Status Network::AllocTensor(Bool bSynapses, Size cbSize, cl::Buffer *pBuffer, Size *pcbOffset)
+{
+	Size               *pcbUsed = (bSynapses ? &m_pool.cbSynapsesUsed : &m_pool.cbNeuronsUsed);
+	Size               cbEnd    = (bSynapses ? m_pool.cbSynapsesSize : m_pool.cbSize);
+	cl_buffer_region   region;
+	cl_int             nError;
+
+	if (0 == cbSize)
+	{
+		return Status(Status_InvalidArg, "Invalid arg at {1}:{2}", __FILE__, __LINE__);
+	}
+	if (*pcbUsed + cbSize > cbEnd)
+	{
+		return Status(Status_MemAllocFailed, "Tensor of {1} bytes does not fit the pool at {2}:{3}", cbSize, 
+		              __FILE__, __LINE__);
+	}
+	if (NULL == m_pool.buffer())
+	{
+		*pBuffer = cl::Buffer(*m_pProvider->GetContext(), 
+		                      CL_MEM_READ_WRITE | (m_pProvider->IsHostUnifiedMemory() ? CL_MEM_ALLOC_HOST_PTR : 0), 
+		                      cbSize, NULL, &nError);
+	}
+	else
+	{
+		region.origin = *pcbUsed;
+		region.size   = cbSize;
+		*pBuffer      = m_pool.buffer.createSubBuffer(CL_MEM_READ_WRITE, CL_BUFFER_CREATE_TYPE_REGION, &region, &nError);
+	}
+	if (CL_SUCCESS != nError)
+	{
+		return Status(Status_MemAllocFailed, "Failed to allocate {1} bytes with error {2} at {3}:{4}", cbSize, nError, 
+		              __FILE__, __LINE__);
+	}
+	*pcbOffset  = *pcbUsed;
+	*pcbUsed   += AlignTensorSize(cbSize);
+
+	return Status();
+}
+
+void Network::GetTensors(UInt32 nSyncType, Bool bToCE, TensorsVector *pVectorTensors)
+{
+	Synapses   *pSynapses;
+	Neurons    *pNeurons;
+
+	pNeurons = m_pInputNeurons;
+	while (NULL != pNeurons)
+	{
+		if (Sync_Neurons == (nSyncType & Sync_Neurons))
+		{
+			AddTensors(pNeurons, pVectorTensors);
+		}
+		if (NULL == (pSynapses = pNeurons->m_pNextSynapses))
+		{
+			break;
+		}
+		if (Sync_Synapse == (nSyncType & Sync_Synapse))
+		{
+			AddTensors(pSynapses, bToCE, pVectorTensors);
+		}
+		pNeurons = pSynapses->m_pNextNeurons;
+	}
+}
+
+void Network::ResetSyncedVersions()
+{
+	Synapses   *pSynapses;
+	Neurons    *pNeurons;
+
+	pNeurons = m_pInputNeurons;
+	while (NULL != pNeurons)
+	{
+		if (NULL == (pSynapses = pNeurons->m_pNextSynapses))
+		{
+			break;
+		}
+		pSynapses->m_nSyncedVersion = NET::Synapses::VERSION_NONE;
+		pNeurons                    = pSynapses->m_pNextNeurons;
+	}
+}
+
+void Network::AddTensor(cl::Buffer *pBuffer, Size cbOffset, Float *data, UInt32 cFirst, UInt32 cCount, Bool bRange, 
+                        TensorsVector *pVectorTensors)
+{
+	Tensor   tensor;
+
+	tensor.pBuffer        = pBuffer;
+	tensor.cbOffset       = cbOffset + sizeof(Float) * cFirst;
+	tensor.cbSize         = sizeof(Float) * cCount;
+	tensor.pData          = data + cFirst;
+	tensor.bRange         = bRange;
+	tensor.cbBufferOffset = sizeof(Float) * cFirst;
+	pVectorTensors->push_back(tensor);
+}
+
+void Network::AddTensors(Synapses *pSynapses, Bool bToCE, TensorsVector *pVectorTensors)
+{
+	NET::Synapses::DirtyRangesVector   vectorRanges;
+	NET::Synapses                      *pNETSynapses = pSynapses->m_pSynapses;
+
+	//mapped from the model file; the engine does not change them
+	if (!bToCE && pNETSynapses->IsReadOnly())
+	{
+		return;
+	}
+	if (bToCE && pNETSynapses->GetDirtyRanges(pSynapses->m_nSyncedVersion, &vectorRanges))
+	{
+		for (NET::Synapses::DirtyRangesVector::iterator iter = vectorRanges.begin(); iter != vectorRanges.end(); ++iter)
+		{
+			if (iter->bBiases)
+			{
+				AddTensor(&pSynapses->m_biases, pSynapses->m_cbBiasesOffset, pNETSynapses->GetBiases(), 
+				          iter->cFirst, iter->cCount, True, pVectorTensors);
+			}
+			else
+			{
+				AddTensor(&pSynapses->m_weights, pSynapses->m_cbWeightsOffset, pNETSynapses->GetWeights(), 
+				          iter->cFirst, iter->cCount, True, pVectorTensors);
+			}
+		}
+	}
+	else
+	{
+		AddTensor(&pSynapses->m_weights, pSynapses->m_cbWeightsOffset, pNETSynapses->GetWeights(), 
+		          0, pNETSynapses->GetWeightsCount(), False, pVectorTensors);
+		if (pSynapses->HasBias())
+		{
+			AddTensor(&pSynapses->m_biases, pSynapses->m_cbBiasesOffset, pNETSynapses->GetBiases(), 
+			          0, pNETSynapses->GetBiasesCount(), False, pVectorTensors);
+		}
+	}
+	if (bToCE)
+	{
+		pSynapses->m_nSyncedVersion = pNETSynapses->GetVersion();
+	}
+}
+
+void Network::AddTensors(Neurons *pNeurons, TensorsVector *pVectorTensors)
+{
+	AddTensor(&pNeurons->m_values, pNeurons->m_cbValuesOffset, pNeurons->m_pNeurons->GetValues(), 
+	          0, pNeurons->GetNeuronsCount(), False, pVectorTensors);
+}
+
+Status Network::SyncSynapses(Synapses *pSynapses, Bool bToCE, Bool bWait)
+{
+	TensorsVector   vectorTensors;
+	Status          status;
+
+	AddTensors(pSynapses, bToCE, &vectorTensors);
+	if (!(status = SyncTensors(vectorTensors, bToCE, bWait)) && bToCE)
+	{
+		pSynapses->m_nSyncedVersion = NET::Synapses::VERSION_NONE;
+	}
+
+	return status;
+}
+
+Status Network::SyncNeurons(Neurons *pNeurons, Bool bToCE, Bool bWait)
+{
+	TensorsVector   vectorTensors;
+
+	AddTensors(pNeurons, &vectorTensors);
+
+	return SyncTensors(vectorTensors, bToCE, bWait);
+}
+
+Status Network::SyncTensors(const TensorsVector &vectorTensors, Bool bToCE, Bool bWait)
+{
+	if (vectorTensors.empty())
+	{
+		return Status();
+	}
+
+	std::vector<cl::Event>   vectorInFlight;
+	std::vector<cl::Event>   *pWaitEvents;
+	TensorsVector            vectorSorted;
+	TensorsVector::iterator  iterRunEnd;
+	Byte                     *pMapped;
+	Size                     cbStart;
+	Size                     cbEnd;
+	Bool                     bRanges;
+	cl::Event                event;
+	cl_int                   nError;
+
+	//the batches on the scheduler queues may still read the tensors being overwritten
+	if (bToCE)
+	{
+		GetInFlightEvents(&vectorInFlight);
+	}
+	pWaitEvents = (vectorInFlight.empty() ? NULL : &vectorInFlight);
+	bRanges     = False;
+	for (auto iter = vectorTensors.begin(); iter != vectorTensors.end(); ++iter)
+	{
+		bRanges |= iter->bRange;
+	}
+	//a write invalidating the covering range would lose what lies between the ranges => they are written one by one
+	if (NULL == m_pool.buffer() || (bToCE && bRanges))
+	{
+		for (auto iter = vectorTensors.begin(); iter != vectorTensors.end(); ++iter)
+		{
+			cl::Buffer   *pBuffer  = (NULL == m_pool.buffer() ? iter->pBuffer : &m_pool.buffer);
+			Size         cbOffset  = (NULL == m_pool.buffer() ? iter->cbBufferOffset : iter->cbOffset);
+
+			if (bToCE)
+			{
+				nError = m_pQueue->enqueueWriteBuffer(*pBuffer, CL_FALSE, cbOffset, iter->cbSize, iter->pData, 
+				                                      pWaitEvents, &event);
+			}
+			else
+			{
+				nError = m_pQueue->enqueueReadBuffer(*pBuffer, CL_FALSE, cbOffset, iter->cbSize, iter->pData, NULL, 
+				                                     &event);
+			}
+			if (CL_SUCCESS != nError)
+			{
+				return Status(Status_OperationFailed, "Failed to sync tensor with error {1} at {2}:{3}", nError, 
+				              __FILE__, __LINE__);
+			}
+		}
+	}
+	else
+	{
+		//one map per run of adjacent tensors (only the alignment padding between them): the run does not need to be 
+		//read before writing, while a range covering tensors that are not synced (clean synapses) would lose them
+		vectorSorted = vectorTensors;
+		std::sort(vectorSorted.begin(), vectorSorted.end(), &CompareTensors);
+		for (auto iter = vectorSorted.begin(); iter != vectorSorted.end(); iter = iterRunEnd)
+		{
+			cbStart = iter->cbOffset;
+			cbEnd   = iter->cbOffset + iter->cbSize;
+			for (iterRunEnd = iter + 1; iterRunEnd != vectorSorted.end(); ++iterRunEnd)
+			{
+				if (iterRunEnd->cbOffset > AlignTensorSize(cbEnd))
+				{
+					break;
+				}
+				if (cbEnd < iterRunEnd->cbOffset + iterRunEnd->cbSize)
+				{
+					cbEnd = iterRunEnd->cbOffset + iterRunEnd->cbSize;
+				}
+			}
+			pMapped = (Byte *)m_pQueue->enqueueMapBuffer(m_pool.buffer, CL_TRUE, 
+			                                             bToCE ? CL_MAP_WRITE_INVALIDATE_REGION : CL_MAP_READ, 
+			                                             cbStart, cbEnd - cbStart, pWaitEvents, NULL, &nError);
+			if (CL_SUCCESS != nError)
+			{
+				return Status(Status_OperationFailed, "Failed to map pool with error {1} at {2}:{3}", nError, 
+				              __FILE__, __LINE__);
+			}
+			for (auto iterRun = iter; iterRun != iterRunEnd; ++iterRun)
+			{
+				if (bToCE)
+				{
+					memcpy(pMapped + (iterRun->cbOffset - cbStart), iterRun->pData, iterRun->cbSize);
+				}
+				else
+				{
+					memcpy(iterRun->pData, pMapped + (iterRun->cbOffset - cbStart), iterRun->cbSize);
+				}
+			}
+			if (CL_SUCCESS != (nError = m_pQueue->enqueueUnmapMemObject(m_pool.buffer, pMapped, NULL, &event)))
+			{
+				return Status(Status_OperationFailed, "Failed to unmap pool with error {1} at {2}:{3}", nError, 
+				              __FILE__, __LINE__);
+			}
+		}
+	}
+	//read by the enqueues of the batches and streams, under the same lock
+	if (bToCE)
+	{
+		AcquireSRWLockExclusive(&m_srwlSlots);
+		m_syncEvent = event;
+		ReleaseSRWLockExclusive(&m_srwlSlots);
+	}
+	if (bWait)
+	{
+		if (CL_SUCCESS != (nError = event.wait()))
+		{
+			return Status(Status_OperationFailed, "Failed to sync tensors with error {1} at {2}:{3}", nError, 
+			              __FILE__, __LINE__);
+		}
+	}
+
+	return Status();
+}
+
+cl::CommandQueue *Network::GetQueue()
+{
+	return m_pQueue;
+}
+
+const Char *Network::GetBuildLog() const
+{
+	return m_sBuildLog.c_str();
+}
+
+Status Network::GenerateKernels()
+{
+	cl::Device   *pDevice    = m_pProvider->GetDevice();
+	UInt64       cbLocalMem  = pDevice->getInfo<CL_DEVICE_LOCAL_MEM_SIZE>();
+	Size         cbMaxParams = pDevice->getInfo<CL_DEVICE_MAX_PARAMETER_SIZE>();
+	Size         cMaxGroup   = pDevice->getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>();
+	UInt32       cMaxNeurons = KernelGenerator::GetMaxNeuronsCount(m_pNetwork);
+	UInt32       cGroupSize  = 0;
+	Synapses     *pSynapses;
+	String       sSource;
+	UInt32       cLayer;
+	Status       status;
+
+	//the whole network kernel needs two local buffers of the widest layer and all the weights as args
+	if (cbLocalMem >= 2 * sizeof(Float) * cMaxNeurons && 
+	    cbMaxParams >= (2 + 2 * (Size)m_pNetwork->GetLayersCount()) * sizeof(cl_mem))
+	{
+		cGroupSize = (cMaxGroup < cMaxNeurons) ? (UInt32)cMaxGroup : cMaxNeurons;
+	}
+	m_sBuildLog.clear();
+	if (!(status = KernelGenerator::Generate(m_pNetwork, cGroupSize, &sSource)))
+	{
+		return status;
+	}
+	//same shapes => same source, so networks of the same topology share the cached binary
+	if (!(status = KernelSources::BuildSource(*m_pProvider->GetDevice(), *m_pProvider->GetContext(), sSource.c_str(), 
+	                                          sSource.size(), &m_pProgram, &m_sBuildLog, NULL, 
+	                                          m_pProvider->GetCacheDir())))
+	{
+		return status;
+	}
+	cLayer    = 0;
+	pSynapses = m_pInputNeurons->m_pNextSynapses;
+	while (NULL != pSynapses)
+	{
+		if (!(status = pSynapses->CreateLayerKernels(m_pProgram, cLayer)))
+		{
+			break;
+		}
+		cLayer++;
+		pSynapses = pSynapses->m_pNextNeurons->m_pNextSynapses;
+	}
+	//without it the per layer kernels are used
+	if (status && 0 < cGroupSize)
+	{
+		CreateNetworkKernel(cGroupSize);
+	}
+	if (!status)
+	{
+		pSynapses = m_pInputNeurons->m_pNextSynapses;
+		while (NULL != pSynapses)
+		{
+			pSynapses->m_kernelLayer        = cl::Kernel();
+			pSynapses->m_kernelLayerSoftMax = cl::Kernel();
+			pSynapses                       = pSynapses->m_pNextNeurons->m_pNextSynapses;
+		}
+		delete m_pProgram;
+		m_pProgram = NULL;
+	}
+
+	return status;
+}
+
+Status Network::CreateNetworkKernel(UInt32 cGroupSize)
+{
+	Synapses   *pSynapses;
+	UInt32     cArg;
+	cl_int     nError;
+	Status     status;
+
+	m_kernelNetwork = cl::Kernel(*m_pProgram, KernelGenerator::GetNetworkKernelName(), &nError);
+	if (CL_SUCCESS != nError)
+	{
+		status = Status(Status_OperationFailed, "Failed to create kernel {1} with error {2} at {3}:{4}", 
+		                KernelGenerator::GetNetworkKernelName(), nError, __FILE__, __LINE__);
+	}
+	else
+	if (cGroupSize > m_kernelNetwork.getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(*m_pProvider->GetDevice()))
+	{
+		status = Status(Status_OperationFailed, "Work-group size {1} not supported at {2}:{3}", cGroupSize, 
+		                __FILE__, __LINE__);
+	}
+	cArg      = 2;
+	pSynapses = m_pInputNeurons->m_pNextSynapses;
+	while (status && NULL != pSynapses)
+	{
+		if (CL_SUCCESS != (nError = m_kernelNetwork.setArg(cArg++, pSynapses->m_weights)) ||
+		    (pSynapses->HasBias() && CL_SUCCESS != (nError = m_kernelNetwork.setArg(cArg++, pSynapses->m_biases))))
+		{
+			status = Status(Status_OperationFailed, "setArg failed with error {1} at {2}:{3}", nError, 
+			                __FILE__, __LINE__);
+		}
+		pSynapses = pSynapses->m_pNextNeurons->m_pNextSynapses;
+	}
+	if (status)
+	{
+		m_cNetworkGroupSize = cGroupSize;
+	}
+	else
+	{
+		m_kernelNetwork     = cl::Kernel();
+		m_cNetworkGroupSize = 0;
+	}
+
+	return status;
+}
+
+UInt32 Network::ComputeMaxStreamChunkSize() const
+{
+	cl::Device   *pDevice      = m_pProvider->GetDevice();
+	UInt64       cbGlobalMem   = pDevice->getInfo<CL_DEVICE_GLOBAL_MEM_SIZE>();
+	UInt64       cbMaxAlloc    = pDevice->getInfo<CL_DEVICE_MAX_MEM_ALLOC_SIZE>();
+	UInt64       cbWeights     = 0;
+	UInt64       cbSample      = sizeof(Float) * m_pInputNeurons->GetNeuronsCount();
+	UInt64       cMaxNeurons   = m_pInputNeurons->GetNeuronsCount();
+	UInt64       cChunkSize;
+	Synapses     *pSynapses;
+
+	pSynapses = m_pInputNeurons->m_pNextSynapses;
+	while (NULL != pSynapses)
+	{
+		cbWeights += sizeof(Float) * pSynapses->GetWeightsCount();
+		if (pSynapses->HasBias())
+		{
+			cbWeights += sizeof(Float) * pSynapses->GetBiasesCount();
+		}
+		cbSample += sizeof(Float) * pSynapses->GetNextNeuronsCount();
+		if (cMaxNeurons < pSynapses->GetNextNeuronsCount())
+		{
+			cMaxNeurons = pSynapses->GetNextNeuronsCount();
+		}
+		pSynapses = pSynapses->m_pNextNeurons->m_pNextSynapses;
+	}
+	//only half of the device memory is planned for, the rest is left to the runtime and to other networks
+	if (cbGlobalMem / 2 <= cbWeights)
+	{
+		return 1;
+	}
+	cChunkSize = (cbGlobalMem / 2 - cbWeights) / (STREAM_SLOTS * cbSample);
+	if (cChunkSize > cbMaxAlloc / (sizeof(Float) * cMaxNeurons))
+	{
+		cChunkSize = cbMaxAlloc / (sizeof(Float) * cMaxNeurons);
+	}
+	if (cChunkSize > 0xFFFFFFFF)
+	{
+		cChunkSize = 0xFFFFFFFF;
+	}
+	if (0 == cChunkSize)
+	{
+		cChunkSize = 1;
+	}
+
+	return (UInt32)cChunkSize;
+}
+
+Status Network::ReserveBatch(Batch *pBatch, UInt32 cCount)
+{
+	if (cCount <= pBatch->cCapacity)
+	{
+		return Status();
+	}
+
+	Synapses       *pSynapses;
+	Batch          batch;
+	cl_mem_flags   nHostFlags;
+	cl_int         nError;
+
+	//inputs and outputs live in host memory when the device shares it so mapping them does not copy
+	nHostFlags = m_pProvider->IsHostUnifiedMemory() ? CL_MEM_ALLOC_HOST_PTR : 0;
+
+	//buffers still used by enqueued commands are released by the runtime once those complete
+	batch.inputs = cl::Buffer(*m_pProvider->GetContext(), CL_MEM_READ_ONLY | nHostFlags, 
+	                          sizeof(Float) * cCount * m_pInputNeurons->GetNeuronsCount(), NULL, &nError);
+	if (CL_SUCCESS != nError)
+	{
+		return Status(Status_OperationFailed, "Failed to init inputs buffer at {1}:{2}", __FILE__, __LINE__);
+	}
+	batch.outputs = cl::Buffer(*m_pProvider->GetContext(), CL_MEM_READ_WRITE | nHostFlags, 
+	                           sizeof(Float) * cCount * m_pOutputNeurons->GetNeuronsCount(), NULL, &nError);
+	if (CL_SUCCESS != nError)
+	{
+		return Status(Status_OperationFailed, "Failed to init outputs buffer at {1}:{2}", __FILE__, __LINE__);
+	}
+	pSynapses = m_pInputNeurons->m_pNextSynapses;
+	while (NULL != pSynapses && pSynapses->m_pNextNeurons != m_pOutputNeurons)
+	{
+		batch.hidden.push_back(cl::Buffer(*m_pProvider->GetContext(), CL_MEM_READ_WRITE, 
+		                                  sizeof(Float) * cCount * pSynapses->GetNextNeuronsCount(), NULL, &nError));
+		if (CL_SUCCESS != nError)
+		{
+			return Status(Status_OperationFailed, "Failed to init neurons buffer at {1}:{2}", __FILE__, __LINE__);
+		}
+		pSynapses = pSynapses->m_pNextNeurons->m_pNextSynapses;
+	}
+	batch.pQueue        = pBatch->pQueue;
+	batch.cCapacity     = cCount;
+	batch.cMappedCount  = 0;
+	batch.mappedInputs  = NULL;
+	batch.mappedOutputs = NULL;
+	*pBatch             = batch;
+
+	return Status();
+}
+
+Status Network::EnqueueLayers(Batch *pBatch, UInt32 cCount, std::vector<cl::Event> *pEvents)
+{
+	Synapses     *pSynapses;
+	cl::Buffer   *prevNeurons;
+	cl::Buffer   *nextNeurons;
+	UInt32       cHidden;
+	Status       status;
+
+	//small batches are launch bound => the generated kernels (the whole network at once if it fits the local 
+	//memory); the tiled ones win once the batch fills a tile
+	if (0 < m_cNetworkGroupSize && cCount < m_pProvider->GetTileSize())
+	{
+		return ComputeNetwork(pBatch->pQueue, &pBatch->inputs, &pBatch->outputs, cCount, pEvents);
+	}
+
+	//one launch per layer for the whole batch
+	cHidden     = 0;
+	prevNeurons = &pBatch->inputs;
+	pSynapses   = m_pInputNeurons->m_pNextSynapses;
+	while (NULL != pSynapses)
+	{
+		if (pSynapses->m_pNextNeurons == m_pOutputNeurons)
+		{
+			nextNeurons = &pBatch->outputs;
+		}
+		else
+		{
+			nextNeurons = &pBatch->hidden[cHidden++];
+		}
+		if (NULL != m_pProgram && cCount < m_pProvider->GetTileSize())
+		{
+			if (!(status = ComputeLayer(pBatch->pQueue, pSynapses, prevNeurons, nextNeurons, cCount, pEvents)))
+			{
+				return status;
+			}
+		}
+		else
+		{
+			if (!(status = Compute(pBatch->pQueue, pSynapses, prevNeurons, nextNeurons, cCount, pEvents)))
+			{
+				return status;
+			}
+			if (!(status = Activate(pBatch->pQueue, pSynapses->m_pNextNeurons, nextNeurons, cCount, pEvents)))
+			{
+				return status;
+			}
+		}
+		prevNeurons = nextNeurons;
+		pSynapses   = pSynapses->m_pNextNeurons->m_pNextSynapses;
+	}
+
+	return Status();
+}
+
+Status Network::SetNeuronsArgs(cl::Kernel *pKernel, UInt32 cArg, cl::Buffer *neurons, UInt32 cNeuronsOffset)
+{
+	cl_int   nError;
+
+	if (CL_SUCCESS != (nError = pKernel->setArg(cArg, *neurons)))
+	{
+		return Status(Status_OperationFailed, "setArg failed with error {1} at {2}:{3}", nError, __FILE__, __LINE__);
+	}
+	if (CL_SUCCESS != (nError = pKernel->setArg(cArg + 1, cNeuronsOffset)))
+	{
+		return Status(Status_OperationFailed, "setArg failed with error {1} at {2}:{3}", nError, __FILE__, __LINE__);
+	}
+
+	return Status();
+}
+
+Status Network::Tune(const Tuner::Shape &shape, Synapses *pSynapses, Neurons *pNeurons, Tuner::Params *pParams)
+{
+	Tuner   *pTuner = m_pProvider->GetTuner();
+
+	if (NULL == pTuner)
+	{
+		return Status(Status_NotSupported, "Tuning not enabled at {1}:{2}", __FILE__, __LINE__);
+	}
+	if (pTuner->Find(shape, pParams))
+	{
+		return Status();
+	}
+
+	Tuner::CandidatesVector   vectorCandidates;
+	Tuner::Candidate          candidate;
+	Vector<UInt32>::Type      vectorSizes0;
+	Vector<UInt32>::Type      vectorSizes1;
+	cl::Buffer                prevNeurons;
+	cl::Buffer                nextNeurons;
+	cl::Kernel                *pKernel;
+	Size                      cMaxSize;
+	UInt32                    cTileSize = m_pProvider->GetTileSize();
+	cl::Event                 event;
+	cl_int                    nError;
+	Status                    status;
+
+	prevNeurons = cl::Buffer(*m_pProvider->GetContext(), CL_MEM_READ_WRITE, 
+	                         sizeof(Float) * (Size)(0 < shape.cPrevNeuronsCount ? shape.cPrevNeuronsCount : 1) * 
+	                         shape.cSamplesCount, NULL, &nError);
+	if (CL_SUCCESS != nError)
+	{
+		return Status(Status_MemAllocFailed, "Failed to create scratch buffer at {1}:{2}", __FILE__, __LINE__);
+	}
+	nextNeurons = cl::Buffer(*m_pProvider->GetContext(), CL_MEM_READ_WRITE, 
+	                         sizeof(Float) * (Size)shape.cNextNeuronsCount * shape.cSamplesCount, NULL, &nError);
+	if (CL_SUCCESS != nError)
+	{
+		return Status(Status_MemAllocFailed, "Failed to create scratch buffer at {1}:{2}", __FILE__, __LINE__);
+	}
+	//zeroes (no denormals or NaNs to skew the timings)
+	if (CL_SUCCESS != (nError = m_pQueue->enqueueFillBuffer(nextNeurons, 0.0f, 0, 
+	                                                        sizeof(Float) * (Size)shape.cNextNeuronsCount * 
+	                                                        shape.cSamplesCount, NULL, &event)) || 
+	    CL_SUCCESS != (nError = event.wait()))
+	{
+		return Status(Status_OperationFailed, "Failed to fill scratch buffer with error {1} at {2}:{3}", nError, 
+		              __FILE__, __LINE__);
+	}
+	if (0 < shape.cPrevNeuronsCount)
+	{
+		if (CL_SUCCESS != (nError = m_pQueue->enqueueFillBuffer(prevNeurons, 0.0f, 0, 
+		                                                        sizeof(Float) * (Size)shape.cPrevNeuronsCount * 
+		                                                        shape.cSamplesCount, NULL, &event)) || 
+		    CL_SUCCESS != (nError = event.wait()))
+		{
+			return Status(Status_OperationFailed, "Failed to fill scratch buffer with error {1} at {2}:{3}", nError, 
+			              __FILE__, __LINE__);
+		}
+	}
+
+	//the driver's choice is always a candidate
+	candidate.params.cLocalSize0 = 0;
+	candidate.params.cLocalSize1 = 0;
+	candidate.params.bTiled      = False;
+	candidate.local              = cl::NullRange;
+	if (Tuner::Kernel_Activate == shape.nKernel)
+	{
+		pKernel = &pNeurons->m_kernelActivate;
+		if (!(status = SetNeuronsArgs(pKernel, 0, &nextNeurons, 0)))
+		{
+			return status;
+		}
+		cMaxSize          = pKernel->getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(*m_pProvider->GetDevice());
+		candidate.pKernel = pKernel;
+		candidate.global  = cl::NDRange((Size)shape.cNextNeuronsCount * shape.cSamplesCount);
+		vectorCandidates.push_back(candidate);
+		Tuner::GetLocalSizes(shape.cNextNeuronsCount * shape.cSamplesCount, cMaxSize, &vectorSizes0);
+		for (auto iter = vectorSizes0.begin(); iter != vectorSizes0.end(); ++iter)
+		{
+			candidate.local              = cl::NDRange(*iter);
+			candidate.params.cLocalSize0 = *iter;
+			vectorCandidates.push_back(candidate);
+		}
+	}
+	else
+	{
+		if (Tuner::Kernel_Layer == shape.nKernel)
+		{
+			pKernel = &pSynapses->m_kernelLayer;
+			if (CL_SUCCESS != (nError = pKernel->setArg(0, prevNeurons)) ||
+			    CL_SUCCESS != (nError = pKernel->setArg(1, nextNeurons)))
+			{
+				return Status(Status_OperationFailed, "setArg failed with error {1} at {2}:{3}", nError, __FILE__, 
+				              __LINE__);
+			}
+		}
+		else
+		{
+			pKernel = &pSynapses->m_kernelCompute;
+			if (!(status = SetNeuronsArgs(pKernel, pSynapses->m_cPrevNeuronsArg, &prevNeurons, 0)))
+			{
+				return status;
+			}
+			if (!(status = SetNeuronsArgs(pKernel, pSynapses->m_cNextNeuronsArg, &nextNeurons, 0)))
+			{
+				return status;
+			}
+		}
+		cMaxSize          = pKernel->getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(*m_pProvider->GetDevice());
+		candidate.pKernel = pKernel;
+		candidate.global  = cl::NDRange(shape.cNextNeuronsCount, shape.cSamplesCount);
+		vectorCandidates.push_back(candidate);
+		Tuner::GetLocalSizes(shape.cNextNeuronsCount, cMaxSize, &vectorSizes0);
+		Tuner::GetLocalSizes(shape.cSamplesCount, cMaxSize, &vectorSizes1);
+		for (auto iter0 = vectorSizes0.begin(); iter0 != vectorSizes0.end(); ++iter0)
+		{
+			for (auto iter1 = vectorSizes1.begin(); iter1 != vectorSizes1.end(); ++iter1)
+			{
+				if ((Size)*iter0 * *iter1 > cMaxSize)
+				{
+					break;
+				}
+				candidate.local              = cl::NDRange(*iter0, *iter1);
+				candidate.params.cLocalSize0 = *iter0;
+				candidate.params.cLocalSize1 = *iter1;
+				vectorCandidates.push_back(candidate);
+			}
+		}
+		//the tiled kernel has a fixed work-group (the tile) and pads the range itself
+		if (Tuner::Kernel_Compute == shape.nKernel && m_pProvider->GetTiledCompute() && 
+		    shape.cSamplesCount >= cTileSize)
+		{
+			UInt32   cColumns = (shape.cNextNeuronsCount + 3) / 4;
+
+			pKernel = &pSynapses->m_kernelComputeTiled;
+			if (!(status = SetNeuronsArgs(pKernel, pSynapses->m_cPrevNeuronsArg, &prevNeurons, 0)))
+			{
+				return status;
+			}
+			if (!(status = SetNeuronsArgs(pKernel, pSynapses->m_cNextNeuronsArg, &nextNeurons, 0)))
+			{
+				return status;
+			}
+			if (CL_SUCCESS != (nError = pKernel->setArg(pSynapses->m_cSamplesCountArg, shape.cSamplesCount)))
+			{
+				return Status(Status_OperationFailed, "setArg failed with error {1} at {2}:{3}", nError, __FILE__, 
+				              __LINE__);
+			}
+			candidate.pKernel            = pKernel;
+			candidate.global             = cl::NDRange((cColumns + cTileSize / 4 - 1) / (cTileSize / 4) * 
+			                                           (cTileSize / 4), 
+			                                           (shape.cSamplesCount + cTileSize - 1) / cTileSize * cTileSize);
+			candidate.local              = cl::NDRange(cTileSize / 4, cTileSize);
+			candidate.params.cLocalSize0 = cTileSize / 4;
+			candidate.params.cLocalSize1 = cTileSize;
+			candidate.params.bTiled      = True;
+			vectorCandidates.push_back(candidate);
+		}
+	}
+
+	return pTuner->Tune(shape, vectorCandidates, pParams);
+}
+
+Status Network::Compute(cl::CommandQueue *pQueue, Synapses *pSynapses, cl::Buffer *prevNeurons, 
+                        cl::Buffer *nextNeurons, UInt32 cCount, std::vector<cl::Event> *pEvents)
+{
+	cl::Kernel      *pKernel;
+	cl::NDRange     global;
+	cl::NDRange     local;
+	UInt32          cTileSize = m_pProvider->GetTileSize();
+	Tuner::Params   params;
+	cl::Event       event;
+	cl_int          nError;
+	Status          status;
+
+	//tiles only pay off once the batch fills at least one tile of samples (unless the tuner found otherwise)
+	params.cLocalSize0 = 0;
+	params.cLocalSize1 = 0;
+	params.bTiled      = (m_pProvider->GetTiledCompute() && cCount >= cTileSize);
+	if (NULL != m_pProvider->GetTuner())
+	{
+		Tuner::Shape   shape = { Tuner::Kernel_Compute, pSynapses->GetPrevNeuronsCount(), 
+		                         pSynapses->GetNextNeuronsCount(), Tuner::GetSamplesBucket(cCount) };
+
+		//the defaults are kept if the shape cannot be tuned
+		Tune(shape, pSynapses, NULL, &params);
+		params.cLocalSize1 = Tuner::FitLocalSize(params.cLocalSize1, cCount);
+		//the record may come from a run with the tiled kernels
+		if (params.bTiled && !m_pProvider->GetTiledCompute())
+		{
+			params.cLocalSize0 = 0;
+			params.cLocalSize1 = 0;
+			params.bTiled      = False;
+		}
+	}
+	if (params.bTiled)
+	{
+		UInt32   cColumns = (pSynapses->GetNextNeuronsCount() + 3) / 4;
+
+		pKernel = &pSynapses->m_kernelComputeTiled;
+		global  = cl::NDRange((cColumns + cTileSize / 4 - 1) / (cTileSize / 4) * (cTileSize / 4), 
+		                      (cCount + cTileSize - 1) / cTileSize * cTileSize);
+		local   = cl::NDRange(cTileSize / 4, cTileSize);
+		if (CL_SUCCESS != (nError = pKernel->setArg(pSynapses->m_cSamplesCountArg, cCount)))
+		{
+			return Status(Status_OperationFailed, "setArg failed with error {1} at {2}:{3}", nError, __FILE__, __LINE__);
+		}
+	}
+	else
+	{
+		pKernel = &pSynapses->m_kernelCompute;
+		global  = cl::NDRange(pSynapses->GetNextNeuronsCount(), cCount);
+		if (0 < params.cLocalSize0)
+		{
+			local = cl::NDRange(params.cLocalSize0, params.cLocalSize1);
+		}
+		else
+		{
+			local = cl::NullRange;
+		}
+	}
+	if (!(status = SetNeuronsArgs(pKernel, pSynapses->m_cPrevNeuronsArg, prevNeurons, 0)))
+	{
+		return status;
+	}
+	if (!(status = SetNeuronsArgs(pKernel, pSynapses->m_cNextNeuronsArg, nextNeurons, 0)))
+	{
+		return status;
+	}
+	if (CL_SUCCESS != (nError = pQueue->enqueueNDRangeKernel(*pKernel, cl::NullRange, global, local, 
+	                                                         pEvents->empty() ? NULL : pEvents, &event)))
+	{
+		return Status(Status_OperationFailed, "enqueueNDRangeKernel failed with error {1} at {2}:{3}", nError, __FILE__, 
+		              __LINE__);
+	}
+	pEvents->assign(1, event);
+
+	return Status();
+}
+
+Status Network::Activate(cl::CommandQueue *pQueue, Neurons *pNeurons, cl::Buffer *neurons, UInt32 cCount, 
+                         std::vector<cl::Event> *pEvents)
+{
+	if (NET::Activation::Identity == pNeurons->GetActivation())
+	{
+		return Status();
+	}
+
+	Tuner::Params   params;
+	cl::NDRange     global;
+	cl::NDRange     local;
+	cl::Event       event;
+	cl_int          nError;
+	Status          status;
+
+	//the sum spans all the neurons of a sample => one work-item per sample, as for Layer<n>SoftMax
+	if (NET::Activation::SoftMax == pNeurons->GetActivation())
+	{
+		global = cl::NDRange(cCount);
+		local  = cl::NullRange;
+	}
+	else
+	{
+		params.cLocalSize0 = 0;
+		if (NULL != m_pProvider->GetTuner())
+		{
+			Tuner::Shape   shape = { Tuner::Kernel_Activate, 0, pNeurons->GetNeuronsCount(), 
+			                         Tuner::GetSamplesBucket(cCount) };
+
+			Tune(shape, NULL, pNeurons, &params);
+			params.cLocalSize0 = Tuner::FitLocalSize(params.cLocalSize0, pNeurons->GetNeuronsCount() * cCount);
+		}
+		global = cl::NDRange(pNeurons->GetNeuronsCount() * cCount);
+		if (0 < params.cLocalSize0)
+		{
+			local = cl::NDRange(params.cLocalSize0);
+		}
+		else
+		{
+			local = cl::NullRange;
+		}
+	}
+	if (!(status = SetNeuronsArgs(&pNeurons->m_kernelActivate, 0, neurons, 0)))
+	{
+		return status;
+	}
+	if (CL_SUCCESS != (nError = pQueue->enqueueNDRangeKernel(pNeurons->m_kernelActivate, cl::NullRange, global, 
+	                                                         local, pEvents->empty() ? NULL : pEvents, &event)))
+	{
+		return Status(Status_OperationFailed, "enqueueNDRangeKernel failed with error {1} at {2}:{3}", nError, __FILE__, 
+		              __LINE__);
+	}
+	pEvents->assign(1, event);
+
+	return Status();
+}
+
+Status Network::ComputeLayer(cl::CommandQueue *pQueue, Synapses *pSynapses, cl::Buffer *prevNeurons, 
+                             cl::Buffer *nextNeurons, UInt32 cCount, std::vector<cl::Event> *pEvents)
+{
+	Tuner::Params   params;
+	cl::NDRange     local;
+	cl::Event       event;
+	cl_int          nError;
+
+	params.cLocalSize0 = 0;
+	params.cLocalSize1 = 0;
+	if (NULL != m_pProvider->GetTuner())
+	{
+		Tuner::Shape   shape = { Tuner::Kernel_Layer, pSynapses->GetPrevNeuronsCount(), 
+		                         pSynapses->GetNextNeuronsCount(), Tuner::GetSamplesBucket(cCount) };
+
+		Tune(shape, pSynapses, NULL, &params);
+		params.cLocalSize1 = Tuner::FitLocalSize(params.cLocalSize1, cCount);
+	}
+	if (0 < params.cLocalSize0)
+	{
+		local = cl::NDRange(params.cLocalSize0, params.cLocalSize1);
+	}
+	else
+	{
+		local = cl::NullRange;
+	}
+	if (CL_SUCCESS != (nError = pSynapses->m_kernelLayer.setArg(0, *prevNeurons)) ||
+	    CL_SUCCESS != (nError = pSynapses->m_kernelLayer.setArg(1, *nextNeurons)))
+	{
+		return Status(Status_OperationFailed, "setArg failed with error {1} at {2}:{3}", nError, __FILE__, __LINE__);
+	}
+	if (CL_SUCCESS != (nError = pQueue->enqueueNDRangeKernel(pSynapses->m_kernelLayer, cl::NullRange, 
+	                                                         cl::NDRange(pSynapses->GetNextNeuronsCount(), cCount), 
+	                                                         local, pEvents->empty() ? NULL : pEvents, &event)))
+	{
+		return Status(Status_OperationFailed, "enqueueNDRangeKernel failed with error {1} at {2}:{3}", nError, __FILE__, 
+		              __LINE__);
+	}
+	pEvents->assign(1, event);
+	if (NET::Activation::SoftMax == pSynapses->m_pNextNeurons->GetActivation())
+	{
+		if (CL_SUCCESS != (nError = pSynapses->m_kernelLayerSoftMax.setArg(0, *nextNeurons)))
+		{
+			return Status(Status_OperationFailed, "setArg failed with error {1} at {2}:{3}", nError, __FILE__, __LINE__);
+		}
+		if (CL_SUCCESS != (nError = pQueue->enqueueNDRangeKernel(pSynapses->m_kernelLayerSoftMax, cl::NullRange, 
+		                                                         cl::NDRange(cCount), cl::NullRange, pEvents, &event)))
+		{
+			return Status(Status_OperationFailed, "enqueueNDRangeKernel failed with error {1} at {2}:{3}", nError, 
+			              __FILE__, __LINE__);
 		}
+		pEvents->assign(1, event);
+	}
+
+	return Status();
+}
+
+Status Network::ComputeNetwork(cl::CommandQueue *pQueue, cl::Buffer *inputs, cl::Buffer *outputs, UInt32 cCount, 
+                               std::vector<cl::Event> *pEvents)
+{
+	cl::Event   event;
+	cl_int      nError;
+
+	if (CL_SUCCESS != (nError = m_kernelNetwork.setArg(0, *inputs)) ||
+	    CL_SUCCESS != (nError = m_kernelNetwork.setArg(1, *outputs)))
+	{
+		return Status(Status_OperationFailed, "setArg failed with error {1} at {2}:{3}", nError, __FILE__, __LINE__);
 	}
-	if (CL_SUCCESS != (nError = m_pQueue->enqueueNDRangeKernel(kernelActivate, cl::NullRange, 
-	                                                           cl::NDRange(cNextNeuronsCount))))
+	if (CL_SUCCESS != (nError = pQueue->enqueueNDRangeKernel(m_kernelNetwork, cl::NullRange, 
+	                                                         cl::NDRange((Size)m_cNetworkGroupSize * cCount), 
+	                                                         cl::NDRange(m_cNetworkGroupSize), 
+	                                                         pEvents->empty() ? NULL : pEvents, &event)))
 	{
 		return Status(Status_OperationFailed, "enqueueNDRangeKernel failed with error {1} at {2}:{3}", nError, __FILE__, 
 		              __LINE__);
 	}
+	pEvents->assign(1, event);
 
 	return Status();
 }
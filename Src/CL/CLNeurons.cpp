@@ -48,6 +48,7 @@ Neurons::Neurons(Network *pNetwork)
 	m_pPrevSynapses        = NULL;
 	m_pNextSynapses        = NULL;
 	m_cbMemSize            = 0;
+	m_cbValuesOffset       = 0;
 	m_szActivationFunction = "";
 }
 
@@ -105,15 +106,53 @@ Status Neurons::Init(NET::Neurons *pNeurons)
 			break;
 		}
 		cNeurons = pNeurons->GetNeuronsCount();
-		m_values = cl::Buffer(*m_pNetwork->GetProvider()->GetContext(), CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, 
-		                      sizeof(Float) * cNeurons, pNeurons->GetValues(), &nError);
-		if (CL_SUCCESS != nError)
+		if (!(status = m_pNetwork->AllocTensor(False, sizeof(Float) * cNeurons, &m_values, &m_cbValuesOffset)))
 		{
-			status = Status(Status_MemAllocFailed, "Failed to allocate {1} bytes at {2}:{3}", sizeof(Float) * cNeurons, 
-			                __FILE__, __LINE__);
-
 			break;
 		}
+		if (NET::Activation::Identity != pNeurons->GetActivation())
+		{
+			m_kernelActivate = cl::Kernel(*m_pNetwork->GetProvider()->GetProgram(), m_szActivationFunction, &nError);
+			if (CL_SUCCESS != nError)
+			{
+				status = Status(Status_OperationFailed, "Failed to create kernel {1} with error {2} at {3}:{4}", 
+				                m_szActivationFunction, nError, __FILE__, __LINE__);
+
+				break;
+			}
+			if (CL_SUCCESS != (nError = m_kernelActivate.setArg(0, m_values)) ||
+			    CL_SUCCESS != (nError = m_kernelActivate.setArg(1, (UInt32)0)))
+			{
+				status = Status(Status_OperationFailed, "setArg failed with error {1} at {2}:{3}", nError, 
+				                __FILE__, __LINE__);
+
+				break;
+			}
+			for (UInt32 i = 0; i < pNeurons->GetActivationArgsCount(); i++)
+			{
+				if (CL_SUCCESS != (nError = m_kernelActivate.setArg(i + 2, pNeurons->GetActivationArgs()[i])))
+				{
+					status = Status(Status_OperationFailed, "setArg failed with error {1} ({2}) at {3}:{4}", nError, i, 
+					                __FILE__, __LINE__);
+
+					break;
+				}
+			}
+			if (!status)
+			{
+				break;
+			}
+			if (NET::Activation::SoftMax == pNeurons->GetActivation())
+			{
+				if (CL_SUCCESS != (nError = m_kernelActivate.setArg(2, cNeurons)))
+				{
+					status = Status(Status_OperationFailed, "setArg failed with error {1} at {2}:{3}", nError, 
+					                __FILE__, __LINE__);
+
+					break;
+				}
+			}
+		}
 		m_pNeurons      = pNeurons;
 		m_pPrevSynapses = NULL;
 		m_pNextSynapses = NULL;
@@ -135,6 +174,8 @@ Status Neurons::Uninit()
 	m_pPrevSynapses        = NULL;
 	m_pNextSynapses        = NULL;
 	m_values               = cl::Buffer();
+	m_cbValuesOffset       = 0;
+	m_kernelActivate       = cl::Kernel();
 	m_cbMemSize            = 0;
 	m_szActivationFunction = "";
 
@@ -223,15 +264,7 @@ Status Neurons::SyncToCE(Bool bWait/* = True*/)
 		return Status(Status_NotInitialized, "Not initialized at {1}:{2}", __FILE__, __LINE__);
 	}
 
-	cl_int   nError;
-
-	if (CL_SUCCESS != (nError = m_pNetwork->GetQueue()->enqueueWriteBuffer(m_values, bWait ? CL_TRUE : CL_FALSE, 0, 
-	                                            sizeof(Float) * m_pNeurons->GetNeuronsCount(), m_pNeurons->GetValues())))
-	{
-		return Status(Status_OperationFailed, "Failed to write values buffer at {1}:{2}", __FILE__, __LINE__);
-	}
-
-	return Status();
+	return m_pNetwork->SyncNeurons(this, True, bWait);
 }
 
 Status Neurons::SyncFromCE(Bool bWait/* = True*/)
@@ -241,15 +274,7 @@ Status Neurons::SyncFromCE(Bool bWait/* = True*/)
 		return Status(Status_NotInitialized, "Not initialized at {1}:{2}", __FILE__, __LINE__);
 	}
 
-	cl_int   nError;
-
-	if (CL_SUCCESS != (nError = m_pNetwork->GetQueue()->enqueueReadBuffer(m_values, bWait ? CL_TRUE : CL_FALSE, 0, 
-	                                            sizeof(Float) * m_pNeurons->GetNeuronsCount(), m_pNeurons->GetValues())))
-	{
-		return Status(Status_OperationFailed, "Failed to read values buffer at {1}:{2}", __FILE__, __LINE__);
-	}
-
-	return Status();
+	return m_pNetwork->SyncNeurons(this, False, bWait);
 }
 
 Size Neurons::GetMemSize() const
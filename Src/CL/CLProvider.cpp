@@ -30,6 +30,10 @@
 #include "N2/CL/Network.hpp"
 #include "N2/CL/Config.hpp"
 #include "N2/CL/KernelSources.hpp"
+#include "CX/Print.hpp"
+#ifdef N2_CL_EMBED_KERNELS
+#include "Kernels/Kernels.inl"
+#endif
 
 
 using namespace CX;
@@ -43,9 +47,16 @@ namespace CL
 
 Provider::Provider()
 {
-	m_pDevice  = NULL;
-	m_pContext = NULL;
-	m_pProgram = NULL;
+	m_pDevice            = NULL;
+	m_pContext           = NULL;
+	m_pProgram           = NULL;
+	m_cTileSize          = 0;
+	m_bTiledCompute      = False;
+	m_bHostUnifiedMemory = False;
+	m_bGenerateKernels   = False;
+	m_pTuner             = NULL;
+	m_pScheduler         = NULL;
+	m_cMaxInFlight       = 0;
 }
 
 Provider::~Provider()
@@ -73,7 +84,15 @@ Status Provider::DestroyConfig(CE::IConfig *pConfig)
 
 Status Provider::Init(const CE::IConfig *pConfig/* = NULL*/)
 {
-	cl_device_id   nDevID = NULL;
+	cl_device_id   nDevID    = NULL;
+	UInt32         cTileSize        = 0;
+	Bool           bTiledCompute    = True;
+	Bool           bGenerateKernels = True;
+	Bool           bAutoTune        = False;
+	UInt32         cQueues          = Config::DEFAULT_QUEUES_COUNT;
+	UInt32         cMaxInFlight     = Config::DEFAULT_MAX_IN_FLIGHT;
+	String         sOptions;
+	String         sCacheDir;
 	Status         status;
 
 	if (NULL != pConfig)
@@ -85,7 +104,22 @@ Status Provider::Init(const CE::IConfig *pConfig/* = NULL*/)
 			return Status(Status_MemAllocFailed, "Invalid arg at {1}:{2}", __FILE__, __LINE__);
 		}
 	
-		nDevID = pCLConfig->GetDeviceID();
+		nDevID           = pCLConfig->GetDeviceID();
+		cTileSize        = pCLConfig->GetTileSize();
+		bTiledCompute    = pCLConfig->GetTiledCompute();
+		sCacheDir        = pCLConfig->GetCacheDir();
+		bGenerateKernels = pCLConfig->GetGenerateKernels();
+		bAutoTune        = pCLConfig->GetAutoTune();
+		cQueues          = pCLConfig->GetQueuesCount();
+		cMaxInFlight     = pCLConfig->GetMaxInFlight();
+		if (0 == cMaxInFlight)
+		{
+			return Status(Status_InvalidArg, "Invalid max in flight {1} at {2}:{3}", cMaxInFlight, __FILE__, __LINE__);
+		}
+		if (0 != cTileSize && 8 != cTileSize && 16 != cTileSize && 32 != cTileSize)
+		{
+			return Status(Status_InvalidArg, "Invalid tile size {1} at {2}:{3}", cTileSize, __FILE__, __LINE__);
+		}
 	}
 	if (NULL == nDevID)
 	{
@@ -116,10 +150,41 @@ Status Provider::Init(const CE::IConfig *pConfig/* = NULL*/)
 		{
 			status = Status(Status_MemAllocFailed, "Failed to create context at {1}:{2}", __FILE__, __LINE__);
 		}
-		if (!(status = KernelSources::Build(*m_pDevice, *m_pContext, &m_pProgram, &m_sBuildLog)))
+		if (0 == cTileSize)
+		{
+			cTileSize = ChooseTileSize(*m_pDevice);
+		}
+		Print(&sOptions, "-D N2_TILE_SIZE={1}", cTileSize);
+		if (!(status = KernelSources::Build(*m_pDevice, *m_pContext, &m_pProgram, &m_sBuildLog, sOptions.c_str(), 
+		                                    sCacheDir.c_str())))
+		{
+			break;
+		}
+		m_cTileSize          = cTileSize;
+		m_bTiledCompute      = bTiledCompute;
+		m_bHostUnifiedMemory = (CL_FALSE != m_pDevice->getInfo<CL_DEVICE_HOST_UNIFIED_MEMORY>());
+		m_sCacheDir          = sCacheDir;
+		m_bGenerateKernels   = bGenerateKernels;
+		m_cMaxInFlight       = cMaxInFlight;
+		if (NULL == (m_pScheduler = new (std::nothrow) Scheduler()))
+		{
+			status = Status(Status_MemAllocFailed, "Failed to allocate scheduler at {1}:{2}", __FILE__, __LINE__);
+
+			break;
+		}
+		if (!(status = m_pScheduler->Init(m_pDevice, m_pContext, cQueues)))
 		{
 			break;
 		}
+		//without a tuner the driver chooses the work-group sizes
+		if (bAutoTune && NULL != (m_pTuner = new (std::nothrow) Tuner()))
+		{
+			if (!m_pTuner->Init(m_pDevice, m_pContext, sOptions.c_str(), sCacheDir.c_str()))
+			{
+				delete m_pTuner;
+				m_pTuner = NULL;
+			}
+		}
 
 		break;
 	}
@@ -133,6 +198,15 @@ Status Provider::Init(const CE::IConfig *pConfig/* = NULL*/)
 
 Status Provider::Uninit()
 {
+	//waits for the batches still in flight
+	if (NULL != m_pScheduler)
+	{
+		delete m_pScheduler;
+	}
+	if (NULL != m_pTuner)
+	{
+		delete m_pTuner;
+	}
 	if (NULL != m_pProgram)
 	{
 		delete m_pProgram;
@@ -145,9 +219,17 @@ Status Provider::Uninit()
 	{
 		delete m_pDevice;
 	}
-	m_pProgram = NULL;
-	m_pDevice  = NULL;
-	m_pContext = NULL;
+	m_pTuner             = NULL;
+	m_pScheduler         = NULL;
+	m_cMaxInFlight       = 0;
+	m_pProgram           = NULL;
+	m_pDevice            = NULL;
+	m_pContext           = NULL;
+	m_cTileSize          = 0;
+	m_bTiledCompute      = False;
+	m_bHostUnifiedMemory = False;
+	m_bGenerateKernels   = False;
+	m_sCacheDir.clear();
 
 	return Status();
 }
@@ -201,10 +283,89 @@ const Char *Provider::GetBuildLog() const
 	return m_sBuildLog.c_str();
 }
 
+UInt32 Provider::GetTileSize() const
+{
+	return m_cTileSize;
+}
+
+Bool Provider::GetTiledCompute() const
+{
+	return m_bTiledCompute;
+}
+
+Bool Provider::IsHostUnifiedMemory() const
+{
+	return m_bHostUnifiedMemory;
+}
+
+const Char *Provider::GetCacheDir() const
+{
+	return m_sCacheDir.c_str();
+}
+
+Bool Provider::GetGenerateKernels() const
+{
+	return m_bGenerateKernels;
+}
+
+Tuner *Provider::GetTuner()
+{
+	return m_pTuner;
+}
+
+Scheduler *Provider::GetScheduler()
+{
+	return m_pScheduler;
+}
+
+UInt32 Provider::GetMaxInFlight() const
+{
+	return m_cMaxInFlight;
+}
+
+UInt32 Provider::ChooseTileSize(cl::Device &device)
+{
+	static const UInt32   TILE_SIZES[] = { 32, 16, 8 };
+
+	Size     cMaxWorkGroupSize = device.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>();
+	UInt64   cbLocalMemSize    = device.getInfo<CL_DEVICE_LOCAL_MEM_SIZE>();
+	Bool     bCPU              = (0 != (CL_DEVICE_TYPE_CPU & device.getInfo<CL_DEVICE_TYPE>()));
+
+	for (Size i = 0; i < sizeof(TILE_SIZES) / sizeof(TILE_SIZES[0]); i++)
+	{
+		UInt32   cTileSize = TILE_SIZES[i];
+
+		if (bCPU && 16 < cTileSize)
+		{
+			continue;
+		}
+		//work-group is (tile / 4) x tile, two float tiles of tile x tile in local memory
+		if (cMaxWorkGroupSize >= (Size)cTileSize * cTileSize / 4 && 
+		    cbLocalMemSize >= 2 * sizeof(Float) * cTileSize * cTileSize)
+		{
+			return cTileSize;
+		}
+	}
+
+	return 8;
+}
+
+#ifdef N2_CL_EMBED_KERNELS
+
+Status Provider::COMPUTE_NEURONS_REGISTERED_STATUS  = KernelSources::Register(EMBEDDED_COMPUTE_CL, 
+                                                                              sizeof(EMBEDDED_COMPUTE_CL) - 1);
+
+Status Provider::ACTIVATE_NEURONS_REGISTERED_STATUS = KernelSources::Register(EMBEDDED_ACTIVATE_CL, 
+                                                                              sizeof(EMBEDDED_ACTIVATE_CL) - 1);
+
+#else
+
 Status Provider::COMPUTE_NEURONS_REGISTERED_STATUS  = KernelSources::Register("file://Compute.cl");
 
 Status Provider::ACTIVATE_NEURONS_REGISTERED_STATUS = KernelSources::Register("file://Activate.cl");
 
+#endif
+
 }//namespace CL
 
 }//namespace N2
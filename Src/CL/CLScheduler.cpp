@@ -0,0 +1,259 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "N2/CL/Scheduler.hpp"
+
+
+using namespace CX;
+
+
+namespace N2
+{
+
+namespace CL
+{
+
+Scheduler::Scheduler()
+{
+	m_queues        = NULL;
+	m_cQueues       = 0;
+	m_bOutOfOrder   = False;
+	m_cMaxInFlight  = 0;
+	m_cInFlight     = 0;
+	m_nNextTicket   = 0;
+	m_nServedTicket = 0;
+	InitializeSRWLock(&m_srwlQueues);
+	InitializeConditionVariable(&m_cvQueues);
+}
+
+Scheduler::~Scheduler()
+{
+	Uninit();
+}
+
+Status Scheduler::Init(cl::Device *pDevice, cl::Context *pContext, UInt32 cQueues)
+{
+	Uninit();
+
+	cl_command_queue_properties   nProperties = 0;
+	cl_int                        nError;
+	Status                        status;
+
+	if (0 == cQueues)
+	{
+		cQueues = 1;
+		if (0 != (CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE & pDevice->getInfo<CL_DEVICE_QUEUE_PROPERTIES>()))
+		{
+			nProperties   = CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE;
+			m_bOutOfOrder = True;
+		}
+	}
+	for (;;)
+	{
+		if (NULL == (m_queues = new (std::nothrow) Queue[cQueues]))
+		{
+			status = Status(Status_MemAllocFailed, "Failed to allocate queues at {1}:{2}", __FILE__, __LINE__);
+
+			break;
+		}
+		for (m_cQueues = 0; m_cQueues < cQueues; m_cQueues++)
+		{
+			m_queues[m_cQueues].pScheduler = this;
+			m_queues[m_cQueues].cIndex     = m_cQueues;
+			m_queues[m_cQueues].cInFlight  = 0;
+			if (NULL == (m_queues[m_cQueues].pQueue = new (std::nothrow) cl::CommandQueue(*pContext, *pDevice, 
+			                                                                               nProperties, &nError)))
+			{
+				status = Status(Status_MemAllocFailed, "Failed to allocate queue at {1}:{2}", __FILE__, __LINE__);
+
+				break;
+			}
+			if (CL_SUCCESS != nError)
+			{
+				delete m_queues[m_cQueues].pQueue;
+				status = Status(Status_OperationFailed, "Failed to create queue with error {1} at {2}:{3}", nError, 
+				                __FILE__, __LINE__);
+
+				break;
+			}
+		}
+		if (!status)
+		{
+			break;
+		}
+		m_cMaxInFlight = QUEUE_DEPTH * m_cQueues;
+
+		break;
+	}
+	if (!status)
+	{
+		Uninit();
+	}
+
+	return status;
+}
+
+Status Scheduler::Uninit()
+{
+	if (NULL != m_queues)
+	{
+		for (UInt32 i = 0; i < m_cQueues; i++)
+		{
+			m_queues[i].pQueue->finish();
+		}
+		//the completion callbacks may still be running after finish
+		AcquireSRWLockExclusive(&m_srwlQueues);
+		while (0 < m_cInFlight)
+		{
+			SleepConditionVariableSRW(&m_cvQueues, &m_srwlQueues, INFINITE, 0);
+		}
+		ReleaseSRWLockExclusive(&m_srwlQueues);
+		for (UInt32 i = 0; i < m_cQueues; i++)
+		{
+			delete m_queues[i].pQueue;
+		}
+		delete [] m_queues;
+	}
+	m_queues        = NULL;
+	m_cQueues       = 0;
+	m_bOutOfOrder   = False;
+	m_cMaxInFlight  = 0;
+	m_cInFlight     = 0;
+	m_nNextTicket   = 0;
+	m_nServedTicket = 0;
+
+	return Status();
+}
+
+Bool Scheduler::IsOK() const
+{
+	return (NULL != m_queues);
+}
+
+UInt32 Scheduler::GetQueuesCount() const
+{
+	return m_cQueues;
+}
+
+Bool Scheduler::IsOutOfOrder() const
+{
+	return m_bOutOfOrder;
+}
+
+UInt32 Scheduler::GetInFlightCount() const
+{
+	UInt32   cInFlight;
+
+	AcquireSRWLockShared(&m_srwlQueues);
+	cInFlight = m_cInFlight;
+	ReleaseSRWLockShared(&m_srwlQueues);
+
+	return cInFlight;
+}
+
+Status Scheduler::Acquire(cl::CommandQueue **ppQueue, UInt32 *pcQueue)
+{
+	if (NULL == m_queues)
+	{
+		return Status(Status_NotInitialized, "Not initialized at {1}:{2}", __FILE__, __LINE__);
+	}
+
+	UInt64   nTicket;
+	UInt32   cQueue;
+
+	AcquireSRWLockExclusive(&m_srwlQueues);
+	nTicket = m_nNextTicket++;
+	while (nTicket != m_nServedTicket || m_cInFlight >= m_cMaxInFlight)
+	{
+		SleepConditionVariableSRW(&m_cvQueues, &m_srwlQueues, INFINITE, 0);
+	}
+	m_nServedTicket++;
+	cQueue = 0;
+	for (UInt32 i = 1; i < m_cQueues; i++)
+	{
+		if (m_queues[i].cInFlight < m_queues[cQueue].cInFlight)
+		{
+			cQueue = i;
+		}
+	}
+	m_queues[cQueue].cInFlight++;
+	m_cInFlight++;
+	ReleaseSRWLockExclusive(&m_srwlQueues);
+	//the next ticket may be admitted too
+	WakeAllConditionVariable(&m_cvQueues);
+
+	*ppQueue = m_queues[cQueue].pQueue;
+	*pcQueue = cQueue;
+
+	return Status();
+}
+
+Status Scheduler::Submit(UInt32 cQueue, cl::Event *pEvent)
+{
+	cl_int   nError;
+
+	if (cQueue >= m_cQueues || NULL == pEvent)
+	{
+		return Status(Status_InvalidArg, "Invalid arg at {1}:{2}", __FILE__, __LINE__);
+	}
+	//the callback may run right away (on this thread), so no lock is held here
+	if (CL_SUCCESS != (nError = pEvent->setCallback(CL_COMPLETE, &OnComplete, &m_queues[cQueue])))
+	{
+		pEvent->wait();
+		Release(cQueue);
+
+		return Status(Status_OperationFailed, "Failed to set event callback with error {1} at {2}:{3}", nError, 
+		              __FILE__, __LINE__);
+	}
+
+	return Status();
+}
+
+void Scheduler::Release(UInt32 cQueue)
+{
+	AcquireSRWLockExclusive(&m_srwlQueues);
+	m_queues[cQueue].cInFlight--;
+	m_cInFlight--;
+	ReleaseSRWLockExclusive(&m_srwlQueues);
+	WakeAllConditionVariable(&m_cvQueues);
+}
+
+//called by the runtime on one of its threads (also if the batch failed)
+void CL_CALLBACK Scheduler::OnComplete(cl_event event, cl_int nStatus, void *pUserData)
+{
+	Queue   *pQueue = (Queue *)pUserData;
+
+	CX_UNUSED(event);
+	CX_UNUSED(nStatus);
+
+	pQueue->pScheduler->Release(pQueue->cIndex);
+}
+
+}//namespace CL
+
+}//namespace N2
@@ -29,6 +29,7 @@
 #include "N2/CL/Synapses.hpp"
 #include "N2/CL/Network.hpp"
 #include "N2/CL/Provider.hpp"
+#include "N2/CL/KernelGenerator.hpp"
 
 
 using namespace CX;
@@ -42,11 +43,17 @@ namespace CL
 
 Synapses::Synapses(Network *pNetwork)
 {
-	m_pNetwork     = pNetwork;
-	m_pSynapses    = NULL;
-	m_pPrevNeurons = NULL;
-	m_pNextNeurons = NULL;
-	m_cbMemSize    = 0;
+	m_pNetwork         = pNetwork;
+	m_pSynapses        = NULL;
+	m_pPrevNeurons     = NULL;
+	m_pNextNeurons     = NULL;
+	m_cbMemSize        = 0;
+	m_cPrevNeuronsArg  = 0;
+	m_cNextNeuronsArg  = 0;
+	m_cSamplesCountArg = 0;
+	m_cbWeightsOffset  = 0;
+	m_cbBiasesOffset   = 0;
+	m_nSyncedVersion   = NET::Synapses::VERSION_NONE;
 }
 
 Synapses::~Synapses()
@@ -56,7 +63,6 @@ Synapses::~Synapses()
 
 Status Synapses::Init(NET::Synapses *pSynapses)
 {
-	cl_int   nError;
 	Status   status;
 
 	Uninit();
@@ -71,27 +77,46 @@ Status Synapses::Init(NET::Synapses *pSynapses)
 			break;
 		}
 
-		m_weights = cl::Buffer(*m_pNetwork->GetProvider()->GetContext(), CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, 
-		                      sizeof(Float) * pSynapses->GetWeightsCount(), 
-		                      pSynapses->GetWeights(), &nError);
-		if (CL_SUCCESS != nError)
+		if (!(status = m_pNetwork->AllocTensor(True, sizeof(Float) * pSynapses->GetWeightsCount(), &m_weights, 
+		                                       &m_cbWeightsOffset)))
 		{
-			status = Status(Status_MemAllocFailed, "Failed to allocate {1} bytes at {2}:{3}", 
-			                sizeof(Float) * pSynapses->GetWeightsCount(), __FILE__, __LINE__);
-
 			break;
 		}
 		if (pSynapses->HasBias())
 		{
-			m_biases = cl::Buffer(*m_pNetwork->GetProvider()->GetContext(), CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, 
-			                      sizeof(Float) * pSynapses->GetBiasesCount(), pSynapses->GetBiases(), &nError);
-			if (CL_SUCCESS != nError)
+			if (!(status = m_pNetwork->AllocTensor(True, sizeof(Float) * pSynapses->GetBiasesCount(), &m_biases, 
+			                                       &m_cbBiasesOffset)))
+			{
+				break;
+			}
+		}
+		if (pSynapses->HasBias())
+		{
+			if (!(status = CreateComputeKernel(pSynapses, "ComputeWithBias", &m_kernelCompute)))
+			{
+				break;
+			}
+			if (!(status = CreateComputeKernel(pSynapses, "ComputeWithBiasTiled", &m_kernelComputeTiled)))
+			{
+				break;
+			}
+			m_cPrevNeuronsArg  = 1;
+			m_cNextNeuronsArg  = 6;
+			m_cSamplesCountArg = 9;
+		}
+		else
+		{
+			if (!(status = CreateComputeKernel(pSynapses, "Compute", &m_kernelCompute)))
+			{
+				break;
+			}
+			if (!(status = CreateComputeKernel(pSynapses, "ComputeTiled", &m_kernelComputeTiled)))
 			{
-				status = Status(Status_MemAllocFailed, "Failed to allocate {1} bytes at {2}:{3}", 
-			                   sizeof(Float) * pSynapses->GetBiasesCount(), __FILE__, __LINE__);
-
 				break;
 			}
+			m_cPrevNeuronsArg  = 0;
+			m_cNextNeuronsArg  = 4;
+			m_cSamplesCountArg = 7;
 		}
 		m_pSynapses   = pSynapses;
 		m_cbMemSize += sizeof(Float) * pSynapses->GetWeightsCount();
@@ -112,12 +137,22 @@ Status Synapses::Init(NET::Synapses *pSynapses)
 
 Status Synapses::Uninit()
 {
-	m_pSynapses    = NULL;
-	m_weights      = cl::Buffer();
-	m_biases       = cl::Buffer();
-	m_pPrevNeurons = NULL;
-	m_pNextNeurons = NULL;
-	m_cbMemSize    = 0;
+	m_pSynapses          = NULL;
+	m_weights            = cl::Buffer();
+	m_biases             = cl::Buffer();
+	m_cbWeightsOffset    = 0;
+	m_cbBiasesOffset     = 0;
+	m_nSyncedVersion     = NET::Synapses::VERSION_NONE;
+	m_kernelCompute      = cl::Kernel();
+	m_kernelComputeTiled = cl::Kernel();
+	m_kernelLayer        = cl::Kernel();
+	m_kernelLayerSoftMax = cl::Kernel();
+	m_cPrevNeuronsArg    = 0;
+	m_cNextNeuronsArg    = 0;
+	m_cSamplesCountArg   = 0;
+	m_pPrevNeurons       = NULL;
+	m_pNextNeurons       = NULL;
+	m_cbMemSize          = 0;
 
 	return Status();
 }
@@ -224,58 +259,90 @@ Status Synapses::SyncToCE(Bool bWait/* = True*/)
 		return Status(Status_NotInitialized, "Not initialized at {1}:{2}", __FILE__, __LINE__);
 	}
 
+	return m_pNetwork->SyncSynapses(this, True, bWait);
+}
+
+Status Synapses::SyncFromCE(Bool bWait/* = True*/)
+{
+	if (NULL == m_pSynapses)
+	{
+		return Status(Status_NotInitialized, "Not initialized at {1}:{2}", __FILE__, __LINE__);
+	}
+
+	return m_pNetwork->SyncSynapses(this, False, bWait);
+}
+
+Size Synapses::GetMemSize() const
+{
+	return m_cbMemSize;
+}
+
+Status Synapses::CreateComputeKernel(NET::Synapses *pSynapses, const Char *szName, cl::Kernel *pKernel)
+{
 	cl_int   nError;
 
-	if (CL_SUCCESS != (nError = m_pNetwork->GetQueue()->enqueueWriteBuffer(m_weights, bWait ? CL_TRUE : CL_FALSE, 0, 
-	                            sizeof(Float) * m_pSynapses->GetWeightsCount(), 
-	                            m_pSynapses->GetWeights())))
+	*pKernel = cl::Kernel(*m_pNetwork->GetProvider()->GetProgram(), szName, &nError);
+	if (CL_SUCCESS != nError)
 	{
-		return Status(Status_OperationFailed, "Failed to write weights buffer at {1}:{2}", __FILE__, __LINE__);
+		return Status(Status_OperationFailed, "Failed to create kernel {1} with error {2} at {3}:{4}", szName, nError, 
+		              __FILE__, __LINE__);
+	}
+	//all the compute kernels share the args layout, the tiled ones add the samples count at the end
+	if (pSynapses->HasBias())
+	{
+		if (CL_SUCCESS != (nError = pKernel->setArg(0, pSynapses->GetBias())) ||
+		    CL_SUCCESS != (nError = pKernel->setArg(3, pSynapses->GetPrevNeuronsCount())) ||
+		    CL_SUCCESS != (nError = pKernel->setArg(4, m_weights)) ||
+		    CL_SUCCESS != (nError = pKernel->setArg(5, m_biases)) ||
+		    CL_SUCCESS != (nError = pKernel->setArg(8, pSynapses->GetNextNeuronsCount())))
+		{
+			return Status(Status_OperationFailed, "setArg failed with error {1} at {2}:{3}", nError, __FILE__, __LINE__);
+		}
 	}
-	if (HasBias())
+	else
 	{
-		if (CL_SUCCESS != (nError = m_pNetwork->GetQueue()->enqueueWriteBuffer(m_biases, bWait ? CL_TRUE : CL_FALSE, 0, 
-		                                   sizeof(Float) * m_pSynapses->GetBiasesCount(), m_pSynapses->GetBiases())))
+		if (CL_SUCCESS != (nError = pKernel->setArg(2, pSynapses->GetPrevNeuronsCount())) ||
+		    CL_SUCCESS != (nError = pKernel->setArg(3, m_weights)) ||
+		    CL_SUCCESS != (nError = pKernel->setArg(6, pSynapses->GetNextNeuronsCount())))
 		{
-			return Status(Status_OperationFailed, "Failed to write weights buffer at {1}:{2}", __FILE__, __LINE__);
+			return Status(Status_OperationFailed, "setArg failed with error {1} at {2}:{3}", nError, __FILE__, __LINE__);
 		}
 	}
 
 	return Status();
 }
 
-Status Synapses::SyncFromCE(Bool bWait/* = True*/)
+Status Synapses::CreateLayerKernels(cl::Program *pProgram, UInt32 cLayer)
 {
-	if (NULL == m_pSynapses)
-	{
-		return Status(Status_NotInitialized, "Not initialized at {1}:{2}", __FILE__, __LINE__);
-	}
-
+	String   sName;
 	cl_int   nError;
 
-	if (CL_SUCCESS != (nError = m_pNetwork->GetQueue()->enqueueReadBuffer(m_weights, bWait ? CL_TRUE : CL_FALSE, 0, 
-	                            sizeof(Float) * m_pSynapses->GetWeightsCount(), 
-	                            m_pSynapses->GetWeights())))
+	KernelGenerator::GetLayerKernelName(cLayer, &sName);
+	m_kernelLayer = cl::Kernel(*pProgram, sName.c_str(), &nError);
+	if (CL_SUCCESS != nError)
+	{
+		return Status(Status_OperationFailed, "Failed to create kernel {1} with error {2} at {3}:{4}", sName, nError, 
+		              __FILE__, __LINE__);
+	}
+	if (CL_SUCCESS != (nError = m_kernelLayer.setArg(2, m_weights)) ||
+	    (HasBias() && CL_SUCCESS != (nError = m_kernelLayer.setArg(3, m_biases))))
 	{
-		return Status(Status_OperationFailed, "Failed to read weights buffer at {1}:{2}", __FILE__, __LINE__);
+		return Status(Status_OperationFailed, "setArg failed with error {1} at {2}:{3}", nError, __FILE__, __LINE__);
 	}
-	if (HasBias())
+	if (NET::Activation::SoftMax == m_pSynapses->GetNextNeurons()->GetActivation())
 	{
-		if (CL_SUCCESS != (nError = m_pNetwork->GetQueue()->enqueueReadBuffer(m_biases, bWait ? CL_TRUE : CL_FALSE, 0, 
-		                                   sizeof(Float) * m_pSynapses->GetBiasesCount(), m_pSynapses->GetBiases())))
+		KernelGenerator::GetSoftMaxKernelName(cLayer, &sName);
+		m_kernelLayerSoftMax = cl::Kernel(*pProgram, sName.c_str(), &nError);
+		if (CL_SUCCESS != nError)
 		{
-			return Status(Status_OperationFailed, "Failed to read weights buffer at {1}:{2}", __FILE__, __LINE__);
+			return Status(Status_OperationFailed, "Failed to create kernel {1} with error {2} at {3}:{4}", sName, nError, 
+			              __FILE__, __LINE__);
 		}
 	}
 
 	return Status();
 }
 
-Size Synapses::GetMemSize() const
-{
-	return m_cbMemSize;
-}
-
 }//namespace CL
 
 }//namespace N2
@@ -0,0 +1,370 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "N2/CL/Tuner.hpp"
+#include "N2/CL/KernelSources.hpp"
+#include "CX/IO/FileInputStream.hpp"
+#include "CX/IO/FileOutputStream.hpp"
+#include "CX/Print.hpp"
+
+
+using namespace CX;
+
+
+namespace N2
+{
+
+namespace CL
+{
+
+bool Tuner::Shape::operator<(const Shape &shape) const
+{
+	if (nKernel != shape.nKernel)
+	{
+		return nKernel < shape.nKernel;
+	}
+	if (cPrevNeuronsCount != shape.cPrevNeuronsCount)
+	{
+		return cPrevNeuronsCount < shape.cPrevNeuronsCount;
+	}
+	if (cNextNeuronsCount != shape.cNextNeuronsCount)
+	{
+		return cNextNeuronsCount < shape.cNextNeuronsCount;
+	}
+
+	return cSamplesCount < shape.cSamplesCount;
+}
+
+Tuner::Tuner()
+{
+	m_pQueue = NULL;
+	m_nKey   = 0;
+	InitializeSRWLock(&m_srwlParams);
+}
+
+Tuner::~Tuner()
+{
+	Uninit();
+}
+
+Status Tuner::Init(cl::Device *pDevice, cl::Context *pContext, const Char *szOptions, const Char *szCacheDir)
+{
+	Uninit();
+
+	cl_int   nError;
+	Status   status;
+
+	for (;;)
+	{
+		//the candidates are timed from the events of this queue
+		if (NULL == (m_pQueue = new (std::nothrow) cl::CommandQueue(*pContext, *pDevice, CL_QUEUE_PROFILING_ENABLE, 
+		                                                            &nError)))
+		{
+			status = Status(Status_MemAllocFailed, "Failed to allocate queue at {1}:{2}", __FILE__, __LINE__);
+
+			break;
+		}
+		if (CL_SUCCESS != nError)
+		{
+			status = Status(Status_OperationFailed, "Failed to create queue at {1}:{2}", __FILE__, __LINE__);
+
+			break;
+		}
+		m_nKey = KernelSources::GetDeviceKey(*pDevice, szOptions);
+		if (NULL != szCacheDir && 0 != *szCacheDir)
+		{
+			KernelSources::GetCachePath(szCacheDir, m_nKey, "tune", &m_sPath);
+			//a missing or stale database is rebuilt as the shapes are tuned again
+			Load();
+		}
+
+		break;
+	}
+	if (!status)
+	{
+		Uninit();
+	}
+
+	return status;
+}
+
+Status Tuner::Uninit()
+{
+	if (NULL != m_pQueue)
+	{
+		delete m_pQueue;
+		m_pQueue = NULL;
+	}
+	m_nKey = 0;
+	m_sPath.clear();
+	m_mapParams.clear();
+
+	return Status();
+}
+
+Bool Tuner::Find(const Shape &shape, Params *pParams)
+{
+	ParamsMap::iterator   iter;
+	Bool                  bFound;
+
+	AcquireSRWLockShared(&m_srwlParams);
+	if ((bFound = (m_mapParams.end() != (iter = m_mapParams.find(shape)))))
+	{
+		*pParams = iter->second;
+	}
+	ReleaseSRWLockShared(&m_srwlParams);
+
+	return bFound;
+}
+
+Status Tuner::Tune(const Shape &shape, const CandidatesVector &vectorCandidates, Params *pParams)
+{
+	if (NULL == m_pQueue)
+	{
+		return Status(Status_NotInitialized, "Not initialized at {1}:{2}", __FILE__, __LINE__);
+	}
+
+	ParamsMap::iterator   iter;
+	cl::Event             event;
+	cl_ulong              nStart;
+	cl_ulong              nEnd;
+	cl_ulong              nTime;
+	cl_ulong              nBestTime;
+	cl_ulong              nBestCandidateTime = (cl_ulong)-1;
+	const Candidate       *pBestCandidate    = NULL;
+	cl_int                nError;
+	Status                status;
+
+	//exclusive for the whole measurement so the candidates of different shapes do not overlap on the device
+	AcquireSRWLockExclusive(&m_srwlParams);
+	//another network may have tuned it in the meantime
+	if (m_mapParams.end() != (iter = m_mapParams.find(shape)))
+	{
+		*pParams = iter->second;
+		ReleaseSRWLockExclusive(&m_srwlParams);
+
+		return Status();
+	}
+	for (auto iterCandidate = vectorCandidates.begin(); iterCandidate != vectorCandidates.end(); ++iterCandidate)
+	{
+		nBestTime = (cl_ulong)-1;
+		for (UInt32 i = 0; i <= TUNE_RUNS; i++)
+		{
+			//invalid work-group sizes (for this kernel or device) are rejected here and the candidate is skipped
+			if (CL_SUCCESS != m_pQueue->enqueueNDRangeKernel(*iterCandidate->pKernel, cl::NullRange, 
+			                                                 iterCandidate->global, iterCandidate->local, NULL, 
+			                                                 &event))
+			{
+				nBestTime = (cl_ulong)-1;
+
+				break;
+			}
+			if (CL_SUCCESS != event.wait())
+			{
+				nBestTime = (cl_ulong)-1;
+
+				break;
+			}
+			if (0 == i)
+			{
+				continue;
+			}
+			nStart = event.getProfilingInfo<CL_PROFILING_COMMAND_START>(&nError);
+			if (CL_SUCCESS != nError)
+			{
+				nBestTime = (cl_ulong)-1;
+
+				break;
+			}
+			nEnd = event.getProfilingInfo<CL_PROFILING_COMMAND_END>(&nError);
+			if (CL_SUCCESS != nError)
+			{
+				nBestTime = (cl_ulong)-1;
+
+				break;
+			}
+			nTime = (nEnd > nStart ? nEnd - nStart : 0);
+			if (nTime < nBestTime)
+			{
+				nBestTime = nTime;
+			}
+		}
+		if (nBestTime < nBestCandidateTime)
+		{
+			nBestCandidateTime = nBestTime;
+			pBestCandidate     = &*iterCandidate;
+		}
+	}
+	if (NULL != pBestCandidate)
+	{
+		m_mapParams[shape] = pBestCandidate->params;
+		*pParams           = pBestCandidate->params;
+		if (!m_sPath.empty())
+		{
+			//the params are still used for this run if the database cannot be written
+			Save();
+		}
+	}
+	else
+	{
+		status = Status(Status_NotFound, "No candidate could run at {1}:{2}", __FILE__, __LINE__);
+	}
+	ReleaseSRWLockExclusive(&m_srwlParams);
+
+	return status;
+}
+
+void Tuner::GetLocalSizes(UInt32 cGlobalSize, Size cMaxSize, Vector<UInt32>::Type *pVectorSizes)
+{
+	pVectorSizes->clear();
+	for (UInt32 cSize = 1; 0 < cSize && cSize <= cMaxSize && cSize <= cGlobalSize; cSize *= 2)
+	{
+		if (0 == cGlobalSize % cSize)
+		{
+			pVectorSizes->push_back(cSize);
+		}
+	}
+}
+
+UInt32 Tuner::GetSamplesBucket(UInt32 cCount)
+{
+	UInt32   cBucket = 1;
+
+	while (cBucket < cCount && cBucket < MAX_SAMPLES)
+	{
+		cBucket *= 2;
+	}
+
+	return cBucket;
+}
+
+UInt32 Tuner::FitLocalSize(UInt32 cLocalSize, UInt32 cGlobalSize)
+{
+	while (1 < cLocalSize && 0 != cGlobalSize % cLocalSize)
+	{
+		cLocalSize /= 2;
+	}
+
+	return cLocalSize;
+}
+
+Status Tuner::Load()
+{
+	IO::FileInputStream   fis(m_sPath.c_str());
+	Header                header;
+	Record                record;
+	UInt64                cbFileSize;
+	Size                  cbAckSize;
+	Status                status;
+
+	if (!fis.IsOK())
+	{
+		return Status(Status_OpenFailed, "Failed to open '{1}' at {2}:{3}", m_sPath, __FILE__, __LINE__);
+	}
+	if (!(status = fis.GetSize(&cbFileSize)))
+	{
+		return status;
+	}
+	if (!(status = fis.Read(&header, sizeof(header), &cbAckSize)))
+	{
+		return status;
+	}
+	if (sizeof(header) != cbAckSize || TUNE_MAGIC != header.nMagic || TUNE_VERSION != header.nVersion || 
+	    m_nKey != header.nKey || cbFileSize != sizeof(header) + (UInt64)header.cRecords * sizeof(Record))
+	{
+		return Status(Status_InvalidArg, "Invalid tuning database '{1}' at {2}:{3}", m_sPath, __FILE__, __LINE__);
+	}
+	for (UInt32 i = 0; i < header.cRecords; i++)
+	{
+		if (!(status = fis.Read(&record, sizeof(record), &cbAckSize)))
+		{
+			return status;
+		}
+		if (sizeof(record) != cbAckSize)
+		{
+			return Status(Status_ReadFailed, "Failed to read '{1}' at {2}:{3}", m_sPath, __FILE__, __LINE__);
+		}
+		m_mapParams[record.shape] = record.params;
+	}
+
+	return Status();
+}
+
+Status Tuner::Save()
+{
+	Header   header;
+	Record   record;
+	String   sTmpPath;
+	Size     cbAckSize;
+	Status   status;
+
+	header.nMagic    = TUNE_MAGIC;
+	header.nVersion  = TUNE_VERSION;
+	header.nKey      = m_nKey;
+	header.cRecords  = (UInt32)m_mapParams.size();
+	header.nReserved = 0;
+
+	//written under a process unique name and then renamed so concurrent processes never see a partial file
+	Print(&sTmpPath, "{1}.{2}.tmp", m_sPath, (UInt32)GetCurrentProcessId());
+	{
+		IO::FileOutputStream   fos(sTmpPath.c_str());
+
+		if (!fos.IsOK())
+		{
+			return Status(Status_CreateFailed, "Failed to create '{1}' at {2}:{3}", sTmpPath, __FILE__, __LINE__);
+		}
+		if ((status = fos.Write(&header, sizeof(header), &cbAckSize)) && sizeof(header) != cbAckSize)
+		{
+			status = Status(Status_WriteFailed, "Failed to write '{1}' at {2}:{3}", sTmpPath, __FILE__, __LINE__);
+		}
+		for (ParamsMap::iterator iter = m_mapParams.begin(); status && iter != m_mapParams.end(); ++iter)
+		{
+			record.shape  = iter->first;
+			record.params = iter->second;
+			if ((status = fos.Write(&record, sizeof(record), &cbAckSize)) && sizeof(record) != cbAckSize)
+			{
+				status = Status(Status_WriteFailed, "Failed to write '{1}' at {2}:{3}", sTmpPath, __FILE__, __LINE__);
+			}
+		}
+	}
+	if (status && !MoveFileExA(sTmpPath.c_str(), m_sPath.c_str(), MOVEFILE_REPLACE_EXISTING))
+	{
+		status = Status(Status_OperationFailed, "Failed to rename '{1}' with error {2} at {3}:{4}", sTmpPath, 
+		                (int)GetLastError(), __FILE__, __LINE__);
+	}
+	if (!status)
+	{
+		DeleteFileA(sTmpPath.c_str());
+	}
+
+	return status;
+}
+
+}//namespace CL
+
+}//namespace N2
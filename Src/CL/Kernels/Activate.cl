@@ -262,23 +262,19 @@ void kernel ActivateGaussian(global float *neurons, unsigned int cNeuronsOffset)
 	neurons[cNeuronsOffset + idx] = exp(- fValue * fValue);
 }
 
-void kernel ActivateSoftMax(global float *neurons, unsigned int cNeuronsOffset, float fExpSum) 
+//the sum spans all the neurons of a sample => one work-item per sample
+void kernel ActivateSoftMax(global float *neurons, unsigned int cNeuronsOffset, unsigned int cNeuronsCount) 
 {
-	unsigned int   idx    = get_global_id(0);
-	float          fValue = neurons[cNeuronsOffset + idx];
-	
-	neurons[cNeuronsOffset + idx] = exp(fValue) / fExpSum;
-}
+	unsigned int   cSample = get_global_id(0);
+	float          fExpSum = 0.0f;
 
-//not very efficient - single threaded
-void kernel ActivateSoftMaxExpSum(global float *neurons, unsigned int cNeuronsOffset, unsigned int cCount, 
-                                  global float *expsum) 
-{
-	float   fExpSum = 0.0f;
-
-	for (unsigned int i = 0; i < cCount; i++)
+	neurons += cNeuronsOffset + cSample * cNeuronsCount;
+	for (unsigned int k = 0; k < cNeuronsCount; k++)
+	{
+		fExpSum += exp(neurons[k]);
+	}
+	for (unsigned int k = 0; k < cNeuronsCount; k++)
 	{
-		fExpSum += exp(neurons[cNeuronsOffset + i]);
+		neurons[k] = exp(neurons[k]) / fExpSum;
 	}
-	expsum[0] = fExpSum;
 }
@@ -26,18 +26,22 @@
  * SOFTWARE.
  */
 
+//2-D range: dim 0 is the next neuron, dim 1 is the sample (neurons of consecutive samples are contiguous)
+
 void kernel Compute(const global float *prevNeurons, unsigned int cPrevNeuronsOffset, unsigned int cPrevNeuronsCount, 
                     const global float *weights, 
                     global float *nextNeurons, unsigned int cNextNeuronsOffset, unsigned int cNextNeuronsCount) 
 {
-	unsigned int   idx    = get_global_id(0);
-	float          fValue = 0.0f;
+	unsigned int   idx     = get_global_id(0);
+	unsigned int   cSample = get_global_id(1);
+	float          fValue  = 0.0f;
 
+	prevNeurons += cPrevNeuronsOffset + cSample * cPrevNeuronsCount;
 	for (unsigned int k = 0; k < cPrevNeuronsCount; k++)
 	{
-		fValue += prevNeurons[cPrevNeuronsOffset + k] * weights[k * cNextNeuronsCount + idx];
+		fValue += prevNeurons[k] * weights[k * cNextNeuronsCount + idx];
 	}
-	nextNeurons[cNextNeuronsOffset + idx] = fValue;
+	nextNeurons[cNextNeuronsOffset + cSample * cNextNeuronsCount + idx] = fValue;
 }
 
 void kernel ComputeWithBias(float fBias, 
@@ -45,13 +49,161 @@ void kernel ComputeWithBias(float fBias,
                       const global float *weights, const global float *biases, 
                       global float *nextNeurons, unsigned int cNextNeuronsOffset, unsigned int cNextNeuronsCount) 
 {
-	unsigned int   idx    = get_global_id(0);
-	float          fValue = 0.0f;
+	unsigned int   idx     = get_global_id(0);
+	unsigned int   cSample = get_global_id(1);
+	float          fValue  = 0.0f;
 
+	prevNeurons += cPrevNeuronsOffset + cSample * cPrevNeuronsCount;
 	for (unsigned int k = 0; k < cPrevNeuronsCount; k++)
 	{
-		fValue += prevNeurons[cPrevNeuronsOffset + k] * weights[k * cNextNeuronsCount + idx];
+		fValue += prevNeurons[k] * weights[k * cNextNeuronsCount + idx];
 	}
 	fValue += fBias * biases[idx];
-	nextNeurons[cNextNeuronsOffset + idx] = fValue;
+	nextNeurons[cNextNeuronsOffset + cSample * cNextNeuronsCount + idx] = fValue;
+}
+
+//tiled variants: each work-group computes a N2_TILE_SIZE (samples) x N2_TILE_SIZE (next neurons) block of outputs, 
+//staging the matching inputs and weights tiles in local memory; each work-item computes 4 consecutive next neurons 
+//of one sample; local range is (N2_TILE_SIZE / 4, N2_TILE_SIZE), global range is padded to it
+
+#ifndef N2_TILE_SIZE
+	#define N2_TILE_SIZE   16
+#endif
+
+#define N2_TILE_WIDTH   (N2_TILE_SIZE / 4)
+
+//loads values[cIndex .. cIndex + 3], zero past cCount
+inline float4 LoadFloat4(const global float *values, unsigned int cIndex, unsigned int cCount)
+{
+	float4   value = (float4)(0.0f);
+
+	if (cIndex + 4 <= cCount)
+	{
+		return vload4(0, values + cIndex);
+	}
+	if (cIndex + 0 < cCount)
+	{
+		value.s0 = values[cIndex + 0];
+	}
+	if (cIndex + 1 < cCount)
+	{
+		value.s1 = values[cIndex + 1];
+	}
+	if (cIndex + 2 < cCount)
+	{
+		value.s2 = values[cIndex + 2];
+	}
+
+	return value;
+}
+
+//stores value to values[cIndex .. cIndex + 3], skipping past cCount
+inline void StoreFloat4(global float *values, unsigned int cIndex, unsigned int cCount, float4 value)
+{
+	if (cIndex + 4 <= cCount)
+	{
+		vstore4(value, 0, values + cIndex);
+
+		return;
+	}
+	if (cIndex + 0 < cCount)
+	{
+		values[cIndex + 0] = value.s0;
+	}
+	if (cIndex + 1 < cCount)
+	{
+		values[cIndex + 1] = value.s1;
+	}
+	if (cIndex + 2 < cCount)
+	{
+		values[cIndex + 2] = value.s2;
+	}
+}
+
+inline float4 ComputeTile(const global float *prevNeurons, unsigned int cPrevNeuronsCount, 
+                          const global float *weights, unsigned int cNextNeuronsCount, unsigned int cSamplesCount, 
+                          local float4 prevTile[N2_TILE_SIZE][N2_TILE_WIDTH], 
+                          local float4 weightsTile[N2_TILE_SIZE][N2_TILE_WIDTH])
+{
+	unsigned int   lx      = get_local_id(0);
+	unsigned int   ly      = get_local_id(1);
+	unsigned int   cNeuron = get_global_id(0) * 4;
+	unsigned int   cSample = get_global_id(1);
+	float4         value   = (float4)(0.0f);
+	float4         prev;
+
+	for (unsigned int t = 0; t < cPrevNeuronsCount; t += N2_TILE_SIZE)
+	{
+		//row ly of the inputs tile is this work-item's sample, row ly of the weights tile is prev neuron t + ly
+		if (cSample < cSamplesCount)
+		{
+			prevTile[ly][lx] = LoadFloat4(prevNeurons + cSample * cPrevNeuronsCount, t + lx * 4, cPrevNeuronsCount);
+		}
+		else
+		{
+			prevTile[ly][lx] = (float4)(0.0f);
+		}
+		if (t + ly < cPrevNeuronsCount)
+		{
+			weightsTile[ly][lx] = LoadFloat4(weights + (t + ly) * cNextNeuronsCount, cNeuron, cNextNeuronsCount);
+		}
+		else
+		{
+			weightsTile[ly][lx] = (float4)(0.0f);
+		}
+		barrier(CLK_LOCAL_MEM_FENCE);
+		for (unsigned int k = 0; k < N2_TILE_WIDTH; k++)
+		{
+			prev   = prevTile[ly][k];
+			value += prev.s0 * weightsTile[k * 4 + 0][lx];
+			value += prev.s1 * weightsTile[k * 4 + 1][lx];
+			value += prev.s2 * weightsTile[k * 4 + 2][lx];
+			value += prev.s3 * weightsTile[k * 4 + 3][lx];
+		}
+		barrier(CLK_LOCAL_MEM_FENCE);
+	}
+
+	return value;
+}
+
+void kernel ComputeTiled(const global float *prevNeurons, unsigned int cPrevNeuronsOffset, 
+                         unsigned int cPrevNeuronsCount, 
+                         const global float *weights, 
+                         global float *nextNeurons, unsigned int cNextNeuronsOffset, unsigned int cNextNeuronsCount, 
+                         unsigned int cSamplesCount) 
+{
+	local float4   prevTile[N2_TILE_SIZE][N2_TILE_WIDTH];
+	local float4   weightsTile[N2_TILE_SIZE][N2_TILE_WIDTH];
+	unsigned int   cSample = get_global_id(1);
+	float4         value;
+
+	value = ComputeTile(prevNeurons + cPrevNeuronsOffset, cPrevNeuronsCount, weights, cNextNeuronsCount, cSamplesCount, 
+	                    prevTile, weightsTile);
+	if (cSample < cSamplesCount)
+	{
+		StoreFloat4(nextNeurons + cNextNeuronsOffset + cSample * cNextNeuronsCount, get_global_id(0) * 4, 
+		            cNextNeuronsCount, value);
+	}
+}
+
+void kernel ComputeWithBiasTiled(float fBias, 
+                         const global float *prevNeurons, unsigned int cPrevNeuronsOffset, 
+                         unsigned int cPrevNeuronsCount, 
+                         const global float *weights, const global float *biases, 
+                         global float *nextNeurons, unsigned int cNextNeuronsOffset, unsigned int cNextNeuronsCount, 
+                         unsigned int cSamplesCount) 
+{
+	local float4   prevTile[N2_TILE_SIZE][N2_TILE_WIDTH];
+	local float4   weightsTile[N2_TILE_SIZE][N2_TILE_WIDTH];
+	unsigned int   cSample = get_global_id(1);
+	float4         value;
+
+	value = ComputeTile(prevNeurons + cPrevNeuronsOffset, cPrevNeuronsCount, weights, cNextNeuronsCount, cSamplesCount, 
+	                    prevTile, weightsTile);
+	value += fBias * LoadFloat4(biases, get_global_id(0) * 4, cNextNeuronsCount);
+	if (cSample < cSamplesCount)
+	{
+		StoreFloat4(nextNeurons + cNextNeuronsOffset + cSample * cNextNeuronsCount, get_global_id(0) * 4, 
+		            cNextNeuronsCount, value);
+	}
 }
@@ -0,0 +1,496 @@
+//generated by embed.py from the .cl files in this directory - do not edit
+
+static const CX::Char EMBEDDED_COMPUTE_CL[] = 
+"/* \n"
+" * N2\n"
+" *\n"
+" * https://github.com/draede/n2\n"
+" * \n"
+" * Copyright (C) 2018 draede - draede [at] outlook [dot] com\n"
+" *\n"
+" * Released under the MIT License.\n"
+" * \n"
+" * Permission is hereby granted, free of charge, to any person obtaining a copy\n"
+" * of this software and associated documentation files (the \"Software\"), to deal\n"
+" * in the Software without restriction, including without limitation the rights\n"
+" * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell\n"
+" * copies of the Software, and to permit persons to whom the Software is\n"
+" * furnished to do so, subject to the following conditions:\n"
+" * \n"
+" * The above copyright notice and this permission notice shall be included in all\n"
+" * copies or substantial portions of the Software.\n"
+" * \n"
+" * THE SOFTWARE IS PROVIDED \"AS IS\", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR\n"
+" * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,\n"
+" * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE\n"
+" * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER\n"
+" * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,\n"
+" * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE\n"
+" * SOFTWARE.\n"
+" */\n"
+"\n"
+"//2-D range: dim 0 is the next neuron, dim 1 is the sample (neurons of consecutive samples are contiguous)\n"
+"\n"
+"void kernel Compute(const global float *prevNeurons, unsigned int cPrevNeuronsOffset, unsigned int cPrevNeuronsCount, \n"
+"                    const global float *weights, \n"
+"                    global float *nextNeurons, unsigned int cNextNeuronsOffset, unsigned int cNextNeuronsCount) \n"
+"{\n"
+"\tunsigned int   idx     = get_global_id(0);\n"
+"\tunsigned int   cSample = get_global_id(1);\n"
+"\tfloat          fValue  = 0.0f;\n"
+"\n"
+"\tprevNeurons += cPrevNeuronsOffset + cSample * cPrevNeuronsCount;\n"
+"\tfor (unsigned int k = 0; k < cPrevNeuronsCount; k++)\n"
+"\t{\n"
+"\t\tfValue += prevNeurons[k] * weights[k * cNextNeuronsCount + idx];\n"
+"\t}\n"
+"\tnextNeurons[cNextNeuronsOffset + cSample * cNextNeuronsCount + idx] = fValue;\n"
+"}\n"
+"\n"
+"void kernel ComputeWithBias(float fBias, \n"
+"                      const global float *prevNeurons, unsigned int cPrevNeuronsOffset, unsigned int cPrevNeuronsCount, \n"
+"                      const global float *weights, const global float *biases, \n"
+"                      global float *nextNeurons, unsigned int cNextNeuronsOffset, unsigned int cNextNeuronsCount) \n"
+"{\n"
+"\tunsigned int   idx     = get_global_id(0);\n"
+"\tunsigned int   cSample = get_global_id(1);\n"
+"\tfloat          fValue  = 0.0f;\n"
+"\n"
+"\tprevNeurons += cPrevNeuronsOffset + cSample * cPrevNeuronsCount;\n"
+"\tfor (unsigned int k = 0; k < cPrevNeuronsCount; k++)\n"
+"\t{\n"
+"\t\tfValue += prevNeurons[k] * weights[k * cNextNeuronsCount + idx];\n"
+"\t}\n"
+"\tfValue += fBias * biases[idx];\n"
+"\tnextNeurons[cNextNeuronsOffset + cSample * cNextNeuronsCount + idx] = fValue;\n"
+"}\n"
+"\n"
+"//tiled variants: each work-group computes a N2_TILE_SIZE (samples) x N2_TILE_SIZE (next neurons) block of outputs, \n"
+"//staging the matching inputs and weights tiles in local memory; each work-item computes 4 consecutive next neurons \n"
+"//of one sample; local range is (N2_TILE_SIZE / 4, N2_TILE_SIZE), global range is padded to it\n"
+"\n"
+"#ifndef N2_TILE_SIZE\n"
+"\t#define N2_TILE_SIZE   16\n"
+"#endif\n"
+"\n"
+"#define N2_TILE_WIDTH   (N2_TILE_SIZE / 4)\n"
+"\n"
+"//loads values[cIndex .. cIndex + 3], zero past cCount\n"
+"inline float4 LoadFloat4(const global float *values, unsigned int cIndex, unsigned int cCount)\n"
+"{\n"
+"\tfloat4   value = (float4)(0.0f);\n"
+"\n"
+"\tif (cIndex + 4 <= cCount)\n"
+"\t{\n"
+"\t\treturn vload4(0, values + cIndex);\n"
+"\t}\n"
+"\tif (cIndex + 0 < cCount)\n"
+"\t{\n"
+"\t\tvalue.s0 = values[cIndex + 0];\n"
+"\t}\n"
+"\tif (cIndex + 1 < cCount)\n"
+"\t{\n"
+"\t\tvalue.s1 = values[cIndex + 1];\n"
+"\t}\n"
+"\tif (cIndex + 2 < cCount)\n"
+"\t{\n"
+"\t\tvalue.s2 = values[cIndex + 2];\n"
+"\t}\n"
+"\n"
+"\treturn value;\n"
+"}\n"
+"\n"
+"//stores value to values[cIndex .. cIndex + 3], skipping past cCount\n"
+"inline void StoreFloat4(global float *values, unsigned int cIndex, unsigned int cCount, float4 value)\n"
+"{\n"
+"\tif (cIndex + 4 <= cCount)\n"
+"\t{\n"
+"\t\tvstore4(value, 0, values + cIndex);\n"
+"\n"
+"\t\treturn;\n"
+"\t}\n"
+"\tif (cIndex + 0 < cCount)\n"
+"\t{\n"
+"\t\tvalues[cIndex + 0] = value.s0;\n"
+"\t}\n"
+"\tif (cIndex + 1 < cCount)\n"
+"\t{\n"
+"\t\tvalues[cIndex + 1] = value.s1;\n"
+"\t}\n"
+"\tif (cIndex + 2 < cCount)\n"
+"\t{\n"
+"\t\tvalues[cIndex + 2] = value.s2;\n"
+"\t}\n"
+"}\n"
+"\n"
+"inline float4 ComputeTile(const global float *prevNeurons, unsigned int cPrevNeuronsCount, \n"
+"                          const global float *weights, unsigned int cNextNeuronsCount, unsigned int cSamplesCount, \n"
+"                          local float4 prevTile[N2_TILE_SIZE][N2_TILE_WIDTH], \n"
+"                          local float4 weightsTile[N2_TILE_SIZE][N2_TILE_WIDTH])\n"
+"{\n"
+"\tunsigned int   lx      = get_local_id(0);\n"
+"\tunsigned int   ly      = get_local_id(1);\n"
+"\tunsigned int   cNeuron = get_global_id(0) * 4;\n"
+"\tunsigned int   cSample = get_global_id(1);\n"
+"\tfloat4         value   = (float4)(0.0f);\n"
+"\tfloat4         prev;\n"
+"\n"
+"\tfor (unsigned int t = 0; t < cPrevNeuronsCount; t += N2_TILE_SIZE)\n"
+"\t{\n"
+"\t\t//row ly of the inputs tile is this work-item's sample, row ly of the weights tile is prev neuron t + ly\n"
+"\t\tif (cSample < cSamplesCount)\n"
+"\t\t{\n"
+"\t\t\tprevTile[ly][lx] = LoadFloat4(prevNeurons + cSample * cPrevNeuronsCount, t + lx * 4, cPrevNeuronsCount);\n"
+"\t\t}\n"
+"\t\telse\n"
+"\t\t{\n"
+"\t\t\tprevTile[ly][lx] = (float4)(0.0f);\n"
+"\t\t}\n"
+"\t\tif (t + ly < cPrevNeuronsCount)\n"
+"\t\t{\n"
+"\t\t\tweightsTile[ly][lx] = LoadFloat4(weights + (t + ly) * cNextNeuronsCount, cNeuron, cNextNeuronsCount);\n"
+"\t\t}\n"
+"\t\telse\n"
+"\t\t{\n"
+"\t\t\tweightsTile[ly][lx] = (float4)(0.0f);\n"
+"\t\t}\n"
+"\t\tbarrier(CLK_LOCAL_MEM_FENCE);\n"
+"\t\tfor (unsigned int k = 0; k < N2_TILE_WIDTH; k++)\n"
+"\t\t{\n"
+"\t\t\tprev   = prevTile[ly][k];\n"
+"\t\t\tvalue += prev.s0 * weightsTile[k * 4 + 0][lx];\n"
+"\t\t\tvalue += prev.s1 * weightsTile[k * 4 + 1][lx];\n"
+"\t\t\tvalue += prev.s2 * weightsTile[k * 4 + 2][lx];\n"
+"\t\t\tvalue += prev.s3 * weightsTile[k * 4 + 3][lx];\n"
+"\t\t}\n"
+"\t\tbarrier(CLK_LOCAL_MEM_FENCE);\n"
+"\t}\n"
+"\n"
+"\treturn value;\n"
+"}\n"
+"\n"
+"void kernel ComputeTiled(const global float *prevNeurons, unsigned int cPrevNeuronsOffset, \n"
+"                         unsigned int cPrevNeuronsCount, \n"
+"                         const global float *weights, \n"
+"                         global float *nextNeurons, unsigned int cNextNeuronsOffset, unsigned int cNextNeuronsCount, \n"
+"                         unsigned int cSamplesCount) \n"
+"{\n"
+"\tlocal float4   prevTile[N2_TILE_SIZE][N2_TILE_WIDTH];\n"
+"\tlocal float4   weightsTile[N2_TILE_SIZE][N2_TILE_WIDTH];\n"
+"\tunsigned int   cSample = get_global_id(1);\n"
+"\tfloat4         value;\n"
+"\n"
+"\tvalue = ComputeTile(prevNeurons + cPrevNeuronsOffset, cPrevNeuronsCount, weights, cNextNeuronsCount, cSamplesCount, \n"
+"\t                    prevTile, weightsTile);\n"
+"\tif (cSample < cSamplesCount)\n"
+"\t{\n"
+"\t\tStoreFloat4(nextNeurons + cNextNeuronsOffset + cSample * cNextNeuronsCount, get_global_id(0) * 4, \n"
+"\t\t            cNextNeuronsCount, value);\n"
+"\t}\n"
+"}\n"
+"\n"
+"void kernel ComputeWithBiasTiled(float fBias, \n"
+"                         const global float *prevNeurons, unsigned int cPrevNeuronsOffset, \n"
+"                         unsigned int cPrevNeuronsCount, \n"
+"                         const global float *weights, const global float *biases, \n"
+"                         global float *nextNeurons, unsigned int cNextNeuronsOffset, unsigned int cNextNeuronsCount, \n"
+"                         unsigned int cSamplesCount) \n"
+"{\n"
+"\tlocal float4   prevTile[N2_TILE_SIZE][N2_TILE_WIDTH];\n"
+"\tlocal float4   weightsTile[N2_TILE_SIZE][N2_TILE_WIDTH];\n"
+"\tunsigned int   cSample = get_global_id(1);\n"
+"\tfloat4         value;\n"
+"\n"
+"\tvalue = ComputeTile(prevNeurons + cPrevNeuronsOffset, cPrevNeuronsCount, weights, cNextNeuronsCount, cSamplesCount, \n"
+"\t                    prevTile, weightsTile);\n"
+"\tvalue += fBias * LoadFloat4(biases, get_global_id(0) * 4, cNextNeuronsCount);\n"
+"\tif (cSample < cSamplesCount)\n"
+"\t{\n"
+"\t\tStoreFloat4(nextNeurons + cNextNeuronsOffset + cSample * cNextNeuronsCount, get_global_id(0) * 4, \n"
+"\t\t            cNextNeuronsCount, value);\n"
+"\t}\n"
+"}\n"
+;
+
+static const CX::Char EMBEDDED_ACTIVATE_CL[] = 
+"/* \n"
+" * N2\n"
+" *\n"
+" * https://github.com/draede/n2\n"
+" * \n"
+" * Copyright (C) 2018 draede - draede [at] outlook [dot] com\n"
+" *\n"
+" * Released under the MIT License.\n"
+" * \n"
+" * Permission is hereby granted, free of charge, to any person obtaining a copy\n"
+" * of this software and associated documentation files (the \"Software\"), to deal\n"
+" * in the Software without restriction, including without limitation the rights\n"
+" * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell\n"
+" * copies of the Software, and to permit persons to whom the Software is\n"
+" * furnished to do so, subject to the following conditions:\n"
+" * \n"
+" * The above copyright notice and this permission notice shall be included in all\n"
+" * copies or substantial portions of the Software.\n"
+" * \n"
+" * THE SOFTWARE IS PROVIDED \"AS IS\", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR\n"
+" * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,\n"
+" * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE\n"
+" * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER\n"
+" * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,\n"
+" * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE\n"
+" * SOFTWARE.\n"
+" */\n"
+"\n"
+"\n"
+"//remake this to match exactly the activations from keras\n"
+"\n"
+"void kernel ActivateSigmoid(global float *neurons, unsigned int cNeuronsOffset) \n"
+"{\n"
+"\tunsigned int   idx    = get_global_id(0);\n"
+"\tfloat          fValue = neurons[cNeuronsOffset + idx];\n"
+"\t\n"
+"\tneurons[cNeuronsOffset + idx] = 1.0f / (1.0f + exp(-fValue));\n"
+"}\n"
+"\n"
+"void kernel ActivateBinaryStep(global float *neurons, unsigned int cNeuronsOffset) \n"
+"{\n"
+"\tunsigned int   idx    = get_global_id(0);\n"
+"\tfloat          fValue = neurons[cNeuronsOffset + idx];\n"
+"\t\n"
+"\tif (0.0f > fValue)\n"
+"\t{\n"
+"\t\tneurons[cNeuronsOffset + idx] = 0.0f;\n"
+"\t}\n"
+"\telse\n"
+"\t{\n"
+"\t\tneurons[cNeuronsOffset + idx] = 1.0f;\n"
+"\t}\n"
+"}\n"
+"\n"
+"void kernel ActivateTanH(global float *neurons, unsigned int cNeuronsOffset) \n"
+"{\n"
+"\tunsigned int   idx    = get_global_id(0);\n"
+"\tfloat          fValue = neurons[cNeuronsOffset + idx];\n"
+"\t\n"
+"\tneurons[cNeuronsOffset + idx] = tanh(fValue);\n"
+"}\n"
+"\n"
+"void kernel ActivateArcTan(global float *neurons, unsigned int cNeuronsOffset) \n"
+"{\n"
+"\tunsigned int   idx    = get_global_id(0);\n"
+"\tfloat          fValue = neurons[cNeuronsOffset + idx];\n"
+"\t\n"
+"\tneurons[cNeuronsOffset + idx] = atan(fValue);\n"
+"}\n"
+"\n"
+"void kernel ActivateSoftSign(global float *neurons, unsigned int cNeuronsOffset) \n"
+"{\n"
+"\tunsigned int   idx    = get_global_id(0);\n"
+"\tfloat          fValue = neurons[cNeuronsOffset + idx];\n"
+"\t\n"
+"\tif (0.0f > fValue)\n"
+"\t{\n"
+"\t\tneurons[cNeuronsOffset + idx] = fValue / (1.0f + -fValue);\n"
+"\t}\n"
+"\telse\n"
+"\t{\n"
+"\t\tneurons[cNeuronsOffset + idx] = fValue / (1.0f + fValue);\n"
+"\t}\n"
+"}\n"
+"\n"
+"void kernel ActivateISRU(global float *neurons, unsigned int cNeuronsOffset, float fAlpha) \n"
+"{\n"
+"\tunsigned int   idx    = get_global_id(0);\n"
+"\tfloat          fValue = neurons[cNeuronsOffset + idx];\n"
+"\t\n"
+"\tneurons[cNeuronsOffset + idx] = fValue / sqrt(1.0f + fAlpha * fValue * fValue);\n"
+"}\n"
+"\n"
+"void kernel ActivateRELU(global float *neurons, unsigned int cNeuronsOffset) \n"
+"{\n"
+"\tunsigned int   idx    = get_global_id(0);\n"
+"\tfloat          fValue = neurons[cNeuronsOffset + idx];\n"
+"\t\n"
+"\tif (0.0f > fValue)\n"
+"\t{\n"
+"\t\tneurons[cNeuronsOffset + idx] = 0.0f;\n"
+"\t}\n"
+"\telse\n"
+"\t{\n"
+"\t\tneurons[cNeuronsOffset + idx] = fValue;\n"
+"\t}\n"
+"}\n"
+"\n"
+"void kernel ActivateLeakyRELU(global float *neurons, unsigned int cNeuronsOffset) \n"
+"{\n"
+"\tunsigned int   idx    = get_global_id(0);\n"
+"\tfloat          fValue = neurons[cNeuronsOffset + idx];\n"
+"\t\n"
+"\tneurons[cNeuronsOffset + idx] = 0.01f * fValue;\n"
+"}\n"
+"\n"
+"void kernel ActivatePRELU(global float *neurons, unsigned int cNeuronsOffset, float fAlpha) \n"
+"{\n"
+"\tunsigned int   idx    = get_global_id(0);\n"
+"\tfloat          fValue = neurons[cNeuronsOffset + idx];\n"
+"\t\n"
+"\tif (0.0f > fValue)\n"
+"\t{\n"
+"\t\tneurons[cNeuronsOffset + idx] = fAlpha * fValue;\n"
+"\t}\n"
+"\telse\n"
+"\t{\n"
+"\t\tneurons[cNeuronsOffset + idx] = fValue;\n"
+"\t}\n"
+"}\n"
+"\n"
+"void kernel ActivateELU(global float *neurons, unsigned int cNeuronsOffset, float fAlpha) \n"
+"{\n"
+"\tunsigned int   idx    = get_global_id(0);\n"
+"\tfloat          fValue = neurons[cNeuronsOffset + idx];\n"
+"\t\n"
+"\tif (0.0f > fValue)\n"
+"\t{\n"
+"\t\tneurons[cNeuronsOffset + idx] = fAlpha * (exp(fValue) - 1.0f);\n"
+"\t}\n"
+"\telse\n"
+"\t{\n"
+"\t\tneurons[cNeuronsOffset + idx] = fValue;\n"
+"\t}\n"
+"}\n"
+"\n"
+"void kernel ActivateSELU(global float *neurons, unsigned int cNeuronsOffset, float fAlpha, float fLambda) \n"
+"{\n"
+"\tunsigned int   idx    = get_global_id(0);\n"
+"\tfloat          fValue = neurons[cNeuronsOffset + idx];\n"
+"\t\n"
+"\tif (0.0f > fValue)\n"
+"\t{\n"
+"\t\tneurons[cNeuronsOffset + idx] = fLambda * fAlpha * (exp(fValue) - 1.0f);\n"
+"\t}\n"
+"\telse\n"
+"\t{\n"
+"\t\tneurons[cNeuronsOffset + idx] = fLambda * fValue;\n"
+"\t}\n"
+"}\n"
+"\n"
+"void kernel ActivateSRELU(global float *neurons, unsigned int cNeuronsOffset, float fTl, float fAl, float fTr, \n"
+"                          float fAr) \n"
+"{\n"
+"\tunsigned int   idx    = get_global_id(0);\n"
+"\tfloat          fValue = neurons[cNeuronsOffset + idx];\n"
+"\t\n"
+"\tif (fValue <= fTl)\n"
+"\t{\n"
+"\t\tneurons[cNeuronsOffset + idx] = fTl + fAl * (fValue - fTl);\n"
+"\t}\n"
+"\telse\n"
+"\tif (fValue >= fTr)\n"
+"\t{\n"
+"\t\tneurons[cNeuronsOffset + idx] = fTr + fAr * (fValue - fTr);\n"
+"\t}\n"
+"\telse\n"
+"\t{\n"
+"\t\tneurons[cNeuronsOffset + idx] = fValue;\n"
+"\t}\n"
+"}\n"
+"\n"
+"void kernel ActivateISRLU(global float *neurons, unsigned int cNeuronsOffset, float fAlpha) \n"
+"{\n"
+"\tunsigned int   idx    = get_global_id(0);\n"
+"\tfloat          fValue = neurons[cNeuronsOffset + idx];\n"
+"\t\n"
+"\tif (0.0f > fValue)\n"
+"\t{\n"
+"\t\tneurons[cNeuronsOffset + idx] = fValue / sqrt(1.0f + fAlpha * fValue * fValue);\n"
+"\t}\n"
+"\telse\n"
+"\t{\n"
+"\t\tneurons[cNeuronsOffset + idx] = fValue;\n"
+"\t}\n"
+"}\n"
+"\n"
+"void kernel ActivateSoftPlus(global float *neurons, unsigned int cNeuronsOffset) \n"
+"{\n"
+"\tunsigned int   idx    = get_global_id(0);\n"
+"\tfloat          fValue = neurons[cNeuronsOffset + idx];\n"
+"\t\n"
+"\tneurons[cNeuronsOffset + idx] = log(1.0f + fValue);\n"
+"}\n"
+"\n"
+"void kernel ActivateBentIdentity(global float *neurons, unsigned int cNeuronsOffset) \n"
+"{\n"
+"\tunsigned int   idx    = get_global_id(0);\n"
+"\tfloat          fValue = neurons[cNeuronsOffset + idx];\n"
+"\t\n"
+"\tneurons[cNeuronsOffset + idx] = (sqrt(fValue * fValue + 1.0f) - 1.0f) / 2.0f + fValue;\n"
+"}\n"
+"\n"
+"void kernel ActivateSoftExponential(global float *neurons, unsigned int cNeuronsOffset, float fAlpha) \n"
+"{\n"
+"\tunsigned int   idx    = get_global_id(0);\n"
+"\tfloat          fValue = neurons[cNeuronsOffset + idx];\n"
+"\t\n"
+"\tif (0.0f > fAlpha)\n"
+"\t{\n"
+"\t\tneurons[cNeuronsOffset + idx] = -log(1.0f - fAlpha * (fValue + fAlpha)) / fAlpha;\n"
+"\t}\n"
+"\telse\n"
+"\tif (0.0f < fAlpha)\n"
+"\t{\n"
+"\t\tneurons[cNeuronsOffset + idx] = (exp(fAlpha * fValue) - 1.0f) / fAlpha + fAlpha;\n"
+"\t}\n"
+"\telse\n"
+"\t{\n"
+"\t\tneurons[cNeuronsOffset + idx] = fValue;\n"
+"\t}\n"
+"}\n"
+"\n"
+"void kernel ActivateSinusoid(global float *neurons, unsigned int cNeuronsOffset) \n"
+"{\n"
+"\tunsigned int   idx    = get_global_id(0);\n"
+"\tfloat          fValue = neurons[cNeuronsOffset + idx];\n"
+"\t\n"
+"\tneurons[cNeuronsOffset + idx] = sin(fValue);\n"
+"}\n"
+"\n"
+"void kernel ActivateSINC(global float *neurons, unsigned int cNeuronsOffset) \n"
+"{\n"
+"\tunsigned int   idx    = get_global_id(0);\n"
+"\tfloat          fValue = neurons[cNeuronsOffset + idx];\n"
+"\t\n"
+"\tif (0.0f == fValue)\n"
+"\t{\n"
+"\t\tneurons[cNeuronsOffset + idx] = 1.0f;\n"
+"\t}\n"
+"\telse\n"
+"\t{\n"
+"\t\tneurons[cNeuronsOffset + idx] = sin(fValue) / fValue;\n"
+"\t}\n"
+"}\n"
+"\n"
+"void kernel ActivateGaussian(global float *neurons, unsigned int cNeuronsOffset) \n"
+"{\n"
+"\tunsigned int   idx    = get_global_id(0);\n"
+"\tfloat          fValue = neurons[cNeuronsOffset + idx];\n"
+"\t\n"
+"\tneurons[cNeuronsOffset + idx] = exp(- fValue * fValue);\n"
+"}\n"
+"\n"
+"//the sum spans all the neurons of a sample => one work-item per sample\n"
+"void kernel ActivateSoftMax(global float *neurons, unsigned int cNeuronsOffset, unsigned int cNeuronsCount) \n"
+"{\n"
+"\tunsigned int   cSample = get_global_id(0);\n"
+"\tfloat          fExpSum = 0.0f;\n"
+"\n"
+"\tneurons += cNeuronsOffset + cSample * cNeuronsCount;\n"
+"\tfor (unsigned int k = 0; k < cNeuronsCount; k++)\n"
+"\t{\n"
+"\t\tfExpSum += exp(neurons[k]);\n"
+"\t}\n"
+"\tfor (unsigned int k = 0; k < cNeuronsCount; k++)\n"
+"\t{\n"
+"\t\tneurons[k] = exp(neurons[k]) / fExpSum;\n"
+"\t}\n"
+"}\n"
+;
@@ -0,0 +1,34 @@
+
+# generates Kernels.inl (the kernel sources as string literals) for builds with N2_CL_EMBED_KERNELS defined
+# run it again after changing any of the .cl files in this directory
+
+import os
+
+
+KERNELS = [("Compute.cl", "EMBEDDED_COMPUTE_CL"), ("Activate.cl", "EMBEDDED_ACTIVATE_CL")]
+
+MAX_LITERAL_LEN = 65535 # MSVC limit for a concatenated string literal
+
+
+def Escape(line):
+	return line.replace("\\", "\\\\").replace("\"", "\\\"").replace("\t", "\\t")
+
+
+def Embed(dir, filename):
+	out = open(filename, "w", newline = "\r\n")
+
+	out.write("//generated by embed.py from the .cl files in this directory - do not edit\n")
+	for (name, symbol) in KERNELS:
+		source = open(os.path.join(dir, name), "r").read()
+		if MAX_LITERAL_LEN <= len(source):
+			raise Exception("%s is too large to embed" % name)
+		out.write("\nstatic const CX::Char %s[] = \n" % symbol)
+		for line in source.splitlines():
+			out.write("\"%s\\n\"\n" % Escape(line))
+		out.write(";\n")
+	out.close()
+
+
+if __name__ == "__main__":
+	dir = os.path.dirname(os.path.abspath(__file__))
+	Embed(dir, os.path.join(dir, "Kernels.inl"))
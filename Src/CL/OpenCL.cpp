@@ -243,6 +243,25 @@ Status OpenCL::ChooseDeviceByTypeAndIndex(std::vector<cl::Device> *pVectorDevice
 	return Status();
 }
 
+Status OpenCL::CreateSubDevices(cl::Device *pDevice, const cl_device_partition_property *pProperties, 
+                                std::vector<cl::Device> *pVectorSubDevices)
+{
+	cl_int   nError;
+
+	pVectorSubDevices->clear();
+	if (CL_SUCCESS != (nError = pDevice->createSubDevices(pProperties, pVectorSubDevices)))
+	{
+		return Status(Status_NotSupported, "Failed to create sub-devices with error {1} at {2}:{3}", nError, 
+		              __FILE__, __LINE__);
+	}
+	if (pVectorSubDevices->empty())
+	{
+		return Status(Status_NotFound, "No sub-devices created at {1}:{2}", __FILE__, __LINE__);
+	}
+
+	return Status();
+}
+
 }//namespace CL
 
 }//namespace N2
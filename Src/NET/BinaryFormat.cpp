@@ -289,6 +289,11 @@ Status BinaryFormat::LoadSynapses(Network *pNetwork, const Char *szPath)
 			return Status(Status_InvalidArg, "Invalid prev neurons count {1} at {2}:{3}", cNextNeurons, __FILE__, 
 			              __LINE__);
 		}
+		//a previously mapped file is read-only
+		if (!(status = pSynapses->MakeWritable()))
+		{
+			return status;
+		}
 		if (!(status = Read(&is, pSynapses->GetWeights(), sizeof(Float) * pSynapses->GetWeightsCount())))
 		{
 			return status;
@@ -309,6 +314,7 @@ Status BinaryFormat::LoadSynapses(Network *pNetwork, const Char *szPath)
 				return status;
 			}
 		}
+		pSynapses->MarkAllDirty();
 		if (NULL == pSynapses->GetNextNeurons())
 		{
 			break;
@@ -319,6 +325,156 @@ Status BinaryFormat::LoadSynapses(Network *pNetwork, const Char *szPath)
 	return Status();
 }
 
+Status BinaryFormat::MapSynapses(Network *pNetwork, const Char *szPath)
+{
+	if (!pNetwork->IsOK())
+	{
+		return Status(Status_InvalidArg, "Invalid arg at {1}:{2}", __FILE__, __LINE__);
+	}
+
+	struct MappedSynapses
+	{
+		Synapses      *pSynapses;
+		const Float   *weights;
+		const Float   *biases;
+	};
+
+	MappedFile                      *pFile;
+	Vector<MappedSynapses>::Type    vectorMapped;
+	MappedSynapses                  mapped;
+	Synapses                        *pSynapses;
+	const void                      *pData;
+	UInt64                          cbOffset;
+	UInt8                           uInt8;
+	UInt32                          uInt32;
+	UInt32                          cLayers;
+	UInt32                          cPrevNeurons;
+	UInt32                          cNextNeurons;
+	Status                          status;
+
+	if (NULL == (pFile = new (std::nothrow) MappedFile()))
+	{
+		return Status(Status_MemAllocFailed, "Failed to allocate mapped file at {1}:{2}", __FILE__, __LINE__);
+	}
+	//the whole file is validated before any synapses points into it
+	cbOffset = 0;
+	for (;;)
+	{
+		if (!(status = pFile->Open(szPath)))
+		{
+			break;
+		}
+		if (!(status = Read(pFile, &cbOffset, &uInt32)))
+		{
+			break;
+		}
+		if (SYNAPSES_MAGIC != uInt32)
+		{
+			status = Status(Status_OpenFailed, "Invalid magic {1} at {2}:{3}", uInt32, __FILE__, __LINE__);
+
+			break;
+		}
+		if (!(status = Read(pFile, &cbOffset, &uInt32)))
+		{
+			break;
+		}
+		if (SYNAPSES_VERSION != uInt32)
+		{
+			status = Status(Status_OpenFailed, "Invalid version {1} at {2}:{3}", uInt32, __FILE__, __LINE__);
+
+			break;
+		}
+		if (!(status = Read(pFile, &cbOffset, &uInt32)))
+		{
+			break;
+		}
+		if (!(status = Read(pFile, &cbOffset, &cLayers)))
+		{
+			break;
+		}
+		if (cLayers != pNetwork->GetLayersCount())
+		{
+			status = Status(Status_InvalidArg, "Invalid layers count {1} at {2}:{3}", cLayers, __FILE__, __LINE__);
+
+			break;
+		}
+		pSynapses = pNetwork->GetInputNeurons()->GetNextSynapses();
+		for (UInt32 i = 0; i < cLayers && NULL != pSynapses; i++)
+		{
+			if (!(status = Read(pFile, &cbOffset, &uInt8)))
+			{
+				break;
+			}
+			if (1 < uInt8)
+			{
+				status = Status(Status_InvalidArg, "Invalid bias {1} at {2}:{3}", uInt8, __FILE__, __LINE__);
+
+				break;
+			}
+			if (!(status = Read(pFile, &cbOffset, &cPrevNeurons)))
+			{
+				break;
+			}
+			if (!(status = Read(pFile, &cbOffset, &cNextNeurons)))
+			{
+				break;
+			}
+			if (cPrevNeurons != pSynapses->GetPrevNeuronsCount() || cNextNeurons != pSynapses->GetNextNeuronsCount())
+			{
+				status = Status(Status_InvalidArg, "Invalid neurons count {1} x {2} at {3}:{4}", cPrevNeurons, 
+				                cNextNeurons, __FILE__, __LINE__);
+
+				break;
+			}
+			//v1 payloads are not aligned; the engines copy them (x86 loads do not need the alignment anyway)
+			if (!(status = Skip(pFile, &cbOffset, sizeof(Float) * pSynapses->GetWeightsCount(), &pData)))
+			{
+				break;
+			}
+			mapped.pSynapses = pSynapses;
+			mapped.weights   = (const Float *)pData;
+			mapped.biases    = NULL;
+			if (1 == uInt8)
+			{
+				if (!(status = Read(pFile, &cbOffset, &cNextNeurons)))
+				{
+					break;
+				}
+				if (cNextNeurons != pSynapses->GetNextNeuronsCount())
+				{
+					status = Status(Status_InvalidArg, "Invalid biases count {1} at {2}:{3}", cNextNeurons, __FILE__, 
+					                __LINE__);
+
+					break;
+				}
+				if (!(status = Skip(pFile, &cbOffset, sizeof(Float) * cNextNeurons, &pData)))
+				{
+					break;
+				}
+				mapped.biases = (const Float *)pData;
+			}
+			vectorMapped.push_back(mapped);
+			pSynapses = (NULL != pSynapses->GetNextNeurons() ? pSynapses->GetNextNeurons()->GetNextSynapses() : NULL);
+		}
+
+		break;
+	}
+	if (!status)
+	{
+		delete pFile;
+
+		return status;
+	}
+	for (auto iter = vectorMapped.begin(); iter != vectorMapped.end(); ++iter)
+	{
+		iter->pSynapses->SetExternalStorage(iter->weights, iter->biases);
+	}
+	//the synapses no longer point into the previous mapping (if any), which is closed here
+	pNetwork->SetMappedFile(pFile);
+
+	return Status();
+}
+
 Status BinaryFormat::SaveSynapses(const Network *pNetwork, const Char *szPath)
 {
 	if (!pNetwork->IsOK())
@@ -417,6 +573,32 @@ Status BinaryFormat::Write(IO::IOutputStream *pOutputStream, const void *pData,
 	return Status();
 }
 
+Status BinaryFormat::Read(const MappedFile *pFile, UInt64 *pcbOffset, void *pData, Size cbSize)
+{
+	const void   *pSrc;
+	Status       status;
+
+	if (!(status = Skip(pFile, pcbOffset, cbSize, &pSrc)))
+	{
+		return status;
+	}
+	memcpy(pData, pSrc, cbSize);
+
+	return Status();
+}
+
+Status BinaryFormat::Skip(const MappedFile *pFile, UInt64 *pcbOffset, UInt64 cbSize, const void **ppData)
+{
+	if (*pcbOffset > pFile->GetSize() || cbSize > pFile->GetSize() - *pcbOffset)
+	{
+		return Status(Status_ReadFailed, "Failed to read file at {1}:{2}", __FILE__, __LINE__);
+	}
+	*ppData     = pFile->GetData() + *pcbOffset;
+	*pcbOffset += cbSize;
+
+	return Status();
+}
+
 Status BinaryFormat::Read(IO::IInputStream *pInputStream, void *pData, CX::Size cbSize)
 {
 	Size     cbAckSize;
@@ -0,0 +1,233 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "N2/NET/CRC32C.hpp"
+#include <intrin.h>
+#include <nmmintrin.h>
+
+
+using namespace CX;
+
+
+namespace N2
+{
+
+namespace NET
+{
+
+//reflected Castagnoli polynomial
+static const UInt32 CRC32C_POLYNOMIAL = 0x82F63B78;
+
+struct CRC32CTable
+{
+	UInt32   values[256];
+
+	CRC32CTable()
+	{
+		for (UInt32 i = 0; i < 256; i++)
+		{
+			UInt32   nValue = i;
+
+			for (UInt32 j = 0; j < 8; j++)
+			{
+				nValue = (nValue >> 1) ^ (0 != (nValue & 1) ? CRC32C_POLYNOMIAL : 0);
+			}
+			values[i] = nValue;
+		}
+	}
+};
+
+struct CRC32CSupport
+{
+	Bool   bHardware;
+
+	CRC32CSupport()
+	{
+		int   info[4];
+
+		//CPUID.01H:ECX.SSE4_2[bit 20]
+		__cpuid(info, 1);
+		bHardware = (0 != (info[2] & (1 << 20)));
+	}
+};
+
+CRC32C::CRC32C()
+{
+}
+
+CRC32C::~CRC32C()
+{
+}
+
+Bool CRC32C::HasHardwareSupport()
+{
+	static const CRC32CSupport   support;
+
+	return support.bHardware;
+}
+
+UInt32 CRC32C::Compute(const void *pData, Size cbSize, UInt32 nCRC/* = 0*/)
+{
+	if (HasHardwareSupport())
+	{
+		return ComputeHardware((const Byte *)pData, cbSize, nCRC);
+	}
+	else
+	{
+		return ComputeSoftware((const Byte *)pData, cbSize, nCRC);
+	}
+}
+
+UInt32 CRC32C::ComputeHardware(const Byte *pData, Size cbSize, UInt32 nCRC)
+{
+	UInt32   nValue = ~nCRC;
+
+	//bytes up to an 8 bytes boundary, then 8 bytes per instruction
+	while (0 < cbSize && 0 != ((Size)pData & 7))
+	{
+		nValue = _mm_crc32_u8(nValue, *pData++);
+		cbSize--;
+	}
+#ifdef _WIN64
+	UInt64   nValue64 = nValue;
+
+	while (8 <= cbSize)
+	{
+		nValue64 = _mm_crc32_u64(nValue64, *(const UInt64 *)pData);
+		pData   += 8;
+		cbSize  -= 8;
+	}
+	nValue = (UInt32)nValue64;
+#else
+	while (4 <= cbSize)
+	{
+		nValue  = _mm_crc32_u32(nValue, *(const UInt32 *)pData);
+		pData  += 4;
+		cbSize -= 4;
+	}
+#endif
+	while (0 < cbSize)
+	{
+		nValue = _mm_crc32_u8(nValue, *pData++);
+		cbSize--;
+	}
+
+	return ~nValue;
+}
+
+UInt32 CRC32C::ComputeSoftware(const Byte *pData, Size cbSize, UInt32 nCRC)
+{
+	static const CRC32CTable   table;
+
+	UInt32   nValue = ~nCRC;
+
+	while (0 < cbSize)
+	{
+		nValue = (nValue >> 8) ^ table.values[(nValue ^ *pData++) & 0xFF];
+		cbSize--;
+	}
+
+	return ~nValue;
+}
+
+//appending cbSize2 zero bytes to A is a linear operator over GF(2) applied to its CRC, computed by repeated squaring 
+//of the single zero bit operator (as zlib's crc32_combine)
+UInt32 CRC32C::Combine(UInt32 nCRC1, UInt32 nCRC2, UInt64 cbSize2)
+{
+	UInt32   even[32];
+	UInt32   odd[32];
+	UInt32   nRow;
+
+	if (0 == cbSize2)
+	{
+		return nCRC1;
+	}
+	odd[0] = CRC32C_POLYNOMIAL;
+	nRow   = 1;
+	for (UInt32 i = 1; i < 32; i++)
+	{
+		odd[i] = nRow;
+		nRow <<= 1;
+	}
+	SquareMatrix(even, odd);
+	SquareMatrix(odd, even);
+	for (;;)
+	{
+		SquareMatrix(even, odd);
+		if (0 != (cbSize2 & 1))
+		{
+			nCRC1 = MultiplyMatrix(even, nCRC1);
+		}
+		cbSize2 >>= 1;
+		if (0 == cbSize2)
+		{
+			break;
+		}
+		SquareMatrix(odd, even);
+		if (0 != (cbSize2 & 1))
+		{
+			nCRC1 = MultiplyMatrix(odd, nCRC1);
+		}
+		cbSize2 >>= 1;
+		if (0 == cbSize2)
+		{
+			break;
+		}
+	}
+
+	return nCRC1 ^ nCRC2;
+}
+
+UInt32 CRC32C::MultiplyMatrix(const UInt32 *matrix, UInt32 nVector)
+{
+	UInt32   nSum = 0;
+
+	while (0 != nVector)
+	{
+		if (0 != (nVector & 1))
+		{
+			nSum ^= *matrix;
+		}
+		nVector >>= 1;
+		matrix++;
+	}
+
+	return nSum;
+}
+
+void CRC32C::SquareMatrix(UInt32 *square, const UInt32 *matrix)
+{
+	for (UInt32 i = 0; i < 32; i++)
+	{
+		square[i] = MultiplyMatrix(matrix, matrix[i]);
+	}
+}
+
+}//namespace NET
+
+}//namespace N2
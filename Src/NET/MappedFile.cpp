@@ -0,0 +1,202 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "N2/NET/MappedFile.hpp"
+
+
+using namespace CX;
+
+
+namespace N2
+{
+
+namespace NET
+{
+
+//WIN32_MEMORY_RANGE_ENTRY
+struct PrefetchRange
+{
+	void     *pAddress;
+	SIZE_T   cbSize;
+};
+
+typedef BOOL (WINAPI *PrefetchVirtualMemoryProc)(HANDLE hProcess, ULONG_PTR cEntries, PrefetchRange *entries, 
+                                                 ULONG nFlags);
+
+//PrefetchVirtualMemory is resolved at run time (Windows 8+)
+struct PrefetchSupport
+{
+	PrefetchVirtualMemoryProc   pfnPrefetchVirtualMemory;
+
+	PrefetchSupport()
+	{
+		HMODULE   hKernel32;
+
+		pfnPrefetchVirtualMemory = NULL;
+		if (NULL != (hKernel32 = GetModuleHandleA("kernel32.dll")))
+		{
+			pfnPrefetchVirtualMemory = (PrefetchVirtualMemoryProc)GetProcAddress(hKernel32, "PrefetchVirtualMemory");
+		}
+	}
+};
+
+MappedFile::MappedFile()
+{
+	m_hFile    = INVALID_HANDLE_VALUE;
+	m_hMapping = NULL;
+	m_pData    = NULL;
+	m_cbSize   = 0;
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+Status MappedFile::Open(const Char *szPath)
+{
+	Close();
+
+	LARGE_INTEGER   liSize;
+	Status          status;
+
+	for (;;)
+	{
+		if (INVALID_HANDLE_VALUE == (m_hFile = CreateFileA(szPath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, 
+		                                                   FILE_ATTRIBUTE_NORMAL, NULL)))
+		{
+			status = Status(Status_OpenFailed, "Failed to open '{1}' with error {2} at {3}:{4}", szPath, 
+			                (int)GetLastError(), __FILE__, __LINE__);
+
+			break;
+		}
+		if (!GetFileSizeEx(m_hFile, &liSize))
+		{
+			status = Status(Status_OperationFailed, "Failed to get size of '{1}' with error {2} at {3}:{4}", szPath, 
+			                (int)GetLastError(), __FILE__, __LINE__);
+
+			break;
+		}
+		if (0 == liSize.QuadPart)
+		{
+			status = Status(Status_InvalidArg, "Empty file '{1}' at {2}:{3}", szPath, __FILE__, __LINE__);
+
+			break;
+		}
+		if (NULL == (m_hMapping = CreateFileMappingA(m_hFile, NULL, PAGE_READONLY, 0, 0, NULL)))
+		{
+			status = Status(Status_OperationFailed, "Failed to map '{1}' with error {2} at {3}:{4}", szPath, 
+			                (int)GetLastError(), __FILE__, __LINE__);
+
+			break;
+		}
+		if (NULL == (m_pData = (const Byte *)MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0)))
+		{
+			status = Status(Status_OperationFailed, "Failed to map view of '{1}' with error {2} at {3}:{4}", szPath, 
+			                (int)GetLastError(), __FILE__, __LINE__);
+
+			break;
+		}
+		m_cbSize = (UInt64)liSize.QuadPart;
+
+		break;
+	}
+	if (!status)
+	{
+		Close();
+	}
+
+	return status;
+}
+
+Status MappedFile::Close()
+{
+	if (NULL != m_pData)
+	{
+		UnmapViewOfFile(m_pData);
+	}
+	if (NULL != m_hMapping)
+	{
+		CloseHandle(m_hMapping);
+	}
+	if (INVALID_HANDLE_VALUE != m_hFile)
+	{
+		CloseHandle(m_hFile);
+	}
+	m_hFile    = INVALID_HANDLE_VALUE;
+	m_hMapping = NULL;
+	m_pData    = NULL;
+	m_cbSize   = 0;
+
+	return Status();
+}
+
+Bool MappedFile::IsOK() const
+{
+	return (NULL != m_pData);
+}
+
+const Byte *MappedFile::GetData() const
+{
+	return m_pData;
+}
+
+UInt64 MappedFile::GetSize() const
+{
+	return m_cbSize;
+}
+
+void MappedFile::Prefetch(const void *pData, Size cbSize)
+{
+	static const PrefetchSupport   support;
+
+	PrefetchRange   range;
+
+	if (NULL == support.pfnPrefetchVirtualMemory || 0 == cbSize)
+	{
+		return;
+	}
+	range.pAddress = (void *)pData;
+	range.cbSize   = cbSize;
+	//only a hint: failures leave the pages to be read on first access
+	support.pfnPrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+void MappedFile::Evict(const void *pData, Size cbSize)
+{
+	if (0 == cbSize)
+	{
+		return;
+	}
+	//unlocking pages that are not locked removes them from the working set (and fails with ERROR_NOT_LOCKED)
+	VirtualUnlock((void *)pData, cbSize);
+}
+
+}//namespace NET
+
+}//namespace N2
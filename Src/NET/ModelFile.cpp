@@ -0,0 +1,289 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "N2/NET/ModelFile.hpp"
+#include "N2/NET/CRC32C.hpp"
+
+
+using namespace CX;
+
+
+namespace N2
+{
+
+namespace NET
+{
+
+ModelFile::ModelFile()
+{
+	m_pFile    = NULL;
+	m_pHeader  = NULL;
+	m_sections = NULL;
+}
+
+ModelFile::~ModelFile()
+{
+	Close();
+}
+
+Status ModelFile::Open(const Char *szPath)
+{
+	Close();
+
+	const Header   *pHeader;
+	Header         header;
+	UInt64         cbTableEnd;
+	UInt32         nChecksum;
+	Status         status;
+
+	if (NULL == (m_pFile = new (std::nothrow) MappedFile()))
+	{
+		return Status(Status_MemAllocFailed, "Failed to allocate mapped file at {1}:{2}", __FILE__, __LINE__);
+	}
+	for (;;)
+	{
+		if (!(status = m_pFile->Open(szPath)))
+		{
+			break;
+		}
+		if (sizeof(Header) > m_pFile->GetSize())
+		{
+			status = Status(Status_OpenFailed, "Invalid model file '{1}' at {2}:{3}", szPath, __FILE__, __LINE__);
+
+			break;
+		}
+		pHeader = (const Header *)m_pFile->GetData();
+		if (MAGIC != pHeader->nMagic)
+		{
+			status = Status(Status_OpenFailed, "Invalid magic {1} at {2}:{3}", pHeader->nMagic, __FILE__, __LINE__);
+
+			break;
+		}
+		if (VERSION != pHeader->nVersion)
+		{
+			status = Status(Status_OpenFailed, "Invalid version {1} at {2}:{3}", pHeader->nVersion, __FILE__, 
+			                __LINE__);
+
+			break;
+		}
+		if (ALIGNMENT != pHeader->cbAlignment)
+		{
+			status = Status(Status_OpenFailed, "Invalid alignment {1} at {2}:{3}", pHeader->cbAlignment, __FILE__, 
+			                __LINE__);
+
+			break;
+		}
+		if (m_pFile->GetSize() != pHeader->cbFileSize)
+		{
+			status = Status(Status_OpenFailed, "Truncated model file '{1}' at {2}:{3}", szPath, __FILE__, __LINE__);
+
+			break;
+		}
+		if ((m_pFile->GetSize() - sizeof(Header)) / sizeof(Section) < pHeader->cSections)
+		{
+			status = Status(Status_OpenFailed, "Invalid sections count {1} at {2}:{3}", pHeader->cSections, __FILE__, 
+			                __LINE__);
+
+			break;
+		}
+		cbTableEnd = sizeof(Header) + sizeof(Section) * (UInt64)pHeader->cSections;
+		memcpy(&header, pHeader, sizeof(Header));
+		header.nChecksum = 0;
+		nChecksum        = CRC32C::Compute(&header, sizeof(Header));
+		nChecksum        = CRC32C::Compute(pHeader + 1, sizeof(Section) * (Size)pHeader->cSections, nChecksum);
+		if (nChecksum != pHeader->nChecksum)
+		{
+			status = Status(Status_OpenFailed, "Invalid header checksum {1} at {2}:{3}", nChecksum, __FILE__, 
+			                __LINE__);
+
+			break;
+		}
+		m_pHeader  = pHeader;
+		m_sections = (const Section *)(pHeader + 1);
+		for (UInt32 i = 0; i < m_pHeader->cSections; i++)
+		{
+			if (0 != m_sections[i].cbOffset % ALIGNMENT || cbTableEnd > m_sections[i].cbOffset || 
+			    m_sections[i].cbOffset > m_pFile->GetSize() || 
+			    m_sections[i].cbSize > m_pFile->GetSize() - m_sections[i].cbOffset)
+			{
+				status = Status(Status_OpenFailed, "Invalid section {1} at {2}:{3}", i, __FILE__, __LINE__);
+
+				break;
+			}
+		}
+
+		break;
+	}
+	if (!status)
+	{
+		Close();
+	}
+
+	return status;
+}
+
+Status ModelFile::Close()
+{
+	if (NULL != m_pFile)
+	{
+		delete m_pFile;
+		m_pFile = NULL;
+	}
+	m_pHeader  = NULL;
+	m_sections = NULL;
+
+	return Status();
+}
+
+Bool ModelFile::IsOK() const
+{
+	return (NULL != m_pHeader);
+}
+
+UInt32 ModelFile::GetSectionsCount() const
+{
+	if (NULL == m_pHeader)
+	{
+		return 0;
+	}
+
+	return m_pHeader->cSections;
+}
+
+const ModelFile::Section *ModelFile::GetSection(UInt32 cSection) const
+{
+	if (cSection >= GetSectionsCount())
+	{
+		return NULL;
+	}
+
+	return &m_sections[cSection];
+}
+
+const ModelFile::Section *ModelFile::FindSection(UInt32 nType, UInt32 cLayer, UInt32 nLayout/* = 0*/) const
+{
+	for (UInt32 i = 0; i < GetSectionsCount(); i++)
+	{
+		if (nType == m_sections[i].nType && cLayer == m_sections[i].cLayer && 
+		    (Section_Packed != nType || nLayout == m_sections[i].nLayout))
+		{
+			return &m_sections[i];
+		}
+	}
+
+	return NULL;
+}
+
+const Byte *ModelFile::GetSectionData(const Section *pSection) const
+{
+	return m_pFile->GetData() + pSection->cbOffset;
+}
+
+Status ModelFile::VerifySection(const Section *pSection) const
+{
+	UInt32   nChecksum;
+
+	nChecksum = CRC32C::Compute(GetSectionData(pSection), (Size)pSection->cbSize);
+	if (nChecksum != pSection->nChecksum)
+	{
+		return Status(Status_ReadFailed, "Invalid checksum {1} of section {2} (layer {3}) at {4}:{5}", nChecksum, 
+		              pSection->nType, pSection->cLayer, __FILE__, __LINE__);
+	}
+
+	return Status();
+}
+
+Status ModelFile::GetLayers(UInt32 *pcInputNeurons, LayersVector *pVectorLayers) const
+{
+	const Section          *pSection;
+	const TopologyHeader   *pTopology;
+	const LayerRecord      *records;
+	Status                 status;
+
+	if (NULL == (pSection = FindSection(Section_Topology, 0)))
+	{
+		return Status(Status_NotFound, "Topology section not found at {1}:{2}", __FILE__, __LINE__);
+	}
+	if (!(status = VerifySection(pSection)))
+	{
+		return status;
+	}
+	if (sizeof(TopologyHeader) > pSection->cbSize)
+	{
+		return Status(Status_InvalidArg, "Invalid topology section at {1}:{2}", __FILE__, __LINE__);
+	}
+	pTopology = (const TopologyHeader *)GetSectionData(pSection);
+	if (Layer::MAX_LAYERS < pTopology->cLayers || 
+	    sizeof(TopologyHeader) + sizeof(LayerRecord) * (UInt64)pTopology->cLayers != pSection->cbSize)
+	{
+		return Status(Status_InvalidArg, "Invalid layers count {1} at {2}:{3}", pTopology->cLayers, __FILE__, 
+		              __LINE__);
+	}
+	records = (const LayerRecord *)(pTopology + 1);
+	pVectorLayers->clear();
+	for (UInt32 i = 0; i < pTopology->cLayers; i++)
+	{
+		Layer   layer;
+
+		if (1 < records[i].bHasBias || Neurons::MAX_ACTIVATION_ARGS_COUNT < records[i].cActivationArgs)
+		{
+			return Status(Status_InvalidArg, "Invalid layer {1} at {2}:{3}", i, __FILE__, __LINE__);
+		}
+		if (Neurons::GetMinActivationArgsCount(records[i].nActivation) > records[i].cActivationArgs)
+		{
+			return Status(Status_InvalidArg, "Invalid activation args count ({1}) of layer {2} at {3}:{4}", 
+			              records[i].cActivationArgs, i, __FILE__, __LINE__);
+		}
+		layer.cNeuronsCount   = records[i].cNeurons;
+		layer.nActivation     = records[i].nActivation;
+		layer.cActivationArgs = records[i].cActivationArgs;
+		layer.bHasBias        = (1 == records[i].bHasBias);
+		layer.fBiasValue      = records[i].fBias;
+		memcpy(layer.activationArgs, records[i].activationArgs, sizeof(layer.activationArgs));
+		pVectorLayers->push_back(layer);
+	}
+	*pcInputNeurons = pTopology->cInputNeurons;
+
+	return Status();
+}
+
+MappedFile *ModelFile::DetachFile()
+{
+	MappedFile   *pFile;
+
+	pFile      = m_pFile;
+	m_pFile    = NULL;
+	m_pHeader  = NULL;
+	m_sections = NULL;
+
+	return pFile;
+}
+
+}//namespace NET
+
+}//namespace N2
@@ -0,0 +1,424 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "N2/NET/ModelFormat.hpp"
+#include "N2/NET/CRC32C.hpp"
+#include "CX/IO/FileOutputStream.hpp"
+
+
+using namespace CX;
+
+
+namespace N2
+{
+
+namespace NET
+{
+
+ModelFormat::ModelFormat()
+{
+}
+
+ModelFormat::~ModelFormat()
+{
+}
+
+Status ModelFormat::Load(Network *pNetwork, const Char *szPath, UInt32 cThreads/* = 0*/)
+{
+	ModelFile                   file;
+	ParallelCopy::TasksVector   vectorTasks;
+	SectionsVector              vectorSections;
+	Synapses                    *pSynapses;
+	const ModelFile::Section    *pWeightsSection;
+	const ModelFile::Section    *pBiasesSection;
+	UInt32                      cLayer;
+	Status                      status;
+
+	if (!(status = file.Open(szPath)))
+	{
+		return status;
+	}
+	if (!(status = InitNetwork(pNetwork, &file, True)))
+	{
+		return status;
+	}
+	cLayer    = 0;
+	pSynapses = pNetwork->GetInputNeurons()->GetNextSynapses();
+	while (NULL != pSynapses)
+	{
+		if (!(status = GetSynapsesData(&file, pSynapses, cLayer, &pWeightsSection, &pBiasesSection)))
+		{
+			break;
+		}
+		AddTask(&file, pWeightsSection, pSynapses->GetWeights(), &vectorTasks, &vectorSections);
+		if (NULL != pBiasesSection)
+		{
+			AddTask(&file, pBiasesSection, pSynapses->GetBiases(), &vectorTasks, &vectorSections);
+		}
+		cLayer++;
+		pSynapses = (NULL != pSynapses->GetNextNeurons() ? pSynapses->GetNextNeurons()->GetNextSynapses() : NULL);
+	}
+	//all the layers are read, copied and checksummed at the same time
+	if (status)
+	{
+		status = ParallelCopy::Run(&vectorTasks, cThreads);
+	}
+	if (status)
+	{
+		status = VerifyTasks(&vectorTasks, &vectorSections);
+	}
+	if (status)
+	{
+		pSynapses = pNetwork->GetInputNeurons()->GetNextSynapses();
+		while (NULL != pSynapses)
+		{
+			pSynapses->MarkAllDirty();
+			pSynapses = (NULL != pSynapses->GetNextNeurons() ? pSynapses->GetNextNeurons()->GetNextSynapses() : NULL);
+		}
+	}
+	else
+	{
+		pNetwork->Uninit();
+	}
+
+	return status;
+}
+
+Status ModelFormat::Map(Network *pNetwork, const Char *szPath, Bool bVerify/* = False*/, UInt32 cThreads/* = 0*/)
+{
+	ModelFile                   file;
+	ParallelCopy::TasksVector   vectorTasks;
+	SectionsVector              vectorSections;
+	Synapses                    *pSynapses;
+	const ModelFile::Section    *pWeightsSection;
+	const ModelFile::Section    *pBiasesSection;
+	UInt32                      cLayer;
+	Status                      status;
+
+	if (!(status = file.Open(szPath)))
+	{
+		return status;
+	}
+	if (!(status = InitNetwork(pNetwork, &file, False)))
+	{
+		return status;
+	}
+	cLayer    = 0;
+	pSynapses = pNetwork->GetInputNeurons()->GetNextSynapses();
+	while (NULL != pSynapses)
+	{
+		if (!(status = GetSynapsesData(&file, pSynapses, cLayer, &pWeightsSection, &pBiasesSection)))
+		{
+			break;
+		}
+		if (!(status = pSynapses->SetExternalStorage((const Float *)file.GetSectionData(pWeightsSection), 
+		                                             NULL != pBiasesSection ? 
+		                                             (const Float *)file.GetSectionData(pBiasesSection) : NULL)))
+		{
+			break;
+		}
+		if (bVerify)
+		{
+			AddTask(&file, pWeightsSection, NULL, &vectorTasks, &vectorSections);
+			if (NULL != pBiasesSection)
+			{
+				AddTask(&file, pBiasesSection, NULL, &vectorTasks, &vectorSections);
+			}
+		}
+		cLayer++;
+		pSynapses = (NULL != pSynapses->GetNextNeurons() ? pSynapses->GetNextNeurons()->GetNextSynapses() : NULL);
+	}
+	if (status && bVerify)
+	{
+		status = ParallelCopy::Run(&vectorTasks, cThreads);
+	}
+	if (status && bVerify)
+	{
+		status = VerifyTasks(&vectorTasks, &vectorSections);
+	}
+	if (!status)
+	{
+		pNetwork->Uninit();
+
+		return status;
+	}
+	pNetwork->SetMappedFile(file.DetachFile());
+
+	return Status();
+}
+
+Status ModelFormat::Save(const Network *pNetwork, const Char *szPath, 
+                         const PackedLayoutsVector *pVectorPacked/* = NULL*/)
+{
+	if (!pNetwork->IsOK())
+	{
+		return Status(Status_InvalidArg, "Invalid arg at {1}:{2}", __FILE__, __LINE__);
+	}
+
+	Vector<ModelFile::Section>::Type   vectorSections;
+	Vector<const void *>::Type         vectorData;
+	Vector<Byte>::Type                 vectorTopology;
+	ModelFile::TopologyHeader          *pTopology;
+	ModelFile::LayerRecord             *pRecord;
+	ModelFile::Header                  header;
+	const Neurons                      *pNeurons;
+	const Synapses                     *pSynapses;
+	UInt64                             cbOffset;
+	UInt32                             cLayer;
+	Status                             status;
+
+	vectorTopology.resize(sizeof(ModelFile::TopologyHeader) + 
+	                      sizeof(ModelFile::LayerRecord) * pNetwork->GetLayersCount(), 0);
+	pTopology                = (ModelFile::TopologyHeader *)&vectorTopology[0];
+	pTopology->cInputNeurons = pNetwork->GetInputNeurons()->GetNeuronsCount();
+	pTopology->cLayers       = pNetwork->GetLayersCount();
+	AddSection(&vectorSections, &vectorData, ModelFile::Section_Topology, 0, 0, NULL, vectorTopology.size());
+
+	cLayer    = 0;
+	pSynapses = pNetwork->GetInputNeurons()->GetNextSynapses();
+	while (NULL != pSynapses && cLayer < pNetwork->GetLayersCount())
+	{
+		pNeurons                 = pSynapses->GetNextNeurons();
+		pRecord                  = (ModelFile::LayerRecord *)(pTopology + 1) + cLayer;
+		pRecord->cNeurons        = pNeurons->GetNeuronsCount();
+		pRecord->nActivation     = pNeurons->GetActivation();
+		pRecord->bHasBias        = (pSynapses->HasBias() ? 1 : 0);
+		pRecord->fBias           = pSynapses->GetBias();
+		pRecord->cActivationArgs = pNeurons->GetActivationArgsCount();
+		memcpy(pRecord->activationArgs, pNeurons->GetActivationArgs(), sizeof(Float) * pRecord->cActivationArgs);
+		AddSection(&vectorSections, &vectorData, ModelFile::Section_Weights, cLayer, 0, pSynapses->GetWeights(), 
+		           sizeof(Float) * pSynapses->GetWeightsCount());
+		if (pSynapses->HasBias())
+		{
+			AddSection(&vectorSections, &vectorData, ModelFile::Section_Biases, cLayer, 0, pSynapses->GetBiases(), 
+			           sizeof(Float) * pSynapses->GetBiasesCount());
+		}
+		cLayer++;
+		pSynapses = pNeurons->GetNextSynapses();
+	}
+	//the topology is complete now
+	vectorData[0]                = &vectorTopology[0];
+	vectorSections[0].nChecksum  = CRC32C::Compute(&vectorTopology[0], vectorTopology.size());
+	if (NULL != pVectorPacked)
+	{
+		for (PackedLayoutsVector::const_iterator iter = pVectorPacked->begin(); iter != pVectorPacked->end(); ++iter)
+		{
+			if (iter->cLayer >= pNetwork->GetLayersCount() || NULL == iter->pData)
+			{
+				return Status(Status_InvalidArg, "Invalid packed layout for layer {1} at {2}:{3}", iter->cLayer, 
+				              __FILE__, __LINE__);
+			}
+			AddSection(&vectorSections, &vectorData, ModelFile::Section_Packed, iter->cLayer, iter->nLayout, 
+			           iter->pData, iter->cbSize);
+		}
+	}
+
+	cbOffset = Align(sizeof(ModelFile::Header) + sizeof(ModelFile::Section) * vectorSections.size());
+	for (Vector<ModelFile::Section>::Type::iterator iter = vectorSections.begin(); iter != vectorSections.end(); 
+	     ++iter)
+	{
+		iter->cbOffset = cbOffset;
+		cbOffset       = Align(cbOffset + iter->cbSize);
+	}
+
+	memset(&header, 0, sizeof(header));
+	header.nMagic      = ModelFile::MAGIC;
+	header.nVersion    = ModelFile::VERSION;
+	header.cSections   = (UInt32)vectorSections.size();
+	header.cbFileSize  = vectorSections.back().cbOffset + vectorSections.back().cbSize;
+	header.nFlags      = 0;
+	header.cbAlignment = ModelFile::ALIGNMENT;
+	header.nChecksum   = CRC32C::Compute(&header, sizeof(header));
+	header.nChecksum   = CRC32C::Compute(&vectorSections[0], sizeof(ModelFile::Section) * vectorSections.size(), 
+	                                     header.nChecksum);
+
+	IO::FileOutputStream   os(szPath);
+
+	if (!os.IsOK())
+	{
+		return Status(Status_CreateFailed, "Failed to create '{1}' at {2}:{3}", szPath, __FILE__, __LINE__);
+	}
+	if (!(status = Write(&os, &header, sizeof(header))))
+	{
+		return status;
+	}
+	if (!(status = Write(&os, &vectorSections[0], sizeof(ModelFile::Section) * vectorSections.size())))
+	{
+		return status;
+	}
+	cbOffset = sizeof(ModelFile::Header) + sizeof(ModelFile::Section) * vectorSections.size();
+	for (Size i = 0; i < vectorSections.size(); i++)
+	{
+		if (!(status = WritePadding(&os, vectorSections[i].cbOffset - cbOffset)))
+		{
+			return status;
+		}
+		if (!(status = Write(&os, vectorData[i], (Size)vectorSections[i].cbSize)))
+		{
+			return status;
+		}
+		cbOffset = vectorSections[i].cbOffset + vectorSections[i].cbSize;
+	}
+
+	return Status();
+}
+
+Status ModelFormat::InitNetwork(Network *pNetwork, const ModelFile *pFile, Bool bAllocateWeights)
+{
+	ModelFile::LayersVector   vectorLayers;
+	UInt32                    cInputNeurons;
+	Status                    status;
+
+	if (!(status = pFile->GetLayers(&cInputNeurons, &vectorLayers)))
+	{
+		return status;
+	}
+	if (vectorLayers.empty())
+	{
+		return Status(Status_InvalidArg, "Invalid layers count {1} at {2}:{3}", 0, __FILE__, __LINE__);
+	}
+
+	return pNetwork->Init(cInputNeurons, (UInt32)vectorLayers.size(), &vectorLayers[0], bAllocateWeights);
+}
+
+Status ModelFormat::GetSynapsesData(const ModelFile *pFile, const Synapses *pSynapses, UInt32 cLayer, 
+                                    const ModelFile::Section **ppWeightsSection, 
+                                    const ModelFile::Section **ppBiasesSection)
+{
+	const ModelFile::Section   *pSection;
+
+	if (NULL == (pSection = pFile->FindSection(ModelFile::Section_Weights, cLayer)))
+	{
+		return Status(Status_NotFound, "Weights of layer {1} not found at {2}:{3}", cLayer, __FILE__, __LINE__);
+	}
+	if (sizeof(Float) * (UInt64)pSynapses->GetWeightsCount() != pSection->cbSize)
+	{
+		return Status(Status_InvalidArg, "Invalid weights size {1} of layer {2} at {3}:{4}", pSection->cbSize, 
+		              cLayer, __FILE__, __LINE__);
+	}
+	*ppWeightsSection = pSection;
+	*ppBiasesSection  = NULL;
+	if (!pSynapses->HasBias())
+	{
+		return Status();
+	}
+	if (NULL == (pSection = pFile->FindSection(ModelFile::Section_Biases, cLayer)))
+	{
+		return Status(Status_NotFound, "Biases of layer {1} not found at {2}:{3}", cLayer, __FILE__, __LINE__);
+	}
+	if (sizeof(Float) * (UInt64)pSynapses->GetBiasesCount() != pSection->cbSize)
+	{
+		return Status(Status_InvalidArg, "Invalid biases size {1} of layer {2} at {3}:{4}", pSection->cbSize, 
+		              cLayer, __FILE__, __LINE__);
+	}
+	*ppBiasesSection = pSection;
+
+	return Status();
+}
+
+void ModelFormat::AddTask(const ModelFile *pFile, const ModelFile::Section *pSection, void *pDest, 
+                          ParallelCopy::TasksVector *pVectorTasks, SectionsVector *pVectorSections)
+{
+	ParallelCopy::Task   task;
+
+	task.pDest     = pDest;
+	task.pSource   = pFile->GetSectionData(pSection);
+	task.cbSize    = (Size)pSection->cbSize;
+	task.bChecksum = True;
+	task.nChecksum = 0;
+	pVectorTasks->push_back(task);
+	pVectorSections->push_back(pSection);
+}
+
+Status ModelFormat::VerifyTasks(const ParallelCopy::TasksVector *pVectorTasks, const SectionsVector *pVectorSections)
+{
+	for (Size i = 0; i < pVectorTasks->size(); i++)
+	{
+		if ((*pVectorTasks)[i].nChecksum != (*pVectorSections)[i]->nChecksum)
+		{
+			return Status(Status_ReadFailed, "Invalid checksum {1} of section {2} (layer {3}) at {4}:{5}", 
+			              (*pVectorTasks)[i].nChecksum, (*pVectorSections)[i]->nType, (*pVectorSections)[i]->cLayer, 
+			              __FILE__, __LINE__);
+		}
+	}
+
+	return Status();
+}
+
+void ModelFormat::AddSection(Vector<ModelFile::Section>::Type *pVectorSections, 
+                             Vector<const void *>::Type *pVectorData, UInt32 nType, UInt32 cLayer, UInt32 nLayout, 
+                             const void *pData, Size cbSize)
+{
+	ModelFile::Section   section;
+
+	section.nType     = nType;
+	section.cLayer    = cLayer;
+	section.cbOffset  = 0;
+	section.cbSize    = cbSize;
+	section.nChecksum = (NULL != pData ? CRC32C::Compute(pData, cbSize) : 0);
+	section.nLayout   = nLayout;
+	pVectorSections->push_back(section);
+	pVectorData->push_back(pData);
+}
+
+UInt64 ModelFormat::Align(UInt64 cbSize)
+{
+	return (cbSize + ModelFile::ALIGNMENT - 1) / ModelFile::ALIGNMENT * ModelFile::ALIGNMENT;
+}
+
+Status ModelFormat::Write(IO::IOutputStream *pOutputStream, const void *pData, Size cbSize)
+{
+	Size     cbAckSize;
+	Status   status;
+
+	if (0 == cbSize)
+	{
+		return Status();
+	}
+	if (!(status = pOutputStream->Write(pData, cbSize, &cbAckSize)))
+	{
+		return Status(Status_WriteFailed, "Failed to write file at {1}:{2}", __FILE__, __LINE__);
+	}
+	if (cbSize != cbAckSize)
+	{
+		return Status(Status_WriteFailed, "Failed to write file at {1}:{2}", __FILE__, __LINE__);
+	}
+
+	return Status();
+}
+
+Status ModelFormat::WritePadding(IO::IOutputStream *pOutputStream, UInt64 cbSize)
+{
+	static const Byte   zeros[ModelFile::ALIGNMENT] = { 0 };
+
+	return Write(pOutputStream, zeros, (Size)cbSize);
+}
+
+}//namespace NET
+
+}//namespace N2
@@ -27,6 +27,7 @@
  */
 
 #include "N2/NET/Network.hpp"
+#include "N2/NET/MappedFile.hpp"
 
 
 using namespace CX;
@@ -44,6 +45,7 @@ Network::Network()
 	m_pInputNeurons  = NULL;
 	m_pOutputNeurons = NULL;
 	m_cbMemSize      = 0;
+	m_pMappedFile    = NULL;
 }
 
 Network::~Network()
@@ -51,7 +53,8 @@ Network::~Network()
 	Uninit();
 }
 
-Status Network::Init(UInt32 cInputNeuronsCount, UInt32 cLayersCount, const Layer *layers)
+Status Network::Init(UInt32 cInputNeuronsCount, UInt32 cLayersCount, const Layer *layers, 
+                     Bool bAllocateWeights/* = True*/)
 {
 	if (Neurons::MIN_NEURONS > cInputNeuronsCount)
 	{
@@ -99,7 +102,7 @@ Status Network::Init(UInt32 cInputNeuronsCount, UInt32 cLayersCount, const Layer
 				break;
 			}
 			if (!(status = pSynapses->Init(m_pOutputNeurons->m_cNeurons, layers[i].cNeuronsCount, layers[i].bHasBias, 
-				                              layers[i].fBiasValue)))
+				                              layers[i].fBiasValue, bAllocateWeights)))
 			{
 				delete pSynapses;
 
@@ -166,6 +169,8 @@ Status Network::Uninit()
 			delete pNeurons;
 		}
 	}
+	//after the synapses pointing into it
+	SetMappedFile(NULL);
 	m_cLayers        = 0;
 	m_pInputNeurons  = NULL;
 	m_pOutputNeurons = NULL;
@@ -174,6 +179,15 @@ Status Network::Uninit()
 	return Status();
 }
 
+void Network::SetMappedFile(MappedFile *pMappedFile)
+{
+	if (NULL != m_pMappedFile && pMappedFile != m_pMappedFile)
+	{
+		delete m_pMappedFile;
+	}
+	m_pMappedFile = pMappedFile;
+}
+
 Bool Network::IsOK() const
 {
 	return (0 < m_cLayers);
@@ -215,7 +229,8 @@ Status Network::LoadWeightsAndBiases(const SynapsesDataVector *pVectorSynapsesDa
 		return Status(Status_InvalidArg, "Invalid arg at {1}:{2}", __FILE__, __LINE__);
 	}
 
-	Synapses *pSynapses = m_pInputNeurons->GetNextSynapses();
+	Synapses   *pSynapses = m_pInputNeurons->GetNextSynapses();
+	Status     status;
 
 	for (auto iterSynapses = pVectorSynapsesData->begin(); iterSynapses != pVectorSynapsesData->end(); ++iterSynapses)
 	{
@@ -230,11 +245,16 @@ Status Network::LoadWeightsAndBiases(const SynapsesDataVector *pVectorSynapsesDa
 				return Status(Status_InvalidArg, "Invalid arg at {1}:{2}", __FILE__, __LINE__);
 			}
 		}
+		if (!(status = pSynapses->MakeWritable()))
+		{
+			return status;
+		}
 		memcpy(pSynapses->GetWeights(), iterSynapses->vectorWeights.data(), sizeof(Float) * pSynapses->GetWeightsCount());
 		if (pSynapses->HasBias())
 		{
 			memcpy(pSynapses->GetBiases(), iterSynapses->vectorBiases.data(), sizeof(Float) * pSynapses->GetBiasesCount());
 		}
+		pSynapses->MarkAllDirty();
 		if (NULL != pSynapses->GetNextNeurons())
 		{
 			pSynapses = pSynapses->GetNextNeurons()->GetNextSynapses();
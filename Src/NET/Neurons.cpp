@@ -67,7 +67,7 @@ Status Neurons::Init(UInt32 cNeuronsCount, ActivationType nActivation/* = Activa
 	{
 		return Status(Status_InvalidArg, "Invalid activation ({1}) at {2}:{3}", nActivation, __FILE__, __LINE__);
 	}
-	if (MAX_ACTIVATION_ARGS_COUNT < cActivationArgs)
+	if (MAX_ACTIVATION_ARGS_COUNT < cActivationArgs || GetMinActivationArgsCount(nActivation) > cActivationArgs)
 	{
 		return Status(Status_InvalidArg, "Invalid activation args count ({1}) at {2}:{3}", cActivationArgs, __FILE__, 
 		              __LINE__);
@@ -183,6 +183,21 @@ Size Neurons::GetMemSize() const
 	return m_cbMemSize;
 }
 
+UInt32 Neurons::GetMinActivationArgsCount(ActivationType nActivation)
+{
+	static const UInt32   ARGS_COUNT[] = 
+	{
+		0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 2, 4, 1, 1, 0, 
+	};
+
+	if (Activation::MIN_VALUE > nActivation || Activation::MAX_VALUE < nActivation)
+	{
+		return 0;
+	}
+
+	return ARGS_COUNT[nActivation];
+}
+
 }//namespace NET
 
 }//namespace N2
@@ -0,0 +1,155 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "N2/NET/ParallelCopy.hpp"
+#include "N2/NET/CRC32C.hpp"
+
+
+using namespace CX;
+
+
+namespace N2
+{
+
+namespace NET
+{
+
+ParallelCopy::ParallelCopy()
+{
+}
+
+ParallelCopy::~ParallelCopy()
+{
+}
+
+Status ParallelCopy::Run(TasksVector *pVectorTasks, UInt32 cThreads/* = 0*/)
+{
+	ChunksVector             vectorChunks;
+	Chunk                    chunk;
+	Context                  context;
+	Vector<HANDLE>::Type     vectorThreads;
+	HANDLE                   hThread;
+	DWORD                    dwID;
+
+	for (UInt32 i = 0; i < (UInt32)pVectorTasks->size(); i++)
+	{
+		chunk.cTask     = i;
+		chunk.nChecksum = 0;
+		for (chunk.cbOffset = 0; chunk.cbOffset < (*pVectorTasks)[i].cbSize; chunk.cbOffset += chunk.cbSize)
+		{
+			chunk.cbSize = (*pVectorTasks)[i].cbSize - chunk.cbOffset;
+			if (CHUNK_SIZE < chunk.cbSize)
+			{
+				chunk.cbSize = CHUNK_SIZE;
+			}
+			vectorChunks.push_back(chunk);
+		}
+	}
+	if (0 == cThreads)
+	{
+		SYSTEM_INFO   sysinfo;
+
+		GetSystemInfo(&sysinfo);
+		cThreads = (UInt32)sysinfo.dwNumberOfProcessors;
+	}
+	if (cThreads > (UInt32)vectorChunks.size())
+	{
+		cThreads = (UInt32)vectorChunks.size();
+	}
+
+	context.pVectorTasks  = pVectorTasks;
+	context.pVectorChunks = &vectorChunks;
+	context.cNextChunk    = 0;
+	//fewer threads than asked for (if they cannot be created) only makes it slower
+	for (UInt32 i = 1; i < cThreads; i++)
+	{
+		if (NULL == (hThread = CreateThread(NULL, THREAD_STACK_SIZE, &ParallelCopy::WorkerThread, &context, 0, &dwID)))
+		{
+			break;
+		}
+		vectorThreads.push_back(hThread);
+	}
+	RunChunks(&context);
+	for (Vector<HANDLE>::Type::iterator iter = vectorThreads.begin(); iter != vectorThreads.end(); ++iter)
+	{
+		WaitForSingleObject(*iter, INFINITE);
+		CloseHandle(*iter);
+	}
+
+	//chunks are in order inside each task
+	for (TasksVector::iterator iter = pVectorTasks->begin(); iter != pVectorTasks->end(); ++iter)
+	{
+		iter->nChecksum = 0;
+	}
+	for (ChunksVector::iterator iter = vectorChunks.begin(); iter != vectorChunks.end(); ++iter)
+	{
+		Task   &task = (*pVectorTasks)[iter->cTask];
+
+		if (task.bChecksum)
+		{
+			task.nChecksum = CRC32C::Combine(task.nChecksum, iter->nChecksum, iter->cbSize);
+		}
+	}
+
+	return Status();
+}
+
+void ParallelCopy::RunChunks(Context *pContext)
+{
+	LONG   cChunk;
+
+	while ((LONG)pContext->pVectorChunks->size() > (cChunk = InterlockedIncrement(&pContext->cNextChunk) - 1))
+	{
+		Chunk        &chunk = (*pContext->pVectorChunks)[cChunk];
+		const Task   &task  = (*pContext->pVectorTasks)[chunk.cTask];
+		const Byte   *pData;
+
+		pData = (const Byte *)task.pSource + chunk.cbOffset;
+		//the copy is the one checksummed when there is one: it is in the cache and it is what will be used
+		if (NULL != task.pDest)
+		{
+			memcpy((Byte *)task.pDest + chunk.cbOffset, pData, chunk.cbSize);
+			pData = (const Byte *)task.pDest + chunk.cbOffset;
+		}
+		if (task.bChecksum)
+		{
+			chunk.nChecksum = CRC32C::Compute(pData, chunk.cbSize);
+		}
+	}
+}
+
+DWORD WINAPI ParallelCopy::WorkerThread(void *pArg)
+{
+	RunChunks((Context *)pArg);
+
+	return 0;
+}
+
+}//namespace NET
+
+}//namespace N2
@@ -28,6 +28,8 @@
 
 #include "N2/NET/Synapses.hpp"
 #include "N2/NET/Neurons.hpp"
+#include "N2/NET/MappedFile.hpp"
+#include <algorithm>
 
 
 using namespace CX;
@@ -50,6 +52,10 @@ Synapses::Synapses()
 	m_pPrevNeurons = NULL;
 	m_pNextNeurons = NULL;
 	m_cbMemSize    = 0;
+	m_bExternalWeights = False;
+	m_bExternalBiases  = False;
+	m_nVersion         = 0;
+	m_nDroppedVersion  = 0;
 }
 
 Synapses::~Synapses()
@@ -58,7 +64,7 @@ Synapses::~Synapses()
 }
 
 Status Synapses::Init(UInt32 cPrevNeuronsCount, UInt32 cNextNeuronsCount, Bool bHasBias/* = False*/, 
-	                   Float fBias/* = 1.0f*/)
+	                   Float fBias/* = 1.0f*/, Bool bAllocateWeights/* = True*/)
 {
 	Uninit();
 
@@ -71,14 +77,18 @@ Status Synapses::Init(UInt32 cPrevNeuronsCount, UInt32 cNextNeuronsCount, Bool b
 		m_cNextNeurons = cNextNeuronsCount;
 		m_bHasBias     = bHasBias;
 		m_fBias        = fBias;
-		if (NULL == (m_weigths = (Float *)Mem::Alloc(sizeof(Float) * cPrevNeuronsCount * cNextNeuronsCount)))
+		if (bAllocateWeights)
 		{
-			status = Status(Status_MemAllocFailed, "Failed to allocate {1} bytes at {2}:{3}", 
-			                sizeof(Float) * cPrevNeuronsCount * cNextNeuronsCount, __FILE__, __LINE__);
-
-			break;
+			if (NULL == (m_weigths = (Float *)Mem::Alloc(sizeof(Float) * cPrevNeuronsCount * cNextNeuronsCount)))
+			{
+				status = Status(Status_MemAllocFailed, "Failed to allocate {1} bytes at {2}:{3}", 
+				                sizeof(Float) * cPrevNeuronsCount * cNextNeuronsCount, __FILE__, __LINE__);
+
+				break;
+			}
+			memset(m_weigths, 0, sizeof(Float) * cPrevNeuronsCount * cNextNeuronsCount);
+			m_cbMemSize += sizeof(Float) * cPrevNeuronsCount * cNextNeuronsCount;
 		}
-		memset(m_weigths, 0, sizeof(Float) * cPrevNeuronsCount * cNextNeuronsCount);
 		if (NULL == (m_biases = (Float *)Mem::Alloc(sizeof(Float) * cNextNeuronsCount)))
 		{
 			status = Status(Status_MemAllocFailed, "Failed to allocate {1} bytes at {2}:{3}", 
@@ -89,7 +99,7 @@ Status Synapses::Init(UInt32 cPrevNeuronsCount, UInt32 cNextNeuronsCount, Bool b
 		memset(m_biases, 0, sizeof(Float) * cNextNeuronsCount);
 		m_pPrevNeurons = NULL;
 		m_pNextNeurons = NULL;
-		m_cbMemSize += sizeof(Float) * cPrevNeuronsCount * cNextNeuronsCount + sizeof(Float) * cNextNeuronsCount;
+		m_cbMemSize += sizeof(Float) * cNextNeuronsCount;
 
 		break;
 	}
@@ -103,11 +113,11 @@ Status Synapses::Init(UInt32 cPrevNeuronsCount, UInt32 cNextNeuronsCount, Bool b
 
 Status Synapses::Uninit()
 {
-	if (NULL != m_biases)
+	if (NULL != m_biases && !m_bExternalBiases)
 	{
 		Mem::Free(m_biases);
 	}
-	if (NULL != m_weigths)
+	if (NULL != m_weigths && !m_bExternalWeights)
 	{
 		Mem::Free(m_weigths);
 	}
@@ -120,6 +130,11 @@ Status Synapses::Uninit()
 	m_pPrevNeurons = NULL;
 	m_pNextNeurons = NULL;
 	m_cbMemSize    = 0;
+	m_bExternalWeights = False;
+	m_bExternalBiases  = False;
+	m_nVersion         = 0;
+	m_nDroppedVersion  = 0;
+	m_vectorDirtyRanges.clear();
 
 	return Status();
 }
@@ -211,6 +226,205 @@ Size Synapses::GetMemSize() const
 	return m_cbMemSize;
 }
 
+//weights first, then biases, each by first element
+static bool CompareDirtyRanges(const Synapses::DirtyRange &a, const Synapses::DirtyRange &b)
+{
+	if (a.bBiases != b.bBiases)
+	{
+		return !a.bBiases;
+	}
+
+	return a.cFirst < b.cFirst;
+}
+
+void Synapses::MarkWeightsDirty(UInt32 cFirst, UInt32 cCount)
+{
+	MarkDirty(False, cFirst, cCount, GetWeightsCount());
+}
+
+void Synapses::MarkBiasesDirty(UInt32 cFirst, UInt32 cCount)
+{
+	MarkDirty(True, cFirst, cCount, GetBiasesCount());
+}
+
+void Synapses::MarkDirty(Bool bBiases, UInt32 cFirst, UInt32 cCount, UInt32 cTotal)
+{
+	VersionedRange   range;
+
+	if (cFirst >= cTotal || 0 == cCount)
+	{
+		return;
+	}
+	if (cCount > cTotal - cFirst)
+	{
+		cCount = cTotal - cFirst;
+	}
+	//the log is full => drop the older half; engines synced before that will copy everything
+	if (MAX_DIRTY_RANGES <= (UInt32)m_vectorDirtyRanges.size())
+	{
+		m_nDroppedVersion = m_vectorDirtyRanges[MAX_DIRTY_RANGES / 2 - 1].nVersion;
+		m_vectorDirtyRanges.erase(m_vectorDirtyRanges.begin(), m_vectorDirtyRanges.begin() + MAX_DIRTY_RANGES / 2);
+	}
+	m_nVersion++;
+	range.nVersion      = m_nVersion;
+	range.range.bBiases = bBiases;
+	range.range.cFirst  = cFirst;
+	range.range.cCount  = cCount;
+	m_vectorDirtyRanges.push_back(range);
+}
+
+UInt64 Synapses::GetVersion() const
+{
+	return m_nVersion;
+}
+
+void Synapses::MarkAllDirty()
+{
+	m_nVersion++;
+	m_nDroppedVersion = m_nVersion;
+	m_vectorDirtyRanges.clear();
+}
+
+Bool Synapses::GetDirtyRanges(UInt64 nVersion, DirtyRangesVector *pVectorRanges) const
+{
+	pVectorRanges->clear();
+	if (VERSION_NONE == nVersion || nVersion < m_nDroppedVersion)
+	{
+		return False;
+	}
+	if (nVersion >= m_nVersion)
+	{
+		return True;
+	}
+	for (VersionedRangesVector::const_iterator iter = m_vectorDirtyRanges.begin(); 
+	     iter != m_vectorDirtyRanges.end(); ++iter)
+	{
+		if (iter->nVersion > nVersion)
+		{
+			pVectorRanges->push_back(iter->range);
+		}
+	}
+	std::sort(pVectorRanges->begin(), pVectorRanges->end(), &CompareDirtyRanges);
+
+	//merge the overlapping and adjacent ranges
+	Size   cRanges = 0;
+
+	for (DirtyRangesVector::iterator iter = pVectorRanges->begin(); iter != pVectorRanges->end(); ++iter)
+	{
+		if (0 < cRanges)
+		{
+			DirtyRange   &last = (*pVectorRanges)[cRanges - 1];
+
+			if (last.bBiases == iter->bBiases && last.cFirst + last.cCount >= iter->cFirst)
+			{
+				if (last.cFirst + last.cCount < iter->cFirst + iter->cCount)
+				{
+					last.cCount = iter->cFirst + iter->cCount - last.cFirst;
+				}
+
+				continue;
+			}
+		}
+		(*pVectorRanges)[cRanges++] = *iter;
+	}
+	pVectorRanges->resize(cRanges);
+
+	return True;
+}
+
+Status Synapses::SetExternalStorage(const Float *weights, const Float *biases)
+{
+	if (!IsOK())
+	{
+		return Status(Status_NotInitialized, "Not initialized at {1}:{2}", __FILE__, __LINE__);
+	}
+	if (NULL == weights)
+	{
+		return Status(Status_InvalidArg, "Invalid arg at {1}:{2}", __FILE__, __LINE__);
+	}
+	if (!m_bExternalWeights && NULL != m_weigths)
+	{
+		Mem::Free(m_weigths);
+		m_cbMemSize -= sizeof(Float) * GetWeightsCount();
+	}
+	m_weigths          = (Float *)weights;
+	m_bExternalWeights = True;
+	if (NULL != biases)
+	{
+		if (!m_bExternalBiases)
+		{
+			Mem::Free(m_biases);
+			m_cbMemSize -= sizeof(Float) * m_cNextNeurons;
+		}
+		m_biases          = (Float *)biases;
+		m_bExternalBiases = True;
+	}
+	MarkAllDirty();
+
+	return Status();
+}
+
+Bool Synapses::IsReadOnly() const
+{
+	return (m_bExternalWeights || m_bExternalBiases);
+}
+
+Status Synapses::MakeWritable()
+{
+	Float   *values;
+
+	if (m_bExternalWeights)
+	{
+		if (NULL == (values = (Float *)Mem::Alloc(sizeof(Float) * GetWeightsCount())))
+		{
+			return Status(Status_MemAllocFailed, "Failed to allocate {1} bytes at {2}:{3}", 
+			              sizeof(Float) * GetWeightsCount(), __FILE__, __LINE__);
+		}
+		memcpy(values, m_weigths, sizeof(Float) * GetWeightsCount());
+		m_weigths          = values;
+		m_bExternalWeights = False;
+		m_cbMemSize       += sizeof(Float) * GetWeightsCount();
+	}
+	if (m_bExternalBiases)
+	{
+		if (NULL == (values = (Float *)Mem::Alloc(sizeof(Float) * m_cNextNeurons)))
+		{
+			return Status(Status_MemAllocFailed, "Failed to allocate {1} bytes at {2}:{3}", 
+			              sizeof(Float) * m_cNextNeurons, __FILE__, __LINE__);
+		}
+		memcpy(values, m_biases, sizeof(Float) * m_cNextNeurons);
+		m_biases          = values;
+		m_bExternalBiases = False;
+		m_cbMemSize      += sizeof(Float) * m_cNextNeurons;
+	}
+
+	return Status();
+}
+
+void Synapses::Prefetch() const
+{
+	if (m_bExternalWeights)
+	{
+		MappedFile::Prefetch(m_weigths, sizeof(Float) * GetWeightsCount());
+	}
+	if (m_bExternalBiases)
+	{
+		MappedFile::Prefetch(m_biases, sizeof(Float) * m_cNextNeurons);
+	}
+}
+
+void Synapses::Evict() const
+{
+	if (m_bExternalWeights)
+	{
+		MappedFile::Evict(m_weigths, sizeof(Float) * GetWeightsCount());
+	}
+	if (m_bExternalBiases)
+	{
+		MappedFile::Evict(m_biases, sizeof(Float) * m_cNextNeurons);
+	}
+}
+
 }//namespace NET
 
 }//namespace N2
@@ -47,6 +47,9 @@ Config::Config()
 	DWORD                                  dwSize;
 	UInt32                                 cCores;
 
+	m_bPinThreads       = False;
+	m_bReplicateWeights = False;
+
 	GetSystemInfo(&sysinfo);
 	m_cThreads = (UInt32)sysinfo.dwNumberOfProcessors;
 
@@ -92,6 +95,26 @@ UInt32 Config::GetThreadsCount() const
 	return m_cThreads;
 }
 
+void Config::SetPinThreads(Bool bPinThreads)
+{
+	m_bPinThreads = bPinThreads;
+}
+
+Bool Config::GetPinThreads() const
+{
+	return m_bPinThreads;
+}
+
+void Config::SetReplicateWeights(Bool bReplicateWeights)
+{
+	m_bReplicateWeights = bReplicateWeights;
+}
+
+Bool Config::GetReplicateWeights() const
+{
+	return m_bReplicateWeights;
+}
+
 }//namespace SWMT
 
 }//namespace N2
@@ -46,6 +46,7 @@ Network::Network(Provider *pProvider)
 	m_pInputNeurons  = NULL;
 	m_pOutputNeurons = NULL;
 	m_cbMemSize      = 0;
+	m_nPriority      = Provider::Priority_Auto;
 }
 
 Network::~Network()
@@ -58,6 +59,16 @@ Provider *Network::GetProvider()
 	return m_pProvider;
 }
 
+void Network::SetPriority(Provider::Priority nPriority)
+{
+	m_nPriority = nPriority;
+}
+
+Provider::Priority Network::GetPriority() const
+{
+	return m_nPriority;
+}
+
 Status Network::Init(NET::Network *pNetwork)
 {
 	Uninit();
@@ -243,7 +254,7 @@ Status Network::SyncToCE(Bool bWait/* = True*/, UInt32 nSyncType/* = Sync_All*/)
 			pNeurons->SyncToCE(True);
 		}
 		pSynapses = pNeurons->m_pNextSynapses;
-		if (NULL != pSynapses)
+		if (NULL == pSynapses)
 		{
 			break;
 		}
@@ -321,8 +332,15 @@ Status Network::Evaluate(UInt32 cCount, Float *inputs, Float *outputs)
 	UInt32             cNextNeuronsOffset;
 	UInt32             cInputsOffset;
 	UInt32             cOutputsOffset;
+	Provider::Priority nPriority;
 	Status             status;
 
+	nPriority = m_nPriority;
+	if (Provider::Priority_Auto == nPriority)
+	{
+		//single samples are latency bound, batches are throughput bound
+		nPriority = (1 == cCount) ? Provider::Priority_High : Provider::Priority_Normal;
+	}
 	cInputsOffset  = 0;
 	cOutputsOffset = 0;
 	for (UInt32 i = 0; i < cCount; i++)
@@ -350,30 +368,8 @@ Status Network::Evaluate(UInt32 cCount, Float *inputs, Float *outputs)
 				nextNeurons        = pSynapses->m_pNextNeurons->m_values;
 				cNextNeuronsOffset = 0;
 			}
-			if (!pSynapses->HasBias())
-			{
-				if (!(status = Compute(prevNeurons, cPrevNeuronsOffset, pSynapses->m_pPrevNeurons->GetNeuronsCount(), 
-				                       pSynapses->m_weights, 
-				                       nextNeurons, cNextNeuronsOffset, pSynapses->m_pNextNeurons->GetNeuronsCount())))
-				{
-					break;
-				}
-			}
-			else
-			{
-				if (!(status = ComputeWithBias(pSynapses->GetBias(), 
-				                            prevNeurons, cPrevNeuronsOffset, pSynapses->m_pPrevNeurons->GetNeuronsCount(), 
-				                            pSynapses->m_weights, pSynapses->m_biases, 
-				                            nextNeurons, cNextNeuronsOffset, pSynapses->m_pNextNeurons->GetNeuronsCount())))
-				{
-					break;
-				}
-			}
-
-			if (!(status = Activate(nextNeurons, cNextNeuronsOffset, pSynapses->m_pNextNeurons->GetNeuronsCount(), 
-			                        pSynapses->m_pNextNeurons->GetActivation(), 
-			                        pSynapses->m_pNextNeurons->GetActivationArgsCount(), 
-			                        pSynapses->m_pNextNeurons->GetActivationArgs())))
+			if (!(status = EvaluateLayer(pSynapses, prevNeurons, cPrevNeuronsOffset, nextNeurons, cNextNeuronsOffset, 
+			                             nPriority, Provider::SHARED_GROUP)))
 			{
 				break;
 			}
@@ -395,67 +391,122 @@ Status Network::Evaluate(UInt32 cCount, Float *inputs, Float *outputs)
 	return Status();
 }
 
-Status Network::Compute(Float *prevNeurons, UInt32 cPrevNeuronsOffset, UInt32 cPrevNeuronsCount,
-                        Float *weights, 
-                        Float *nextNeurons, UInt32 cNextNeuronsOffset, UInt32 cNextNeuronsCount)
+Status Network::EvaluateLayer(Synapses *pSynapses, 
+                              Float *prevNeurons, UInt32 cPrevNeuronsOffset, 
+                              Float *nextNeurons, UInt32 cNextNeuronsOffset, 
+                              Provider::Priority nPriority, UInt32 cGroup)
 {
-	ComputeKernel   krnl;
-	UInt32          dims[1] = { cNextNeuronsCount };
-
-	krnl.prevNeurons        = prevNeurons;
-	krnl.cPrevNeuronsOffset = cPrevNeuronsOffset;
-	krnl.cPrevNeuronsCount  = cPrevNeuronsCount;
-	krnl.weights            = weights;
-	krnl.nextNeurons        = nextNeurons;
-	krnl.cNextNeuronsOffset = cNextNeuronsOffset;
-	krnl.cNextNeuronsCount  = cNextNeuronsCount;
-	m_pProvider->RunKernel(&krnl, sizeof(dims) / sizeof(dims[0]), dims);
+	Status   status;
 
-	return Status();
+	if (!pSynapses->HasBias())
+	{
+		if (!(status = Compute(prevNeurons, cPrevNeuronsOffset, pSynapses->m_pPrevNeurons->GetNeuronsCount(), 
+		                       pSynapses->m_weights, 
+		                       nextNeurons, cNextNeuronsOffset, pSynapses->m_pNextNeurons->GetNeuronsCount(), 
+		                       nPriority, cGroup)))
+		{
+			return status;
+		}
+	}
+	else
+	{
+		if (!(status = ComputeWithBias(pSynapses->GetBias(), 
+		                               prevNeurons, cPrevNeuronsOffset, pSynapses->m_pPrevNeurons->GetNeuronsCount(), 
+		                               pSynapses->m_weights, pSynapses->m_biases, 
+		                               nextNeurons, cNextNeuronsOffset, pSynapses->m_pNextNeurons->GetNeuronsCount(), 
+		                               nPriority, cGroup)))
+		{
+			return status;
+		}
+	}
+
+	return Activate(nextNeurons, cNextNeuronsOffset, pSynapses->m_pNextNeurons->GetNeuronsCount(), 
+	                pSynapses->m_pNextNeurons->GetActivation(), 
+	                pSynapses->m_pNextNeurons->GetActivationArgsCount(), 
+	                pSynapses->m_pNextNeurons->GetActivationArgs(), nPriority, cGroup);
 }
 
-Status Network::ComputeWithBias(Float fBias, 
-                                Float *prevNeurons, UInt32 cPrevNeuronsOffset, UInt32 cPrevNeuronsCount,
-                                Float *weights, Float *biases, 
-                                Float *nextNeurons, UInt32 cNextNeuronsOffset, UInt32 cNextNeuronsCount)
+Status Network::Compute(Float *prevNeurons, UInt32 cPrevNeuronsOffset, UInt32 cPrevNeuronsCount,
+                        Float **weights, 
+                        Float *nextNeurons, UInt32 cNextNeuronsOffset, UInt32 cNextNeuronsCount, 
+                        Provider::Priority nPriority, UInt32 cGroup)
 {
-	ComputeWithBiasKernel   krnl;
+	Kernel<ComputeKernel>   krnl;
 	UInt32                  dims[1] = { cNextNeuronsCount };
 
-	krnl.fBias              = fBias;
-	krnl.prevNeurons        = prevNeurons;
-	krnl.cPrevNeuronsOffset = cPrevNeuronsOffset;
-	krnl.cPrevNeuronsCount  = cPrevNeuronsCount;
-	krnl.weights            = weights;
-	krnl.biases             = biases;
-	krnl.nextNeurons        = nextNeurons;
-	krnl.cNextNeuronsOffset = cNextNeuronsOffset;
-	krnl.cNextNeuronsCount  = cNextNeuronsCount;
-	m_pProvider->RunKernel(&krnl, sizeof(dims) / sizeof(dims[0]), dims);
+	krnl.body.prevNeurons        = prevNeurons;
+	krnl.body.cPrevNeuronsOffset = cPrevNeuronsOffset;
+	krnl.body.cPrevNeuronsCount  = cPrevNeuronsCount;
+	krnl.body.weights            = weights;
+	krnl.body.nextNeurons        = nextNeurons;
+	krnl.body.cNextNeuronsOffset = cNextNeuronsOffset;
+	krnl.body.cNextNeuronsCount  = cNextNeuronsCount;
 
-	return Status();
+	return m_pProvider->RunKernel(&krnl, sizeof(dims) / sizeof(dims[0]), dims, nextNeurons + cNextNeuronsOffset, 
+	                              nPriority, cGroup);
+}
+
+Status Network::ComputeWithBias(Float fBias, 
+                                Float *prevNeurons, UInt32 cPrevNeuronsOffset, UInt32 cPrevNeuronsCount,
+                                Float **weights, Float **biases, 
+                                Float *nextNeurons, UInt32 cNextNeuronsOffset, UInt32 cNextNeuronsCount, 
+                                Provider::Priority nPriority, UInt32 cGroup)
+{
+	Kernel<ComputeWithBiasKernel>   krnl;
+	UInt32                          dims[1] = { cNextNeuronsCount };
+
+	krnl.body.fBias              = fBias;
+	krnl.body.prevNeurons        = prevNeurons;
+	krnl.body.cPrevNeuronsOffset = cPrevNeuronsOffset;
+	krnl.body.cPrevNeuronsCount  = cPrevNeuronsCount;
+	krnl.body.weights            = weights;
+	krnl.body.biases             = biases;
+	krnl.body.nextNeurons        = nextNeurons;
+	krnl.body.cNextNeuronsOffset = cNextNeuronsOffset;
+	krnl.body.cNextNeuronsCount  = cNextNeuronsCount;
+
+	return m_pProvider->RunKernel(&krnl, sizeof(dims) / sizeof(dims[0]), dims, nextNeurons + cNextNeuronsOffset, 
+	                              nPriority, cGroup);
 }
 
 Status Network::Activate(Float *nextNeurons, UInt32 cNextNeuronsOffset, UInt32 cNextNeuronsCount, 
-                         NET::ActivationType nActivation, UInt32 cActivationArgs, const Float *activationArgs)
+                         NET::ActivationType nActivation, UInt32 cActivationArgs, const Float *activationArgs, 
+                         Provider::Priority nPriority, UInt32 cGroup)
 {
 	if (NET::Activation::Identity == nActivation)
 	{
 		return Status();
 	}
+	//one sample is too small to split the exp sum across the workers
+	if (NET::Activation::SoftMax == nActivation)
+	{
+		Float   *next   = nextNeurons + cNextNeuronsOffset;
+		Float   fExpSum = 0.0f;
 
-	ActivateKernel   krnl;
-	UInt32           dims[1] = { cNextNeuronsCount };
- 
-	krnl.nextNeurons        = nextNeurons;
-	krnl.cNextNeuronsOffset = cNextNeuronsOffset;
-	krnl.cNextNeuronsCount  = cNextNeuronsCount;
-	krnl.nActivation        = nActivation;
-	krnl.cActivationArgs   = cActivationArgs;
-	krnl.activationArgs     = activationArgs;
-	m_pProvider->RunKernel(&krnl, sizeof(dims) / sizeof(dims[0]), dims);
+		for (UInt32 i = 0; i < cNextNeuronsCount; i++)
+		{
+			fExpSum += exp(next[i]);
+		}
+		for (UInt32 i = 0; i < cNextNeuronsCount; i++)
+		{
+			next[i] = exp(next[i]) / fExpSum;
+		}
 
-	return Status();
+		return Status();
+	}
+
+	Kernel<ActivateKernel>   krnl;
+	UInt32                   dims[1] = { cNextNeuronsCount };
+ 
+	krnl.body.nextNeurons        = nextNeurons;
+	krnl.body.cNextNeuronsOffset = cNextNeuronsOffset;
+	krnl.body.cNextNeuronsCount  = cNextNeuronsCount;
+	krnl.body.nActivation        = nActivation;
+	krnl.body.cActivationArgs    = cActivationArgs;
+	krnl.body.activationArgs     = activationArgs;
+
+	return m_pProvider->RunKernel(&krnl, sizeof(dims) / sizeof(dims[0]), dims, nextNeurons + cNextNeuronsOffset, 
+	                              nPriority, cGroup);
 }
 
 }//namespace SWMT
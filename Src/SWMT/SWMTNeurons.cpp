@@ -30,6 +30,7 @@
 #include "N2/SWMT/Network.hpp"
 #include "N2/SWMT/Provider.hpp"
 #include "N2/SWMT/Synapses.hpp"
+#include <malloc.h>
 
 
 using namespace CX;
@@ -61,6 +62,7 @@ Status Neurons::Init(NET::Neurons *pNeurons)
 	Uninit();
 
 	UInt32   cNeurons;
+	Size     cbSize;
 	Status   status;
 
 	m_cbMemSize = sizeof(Neurons);
@@ -73,9 +75,12 @@ Status Neurons::Init(NET::Neurons *pNeurons)
 			break;
 		}
 		cNeurons = pNeurons->GetNeuronsCount();
-		if (NULL == (m_values = (Float *)Mem::Alloc(sizeof(Float) * cNeurons)))
+		//whole cache lines, so threads writing the values never share a line with other data
+		cbSize   = (sizeof(Float) * cNeurons + Provider::CACHE_LINE_SIZE - 1) / Provider::CACHE_LINE_SIZE * 
+		           Provider::CACHE_LINE_SIZE;
+		if (NULL == (m_values = (Float *)_aligned_malloc(cbSize, Provider::CACHE_LINE_SIZE)))
 		{
-			status = Status(Status_MemAllocFailed, "Failed to allocate {1} bytes at {2}:{3}", sizeof(Float) * cNeurons, 
+			status = Status(Status_MemAllocFailed, "Failed to allocate {1} bytes at {2}:{3}", cbSize, 
 			                __FILE__, __LINE__);
 
 			break;
@@ -84,7 +89,7 @@ Status Neurons::Init(NET::Neurons *pNeurons)
 		m_pNeurons      = pNeurons;
 		m_pPrevSynapses = NULL;
 		m_pNextSynapses = NULL;
-		m_cbMemSize += sizeof(Float) * pNeurons->GetNeuronsCount();
+		m_cbMemSize += cbSize;
 
 		break;
 	}
@@ -100,7 +105,7 @@ Status Neurons::Uninit()
 {
 	if (NULL != m_values)
 	{
-		Mem::Free(m_values);
+		_aligned_free(m_values);
 	}
 	m_pNeurons             = NULL;
 	m_pPrevSynapses        = NULL;
@@ -0,0 +1,755 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "N2/SWMT/Pipeline.hpp"
+#include <malloc.h>
+
+
+using namespace CX;
+
+
+namespace N2
+{
+
+namespace SWMT
+{
+
+Pipeline::Pipeline()
+{
+	m_pNetwork        = NULL;
+	m_layers          = NULL;
+	m_cLayers         = 0;
+	m_stages          = NULL;
+	m_cStages         = 0;
+	m_slots           = NULL;
+	m_cSlots          = 0;
+	m_cMicroBatchSize = 0;
+	m_hFreeSemaphore  = NULL;
+	m_hStopEvent      = NULL;
+	m_cInFlight       = 0;
+	m_cTicksPerSecond = 1;
+	InitializeSRWLock(&m_srwlInFlight);
+	InitializeConditionVariable(&m_cvInFlight);
+}
+
+Pipeline::~Pipeline()
+{
+	Uninit();
+}
+
+Status Pipeline::Init(Network *pNetwork, UInt32 cStages/* = 0*/, 
+                      UInt32 cMicroBatchSize/* = DEFAULT_MICRO_BATCH_SIZE*/, 
+                      UInt32 cQueueDepth/* = DEFAULT_QUEUE_DEPTH*/)
+{
+	Uninit();
+
+	if (NULL == pNetwork || !pNetwork->IsOK() || 0 == cMicroBatchSize || 0 == cQueueDepth)
+	{
+		return Status(Status_InvalidArg, "Invalid arg at {1}:{2}", __FILE__, __LINE__);
+	}
+
+	Provider        *pProvider = pNetwork->GetProvider();
+	Synapses        *pSynapses;
+	LARGE_INTEGER   liFreq;
+	UInt32          cAvailThreads;
+	DWORD           dwID;
+	Status          status;
+
+	QueryPerformanceFrequency(&liFreq);
+	m_cTicksPerSecond = liFreq.QuadPart;
+	m_pNetwork        = pNetwork;
+	m_cMicroBatchSize = cMicroBatchSize;
+	for (;;)
+	{
+		//layers
+		m_cLayers = 0;
+		pSynapses = pNetwork->m_pInputNeurons->m_pNextSynapses;
+		while (NULL != pSynapses)
+		{
+			m_cLayers++;
+			pSynapses = pSynapses->m_pNextNeurons->m_pNextSynapses;
+		}
+		if (0 == m_cLayers)
+		{
+			status = Status(Status_InvalidArg, "Network has no layers at {1}:{2}", __FILE__, __LINE__);
+
+			break;
+		}
+		if (NULL == (m_layers = (Layer *)Mem::Alloc(sizeof(Layer) * m_cLayers)))
+		{
+			status = Status(Status_MemAllocFailed, "Failed to allocate {1} bytes at {2}:{3}", sizeof(Layer) * m_cLayers, 
+			                __FILE__, __LINE__);
+
+			break;
+		}
+		memset(m_layers, 0, sizeof(Layer) * m_cLayers);
+		pSynapses = pNetwork->m_pInputNeurons->m_pNextSynapses;
+		for (UInt32 i = 0; i < m_cLayers; i++)
+		{
+			m_layers[i].pSynapses = pSynapses;
+			pSynapses             = pSynapses->m_pNextNeurons->m_pNextSynapses;
+		}
+
+		//stages; one provider thread always stays in the shared pool
+		cAvailThreads = pProvider->GetGroupThreadsCount(Provider::SHARED_GROUP);
+		if (0 < cAvailThreads)
+		{
+			cAvailThreads--;
+		}
+		if (0 == cStages)
+		{
+			cStages = cAvailThreads;
+		}
+		if (cStages > m_cLayers)
+		{
+			cStages = m_cLayers;
+		}
+		if (0 == cStages || cStages > cAvailThreads)
+		{
+			status = Status(Status_InvalidArg, "{1} threads available for {2} stages at {3}:{4}", cAvailThreads, cStages, 
+			                __FILE__, __LINE__);
+
+			break;
+		}
+		if (NULL == (m_stages = new (std::nothrow) Stage[cStages]))
+		{
+			status = Status(Status_MemAllocFailed, "Failed to allocate {1} bytes at {2}:{3}", sizeof(Stage) * cStages, 
+			                __FILE__, __LINE__);
+
+			break;
+		}
+		m_cStages = cStages;
+		if (!(status = SplitLayers(cStages)))
+		{
+			break;
+		}
+		//threads are given one at a time to the stage with the most FLOPs per thread
+		for (UInt32 i = 0; i < m_cStages; i++)
+		{
+			m_stages[i].cThreads = 1;
+		}
+		for (UInt32 k = m_cStages; k < cAvailThreads; k++)
+		{
+			Double   lfMax   = 0.0;
+			UInt32   cBusiest = 0;
+
+			for (UInt32 i = 0; i < m_cStages; i++)
+			{
+				Double   lfFLOPs = 0.0;
+
+				for (UInt32 j = 0; j < m_stages[i].cLayersCount; j++)
+				{
+					lfFLOPs += 2.0 * m_layers[m_stages[i].cFirstLayer + j].pSynapses->GetWeightsCount();
+				}
+				lfFLOPs /= m_stages[i].cThreads;
+				if (lfFLOPs > lfMax)
+				{
+					lfMax    = lfFLOPs;
+					cBusiest = i;
+				}
+			}
+			m_stages[cBusiest].cThreads++;
+		}
+
+		//scratch values for the layers inside a stage
+		for (UInt32 i = 0; i < m_cStages; i++)
+		{
+			for (UInt32 j = 0; j + 1 < m_stages[i].cLayersCount; j++)
+			{
+				Layer   *pLayer = &m_layers[m_stages[i].cFirstLayer + j];
+				Size    cbSize  = sizeof(Float) * pLayer->pSynapses->GetNextNeuronsCount();
+
+				if (NULL == (pLayer->values = (Float *)_aligned_malloc(cbSize, Provider::CACHE_LINE_SIZE)))
+				{
+					status = Status(Status_MemAllocFailed, "Failed to allocate {1} bytes at {2}:{3}", cbSize, 
+					                __FILE__, __LINE__);
+
+					break;
+				}
+			}
+			if (!status)
+			{
+				break;
+			}
+		}
+		if (!status)
+		{
+			break;
+		}
+
+		//micro-batch slots
+		m_cSlots = m_cStages * cQueueDepth;
+		if (NULL == (m_slots = (Slot *)Mem::Alloc(sizeof(Slot) * m_cSlots)))
+		{
+			status = Status(Status_MemAllocFailed, "Failed to allocate {1} bytes at {2}:{3}", sizeof(Slot) * m_cSlots, 
+			                __FILE__, __LINE__);
+
+			break;
+		}
+		memset(m_slots, 0, sizeof(Slot) * m_cSlots);
+		if (!(status = m_freeSlots.Init(GetQueueCapacity(m_cSlots))))
+		{
+			break;
+		}
+		for (UInt32 i = 0; i < m_cSlots; i++)
+		{
+			if (1 < m_cStages)
+			{
+				if (NULL == (m_slots[i].boundaries = (Float **)Mem::Alloc(sizeof(Float *) * (m_cStages - 1))))
+				{
+					status = Status(Status_MemAllocFailed, "Failed to allocate {1} bytes at {2}:{3}", 
+					                sizeof(Float *) * (m_cStages - 1), __FILE__, __LINE__);
+
+					break;
+				}
+				memset(m_slots[i].boundaries, 0, sizeof(Float *) * (m_cStages - 1));
+				for (UInt32 k = 0; k + 1 < m_cStages; k++)
+				{
+					Layer   *pLayer = &m_layers[m_stages[k].cFirstLayer + m_stages[k].cLayersCount - 1];
+					Size    cbSize  = sizeof(Float) * pLayer->pSynapses->GetNextNeuronsCount() * m_cMicroBatchSize;
+
+					if (NULL == (m_slots[i].boundaries[k] = (Float *)_aligned_malloc(cbSize, Provider::CACHE_LINE_SIZE)))
+					{
+						status = Status(Status_MemAllocFailed, "Failed to allocate {1} bytes at {2}:{3}", cbSize, 
+						                __FILE__, __LINE__);
+
+						break;
+					}
+				}
+				if (!status)
+				{
+					break;
+				}
+			}
+			m_freeSlots.Push(i);
+		}
+		if (!status)
+		{
+			break;
+		}
+		if (NULL == (m_hFreeSemaphore = CreateSemaphore(NULL, (LONG)m_cSlots, (LONG)m_cSlots, NULL)))
+		{
+			status = Status(Status_OperationFailed, "Failed to create semaphore at {1}:{2}", __FILE__, __LINE__);
+
+			break;
+		}
+		if (NULL == (m_hStopEvent = CreateEvent(NULL, TRUE, FALSE, NULL)))
+		{
+			status = Status(Status_OperationFailed, "Failed to create stop event at {1}:{2}", __FILE__, __LINE__);
+
+			break;
+		}
+
+		//stage queues, groups and threads
+		for (UInt32 i = 0; i < m_cStages; i++)
+		{
+			m_stages[i].pPipeline = this;
+			m_stages[i].cIndex    = i;
+			if (!(status = m_stages[i].queue.Init(GetQueueCapacity(cQueueDepth))))
+			{
+				break;
+			}
+			if (NULL == (m_stages[i].hSemaphore = CreateSemaphore(NULL, 0, (LONG)m_cSlots, NULL)))
+			{
+				status = Status(Status_OperationFailed, "Failed to create semaphore for stage {1} at {2}:{3}", i, 
+				                __FILE__, __LINE__);
+
+				break;
+			}
+			if (NULL == (m_stages[i].hSpaceSemaphore = CreateSemaphore(NULL, (LONG)cQueueDepth, (LONG)cQueueDepth, 
+			                                                           NULL)))
+			{
+				status = Status(Status_OperationFailed, "Failed to create semaphore for stage {1} at {2}:{3}", i, 
+				                __FILE__, __LINE__);
+
+				break;
+			}
+			if (!(status = pProvider->ReserveGroup(m_stages[i].cThreads, &m_stages[i].cGroup)))
+			{
+				break;
+			}
+		}
+		if (!status)
+		{
+			break;
+		}
+		ResetStats();
+		for (UInt32 i = 0; i < m_cStages; i++)
+		{
+			if (NULL == (m_stages[i].hThread = CreateThread(NULL, Provider::THREAD_STACK_SIZE, &Pipeline::StageThread, 
+			                                                &m_stages[i], 0, &dwID)))
+			{
+				status = Status(Status_OperationFailed, "Failed to create thread for stage {1} with error {2} at {3}:{4}", 
+				                i, (int)GetLastError(), __FILE__, __LINE__);
+
+				break;
+			}
+		}
+		if (!status)
+		{
+			break;
+		}
+
+		break;
+	}
+	if (!status)
+	{
+		Uninit();
+	}
+
+	return status;
+}
+
+Status Pipeline::Uninit()
+{
+	if (NULL != m_stages)
+	{
+		Bool   bRunning = False;
+
+		for (UInt32 i = 0; i < m_cStages; i++)
+		{
+			if (NULL != m_stages[i].hThread)
+			{
+				bRunning = True;
+			}
+		}
+		if (bRunning)
+		{
+			Wait();
+			SetEvent(m_hStopEvent);
+		}
+		for (UInt32 i = 0; i < m_cStages; i++)
+		{
+			if (NULL != m_stages[i].hThread)
+			{
+				WaitForSingleObject(m_stages[i].hThread, INFINITE);
+				CloseHandle(m_stages[i].hThread);
+			}
+			if (NULL != m_stages[i].hSemaphore)
+			{
+				CloseHandle(m_stages[i].hSemaphore);
+			}
+			if (NULL != m_stages[i].hSpaceSemaphore)
+			{
+				CloseHandle(m_stages[i].hSpaceSemaphore);
+			}
+			if (Provider::SHARED_GROUP != m_stages[i].cGroup)
+			{
+				m_pNetwork->GetProvider()->ReleaseGroup(m_stages[i].cGroup);
+			}
+		}
+		delete [] m_stages;
+	}
+	if (NULL != m_slots)
+	{
+		for (UInt32 i = 0; i < m_cSlots; i++)
+		{
+			if (NULL != m_slots[i].boundaries)
+			{
+				for (UInt32 k = 0; k + 1 < m_cStages; k++)
+				{
+					if (NULL != m_slots[i].boundaries[k])
+					{
+						_aligned_free(m_slots[i].boundaries[k]);
+					}
+				}
+				Mem::Free(m_slots[i].boundaries);
+			}
+		}
+		Mem::Free(m_slots);
+	}
+	if (NULL != m_layers)
+	{
+		for (UInt32 i = 0; i < m_cLayers; i++)
+		{
+			if (NULL != m_layers[i].values)
+			{
+				_aligned_free(m_layers[i].values);
+			}
+		}
+		Mem::Free(m_layers);
+	}
+	m_freeSlots.Uninit();
+	if (NULL != m_hFreeSemaphore)
+	{
+		CloseHandle(m_hFreeSemaphore);
+	}
+	if (NULL != m_hStopEvent)
+	{
+		CloseHandle(m_hStopEvent);
+	}
+	m_pNetwork        = NULL;
+	m_layers          = NULL;
+	m_cLayers         = 0;
+	m_stages          = NULL;
+	m_cStages         = 0;
+	m_slots           = NULL;
+	m_cSlots          = 0;
+	m_cMicroBatchSize = 0;
+	m_hFreeSemaphore  = NULL;
+	m_hStopEvent      = NULL;
+	m_cInFlight       = 0;
+	m_status          = Status();
+
+	return Status();
+}
+
+Bool Pipeline::IsOK() const
+{
+	return (NULL != m_stages);
+}
+
+UInt32 Pipeline::GetStagesCount() const
+{
+	return m_cStages;
+}
+
+UInt32 Pipeline::GetMicroBatchSize() const
+{
+	return m_cMicroBatchSize;
+}
+
+Status Pipeline::SplitLayers(UInt32 cStages)
+{
+	Double   lfTotal;
+	Double   lfSum;
+	Double   lfTarget;
+	Double   lfFLOPs;
+	UInt32   cLayer;
+
+	lfTotal = 0.0;
+	for (UInt32 i = 0; i < m_cLayers; i++)
+	{
+		lfTotal += 2.0 * m_layers[i].pSynapses->GetWeightsCount();
+	}
+
+	//a stage takes layers while its cumulated FLOPs stay closest to its share, leaving one layer for each next stage
+	lfSum  = 0.0;
+	cLayer = 0;
+	for (UInt32 k = 0; k < cStages; k++)
+	{
+		lfTarget                = lfTotal * (k + 1) / cStages;
+		m_stages[k].cFirstLayer = cLayer;
+		lfSum += 2.0 * m_layers[cLayer].pSynapses->GetWeightsCount();
+		cLayer++;
+		if (k + 1 == cStages)
+		{
+			cLayer = m_cLayers;
+		}
+		else
+		{
+			while (cLayer + (cStages - k - 1) < m_cLayers)
+			{
+				lfFLOPs = 2.0 * m_layers[cLayer].pSynapses->GetWeightsCount();
+				if (lfSum + lfFLOPs / 2.0 > lfTarget)
+				{
+					break;
+				}
+				lfSum += lfFLOPs;
+				cLayer++;
+			}
+		}
+		m_stages[k].cLayersCount = cLayer - m_stages[k].cFirstLayer;
+	}
+
+	return Status();
+}
+
+Status Pipeline::Submit(UInt32 cCount, Float *inputs, Float *outputs)
+{
+	if (NULL == m_stages)
+	{
+		return Status(Status_NotInitialized, "Not initialized at {1}:{2}", __FILE__, __LINE__);
+	}
+	if (0 == cCount || NULL == inputs || NULL == outputs)
+	{
+		return Status(Status_InvalidArg, "Invalid arg at {1}:{2}", __FILE__, __LINE__);
+	}
+
+	UInt32   cInputs  = m_pNetwork->m_pInputNeurons->GetNeuronsCount();
+	UInt32   cOutputs = m_pNetwork->m_pOutputNeurons->GetNeuronsCount();
+	UInt32   cSlot;
+
+	for (UInt32 i = 0; i < cCount; i += m_cMicroBatchSize)
+	{
+		//back pressure: waits for a free slot
+		WaitForSingleObject(m_hFreeSemaphore, INFINITE);
+		while (!m_freeSlots.Pop(&cSlot))
+		{
+			YieldProcessor();
+		}
+		m_slots[cSlot].cCount  = (cCount - i < m_cMicroBatchSize) ? cCount - i : m_cMicroBatchSize;
+		m_slots[cSlot].inputs  = inputs + (Size)i * cInputs;
+		m_slots[cSlot].outputs = outputs + (Size)i * cOutputs;
+		m_slots[cSlot].bFailed = False;
+
+		AcquireSRWLockExclusive(&m_srwlInFlight);
+		m_cInFlight++;
+		ReleaseSRWLockExclusive(&m_srwlInFlight);
+
+		//the queue holds at least the depth, so the push cannot fail once there is room
+		WaitForSingleObject(m_stages[0].hSpaceSemaphore, INFINITE);
+		m_stages[0].queue.Push(cSlot);
+		ReleaseSemaphore(m_stages[0].hSemaphore, 1, NULL);
+	}
+
+	return Status();
+}
+
+Status Pipeline::Wait()
+{
+	if (NULL == m_stages)
+	{
+		return Status(Status_NotInitialized, "Not initialized at {1}:{2}", __FILE__, __LINE__);
+	}
+
+	Status   status;
+
+	AcquireSRWLockExclusive(&m_srwlInFlight);
+	while (0 < m_cInFlight)
+	{
+		SleepConditionVariableSRW(&m_cvInFlight, &m_srwlInFlight, INFINITE, 0);
+	}
+	status   = m_status;
+	m_status = Status();
+	ReleaseSRWLockExclusive(&m_srwlInFlight);
+
+	return status;
+}
+
+Status Pipeline::GetStageStats(UInt32 cStage, StageStats *pStats) const
+{
+	if (NULL == m_stages)
+	{
+		return Status(Status_NotInitialized, "Not initialized at {1}:{2}", __FILE__, __LINE__);
+	}
+	if (cStage >= m_cStages || NULL == pStats)
+	{
+		return Status(Status_InvalidArg, "Invalid arg at {1}:{2}", __FILE__, __LINE__);
+	}
+
+	const Stage   *pStage = &m_stages[cStage];
+
+	pStats->cFirstLayer       = pStage->cFirstLayer;
+	pStats->cLayersCount      = pStage->cLayersCount;
+	pStats->cThreads          = pStage->cThreads;
+	pStats->cMicroBatches     = pStage->cMicroBatches;
+	pStats->cSamples          = pStage->cSamples;
+	pStats->lfBusyTime        = (Double)pStage->cBusyTicks / m_cTicksPerSecond;
+	pStats->lfInputStallTime  = (Double)pStage->cInputStallTicks / m_cTicksPerSecond;
+	pStats->lfOutputStallTime = (Double)pStage->cOutputStallTicks / m_cTicksPerSecond;
+
+	return Status();
+}
+
+Status Pipeline::ResetStats()
+{
+	if (NULL == m_stages)
+	{
+		return Status(Status_NotInitialized, "Not initialized at {1}:{2}", __FILE__, __LINE__);
+	}
+	for (UInt32 i = 0; i < m_cStages; i++)
+	{
+		m_stages[i].cMicroBatches     = 0;
+		m_stages[i].cSamples          = 0;
+		m_stages[i].cBusyTicks        = 0;
+		m_stages[i].cInputStallTicks  = 0;
+		m_stages[i].cOutputStallTicks = 0;
+	}
+
+	return Status();
+}
+
+Status Pipeline::RunStage(Stage *pStage, Slot *pSlot)
+{
+	Layer    *pLayer;
+	Float    *prevNeurons;
+	UInt32   cPrevNeuronsOffset;
+	Float    *nextNeurons;
+	UInt32   cNextNeuronsOffset;
+	Status   status;
+
+	for (UInt32 i = 0; i < pSlot->cCount; i++)
+	{
+		pLayer = &m_layers[pStage->cFirstLayer];
+		if (0 == pStage->cIndex)
+		{
+			prevNeurons        = pSlot->inputs;
+			cPrevNeuronsOffset = i * pLayer->pSynapses->GetPrevNeuronsCount();
+		}
+		else
+		{
+			prevNeurons        = pSlot->boundaries[pStage->cIndex - 1];
+			cPrevNeuronsOffset = i * pLayer->pSynapses->GetPrevNeuronsCount();
+		}
+		for (UInt32 j = 0; j < pStage->cLayersCount; j++, pLayer++)
+		{
+			if (j + 1 < pStage->cLayersCount)
+			{
+				nextNeurons        = pLayer->values;
+				cNextNeuronsOffset = 0;
+			}
+			else
+			if (pStage->cIndex + 1 < m_cStages)
+			{
+				nextNeurons        = pSlot->boundaries[pStage->cIndex];
+				cNextNeuronsOffset = i * pLayer->pSynapses->GetNextNeuronsCount();
+			}
+			else
+			{
+				nextNeurons        = pSlot->outputs;
+				cNextNeuronsOffset = i * pLayer->pSynapses->GetNextNeuronsCount();
+			}
+			if (!(status = m_pNetwork->EvaluateLayer(pLayer->pSynapses, prevNeurons, cPrevNeuronsOffset, 
+			                                         nextNeurons, cNextNeuronsOffset, Provider::Priority_Normal, 
+			                                         pStage->cGroup)))
+			{
+				return status;
+			}
+			prevNeurons        = nextNeurons;
+			cPrevNeuronsOffset = cNextNeuronsOffset;
+		}
+	}
+
+	return Status();
+}
+
+void Pipeline::FailSlot(UInt32 cSlot, const Status &status)
+{
+	m_slots[cSlot].bFailed = True;
+
+	AcquireSRWLockExclusive(&m_srwlInFlight);
+	if (m_status)
+	{
+		m_status = status;
+	}
+	ReleaseSRWLockExclusive(&m_srwlInFlight);
+}
+
+void Pipeline::CompleteSlot(UInt32 cSlot)
+{
+	m_freeSlots.Push(cSlot);
+	ReleaseSemaphore(m_hFreeSemaphore, 1, NULL);
+
+	AcquireSRWLockExclusive(&m_srwlInFlight);
+	m_cInFlight--;
+	if (0 == m_cInFlight)
+	{
+		WakeAllConditionVariable(&m_cvInFlight);
+	}
+	ReleaseSRWLockExclusive(&m_srwlInFlight);
+}
+
+UInt32 Pipeline::GetQueueCapacity(UInt32 cCount)
+{
+	UInt32   cCapacity = 2;
+
+	while (cCapacity < cCount)
+	{
+		cCapacity *= 2;
+	}
+
+	return cCapacity;
+}
+
+Int64 Pipeline::GetTicks()
+{
+	LARGE_INTEGER   liCounter;
+
+	QueryPerformanceCounter(&liCounter);
+
+	return liCounter.QuadPart;
+}
+
+DWORD WINAPI Pipeline::StageThread(void *pArg)
+{
+	Stage      *pStage    = (Stage *)pArg;
+	Pipeline   *pPipeline = pStage->pPipeline;
+	Stage      *pNext     = NULL;
+	HANDLE     handles[2] = { pPipeline->m_hStopEvent, pStage->hSemaphore };
+	UInt32     cSlot;
+	Int64      cStart;
+	Int64      cReady;
+	Int64      cDone;
+	DWORD      dwRet;
+	Status     status;
+
+	if (pStage->cIndex + 1 < pPipeline->m_cStages)
+	{
+		pNext = &pPipeline->m_stages[pStage->cIndex + 1];
+	}
+	for (;;)
+	{
+		cStart = GetTicks();
+		dwRet  = WaitForMultipleObjects(2, handles, FALSE, INFINITE);
+		if (WAIT_OBJECT_0 + 1 != dwRet)
+		{
+			break;
+		}
+		while (!pStage->queue.Pop(&cSlot))
+		{
+			YieldProcessor();
+		}
+		ReleaseSemaphore(pStage->hSpaceSemaphore, 1, NULL);
+		cReady = GetTicks();
+		pStage->cInputStallTicks += cReady - cStart;
+
+		//a failed micro-batch still flows to the end so Wait returns (with the failure)
+		if (!pPipeline->m_slots[cSlot].bFailed)
+		{
+			if (!(status = pPipeline->RunStage(pStage, &pPipeline->m_slots[cSlot])))
+			{
+				pPipeline->FailSlot(cSlot, status);
+			}
+		}
+
+		cDone = GetTicks();
+		pStage->cBusyTicks += cDone - cReady;
+		pStage->cMicroBatches++;
+		pStage->cSamples += pPipeline->m_slots[cSlot].cCount;
+
+		if (NULL == pNext)
+		{
+			pPipeline->CompleteSlot(cSlot);
+		}
+		else
+		{
+			//back pressure: blocks while the next stage is behind by a whole queue depth
+			WaitForSingleObject(pNext->hSpaceSemaphore, INFINITE);
+			pNext->queue.Push(cSlot);
+			ReleaseSemaphore(pNext->hSemaphore, 1, NULL);
+			pStage->cOutputStallTicks += GetTicks() - cDone;
+		}
+	}
+
+	return 0;
+}
+
+}//namespace SWMT
+
+}//namespace N2
@@ -30,6 +30,7 @@
 #include "N2/SWMT/Network.hpp"
 #include "N2/SWMT/Config.hpp"
 #include "CX/Print.hpp"
+#include <malloc.h>
 
 
 using namespace CX;
@@ -43,13 +44,17 @@ namespace SWMT
 
 Provider::Provider()
 {
-	InitializeSRWLock(&m_srwlThreads);
-	m_stopEvents   = NULL;
-	m_startEvents  = NULL;
-	m_finishEvents = NULL;
-	m_threads      = NULL;
-	m_entries      = NULL;
-	m_cThreads     = 0;
+	m_hStopEvent = NULL;
+	m_hSemaphore = NULL;
+	m_threads    = NULL;
+	m_entries    = NULL;
+	m_nodes      = NULL;
+	m_groups     = NULL;
+	m_jobs       = NULL;
+	m_cThreads   = 0;
+	m_cNodes     = 0;
+	m_cReplicas  = 0;
+	InitializeSRWLock(&m_srwlGroups);
 }
 
 Provider::~Provider()
@@ -77,6 +82,11 @@ Status Provider::DestroyConfig(CE::IConfig *pConfig)
 
 Status Provider::Init(const CE::IConfig *pConfig/* = NULL*/)
 {
+	Bool   bPinThreads;
+	Bool   bReplicateWeights;
+
+	Uninit();
+
 	if (NULL != pConfig)
 	{
 		const Config   *pCLConfig = dynamic_cast<const Config *>(pConfig);
@@ -85,13 +95,17 @@ Status Provider::Init(const CE::IConfig *pConfig/* = NULL*/)
 		{
 			return Status(Status_InvalidArg, "Invalid arg at {1}:{2}", __FILE__, __LINE__);
 		}
-		m_cThreads = pCLConfig->GetThreadsCount();
+		m_cThreads        = pCLConfig->GetThreadsCount();
+		bPinThreads       = pCLConfig->GetPinThreads();
+		bReplicateWeights = pCLConfig->GetReplicateWeights();
 	}
 	else
 	{
 		Config   config;
 
-		m_cThreads = config.GetThreadsCount();
+		m_cThreads        = config.GetThreadsCount();
+		bPinThreads       = config.GetPinThreads();
+		bReplicateWeights = config.GetReplicateWeights();
 	}
 	if (0 >= m_cThreads)
 	{
@@ -103,62 +117,145 @@ Status Provider::Init(const CE::IConfig *pConfig/* = NULL*/)
 
 	for (;;)
 	{
-		if (NULL == (m_stopEvents = (HANDLE *)Mem::Alloc(sizeof(HANDLE) * m_cThreads)))
+		if (NULL == (m_entries = (Entry *)_aligned_malloc(sizeof(Entry) * m_cThreads, CACHE_LINE_SIZE)))
 		{
-			status = Status(Status_MemAllocFailed, "Failed to allocate {1} bytes at {2}:{3}", sizeof(HANDLE) * m_cThreads, 
+			status = Status(Status_MemAllocFailed, "Failed to allocate {1} bytes at {2}:{3}", sizeof(Entry) * m_cThreads, 
 			                __FILE__, __LINE__);
 
 			break;
 		}
-		memset(m_stopEvents, 0, sizeof(HANDLE) * m_cThreads);
+		memset(m_entries, 0, sizeof(Entry) * m_cThreads);
+		if (!(status = PlaceThreads(bPinThreads, bReplicateWeights)))
+		{
+			break;
+		}
 		for (UInt32 i = 0; i < m_cThreads; i++)
 		{
-			if (NULL == (m_stopEvents[i] = CreateEvent(NULL, FALSE, FALSE, NULL)))
+			m_entries[i].pProvider = this;
+			m_entries[i].nGroup    = SHARED_GROUP;
+			if (NULL == (m_entries[i].hWakeEvent = CreateEvent(NULL, FALSE, FALSE, NULL)))
 			{
-				status = Status(Status_OperationFailed, "Failed to create stop event {1} at {2}:{3}", i, __FILE__, 
+				status = Status(Status_OperationFailed, "Failed to create wake event {1} at {2}:{3}", i, __FILE__, 
 				                __LINE__);
+
+				break;
 			}
 		}
-		if (NULL == (m_startEvents = (HANDLE *)Mem::Alloc(sizeof(HANDLE) * m_cThreads)))
+		if (!status)
 		{
-			status = Status(Status_MemAllocFailed, "Failed to allocate {1} bytes at {2}:{3}", sizeof(HANDLE) * m_cThreads, 
+			break;
+		}
+		if (NULL == (m_hStopEvent = CreateEvent(NULL, TRUE, FALSE, NULL)))
+		{
+			status = Status(Status_OperationFailed, "Failed to create stop event at {1}:{2}", __FILE__, __LINE__);
+
+			break;
+		}
+		if (NULL == (m_hSemaphore = CreateSemaphore(NULL, 0, MAX_SEMAPHORE_COUNT, NULL)))
+		{
+			status = Status(Status_OperationFailed, "Failed to create semaphore at {1}:{2}", __FILE__, __LINE__);
+
+			break;
+		}
+		if (NULL == (m_nodes = new (std::nothrow) Node[m_cNodes]))
+		{
+			status = Status(Status_MemAllocFailed, "Failed to allocate {1} bytes at {2}:{3}", sizeof(Node) * m_cNodes, 
 			                __FILE__, __LINE__);
 
 			break;
 		}
-		memset(m_startEvents, 0, sizeof(HANDLE) * m_cThreads);
-		for (UInt32 i = 0; i < m_cThreads; i++)
+		for (UInt32 i = 0; i < m_cNodes; i++)
 		{
-			if (NULL == (m_startEvents[i] = CreateEvent(NULL, FALSE, FALSE, NULL)))
+			for (UInt32 k = 0; k < PRIORITIES_COUNT; k++)
 			{
-				status = Status(Status_OperationFailed, "Failed to create start event {1} at {2}:{3}", i, __FILE__, 
-				                __LINE__);
+				if (!(status = m_nodes[i].queues[k].Init(QUEUE_CAPACITY)))
+				{
+					break;
+				}
+			}
+			if (!status)
+			{
+				break;
+			}
+			if (!(status = m_nodes[i].localQueue.Init(QUEUE_CAPACITY)))
+			{
+				break;
+			}
+			if (NULL == (m_nodes[i].hLocalSemaphore = CreateSemaphore(NULL, 0, MAX_SEMAPHORE_COUNT, NULL)))
+			{
+				status = Status(Status_OperationFailed, "Failed to create semaphore for node {1} at {2}:{3}", i, 
+				                __FILE__, __LINE__);
+
+				break;
 			}
 		}
-		if (NULL == (m_finishEvents = (HANDLE *)Mem::Alloc(sizeof(HANDLE) * m_cThreads)))
+		if (!status)
 		{
-			status = Status(Status_MemAllocFailed, "Failed to allocate {1} bytes at {2}:{3}", sizeof(HANDLE) * m_cThreads, 
+			break;
+		}
+		if (NULL == (m_groups = new (std::nothrow) Group[MAX_GROUPS]))
+		{
+			status = Status(Status_MemAllocFailed, "Failed to allocate {1} bytes at {2}:{3}", sizeof(Group) * MAX_GROUPS, 
 			                __FILE__, __LINE__);
 
 			break;
 		}
-		memset(m_finishEvents, 0, sizeof(HANDLE) * m_cThreads);
-		for (UInt32 i = 0; i < m_cThreads; i++)
+		for (UInt32 i = 0; i < MAX_GROUPS; i++)
 		{
-			if (NULL == (m_finishEvents[i] = CreateEvent(NULL, FALSE, FALSE, NULL)))
+			if (SHARED_GROUP == i)
 			{
-				status = Status(Status_OperationFailed, "Failed to create finish event {1} at {2}:{3}", i, __FILE__, 
-				                __LINE__);
+				continue;
+			}
+			for (UInt32 k = 0; k < PRIORITIES_COUNT; k++)
+			{
+				if (!(status = m_groups[i].queues[k].Init(QUEUE_CAPACITY)))
+				{
+					break;
+				}
+			}
+			if (!status)
+			{
+				break;
+			}
+			if (NULL == (m_groups[i].hSemaphore = CreateSemaphore(NULL, 0, MAX_SEMAPHORE_COUNT, NULL)))
+			{
+				status = Status(Status_OperationFailed, "Failed to create semaphore for group {1} at {2}:{3}", i, 
+				                __FILE__, __LINE__);
+
+				break;
 			}
 		}
-		if (NULL == (m_entries = (Entry *)Mem::Alloc(sizeof(Entry) * m_cThreads)))
+		if (!status)
 		{
-			status = Status(Status_MemAllocFailed, "Failed to allocate {1} bytes at {2}:{3}", sizeof(Entry) * m_cThreads, 
+			break;
+		}
+		if (NULL == (m_jobs = (Job *)_aligned_malloc(sizeof(Job) * MAX_JOBS, CACHE_LINE_SIZE)))
+		{
+			status = Status(Status_MemAllocFailed, "Failed to allocate {1} bytes at {2}:{3}", sizeof(Job) * MAX_JOBS, 
 			                __FILE__, __LINE__);
 
 			break;
 		}
-		memset(m_entries, 0, sizeof(Entry) * m_cThreads);
+		memset(m_jobs, 0, sizeof(Job) * MAX_JOBS);
+		if (!(status = m_freeJobs.Init(MAX_JOBS)))
+		{
+			break;
+		}
+		for (UInt32 i = 0; i < MAX_JOBS; i++)
+		{
+			if (NULL == (m_jobs[i].hDoneEvent = CreateEvent(NULL, FALSE, FALSE, NULL)))
+			{
+				status = Status(Status_OperationFailed, "Failed to create done event {1} at {2}:{3}", i, __FILE__, 
+				                __LINE__);
+
+				break;
+			}
+			m_freeJobs.Push(i);
+		}
+		if (!status)
+		{
+			break;
+		}
 		if (NULL == (m_threads = (HANDLE *)Mem::Alloc(sizeof(HANDLE) * m_cThreads)))
 		{
 			status = Status(Status_MemAllocFailed, "Failed to allocate {1} bytes at {2}:{3}", sizeof(HANDLE) * m_cThreads, 
@@ -177,9 +274,16 @@ Status Provider::Init(const CE::IConfig *pConfig/* = NULL*/)
 
 				break;
 			}
-			m_entries[i].phStopEvent   = &m_stopEvents[i];
-			m_entries[i].phStartEvent  = &m_startEvents[i];
-			m_entries[i].phFinishEvent = &m_finishEvents[i];
+			if (0 != m_entries[i].nAffinityMask)
+			{
+				if (0 == SetThreadAffinityMask(m_threads[i], m_entries[i].nAffinityMask))
+				{
+					status = Status(Status_OperationFailed, "Failed to pin thread {1} with error {2} at {3}:{4}", 
+					                i, (int)GetLastError(), __FILE__, __LINE__);
+
+					break;
+				}
+			}
 		}
 		if (!status)
 		{
@@ -200,73 +304,84 @@ Status Provider::Uninit()
 {
 	if (NULL != m_threads)
 	{
-		DWORD   dwCount = 0;
-
-		for (UInt32 i = 0; i < m_cThreads; i++)
-		{
-			if (NULL != m_threads[i])
-			{
-				SetEvent(m_stopEvents[i]);
-				dwCount++;
-			}
-		}
-		if (0 < dwCount)
+		if (NULL != m_hStopEvent)
 		{
-			WaitForMultipleObjects(dwCount, m_threads, TRUE, INFINITE);
+			SetEvent(m_hStopEvent);
 		}
 		for (UInt32 i = 0; i < m_cThreads; i++)
 		{
 			if (NULL != m_threads[i])
 			{
+				WaitForSingleObject(m_threads[i], INFINITE);
 				CloseHandle(m_threads[i]);
 			}
 		}
 		Mem::Free(m_threads);
 	}
-	if (NULL != m_entries)
+	m_freeJobs.Uninit();
+	if (NULL != m_jobs)
 	{
-		Mem::Free(m_entries);
+		for (UInt32 i = 0; i < MAX_JOBS; i++)
+		{
+			if (NULL != m_jobs[i].hDoneEvent)
+			{
+				CloseHandle(m_jobs[i].hDoneEvent);
+			}
+		}
+		_aligned_free(m_jobs);
 	}
-	if (NULL != m_finishEvents)
+	if (NULL != m_groups)
 	{
-		for (UInt32 i = 0; i < m_cThreads; i++)
+		for (UInt32 i = 0; i < MAX_GROUPS; i++)
 		{
-			if (NULL != m_finishEvents[i])
+			if (NULL != m_groups[i].hSemaphore)
 			{
-				CloseHandle(m_finishEvents[i]);
+				CloseHandle(m_groups[i].hSemaphore);
 			}
 		}
-		Mem::Free(m_finishEvents);
+		delete [] m_groups;
 	}
-	if (NULL != m_startEvents)
+	if (NULL != m_nodes)
 	{
-		for (UInt32 i = 0; i < m_cThreads; i++)
+		for (UInt32 i = 0; i < m_cNodes; i++)
 		{
-			if (NULL != m_startEvents[i])
+			if (NULL != m_nodes[i].hLocalSemaphore)
 			{
-				CloseHandle(m_startEvents[i]);
+				CloseHandle(m_nodes[i].hLocalSemaphore);
 			}
 		}
-		Mem::Free(m_startEvents);
+		delete [] m_nodes;
 	}
-	if (NULL != m_stopEvents)
+	if (NULL != m_hSemaphore)
+	{
+		CloseHandle(m_hSemaphore);
+	}
+	if (NULL != m_hStopEvent)
+	{
+		CloseHandle(m_hStopEvent);
+	}
+	if (NULL != m_entries)
 	{
 		for (UInt32 i = 0; i < m_cThreads; i++)
 		{
-			if (NULL != m_stopEvents[i])
+			if (NULL != m_entries[i].hWakeEvent)
 			{
-				CloseHandle(m_stopEvents[i]);
+				CloseHandle(m_entries[i].hWakeEvent);
 			}
 		}
-		Mem::Free(m_stopEvents);
+		_aligned_free(m_entries);
 	}
-	m_threads      = NULL;
-	m_stopEvents   = NULL;
-	m_startEvents  = NULL;
-	m_finishEvents = NULL;
-	m_entries      = NULL;
-	m_cThreads     = 0;
-
+	m_hStopEvent = NULL;
+	m_hSemaphore = NULL;
+	m_threads    = NULL;
+	m_entries    = NULL;
+	m_nodes      = NULL;
+	m_groups     = NULL;
+	m_jobs       = NULL;
+	m_cThreads   = 0;
+	m_cNodes     = 0;
+	m_cReplicas  = 0;
+	m_topology.Uninit();
 
 	return Status();
 }
@@ -300,164 +415,465 @@ UInt32 Provider::GetThreadsCount() const
 	return m_cThreads;
 }
 
-Status Provider::RunKernel(IKernel *pKernel, UInt32 cDims, const UInt32 *dims)
+UInt32 Provider::GetNodesCount() const
+{
+	return m_cNodes;
+}
+
+UInt32 Provider::GetReplicasCount() const
+{
+	return m_cReplicas;
+}
+
+Status Provider::PlaceThreads(Bool bPinThreads, Bool bReplicateWeights)
+{
+	const Topology::Node   *pNode;
+	UInt32                 cNodeThreads;
+	UInt32                 cThread;
+	Status                 status;
+
+	m_cNodes    = 1;
+	m_cReplicas = 1;
+	for (UInt32 i = 0; i < m_cThreads; i++)
+	{
+		m_entries[i].cNode         = 0;
+		m_entries[i].cReplica      = 0;
+		m_entries[i].nAffinityMask = 0;
+	}
+	if (bReplicateWeights)
+	{
+		bPinThreads = True;
+	}
+	if (!bPinThreads)
+	{
+		return Status();
+	}
+	if (!(status = m_topology.Init()))
+	{
+		return status;
+	}
+	m_cNodes = m_topology.GetNodesCount();
+	if (m_cNodes > m_cThreads)
+	{
+		m_cNodes = m_cThreads;
+	}
+
+	//threads are split evenly over the nodes and kept contiguous per node, so the contiguous ranges handed out by
+	//RunKernel are processed by threads of the same node
+	cThread = 0;
+	for (UInt32 cNode = 0; cNode < m_cNodes; cNode++)
+	{
+		pNode        = m_topology.GetNode(cNode);
+		cNodeThreads = m_cThreads / m_cNodes;
+		if (cNode < m_cThreads % m_cNodes)
+		{
+			cNodeThreads++;
+		}
+		for (UInt32 k = 0; k < cNodeThreads; k++)
+		{
+			m_entries[cThread].cNode         = cNode;
+			m_entries[cThread].cReplica      = bReplicateWeights ? cNode : 0;
+			m_entries[cThread].nAffinityMask = m_topology.GetNodeCore(cNode, k % pNode->cCoresCount)->nMask;
+			cThread++;
+		}
+	}
+	if (bReplicateWeights)
+	{
+		m_cReplicas = m_cNodes;
+	}
+
+	return Status();
+}
+
+Status Provider::RunKernel(IKernel *pKernel, UInt32 cDims, const UInt32 *dims, const Float *outputs/* = NULL*/, 
+                           Priority nPriority/* = Priority_Normal*/, UInt32 cGroup/* = SHARED_GROUP*/)
 {
 	if (0 == m_cThreads)
 	{
 		return Status(Status_NotInitialized, "Invalid arg at {1}:{2}", __FILE__, __LINE__);
 	}
-	if (MAX_DIMS < cDims)
+	if (0 == cDims || MAX_DIMS < cDims)
 	{
 		return Status(Status_InvalidArg, "Invalid arg at {1}:{2}", __FILE__, __LINE__);
 	}
+	if (MAX_GROUPS <= cGroup || (SHARED_GROUP != cGroup && 0 == m_groups[cGroup].cThreads))
+	{
+		return Status(Status_InvalidArg, "Invalid arg at {1}:{2}", __FILE__, __LINE__);
+	}
+	if (Priority_Auto == nPriority)
+	{
+		nPriority = Priority_Normal;
+	}
 
-	AcquireSRWLockExclusive(&m_srwlThreads);
-
-	for (UInt32 i = 0; i < m_cThreads; i++)
+	UInt32   cThreads;
+	UInt32   cTotalItems;
+	UInt32   cItemsPerThread;
+	UInt32   cAlign;
+	UInt32   cAlignOffset;
+	UInt32   cBegin;
+	UInt32   cEnd;
+	UInt32   cTasks;
+	UInt32   cJob;
+	LONG     cQueuedTasks;
+	Task     task;
+
+	cTotalItems = 1;
+	for (UInt32 i = 0; i < cDims; i++)
 	{
-		m_entries[i].pKernel = pKernel;
+		cTotalItems *= dims[i];
 	}
+	if (0 == cTotalItems)
+	{
+		return Status();
+	}
+	if (NULL != outputs)
+	{
+		cAlign       = ITEMS_PER_CACHE_LINE;
+		cAlignOffset = (UInt32)(((Size)outputs % CACHE_LINE_SIZE) / sizeof(Float));
+	}
+	else
+	{
+		cAlign       = 1;
+		cAlignOffset = 0;
+	}
+	if (SHARED_GROUP == cGroup)
+	{
+		cThreads = m_cThreads;
+	}
+	else
+	{
+		cThreads = m_groups[cGroup].cThreads;
+	}
+	cItemsPerThread = cTotalItems / cThreads;
+	if (0 < cTotalItems % cThreads)
+	{
+		cItemsPerThread++;
+	}
+	cItemsPerThread = (cItemsPerThread + cAlign - 1) / cAlign * cAlign;
 
-	unsigned int   cThread;
-	unsigned int   cTotalItems;
-	unsigned int   cItemsPerThread;
-	unsigned int   cItemsCount;
+	//range boundaries are multiples of cAlign items counted from the first cache line boundary of outputs; the first 
+	//range absorbs the unaligned head and the last one the tail
+	cTasks = 0;
+	cBegin = 0;
+	for (UInt32 i = 0; i < cThreads && cBegin < cTotalItems; i++)
+	{
+		cEnd = (i + 1) * cItemsPerThread - cAlignOffset;
+		if (i + 1 == cThreads || cEnd > cTotalItems)
+		{
+			cEnd = cTotalItems;
+		}
+		if (cBegin < cEnd)
+		{
+			cTasks++;
+		}
+		cBegin = cEnd;
+	}
 
-	cTotalItems = 0;
-	if (3 == cDims)
+	cJob         = AcquireJob(pKernel, cTasks);
+	cQueuedTasks = 0;
+	cBegin       = 0;
+	for (UInt32 i = 0; i < cThreads && cBegin < cTotalItems; i++)
 	{
-		cTotalItems     = dims[0] * dims[1] * dims[2];
-		cItemsPerThread = cTotalItems / m_cThreads;
-		if (0 < cTotalItems % m_cThreads)
+		cEnd = (i + 1) * cItemsPerThread - cAlignOffset;
+		if (i + 1 == cThreads || cEnd > cTotalItems)
 		{
-			cItemsPerThread++;
+			cEnd = cTotalItems;
 		}
-		cItemsCount = 0;
-		cThread     = 0;
-		for (unsigned int cIdx1 = 0; cIdx1 < dims[0]; cIdx1++)
+		if (cBegin < cEnd)
 		{
-			for (unsigned int cIdx2 = 0; cIdx2 < dims[1]; cIdx2++)
+			TasksQueue   *pQueue;
+
+			task.cJob   = cJob;
+			task.cBegin = cBegin;
+			task.cEnd   = cEnd;
+			//shared ranges are queued on the node of the thread that would have run them, so the node's threads pick 
+			//them first; a full queue makes the caller run the range itself
+			if (SHARED_GROUP == cGroup)
 			{
-				for (unsigned int cIdx3 = 0; cIdx3 < dims[2]; cIdx3++)
-				{
-					if (0 == cItemsCount)
-					{
-						m_entries[cThread].cDims   = cDims;
-						memcpy(m_entries[cThread].dims, dims, sizeof(dims));
-						m_entries[cThread].cCount  = 1;
-						m_entries[cThread].idxs[0] = cIdx1;
-						m_entries[cThread].idxs[1] = cIdx2;
-						m_entries[cThread].idxs[2] = cIdx3;
-					}
-					else
-					{
-						m_entries[cThread].cCount++;
-					}
-					cItemsCount++;
-					cTotalItems--;
-					if (0 == cTotalItems || cItemsPerThread == cItemsCount)
-					{
-						cItemsCount = 0;
-						cThread++;
-					}
-				}
+				pQueue = &m_nodes[m_entries[i].cNode].queues[nPriority];
+			}
+			else
+			{
+				pQueue = &m_groups[cGroup].queues[nPriority];
+			}
+			if (pQueue->Push(task))
+			{
+				cQueuedTasks++;
+			}
+			else
+			{
+				RunTask(0, task);
 			}
 		}
+		cBegin = cEnd;
 	}
-	else
-	if (2 == cDims)
+	if (0 < cQueuedTasks)
 	{
-		cTotalItems     = dims[0] * dims[1];
-		cItemsPerThread = cTotalItems / m_cThreads;
-		if (0 < cTotalItems % m_cThreads)
+		if (SHARED_GROUP == cGroup)
 		{
-			cItemsPerThread++;
+			ReleaseSemaphore(m_hSemaphore, cQueuedTasks, NULL);
 		}
-		cItemsCount  = 0;
-		cThread = 0;
-		for (unsigned int cIdx1 = 0; cIdx1 < dims[0]; cIdx1++)
+		else
 		{
-			for (unsigned int cIdx2 = 0; cIdx2 < dims[1]; cIdx2++)
-			{
-				if (0 == cItemsCount)
-				{
-					m_entries[cThread].cDims   = cDims;
-					memcpy(m_entries[cThread].dims, dims, sizeof(dims));
-					m_entries[cThread].cCount  = 1;
-					m_entries[cThread].idxs[0] = cIdx1;
-					m_entries[cThread].idxs[1] = cIdx2;
-				}
-				else
-				{
-					m_entries[cThread].cCount++;
-				}
-				cItemsCount++;
-				cTotalItems--;
-				if (0 == cTotalItems || cItemsPerThread == cItemsCount)
-				{
-					cItemsCount = 0;
-					cThread++;
-				}
-			}
+			ReleaseSemaphore(m_groups[cGroup].hSemaphore, cQueuedTasks, NULL);
 		}
 	}
-	else
+	WaitJob(cJob);
+
+	return Status();
+}
+
+Status Provider::RunPerReplica(IKernel *pKernel)
+{
+	if (0 == m_cThreads)
+	{
+		return Status(Status_NotInitialized, "Invalid arg at {1}:{2}", __FILE__, __LINE__);
+	}
+
+	UInt32   cJob;
+	Task     task;
+
+	cJob = AcquireJob(pKernel, m_cReplicas);
+	//replica r lives on node r when weights are replicated, otherwise there is a single replica (0)
+	for (UInt32 i = 0; i < m_cReplicas; i++)
 	{
-		cTotalItems     = dims[0];
-		cItemsPerThread = cTotalItems / m_cThreads;
-		if (0 < cTotalItems % m_cThreads)
+		task.cJob   = cJob;
+		task.cBegin = i;
+		task.cEnd   = i + 1;
+		if (m_nodes[i].localQueue.Push(task))
+		{
+			ReleaseSemaphore(m_nodes[i].hLocalSemaphore, 1, NULL);
+		}
+		else
 		{
-			cItemsPerThread++;
+			RunTask(i, task);
 		}
-		cItemsCount  = 0;
-		cThread = 0;
-		for (unsigned int cIdx1 = 0; cIdx1 < dims[0]; cIdx1++)
+	}
+	WaitJob(cJob);
+
+	return Status();
+}
+
+Status Provider::ReserveGroup(UInt32 cThreads, UInt32 *pcGroup)
+{
+	if (0 == m_cThreads)
+	{
+		return Status(Status_NotInitialized, "Invalid arg at {1}:{2}", __FILE__, __LINE__);
+	}
+	if (0 == cThreads)
+	{
+		return Status(Status_InvalidArg, "Invalid arg at {1}:{2}", __FILE__, __LINE__);
+	}
+
+	UInt32   cGroup;
+	UInt32   cSharedThreads;
+	Status   status;
+
+	AcquireSRWLockExclusive(&m_srwlGroups);
+
+	for (;;)
+	{
+		cGroup = SHARED_GROUP;
+		for (UInt32 i = 0; i < MAX_GROUPS; i++)
 		{
-			if (0 == cItemsCount)
+			if (SHARED_GROUP != i && 0 == m_groups[i].cThreads)
 			{
-				m_entries[cThread].cDims   = cDims;
-				memcpy(m_entries[cThread].dims, dims, sizeof(dims));
-				m_entries[cThread].cCount  = 1;
-				m_entries[cThread].idxs[0] = cIdx1;
+				cGroup = i;
+
+				break;
 			}
-			else
+		}
+		if (SHARED_GROUP == cGroup)
+		{
+			status = Status(Status_NotFound, "No free group at {1}:{2}", __FILE__, __LINE__);
+
+			break;
+		}
+		cSharedThreads = 0;
+		for (UInt32 i = 0; i < m_cThreads; i++)
+		{
+			if (SHARED_GROUP == m_entries[i].nGroup)
 			{
-				m_entries[cThread].cCount++;
+				cSharedThreads++;
 			}
-			cItemsCount++;
-			cTotalItems--;
-			if (0 == cTotalItems || cItemsPerThread == cItemsCount)
+		}
+		if (cThreads >= cSharedThreads)
+		{
+			status = Status(Status_InvalidArg, "Only {1} shared threads left at {2}:{3}", cSharedThreads, __FILE__, 
+			                __LINE__);
+
+			break;
+		}
+		//threads are taken from the end, so a group is made of neighbouring threads (same node when pinned)
+		m_groups[cGroup].cThreads = cThreads;
+		for (UInt32 i = m_cThreads; 0 < i && 0 < cThreads; i--)
+		{
+			if (SHARED_GROUP == m_entries[i - 1].nGroup)
 			{
-				cItemsCount = 0;
-				cThread++;
+				InterlockedExchange(&m_entries[i - 1].nGroup, (LONG)cGroup);
+				SetEvent(m_entries[i - 1].hWakeEvent);
+				cThreads--;
 			}
 		}
+		*pcGroup = cGroup;
+
+		break;
+	}
+
+	ReleaseSRWLockExclusive(&m_srwlGroups);
+
+	return status;
+}
+
+Status Provider::ReleaseGroup(UInt32 cGroup)
+{
+	if (0 == m_cThreads)
+	{
+		return Status(Status_NotInitialized, "Invalid arg at {1}:{2}", __FILE__, __LINE__);
 	}
-	for (UInt32 i = cThread; i < m_cThreads; i++)
+	if (SHARED_GROUP == cGroup || MAX_GROUPS <= cGroup)
 	{
-		m_entries[i].cCount = 0;
+		return Status(Status_InvalidArg, "Invalid arg at {1}:{2}", __FILE__, __LINE__);
 	}
 
+	AcquireSRWLockExclusive(&m_srwlGroups);
+
 	for (UInt32 i = 0; i < m_cThreads; i++)
 	{
-		SetEvent(m_startEvents[i]);
+		if ((LONG)cGroup == m_entries[i].nGroup)
+		{
+			InterlockedExchange(&m_entries[i].nGroup, (LONG)SHARED_GROUP);
+			SetEvent(m_entries[i].hWakeEvent);
+		}
 	}
-	WaitForMultipleObjects((DWORD)m_cThreads, m_finishEvents, TRUE, INFINITE);
+	m_groups[cGroup].cThreads = 0;
 
-	ReleaseSRWLockExclusive(&m_srwlThreads);
+	ReleaseSRWLockExclusive(&m_srwlGroups);
 
 	return Status();
 }
 
+UInt32 Provider::GetGroupThreadsCount(UInt32 cGroup) const
+{
+	if (0 == m_cThreads || MAX_GROUPS <= cGroup)
+	{
+		return 0;
+	}
+	if (SHARED_GROUP == cGroup)
+	{
+		UInt32   cSharedThreads = 0;
+
+		for (UInt32 i = 0; i < m_cThreads; i++)
+		{
+			if (SHARED_GROUP == m_entries[i].nGroup)
+			{
+				cSharedThreads++;
+			}
+		}
+
+		return cSharedThreads;
+	}
+
+	return m_groups[cGroup].cThreads;
+}
+
+UInt32 Provider::AcquireJob(IKernel *pKernel, UInt32 cTasks)
+{
+	UInt32   cJob;
+
+	//more than MAX_JOBS concurrent callers => wait for a slot
+	while (!m_freeJobs.Pop(&cJob))
+	{
+		SwitchToThread();
+	}
+	m_jobs[cJob].pKernel       = pKernel;
+	m_jobs[cJob].cPendingTasks = (LONG)cTasks;
+	if (0 == cTasks)
+	{
+		SetEvent(m_jobs[cJob].hDoneEvent);
+	}
+
+	return cJob;
+}
+
+void Provider::WaitJob(UInt32 cJob)
+{
+	WaitForSingleObject(m_jobs[cJob].hDoneEvent, INFINITE);
+	m_freeJobs.Push(cJob);
+}
+
+void Provider::RunTask(UInt32 cReplica, const Task &task)
+{
+	Job              *pJob = &m_jobs[task.cJob];
+	IKernel::Range   range;
+
+	range.cReplica = cReplica;
+	range.cBegin   = task.cBegin;
+	range.cEnd     = task.cEnd;
+	pJob->pKernel->Run(range);
+	if (0 == InterlockedDecrement(&pJob->cPendingTasks))
+	{
+		SetEvent(pJob->hDoneEvent);
+	}
+}
+
+Bool Provider::PopTask(UInt32 cNode, Task *pTask)
+{
+	//higher priorities first; for a priority the own node first, then the other nodes
+	for (UInt32 k = 0; k < PRIORITIES_COUNT; k++)
+	{
+		for (UInt32 i = 0; i < m_cNodes; i++)
+		{
+			if (m_nodes[(cNode + i) % m_cNodes].queues[k].Pop(pTask))
+			{
+				return True;
+			}
+		}
+	}
+
+	return False;
+}
+
+Bool Provider::PopGroupTask(UInt32 cGroup, Task *pTask)
+{
+	for (UInt32 k = 0; k < PRIORITIES_COUNT; k++)
+	{
+		if (m_groups[cGroup].queues[k].Pop(pTask))
+		{
+			return True;
+		}
+	}
+
+	return False;
+}
+
 DWORD WINAPI Provider::WorkerThread(void *pArg)
 {
-	Entry    *pEntry    = (Entry *)pArg;
-	HANDLE   handles[2] = { *pEntry->phStopEvent, *pEntry->phStartEvent };
-	DWORD    dwRet;
+	Entry      *pEntry    = (Entry *)pArg;
+	Provider   *pProvider = pEntry->pProvider;
+	HANDLE     handles[4] = 
+	{ 
+		pProvider->m_hStopEvent, 
+		pEntry->hWakeEvent, 
+		pProvider->m_nodes[pEntry->cNode].hLocalSemaphore, 
+		pProvider->m_hSemaphore 
+	};
+	LONG       nGroup;
+	Task       task;
+	DWORD      dwRet;
 
 	for (;;)
 	{
-		dwRet = WaitForMultipleObjects(2, handles, FALSE, INFINITE);
+		nGroup = pEntry->nGroup;
+		if (SHARED_GROUP == nGroup)
+		{
+			handles[3] = pProvider->m_hSemaphore;
+		}
+		else
+		{
+			handles[3] = pProvider->m_groups[nGroup].hSemaphore;
+		}
+		dwRet = WaitForMultipleObjects(4, handles, FALSE, INFINITE);
 		if (WAIT_OBJECT_0 == dwRet)
 		{
 			break;
@@ -465,11 +881,43 @@ DWORD WINAPI Provider::WorkerThread(void *pArg)
 		else
 		if (WAIT_OBJECT_0 + 1 == dwRet)
 		{
-			if (0 < pEntry->cCount)
+			//group changed => wait on the other semaphore
+			continue;
+		}
+		else
+		if (WAIT_OBJECT_0 + 2 == dwRet)
+		{
+			//a pop can fail for a moment while another producer is still publishing an earlier slot
+			while (!pProvider->m_nodes[pEntry->cNode].localQueue.Pop(&task))
+			{
+				YieldProcessor();
+			}
+			pProvider->RunTask(pEntry->cReplica, task);
+		}
+		else
+		if (WAIT_OBJECT_0 + 3 == dwRet)
+		{
+			if (SHARED_GROUP == nGroup)
+			{
+				while (!pProvider->PopTask(pEntry->cNode, &task))
+				{
+					YieldProcessor();
+				}
+				pProvider->RunTask(pEntry->cReplica, task);
+			}
+			else
 			{
-				pEntry->pKernel->Run(pEntry->cDims, pEntry->dims, pEntry->idxs, pEntry->cCount);
+				//the count of a group semaphore may be left over from a previous owner of the group, so it is only a 
+				//hint: the group queues are drained and an empty pop goes back to waiting
+				while (pProvider->PopGroupTask((UInt32)nGroup, &task))
+				{
+					pProvider->RunTask(pEntry->cReplica, task);
+				}
 			}
-			SetEvent(*pEntry->phFinishEvent);
+		}
+		else
+		{
+			break;
 		}
 	}
 
@@ -46,9 +46,11 @@ Synapses::Synapses(Network *pNetwork)
 	m_pSynapses    = NULL;
 	m_pPrevNeurons = NULL;
 	m_pNextNeurons = NULL;
+	m_cReplicas    = 0;
 	m_weights      = NULL;
 	m_biases       = NULL;
 	m_cbMemSize    = 0;
+	m_nSyncedVersion = NET::Synapses::VERSION_NONE;
 }
 
 Synapses::~Synapses()
@@ -72,30 +74,68 @@ Status Synapses::Init(NET::Synapses *pSynapses)
 			break;
 		}
 
-		if (NULL == (m_weights = (Float *)Mem::Alloc(sizeof(Float) * pSynapses->GetWeightsCount())))
+		if (0 == (m_cReplicas = m_pNetwork->GetProvider()->GetReplicasCount()))
+		{
+			status = Status(Status_NotInitialized, "Provider not initialized at {1}:{2}", __FILE__, __LINE__);
+
+			break;
+		}
+		if (NULL == (m_weights = (Float **)Mem::Alloc(sizeof(Float *) * m_cReplicas)))
 		{
 			status = Status(Status_MemAllocFailed, "Failed to allocate {1} bytes at {2}:{3}", 
-			                sizeof(Float) * pSynapses->GetWeightsCount(), __FILE__, __LINE__);
+			                sizeof(Float *) * m_cReplicas, __FILE__, __LINE__);
 
 			break;
 		}
-		memcpy(m_weights, pSynapses->GetWeights(), sizeof(Float) * pSynapses->GetWeightsCount());
+		memset(m_weights, 0, sizeof(Float *) * m_cReplicas);
 		if (pSynapses->HasBias())
 		{
-			if (NULL == (m_biases = (Float *)Mem::Alloc(sizeof(Float) * pSynapses->GetBiasesCount())))
+			if (NULL == (m_biases = (Float **)Mem::Alloc(sizeof(Float *) * m_cReplicas)))
 			{
 				status = Status(Status_MemAllocFailed, "Failed to allocate {1} bytes at {2}:{3}", 
-			                   sizeof(Float) * pSynapses->GetBiasesCount(), __FILE__, __LINE__);
+				                sizeof(Float *) * m_cReplicas, __FILE__, __LINE__);
 
 				break;
 			}
-			memcpy(m_biases, pSynapses->GetBiases(), sizeof(Float) * pSynapses->GetBiasesCount());
+			memset(m_biases, 0, sizeof(Float *) * m_cReplicas);
+		}
+		//pages are committed but not touched here; physical memory comes from the node of the worker thread that first 
+		//touches them in SyncToCE
+		for (UInt32 i = 0; i < m_cReplicas; i++)
+		{
+			if (NULL == (m_weights[i] = (Float *)VirtualAlloc(NULL, sizeof(Float) * pSynapses->GetWeightsCount(), 
+			                                                  MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE)))
+			{
+				status = Status(Status_MemAllocFailed, "Failed to allocate {1} bytes at {2}:{3}", 
+				                sizeof(Float) * pSynapses->GetWeightsCount(), __FILE__, __LINE__);
+
+				break;
+			}
+			if (pSynapses->HasBias())
+			{
+				if (NULL == (m_biases[i] = (Float *)VirtualAlloc(NULL, sizeof(Float) * pSynapses->GetBiasesCount(), 
+				                                                 MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE)))
+				{
+					status = Status(Status_MemAllocFailed, "Failed to allocate {1} bytes at {2}:{3}", 
+					                sizeof(Float) * pSynapses->GetBiasesCount(), __FILE__, __LINE__);
+
+					break;
+				}
+			}
+		}
+		if (!status)
+		{
+			break;
 		}
 		m_pSynapses   = pSynapses;
-		m_cbMemSize += sizeof(Float) * pSynapses->GetWeightsCount();
+		if (!(status = SyncToCE(True)))
+		{
+			break;
+		}
+		m_cbMemSize += sizeof(Float *) * m_cReplicas + sizeof(Float) * pSynapses->GetWeightsCount() * m_cReplicas;
 		if (pSynapses->HasBias())
 		{
-			m_cbMemSize += sizeof(Float) * pSynapses->GetBiasesCount();
+			m_cbMemSize += sizeof(Float *) * m_cReplicas + sizeof(Float) * pSynapses->GetBiasesCount() * m_cReplicas;
 		}
 
 		break;
@@ -112,18 +152,34 @@ Status Synapses::Uninit()
 {
 	if (NULL != m_weights)
 	{
+		for (UInt32 i = 0; i < m_cReplicas; i++)
+		{
+			if (NULL != m_weights[i])
+			{
+				VirtualFree(m_weights[i], 0, MEM_RELEASE);
+			}
+		}
 		Mem::Free(m_weights);
 	}
 	if (NULL != m_biases)
 	{
+		for (UInt32 i = 0; i < m_cReplicas; i++)
+		{
+			if (NULL != m_biases[i])
+			{
+				VirtualFree(m_biases[i], 0, MEM_RELEASE);
+			}
+		}
 		Mem::Free(m_biases);
 	}
 	m_pSynapses    = NULL;
+	m_cReplicas    = 0;
 	m_weights      = NULL;
 	m_biases       = NULL;
 	m_pPrevNeurons = NULL;
 	m_pNextNeurons = NULL;
 	m_cbMemSize    = 0;
+	m_nSyncedVersion = NET::Synapses::VERSION_NONE;
 
 	return Status();
 }
@@ -232,12 +288,47 @@ Status Synapses::SyncToCE(Bool bWait/* = True*/)
 
 	CX_UNUSED(bWait);
 
-	memcpy(m_weights, m_pSynapses->GetWeights(), sizeof(Float) * m_pSynapses->GetWeightsCount());
+	Kernel<ReplicateKernel>              krnl;
+	NET::Synapses::DirtyRangesVector     vectorRanges;
+	Status                               status;
 
-	if (HasBias())
+	//only the ranges marked since the last sync, otherwise everything
+	if (!m_pSynapses->GetDirtyRanges(m_nSyncedVersion, &vectorRanges))
 	{
-		memcpy(m_biases, m_pSynapses->GetBiases(), sizeof(Float) * m_pSynapses->GetBiasesCount());
+		NET::Synapses::DirtyRange   range;
+
+		range.bBiases = False;
+		range.cFirst  = 0;
+		range.cCount  = m_pSynapses->GetWeightsCount();
+		vectorRanges.push_back(range);
+		if (HasBias())
+		{
+			range.bBiases = True;
+			range.cFirst  = 0;
+			range.cCount  = m_pSynapses->GetBiasesCount();
+			vectorRanges.push_back(range);
+		}
 	}
+	for (NET::Synapses::DirtyRangesVector::iterator iter = vectorRanges.begin(); iter != vectorRanges.end(); ++iter)
+	{
+		if (iter->bBiases)
+		{
+			krnl.body.replicas = m_biases;
+			krnl.body.values   = m_pSynapses->GetBiases();
+		}
+		else
+		{
+			krnl.body.replicas = m_weights;
+			krnl.body.values   = m_pSynapses->GetWeights();
+		}
+		krnl.body.cOffset = iter->cFirst;
+		krnl.body.cbSize  = sizeof(Float) * iter->cCount;
+		if (!(status = m_pNetwork->GetProvider()->RunPerReplica(&krnl)))
+		{
+			return status;
+		}
+	}
+	m_nSyncedVersion = m_pSynapses->GetVersion();
 
 	return Status();
 }
@@ -251,11 +342,18 @@ Status Synapses::SyncFromCE(Bool bWait/* = True*/)
 
 	CX_UNUSED(bWait);
 
-	memcpy(m_pSynapses->GetWeights(), m_weights, sizeof(Float) * m_pSynapses->GetWeightsCount());
+	//mapped from the model file; the engine does not change them
+	if (m_pSynapses->IsReadOnly())
+	{
+		return Status();
+	}
+
+	//all replicas hold the same values
+	memcpy(m_pSynapses->GetWeights(), m_weights[0], sizeof(Float) * m_pSynapses->GetWeightsCount());
 
 	if (HasBias())
 	{
-		memcpy(m_pSynapses->GetBiases(), m_biases, sizeof(Float) * m_pSynapses->GetBiasesCount());
+		memcpy(m_pSynapses->GetBiases(), m_biases[0], sizeof(Float) * m_pSynapses->GetBiasesCount());
 	}
 
 	return Status();
@@ -0,0 +1,230 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "N2/SWMT/Topology.hpp"
+
+
+using namespace CX;
+
+
+namespace N2
+{
+
+namespace SWMT
+{
+
+Topology::Topology()
+{
+}
+
+Topology::~Topology()
+{
+	Uninit();
+}
+
+Status Topology::Init()
+{
+	Uninit();
+
+	void                                   *pData;
+	SYSTEM_LOGICAL_PROCESSOR_INFORMATION   *cpuinfo;
+	DWORD                                  dwSize;
+	CoresVector                            vectorCores;
+	NodesVector                            vectorNodes;
+	Status                                 status;
+
+	pData = NULL;
+	for (;;)
+	{
+		dwSize = 0;
+		if (GetLogicalProcessorInformation(NULL, &dwSize) || ERROR_INSUFFICIENT_BUFFER != GetLastError())
+		{
+			status = Status(Status_OperationFailed, "Failed to get processor information size with error {1} at {2}:{3}",
+			                (int)GetLastError(), __FILE__, __LINE__);
+
+			break;
+		}
+		if (NULL == (pData = Mem::Alloc(dwSize)))
+		{
+			status = Status(Status_MemAllocFailed, "Failed to allocate {1} bytes at {2}:{3}", (Size)dwSize,
+			                __FILE__, __LINE__);
+
+			break;
+		}
+		cpuinfo = (SYSTEM_LOGICAL_PROCESSOR_INFORMATION *)pData;
+		if (!GetLogicalProcessorInformation(cpuinfo, &dwSize))
+		{
+			status = Status(Status_OperationFailed, "Failed to get processor information with error {1} at {2}:{3}",
+			                (int)GetLastError(), __FILE__, __LINE__);
+
+			break;
+		}
+		while (sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION) <= dwSize)
+		{
+			if (RelationProcessorCore == cpuinfo->Relationship)
+			{
+				Core   core;
+
+				core.cNode = 0;
+				core.nMask = cpuinfo->ProcessorMask;
+				vectorCores.push_back(core);
+			}
+			else
+			if (RelationNumaNode == cpuinfo->Relationship)
+			{
+				Node   node;
+
+				node.cFirstCore  = 0;
+				node.cCoresCount = 0;
+				node.nMask       = cpuinfo->ProcessorMask;
+				vectorNodes.push_back(node);
+			}
+			dwSize -= sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION);
+			cpuinfo++;
+		}
+		if (vectorCores.empty())
+		{
+			status = Status(Status_NotFound, "No processor cores found at {1}:{2}", __FILE__, __LINE__);
+
+			break;
+		}
+		//no NUMA information (or a single node) => all cores are on node 0
+		if (vectorNodes.empty())
+		{
+			Node   node;
+
+			node.cFirstCore  = 0;
+			node.cCoresCount = 0;
+			node.nMask       = 0;
+			for (CoresVector::iterator iter = vectorCores.begin(); iter != vectorCores.end(); ++iter)
+			{
+				node.nMask |= iter->nMask;
+			}
+			vectorNodes.push_back(node);
+		}
+		//group the cores by node; nodes without cores (memory only nodes) are skipped
+		for (NodesVector::iterator iterNode = vectorNodes.begin(); iterNode != vectorNodes.end(); ++iterNode)
+		{
+			Node   node;
+
+			node.cFirstCore  = (UInt32)m_vectorCores.size();
+			node.cCoresCount = 0;
+			node.nMask       = iterNode->nMask;
+			for (CoresVector::iterator iterCore = vectorCores.begin(); iterCore != vectorCores.end(); ++iterCore)
+			{
+				if (0 != (iterCore->nMask & iterNode->nMask))
+				{
+					Core   core;
+
+					core.cNode = (UInt32)m_vectorNodes.size();
+					core.nMask = iterCore->nMask;
+					m_vectorCores.push_back(core);
+					node.cCoresCount++;
+				}
+			}
+			if (0 < node.cCoresCount)
+			{
+				m_vectorNodes.push_back(node);
+			}
+		}
+		if (m_vectorCores.empty())
+		{
+			status = Status(Status_NotFound, "No processor cores found at {1}:{2}", __FILE__, __LINE__);
+
+			break;
+		}
+
+		break;
+	}
+	if (NULL != pData)
+	{
+		Mem::Free(pData);
+	}
+	if (!status)
+	{
+		Uninit();
+	}
+
+	return status;
+}
+
+Status Topology::Uninit()
+{
+	m_vectorCores.clear();
+	m_vectorNodes.clear();
+
+	return Status();
+}
+
+UInt32 Topology::GetNodesCount() const
+{
+	return (UInt32)m_vectorNodes.size();
+}
+
+const Topology::Node *Topology::GetNode(UInt32 cNode) const
+{
+	if (cNode >= (UInt32)m_vectorNodes.size())
+	{
+		return NULL;
+	}
+
+	return &m_vectorNodes[cNode];
+}
+
+UInt32 Topology::GetCoresCount() const
+{
+	return (UInt32)m_vectorCores.size();
+}
+
+const Topology::Core *Topology::GetCore(UInt32 cCore) const
+{
+	if (cCore >= (UInt32)m_vectorCores.size())
+	{
+		return NULL;
+	}
+
+	return &m_vectorCores[cCore];
+}
+
+const Topology::Core *Topology::GetNodeCore(UInt32 cNode, UInt32 cCore) const
+{
+	if (cNode >= (UInt32)m_vectorNodes.size())
+	{
+		return NULL;
+	}
+	if (cCore >= m_vectorNodes[cNode].cCoresCount)
+	{
+		return NULL;
+	}
+
+	return &m_vectorCores[m_vectorNodes[cNode].cFirstCore + cCore];
+}
+
+}//namespace SWMT
+
+}//namespace N2
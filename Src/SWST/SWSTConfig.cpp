@@ -29,6 +29,9 @@
 #include "N2/SWST/Config.hpp"
 
 
+using namespace CX;
+
+
 namespace N2
 {
 
@@ -37,12 +40,23 @@ namespace SWST
 
 Config::Config()
 {
+	m_bStreamWeights = False;
 }
 
 Config::~Config()
 {
 }
 
+void Config::SetStreamWeights(Bool bStreamWeights)
+{
+	m_bStreamWeights = bStreamWeights;
+}
+
+Bool Config::GetStreamWeights() const
+{
+	return m_bStreamWeights;
+}
+
 }//namespace SWST
 
 }//namespace N2
@@ -46,6 +46,7 @@ Network::Network(Provider *pProvider)
 	m_pInputNeurons  = NULL;
 	m_pOutputNeurons = NULL;
 	m_cbMemSize      = 0;
+	m_bStreamed      = False;
 }
 
 Network::~Network()
@@ -132,6 +133,10 @@ Status Network::Init(NET::Network *pNetwork)
 			m_pOutputNeurons                  = pNeurons;
 
 			m_cbMemSize += pSynapses->GetMemSize() + pNeurons->GetMemSize();
+			if (pSynapses->m_bStreamed)
+			{
+				m_bStreamed = True;
+			}
 		
 			pNETSynapses = pNETNeurons->GetNextSynapses();
 		}
@@ -174,6 +179,7 @@ Status Network::Uninit()
 	m_pInputNeurons  = NULL;
 	m_pOutputNeurons = NULL;
 	m_cbMemSize      = 0;
+	m_bStreamed      = False;
 
 	return Status();
 }
@@ -243,7 +249,7 @@ Status Network::SyncToCE(Bool bWait/* = True*/, UInt32 nSyncType/* = Sync_All*/)
 			pNeurons->SyncToCE(True);
 		}
 		pSynapses = pNeurons->m_pNextSynapses;
-		if (NULL != pSynapses)
+		if (NULL == pSynapses)
 		{
 			break;
 		}
@@ -313,6 +319,10 @@ Status Network::Evaluate(UInt32 cCount, Float *inputs, Float *outputs)
 	{
 		return Status(Status_InvalidArg, "Invalid arg at {1}:{2}", __FILE__, __LINE__);
 	}
+	if (m_bStreamed)
+	{
+		return EvaluateStreamed(cCount, inputs, outputs);
+	}
 
 	Synapses           *pSynapses;
 	Float              *prevNeurons;
@@ -395,6 +405,116 @@ Status Network::Evaluate(UInt32 cCount, Float *inputs, Float *outputs)
 	return Status();
 }
 
+Status Network::EvaluateStreamed(UInt32 cCount, Float *inputs, Float *outputs)
+{
+	Synapses   *pSynapses;
+	Synapses   *pNextSynapses;
+	Float      *buffers[2];
+	Float      *prevNeurons;
+	Float      *nextNeurons;
+	UInt32     cPrevNeuronsCount;
+	UInt32     cNextNeuronsCount;
+	UInt32     cMaxNeurons;
+	UInt32     cBuffer;
+	Status     status;
+
+	//each layer is read once per batch: its outputs for all the samples go to one of the two buffers, which is the 
+	//input of the next layer
+	cMaxNeurons = 0;
+	pSynapses   = m_pInputNeurons->m_pNextSynapses;
+	while (NULL != pSynapses && pSynapses->m_pNextNeurons != m_pOutputNeurons)
+	{
+		if (cMaxNeurons < pSynapses->m_pNextNeurons->GetNeuronsCount())
+		{
+			cMaxNeurons = pSynapses->m_pNextNeurons->GetNeuronsCount();
+		}
+		pSynapses = pSynapses->m_pNextNeurons->m_pNextSynapses;
+	}
+	buffers[0] = NULL;
+	buffers[1] = NULL;
+	if (0 < cMaxNeurons)
+	{
+		for (UInt32 i = 0; i < 2; i++)
+		{
+			if (NULL == (buffers[i] = (Float *)Mem::Alloc(sizeof(Float) * cCount * cMaxNeurons)))
+			{
+				status = Status(Status_MemAllocFailed, "Failed to allocate {1} bytes at {2}:{3}", 
+				                sizeof(Float) * cCount * cMaxNeurons, __FILE__, __LINE__);
+
+				break;
+			}
+		}
+	}
+
+	pSynapses   = m_pInputNeurons->m_pNextSynapses;
+	prevNeurons = inputs;
+	cBuffer     = 0;
+	if (status)
+	{
+		pSynapses->m_pSynapses->Prefetch();
+	}
+	while (status && NULL != pSynapses)
+	{
+		pNextSynapses = pSynapses->m_pNextNeurons->m_pNextSynapses;
+		//read-ahead of the next layer while this one is computed
+		if (NULL != pNextSynapses)
+		{
+			pNextSynapses->m_pSynapses->Prefetch();
+			nextNeurons = buffers[cBuffer];
+		}
+		else
+		{
+			nextNeurons = outputs;
+		}
+		cPrevNeuronsCount = pSynapses->m_pPrevNeurons->GetNeuronsCount();
+		cNextNeuronsCount = pSynapses->m_pNextNeurons->GetNeuronsCount();
+		for (UInt32 i = 0; i < cCount; i++)
+		{
+			if (!pSynapses->HasBias())
+			{
+				if (!(status = Compute(prevNeurons, i * cPrevNeuronsCount, cPrevNeuronsCount, 
+				                       pSynapses->GetComputeWeights(), 
+				                       nextNeurons, i * cNextNeuronsCount, cNextNeuronsCount)))
+				{
+					break;
+				}
+			}
+			else
+			{
+				if (!(status = ComputeWithBias(pSynapses->GetBias(), 
+				                               prevNeurons, i * cPrevNeuronsCount, cPrevNeuronsCount, 
+				                               pSynapses->GetComputeWeights(), pSynapses->GetComputeBiases(), 
+				                               nextNeurons, i * cNextNeuronsCount, cNextNeuronsCount)))
+				{
+					break;
+				}
+			}
+			if (!(status = Activate(nextNeurons, i * cNextNeuronsCount, cNextNeuronsCount, 
+			                        pSynapses->m_pNextNeurons->GetActivation(), 
+			                        pSynapses->m_pNextNeurons->GetActivationArgsCount(), 
+			                        pSynapses->m_pNextNeurons->GetActivationArgs())))
+			{
+				break;
+			}
+		}
+		//the batch is done with this layer
+		pSynapses->m_pSynapses->Evict();
+
+		prevNeurons = nextNeurons;
+		cBuffer     = 1 - cBuffer;
+		pSynapses   = pNextSynapses;
+	}
+	for (UInt32 i = 0; i < 2; i++)
+	{
+		if (NULL != buffers[i])
+		{
+			Mem::Free(buffers[i]);
+		}
+	}
+
+	return status;
+}
+
 Status Network::Compute(Float *prevNeurons, UInt32 cPrevNeuronsOffset, UInt32 cPrevNeuronsCount,
                         Float *weights, 
                         Float *nextNeurons, UInt32 cNextNeuronsOffset, UInt32 cNextNeuronsCount)
@@ -465,7 +585,15 @@ Status Network::Activate(Float *nextNeurons, UInt32 cNextNeuronsOffset, UInt32 c
 		case NET::Activation::SRELU           : ActivateSRELU(nextNeurons, cNextNeuronsOffset, cNextNeuronsCount, activationArgs[0], activationArgs[1], activationArgs[2], activationArgs[3]); break;
 		case NET::Activation::ISRLU           : ActivateISRLU(nextNeurons, cNextNeuronsOffset, cNextNeuronsCount, activationArgs[0]); break;
 		case NET::Activation::SoftExponential : ActivateSoftExponential(nextNeurons, cNextNeuronsOffset, cNextNeuronsCount, activationArgs[0]); break;
-		case NET::Activation::SoftMax         : ActivateSoftMax(nextNeurons, cNextNeuronsOffset, cNextNeuronsCount, activationArgs[0]); break;
+		case NET::Activation::SoftMax         : 
+		{
+			Float   fExpSum;
+
+			//the sum is per sample, the activation args do not hold it
+			ActivateSoftMaxExpSum(nextNeurons, cNextNeuronsOffset, cNextNeuronsCount, &fExpSum);
+			ActivateSoftMax(nextNeurons, cNextNeuronsOffset, cNextNeuronsCount, fExpSum);
+		}
+		break;
 	}
 
 	return Status();
@@ -42,6 +42,7 @@ namespace SWST
 
 Provider::Provider()
 {
+	m_bStreamWeights = False;
 }
 
 Provider::~Provider()
@@ -56,26 +57,45 @@ CE::IConfig *Provider::CreateConfig()
 
 Status Provider::DestroyConfig(CE::IConfig *pConfig)
 {
-	Config *pCLConfig = dynamic_cast<Config *>(pConfig);
+	Config *pSWSTConfig = dynamic_cast<Config *>(pConfig);
 
-	if (NULL == pCLConfig)
+	if (NULL == pSWSTConfig)
 	{
 		return Status(Status_InvalidArg, "Invalid arg at {1}:{2}", __FILE__, __LINE__);
 	}
-	delete pCLConfig;
+	delete pSWSTConfig;
 
 	return Status();
 }
 
 Status Provider::Init(const CE::IConfig *pConfig/* = NULL*/)
 {
-	CX_UNUSED(pConfig);
+	Uninit();
+
+	if (NULL != pConfig)
+	{
+		const Config   *pSWSTConfig = dynamic_cast<const Config *>(pConfig);
+
+		if (NULL == pSWSTConfig)
+		{
+			return Status(Status_InvalidArg, "Invalid arg at {1}:{2}", __FILE__, __LINE__);
+		}
+		m_bStreamWeights = pSWSTConfig->GetStreamWeights();
+	}
+	else
+	{
+		Config   config;
+
+		m_bStreamWeights = config.GetStreamWeights();
+	}
 
 	return Status();
 }
 
 Status Provider::Uninit()
 {
+	m_bStreamWeights = False;
+
 	return Status();
 }
 
@@ -103,6 +123,11 @@ Status Provider::DestroyNetwork(CE::INetwork *pNetwork)
 	return Status();
 }
 
+Bool Provider::GetStreamWeights() const
+{
+	return m_bStreamWeights;
+}
+
 }//namespace SWST
 
 }//namespace N2
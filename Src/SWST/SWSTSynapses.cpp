@@ -29,6 +29,7 @@
 #include "N2/SWST/Synapses.hpp"
 #include "N2/SWST/Network.hpp"
 #include "N2/SWST/Provider.hpp"
+#include "N2/NET/ParallelCopy.hpp"
 
 
 using namespace CX;
@@ -49,6 +50,8 @@ Synapses::Synapses(Network *pNetwork)
 	m_weights      = NULL;
 	m_biases       = NULL;
 	m_cbMemSize    = 0;
+	m_nSyncedVersion = NET::Synapses::VERSION_NONE;
+	m_bStreamed      = False;
 }
 
 Synapses::~Synapses()
@@ -71,6 +74,14 @@ Status Synapses::Init(NET::Synapses *pSynapses)
 
 			break;
 		}
+		if (m_pNetwork->GetProvider()->GetStreamWeights() && pSynapses->IsReadOnly())
+		{
+			m_pSynapses      = pSynapses;
+			m_nSyncedVersion = pSynapses->GetVersion();
+			m_bStreamed      = True;
+
+			break;
+		}
 
 		if (NULL == (m_weights = (Float *)Mem::Alloc(sizeof(Float) * pSynapses->GetWeightsCount())))
 		{
@@ -79,7 +90,6 @@ Status Synapses::Init(NET::Synapses *pSynapses)
 
 			break;
 		}
-		memcpy(m_weights, pSynapses->GetWeights(), sizeof(Float) * pSynapses->GetWeightsCount());
 		if (pSynapses->HasBias())
 		{
 			if (NULL == (m_biases = (Float *)Mem::Alloc(sizeof(Float) * pSynapses->GetBiasesCount())))
@@ -89,9 +99,14 @@ Status Synapses::Init(NET::Synapses *pSynapses)
 
 				break;
 			}
-			memcpy(m_biases, pSynapses->GetBiases(), sizeof(Float) * pSynapses->GetBiasesCount());
 		}
-		m_pSynapses   = pSynapses;
+		//large layers are copied on several threads (and read in parallel from mapped models)
+		if (!(status = CopyFrom(pSynapses)))
+		{
+			break;
+		}
+		m_pSynapses      = pSynapses;
+		m_nSyncedVersion = pSynapses->GetVersion();
 		m_cbMemSize += sizeof(Float) * pSynapses->GetWeightsCount();
 		if (pSynapses->HasBias())
 		{
@@ -124,6 +139,8 @@ Status Synapses::Uninit()
 	m_pPrevNeurons = NULL;
 	m_pNextNeurons = NULL;
 	m_cbMemSize    = 0;
+	m_nSyncedVersion = NET::Synapses::VERSION_NONE;
+	m_bStreamed      = False;
 
 	return Status();
 }
@@ -232,12 +249,38 @@ Status Synapses::SyncToCE(Bool bWait/* = True*/)
 
 	CX_UNUSED(bWait);
 
-	memcpy(m_weights, m_pSynapses->GetWeights(), sizeof(Float) * m_pSynapses->GetWeightsCount());
+	NET::Synapses::DirtyRangesVector   vectorRanges;
+	Status                             status;
 
-	if (HasBias())
+	if (m_bStreamed)
+	{
+		m_nSyncedVersion = m_pSynapses->GetVersion();
+
+		return Status();
+	}
+	//only the ranges marked since the last sync
+	if (m_pSynapses->GetDirtyRanges(m_nSyncedVersion, &vectorRanges))
 	{
-		memcpy(m_biases, m_pSynapses->GetBiases(), sizeof(Float) * m_pSynapses->GetBiasesCount());
+		for (NET::Synapses::DirtyRangesVector::iterator iter = vectorRanges.begin(); iter != vectorRanges.end(); ++iter)
+		{
+			if (iter->bBiases)
+			{
+				memcpy(m_biases + iter->cFirst, m_pSynapses->GetBiases() + iter->cFirst, sizeof(Float) * iter->cCount);
+			}
+			else
+			{
+				memcpy(m_weights + iter->cFirst, m_pSynapses->GetWeights() + iter->cFirst, sizeof(Float) * iter->cCount);
+			}
+		}
+	}
+	else
+	{
+		if (!(status = CopyFrom(m_pSynapses)))
+		{
+			return status;
+		}
 	}
+	m_nSyncedVersion = m_pSynapses->GetVersion();
 
 	return Status();
 }
@@ -251,6 +294,12 @@ Status Synapses::SyncFromCE(Bool bWait/* = True*/)
 
 	CX_UNUSED(bWait);
 
+	//mapped from the model file; the engine does not change them
+	if (m_pSynapses->IsReadOnly())
+	{
+		return Status();
+	}
+
 	memcpy(m_pSynapses->GetWeights(), m_weights, sizeof(Float) * m_pSynapses->GetWeightsCount());
 
 	if (HasBias())
@@ -266,6 +315,48 @@ Size Synapses::GetMemSize() const
 	return m_cbMemSize;
 }
 
+Status Synapses::CopyFrom(const NET::Synapses *pSynapses)
+{
+	NET::ParallelCopy::TasksVector   vectorTasks;
+	NET::ParallelCopy::Task          task;
+
+	task.pDest     = m_weights;
+	task.pSource   = pSynapses->GetWeights();
+	task.cbSize    = sizeof(Float) * pSynapses->GetWeightsCount();
+	task.bChecksum = False;
+	task.nChecksum = 0;
+	vectorTasks.push_back(task);
+	if (pSynapses->HasBias())
+	{
+		task.pDest   = m_biases;
+		task.pSource = pSynapses->GetBiases();
+		task.cbSize  = sizeof(Float) * pSynapses->GetBiasesCount();
+		vectorTasks.push_back(task);
+	}
+
+	return NET::ParallelCopy::Run(&vectorTasks);
+}
+
+Float *Synapses::GetComputeWeights()
+{
+	if (m_bStreamed)
+	{
+		return m_pSynapses->GetWeights();
+	}
+
+	return m_weights;
+}
+
+Float *Synapses::GetComputeBiases()
+{
+	if (m_bStreamed)
+	{
+		return m_pSynapses->GetBiases();
+	}
+
+	return m_biases;
+}
+
 }//namespace SWST
 
 }//namespace N2
@@ -0,0 +1,213 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+
+#include "CX/Types.hpp"
+#include "CX/Status.hpp"
+#include "CX/Print.hpp"
+#include "N2/NET/Network.hpp"
+#include "N2/SWMT/Provider.hpp"
+#include "N2/SWMT/Config.hpp"
+#include "N2/SWMT/Network.hpp"
+#include "NetworkFixture.hpp"
+
+
+//several callers share one SWMT provider, each evaluates its own network from its own thread with its own priority 
+//(single samples and batches mixed, so the queues hold work of all the priorities at once): every output must match 
+//the plain reference of its network
+class ConcurrentEvaluateTest
+{
+public:
+
+	static void Run(N2::CE::IProvider *pProvider)
+	{
+		static const N2::SWMT::Provider::Priority   PRIORITIES[] = 
+		{
+			N2::SWMT::Provider::Priority_Auto, N2::SWMT::Provider::Priority_High, 
+			N2::SWMT::Provider::Priority_Normal, N2::SWMT::Provider::Priority_Low
+		};
+
+		N2::CE::IConfig   *pConfig;
+		Caller            callers[CALLERS_COUNT];
+		CX::UInt32        cOpened;
+		CX::UInt32        cErrors;
+		CX::Status        status;
+
+		if (NULL == dynamic_cast<N2::SWMT::Provider *>(pProvider))
+		{
+			CX::Print(stdout, "ConcurrentEvaluateTest : the shared queues are SWMT only\n");
+
+			return;
+		}
+		if (NULL == (pConfig = pProvider->CreateConfig()))
+		{
+			CX::Print(stdout, "ConcurrentEvaluateTest : failed to create the config\n");
+
+			return;
+		}
+		dynamic_cast<N2::SWMT::Config *>(pConfig)->SetThreadsCount(4);
+		if ((status = pProvider->Init(pConfig)))
+		{
+			for (cOpened = 0; status && cOpened < CALLERS_COUNT; cOpened++)
+			{
+				status = Open(pProvider, cOpened, PRIORITIES[cOpened % 4], &callers[cOpened]);
+			}
+			if (status)
+			{
+				status = NetworkFixture::RunThreads(CALLERS_COUNT, &ConcurrentEvaluateTest::CallerThread, callers, 
+				                                    sizeof(Caller));
+			}
+			cErrors = 0;
+			for (CX::UInt32 i = 0; i < cOpened; i++)
+			{
+				if (status && !callers[i].status)
+				{
+					status = callers[i].status;
+				}
+				cErrors += callers[i].cErrors;
+				if (NULL != callers[i].pCENetwork)
+				{
+					callers[i].pCENetwork->Uninit();
+					pProvider->DestroyNetwork(callers[i].pCENetwork);
+				}
+				callers[i].network.Uninit();
+			}
+			if (status)
+			{
+				CX::Print(stdout, "ConcurrentEvaluateTest ({1} callers, {2} rounds) : {3} ({4} wrong outputs)\n", 
+				          CALLERS_COUNT, ROUNDS_COUNT, 0 == cErrors ? "passed" : "FAILED", cErrors);
+			}
+			else
+			{
+				CX::Print(stdout, "ConcurrentEvaluateTest : {1}\n", status.GetMsg());
+			}
+
+			pProvider->Uninit();
+		}
+		else
+		{
+			CX::Print(stdout, "N2::CE::IProvider::Init : {1}\n", status.GetMsg());
+		}
+		pProvider->DestroyConfig(pConfig);
+	}
+
+private:
+
+	typedef NetworkFixture::ValuesVector   ValuesVector;
+
+	static const CX::UInt32   CALLERS_COUNT   = 8;
+	static const CX::UInt32   ROUNDS_COUNT    = 50;
+	static const CX::UInt32   MAX_BATCH_SIZE  = 67;
+
+	struct Caller
+	{
+		N2::NET::Network   network;
+		N2::CE::INetwork   *pCENetwork;
+		ValuesVector       vectorInputs;
+		ValuesVector       vectorExpected;
+		CX::UInt32         cErrors;
+		CX::Status         status;
+
+		Caller()
+		{
+			pCENetwork = NULL;
+			cErrors    = 0;
+		}
+	};
+
+	ConcurrentEvaluateTest()
+	{
+	}
+
+	~ConcurrentEvaluateTest()
+	{
+	}
+
+	//the networks differ in size so their kernels split differently
+	static CX::Status Open(N2::CE::IProvider *pProvider, CX::UInt32 cIndex, N2::SWMT::Provider::Priority nPriority, 
+	                       Caller *pCaller)
+	{
+		N2::NET::Layer   layers[] = 
+		{
+			{ 24 + cIndex * 8, N2::NET::Activation::TanH, 0, { 0.0f }, CX::True, 1.0f },
+			{ 5 + cIndex, N2::NET::Activation::Sigmoid, 0, { 0.0f }, CX::True, 1.0f }
+		};
+		CX::UInt32       cInputs = 17 + cIndex * 3;
+		CX::Status       status;
+
+		if (!(status = pCaller->network.Init(cInputs, sizeof(layers) / sizeof(layers[0]), layers)))
+		{
+			return status;
+		}
+		NetworkFixture::Fill(&pCaller->network, 1.0f / 1024.0f);
+		NetworkFixture::FillInputs(&pCaller->vectorInputs, cInputs, MAX_BATCH_SIZE);
+		pCaller->vectorExpected.resize((CX::Size)MAX_BATCH_SIZE * layers[1].cNeuronsCount);
+		NetworkFixture::Reference(&pCaller->network, MAX_BATCH_SIZE, &pCaller->vectorInputs[0], 
+		                          &pCaller->vectorExpected[0]);
+		if (NULL == (pCaller->pCENetwork = pProvider->CreateNetwork()))
+		{
+			return CX::Status(CX::Status_MemAllocFailed, "Failed to create the engine network");
+		}
+		if (!(status = pCaller->pCENetwork->Init(&pCaller->network)))
+		{
+			return status;
+		}
+		dynamic_cast<N2::SWMT::Network *>(pCaller->pCENetwork)->SetPriority(nPriority);
+
+		return CX::Status();
+	}
+
+	//a single sample, a small and a large batch in turn; a batch of cCount checks the first cCount references
+	static DWORD WINAPI CallerThread(void *pArg)
+	{
+		static const CX::UInt32   BATCH_SIZES[] = { 1, 3, MAX_BATCH_SIZE };
+
+		Caller         *pCaller = (Caller *)pArg;
+		CX::UInt32     cOutputs = pCaller->network.GetOutputNeurons()->GetNeuronsCount();
+		ValuesVector   vectorOutputs;
+		ValuesVector   vectorExpected;
+		CX::UInt32     cCount;
+
+		for (CX::UInt32 i = 0; pCaller->status && i < ROUNDS_COUNT; i++)
+		{
+			cCount = BATCH_SIZES[i % 3];
+			vectorOutputs.assign((CX::Size)cCount * cOutputs, -1.0f);
+			if ((pCaller->status = pCaller->pCENetwork->Evaluate(cCount, &pCaller->vectorInputs[0], &vectorOutputs[0])))
+			{
+				vectorExpected.assign(pCaller->vectorExpected.begin(), 
+				                      pCaller->vectorExpected.begin() + (CX::Size)cCount * cOutputs);
+				pCaller->cErrors += NetworkFixture::CountErrors(vectorOutputs, vectorExpected, 1e-5f);
+			}
+		}
+
+		return 0;
+	}
+
+};
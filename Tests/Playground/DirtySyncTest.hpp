@@ -0,0 +1,223 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+
+#include "CX/Types.hpp"
+#include "CX/Status.hpp"
+#include "CX/Print.hpp"
+#include "CX/Vector.hpp"
+#include "N2/NET/Network.hpp"
+#include "N2/CE/IProvider.hpp"
+
+
+//SyncToCE after a change of some layers, then the engine copies are read back: the changed layers must be there 
+//while the others must still hold their previous values (they are overwritten in the NET network without being 
+//marked, so a copy of them would show)
+//first a single weight of the middle layer is marked (ranges), then the outer layers are marked whole (tensors)
+class DirtySyncTest
+{
+public:
+
+	static void Run(N2::CE::IProvider *pProvider)
+	{
+		static const CX::UInt32       INPUTS_COUNT = 16;
+		static const N2::NET::Layer   LAYERS[]     = 
+		{
+			{ 16, N2::NET::Activation::Identity, 0, { 0.0f }, CX::True, 1.0f },
+			{ 16, N2::NET::Activation::Identity, 0, { 0.0f }, CX::True, 1.0f },
+			{  4, N2::NET::Activation::Identity, 0, { 0.0f }, CX::True, 1.0f }
+		};
+		static const CX::Size         LAYERS_COUNT = sizeof(LAYERS) / sizeof(LAYERS[0]);
+
+		N2::NET::Network   network;
+		N2::CE::INetwork   *pCENetwork;
+		ValuesVector       vectorExpected;
+		CX::Status         status;
+
+		if ((status = network.Init(INPUTS_COUNT, LAYERS_COUNT, LAYERS)))
+		{
+			Change(&network, 0x7, 0, &vectorExpected);
+			if ((status = pProvider->Init()))
+			{
+				if (NULL != (pCENetwork = pProvider->CreateNetwork()))
+				{
+					//Init copies everything
+					if ((status = pCENetwork->Init(&network)))
+					{
+						if ((status = Sync(pCENetwork, &network, 0x2, 1, &vectorExpected, "patched weight")))
+						{
+							status = Sync(pCENetwork, &network, 0x5, 2, &vectorExpected, "reloaded layers");
+						}
+						if (!status)
+						{
+							CX::Print(stdout, "N2::CE::INetwork::SyncToCE / SyncFromCE : {1}\n", status.GetMsg());
+						}
+
+						pCENetwork->Uninit();
+					}
+					else
+					{
+						CX::Print(stdout, "N2::CE::INetwork::Init : {1}\n", status.GetMsg());
+					}
+					pProvider->DestroyNetwork(pCENetwork);
+				}
+				else
+				{
+					CX::Print(stdout, "N2::CE::IProvider::CreateNetwork : {1}\n", status.GetMsg());
+				}
+
+				pProvider->Uninit();
+			}
+			else
+			{
+				CX::Print(stdout, "N2::CE::IProvider::Init : {1}\n", status.GetMsg());
+			}
+
+			status = network.Uninit();
+		}
+		else
+		{
+			CX::Print(stdout, "N2::NET::Network::Init : {1}\n", status.GetMsg());
+		}
+	}
+
+private:
+
+	typedef CX::Vector<CX::Float>::Type   ValuesVector;
+
+	static const CX::UInt32   PATCHED_WEIGHT = 37;
+	static const CX::UInt32   STALE_VALUE    = 1000;
+
+	DirtySyncTest()
+	{
+	}
+
+	~DirtySyncTest()
+	{
+	}
+
+	//weights then biases of all the layers
+	static CX::Float *GetValues(N2::NET::Synapses *pSynapses, CX::UInt32 cIndex)
+	{
+		if (cIndex < pSynapses->GetWeightsCount())
+		{
+			return &pSynapses->GetWeights()[cIndex];
+		}
+
+		return &pSynapses->GetBiases()[cIndex - pSynapses->GetWeightsCount()];
+	}
+
+	//the layers in nLayersMask get values of round cRound (only PATCHED_WEIGHT for round 1, marked as a range, or 
+	//everything, marked whole) and vectorExpected is updated; the others get a value that must not reach the engine
+	static void Change(N2::NET::Network *pNetwork, CX::UInt32 nLayersMask, CX::UInt32 cRound, 
+	                   ValuesVector *pVectorExpected)
+	{
+		N2::NET::Synapses   *pSynapses;
+		CX::UInt32          cLayer;
+		CX::UInt32          cCount;
+		CX::Size            cOffset;
+
+		cOffset = 0;
+		for (pSynapses = pNetwork->GetInputNeurons()->GetNextSynapses(), cLayer = 0; NULL != pSynapses; 
+		     pSynapses = pSynapses->GetNextNeurons()->GetNextSynapses(), cLayer++)
+		{
+			cCount = pSynapses->GetWeightsCount() + pSynapses->GetBiasesCount();
+			if (pVectorExpected->size() < cOffset + cCount)
+			{
+				pVectorExpected->resize(cOffset + cCount);
+			}
+			for (CX::UInt32 i = 0; i < cCount; i++)
+			{
+				if (0 == (nLayersMask & (1 << cLayer)))
+				{
+					*GetValues(pSynapses, i) = (CX::Float)STALE_VALUE;
+				}
+				else
+				if (1 != cRound || PATCHED_WEIGHT == i)
+				{
+					*GetValues(pSynapses, i)        = (CX::Float)(cRound * 100 + cLayer * 10) + (i % 10) / 10.0f;
+					(*pVectorExpected)[cOffset + i] = *GetValues(pSynapses, i);
+				}
+			}
+			if (0 != (nLayersMask & (1 << cLayer)))
+			{
+				if (1 == cRound)
+				{
+					pSynapses->MarkWeightsDirty(PATCHED_WEIGHT, 1);
+				}
+				else
+				{
+					pSynapses->MarkAllDirty();
+				}
+			}
+			cOffset += cCount;
+		}
+	}
+
+	static CX::Status Sync(N2::CE::INetwork *pCENetwork, N2::NET::Network *pNetwork, CX::UInt32 nLayersMask, 
+	                       CX::UInt32 cRound, ValuesVector *pVectorExpected, const CX::Char *szName)
+	{
+		N2::NET::Synapses   *pSynapses;
+		CX::UInt32          cCount;
+		CX::UInt32          cErrors;
+		CX::Size            cOffset;
+		CX::Status          status;
+
+		Change(pNetwork, nLayersMask, cRound, pVectorExpected);
+		if (!(status = pCENetwork->SyncToCE(CX::True, N2::CE::INetwork::Sync_Synapse)))
+		{
+			return status;
+		}
+		if (!(status = pCENetwork->SyncFromCE(CX::True, N2::CE::INetwork::Sync_Synapse)))
+		{
+			return status;
+		}
+		cErrors = 0;
+		cOffset = 0;
+		for (pSynapses = pNetwork->GetInputNeurons()->GetNextSynapses(); NULL != pSynapses; 
+		     pSynapses = pSynapses->GetNextNeurons()->GetNextSynapses())
+		{
+			cCount = pSynapses->GetWeightsCount() + pSynapses->GetBiasesCount();
+			for (CX::UInt32 i = 0; i < cCount; i++)
+			{
+				if ((*pVectorExpected)[cOffset + i] != *GetValues(pSynapses, i))
+				{
+					cErrors++;
+				}
+			}
+			cOffset += cCount;
+		}
+		CX::Print(stdout, "DirtySyncTest ({1}) : {2} ({3} wrong values)\n", szName, 
+		          0 == cErrors ? "passed" : "FAILED", cErrors);
+
+		return status;
+	}
+
+};
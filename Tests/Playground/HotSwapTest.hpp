@@ -0,0 +1,277 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+
+#include "CX/Types.hpp"
+#include "CX/Status.hpp"
+#include "CX/Print.hpp"
+#include "N2/NET/Network.hpp"
+#include "N2/CE/ModelHandle.hpp"
+#include "NetworkFixture.hpp"
+
+
+//a model handle is republished over and over (two models with the same shape and different weights, in turn) while
+//several threads acquire and evaluate the current version: every output must match the reference of the version it
+//was evaluated on; the engines do not evaluate concurrently on one network (it holds the hidden layers values), so
+//the readers take turns for the Evaluate call only while the acquires, releases and swaps all race
+class HotSwapTest
+{
+public:
+
+	static void Run(N2::CE::IProvider *pProvider)
+	{
+		N2::CE::ModelHandle     handle;
+		N2::NET::Network        models[MODELS_COUNT];
+		Worker                  workers[READERS_COUNT + 1];
+		volatile LONG           bPublishing;
+		SRWLOCK                 srwlEvaluate;
+		ValuesVector            vectorInputs;
+		ValuesVector            vectorExpected[MODELS_COUNT];
+		CX::UInt32              cErrors;
+		CX::UInt32              cSeen;
+		CX::Status              status;
+
+		InitializeSRWLock(&srwlEvaluate);
+		if ((status = pProvider->Init()))
+		{
+			for (;;)
+			{
+				NetworkFixture::FillInputs(&vectorInputs, INPUTS_COUNT, BATCH_SIZE);
+				for (CX::UInt32 i = 0; status && i < MODELS_COUNT; i++)
+				{
+					if ((status = InitModel(&models[i], i)))
+					{
+						vectorExpected[i].resize((CX::Size)BATCH_SIZE * OUTPUTS_COUNT);
+						NetworkFixture::Reference(&models[i], BATCH_SIZE, &vectorInputs[0], &vectorExpected[i][0]);
+					}
+				}
+				if (!status)
+				{
+					break;
+				}
+				if (!(status = handle.Init(pProvider)))
+				{
+					break;
+				}
+				//the readers always find a version
+				if (!(status = Publish(&handle, 0)))
+				{
+					break;
+				}
+				for (CX::UInt32 i = 0; i <= READERS_COUNT; i++)
+				{
+					workers[i].pHandle         = &handle;
+					workers[i].pbPublishing    = &bPublishing;
+					workers[i].pSRWLEvaluate   = &srwlEvaluate;
+					workers[i].pInputs         = &vectorInputs[0];
+					workers[i].pVectorExpected = vectorExpected;
+					workers[i].bPublisher      = (0 == i);
+				}
+				bPublishing = TRUE;
+				if (!(status = NetworkFixture::RunThreads(READERS_COUNT + 1, &HotSwapTest::WorkerThread, workers,
+				                                          sizeof(Worker))))
+				{
+					break;
+				}
+				cErrors = 0;
+				cSeen   = 0;
+				for (CX::UInt32 i = 0; i <= READERS_COUNT; i++)
+				{
+					if (status && !workers[i].status)
+					{
+						status = workers[i].status;
+					}
+					cErrors += workers[i].cErrors;
+					cSeen   += workers[i].cVersionsSeen;
+				}
+				if (!status)
+				{
+					break;
+				}
+				if (SWAPS_COUNT + 1 != handle.GetVersionNumber())
+				{
+					cErrors++;
+				}
+				CX::Print(stdout, "HotSwapTest ({1} swaps, {2} readers, {3} version changes seen) : {4} "
+				          "({5} wrong outputs)\n", SWAPS_COUNT, READERS_COUNT, cSeen,
+				          0 == cErrors ? "passed" : "FAILED", cErrors);
+
+				break;
+			}
+			if (!status)
+			{
+				CX::Print(stdout, "HotSwapTest : {1}\n", status.GetMsg());
+			}
+			handle.Uninit();
+			for (CX::UInt32 i = 0; i < MODELS_COUNT; i++)
+			{
+				models[i].Uninit();
+			}
+
+			pProvider->Uninit();
+		}
+		else
+		{
+			CX::Print(stdout, "N2::CE::IProvider::Init : {1}\n", status.GetMsg());
+		}
+	}
+
+private:
+
+	typedef NetworkFixture::ValuesVector   ValuesVector;
+
+	static const CX::UInt32   MODELS_COUNT   = 2;
+	static const CX::UInt32   READERS_COUNT  = 6;
+	static const CX::UInt32   SWAPS_COUNT    = 40;
+	static const CX::UInt32   INPUTS_COUNT   = 29;
+	static const CX::UInt32   OUTPUTS_COUNT  = 7;
+	static const CX::UInt32   BATCH_SIZE     = 13;
+
+	struct Worker
+	{
+		N2::CE::ModelHandle   *pHandle;
+		volatile LONG         *pbPublishing;      //cleared by the publisher once done
+		SRWLOCK               *pSRWLEvaluate;
+		const CX::Float       *pInputs;
+		const ValuesVector    *pVectorExpected;
+		CX::Bool              bPublisher;
+		CX::UInt32            cErrors;
+		CX::UInt32            cVersionsSeen;
+		CX::Status            status;
+
+		Worker()
+		{
+			pHandle         = NULL;
+			pbPublishing    = NULL;
+			pSRWLEvaluate   = NULL;
+			pInputs         = NULL;
+			pVectorExpected = NULL;
+			bPublisher      = CX::False;
+			cErrors         = 0;
+			cVersionsSeen   = 0;
+		}
+	};
+
+	HotSwapTest()
+	{
+	}
+
+	~HotSwapTest()
+	{
+	}
+
+	//same shape, the weights of the second model are the ones of the first negated and doubled
+	static CX::Status InitModel(N2::NET::Network *pNetwork, CX::UInt32 cModel)
+	{
+		N2::NET::Layer   layers[] =
+		{
+			{ 40, N2::NET::Activation::TanH, 0, { 0.0f }, CX::True, 1.0f },
+			{ OUTPUTS_COUNT, N2::NET::Activation::Sigmoid, 0, { 0.0f }, CX::True, 1.0f }
+		};
+		CX::Status       status;
+
+		if ((status = pNetwork->Init(INPUTS_COUNT, sizeof(layers) / sizeof(layers[0]), layers)))
+		{
+			NetworkFixture::Fill(pNetwork, (0 == cModel ? 1.0f : -2.0f) / 1024.0f);
+		}
+
+		return status;
+	}
+
+	//the handle owns what it is given, so each publish builds its own copy of the model; version n is model (n - 1) % 2
+	static CX::Status Publish(N2::CE::ModelHandle *pHandle, CX::UInt32 cModel)
+	{
+		N2::NET::Network   *pNetwork;
+		CX::Status         status;
+
+		if (NULL == (pNetwork = new (std::nothrow) N2::NET::Network()))
+		{
+			return CX::Status(CX::Status_MemAllocFailed, "Failed to allocate the network");
+		}
+		if (!(status = InitModel(pNetwork, cModel)))
+		{
+			delete pNetwork;
+
+			return status;
+		}
+
+		return pHandle->Publish(pNetwork);
+	}
+
+	static DWORD WINAPI WorkerThread(void *pArg)
+	{
+		Worker                          *pWorker = (Worker *)pArg;
+		N2::CE::ModelHandle::Version    *pVersion;
+		ValuesVector                    vectorOutputs;
+		CX::UInt64                      nLastNumber;
+
+		if (pWorker->bPublisher)
+		{
+			for (CX::UInt32 i = 1; pWorker->status && i <= SWAPS_COUNT; i++)
+			{
+				pWorker->status = Publish(pWorker->pHandle, i % MODELS_COUNT);
+			}
+			InterlockedExchange(pWorker->pbPublishing, FALSE);
+
+			return 0;
+		}
+		nLastNumber = 0;
+		while (pWorker->status && *pWorker->pbPublishing)
+		{
+			if (NULL == (pVersion = pWorker->pHandle->Acquire()))
+			{
+				pWorker->status = CX::Status(CX::Status_InvalidCall, "No version published");
+
+				break;
+			}
+			vectorOutputs.assign((CX::Size)BATCH_SIZE * OUTPUTS_COUNT, -1.0f);
+			//the version is held while waiting for the turn, so a publisher retiring it has to wait for this reader
+			AcquireSRWLockExclusive(pWorker->pSRWLEvaluate);
+			pWorker->status = pVersion->pCENetwork->Evaluate(BATCH_SIZE, (CX::Float *)pWorker->pInputs,
+			                                                 &vectorOutputs[0]);
+			ReleaseSRWLockExclusive(pWorker->pSRWLEvaluate);
+			if (pWorker->status)
+			{
+				pWorker->cErrors += NetworkFixture::CountErrors(vectorOutputs,
+				                                     pWorker->pVectorExpected[(pVersion->nNumber - 1) % MODELS_COUNT],
+				                                     1e-5f);
+				if (0 != nLastNumber && nLastNumber != pVersion->nNumber)
+				{
+					pWorker->cVersionsSeen++;
+				}
+				nLastNumber = pVersion->nNumber;
+			}
+			pWorker->pHandle->Release(pVersion);
+		}
+
+		return 0;
+	}
+
+};
@@ -0,0 +1,227 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+
+#include <stdio.h>
+#include "CX/Types.hpp"
+#include "CX/Status.hpp"
+#include "CX/Print.hpp"
+#include "N2/NET/Network.hpp"
+#include "N2/NET/BinaryFormat.hpp"
+#include "N2/CE/IProvider.hpp"
+#include "NetworkFixture.hpp"
+
+
+//a network is saved in the v1 format, then its synapses file is mapped (BinaryFormat::MapSynapses) and the synapses
+//read back from it: the values must match the saved network, the mapped synapses must be read-only, the engine outputs
+//must match the plain reference of the saved network and SyncFromCE must leave the mapping alone; a mapped layer made
+//writable and changed must then be evaluated with its new values
+class MappedSynapsesTest
+{
+public:
+
+	static void Run(N2::CE::IProvider *pProvider)
+	{
+		static const CX::UInt32       INPUTS_COUNT    = 23;
+		//the v1 neurons file has RELU and Sigmoid layers only, with a bias value of 1
+		static const N2::NET::Layer   LAYERS[]        =
+		{
+			{ 35, N2::NET::Activation::RELU, 0, { 0.0f }, CX::True, 1.0f },
+			{ 19, N2::NET::Activation::RELU, 0, { 0.0f }, CX::False, 0.0f },
+			{  6, N2::NET::Activation::Sigmoid, 0, { 0.0f }, CX::True, 1.0f }
+		};
+		static const CX::Size         LAYERS_COUNT    = sizeof(LAYERS) / sizeof(LAYERS[0]);
+		static const CX::Char         NEURONS_PATH[]  = "MappedSynapsesTest.n2n";
+		static const CX::Char         SYNAPSES_PATH[] = "MappedSynapsesTest.n2s";
+
+		N2::NET::Network   network;
+		N2::NET::Network   mapped;
+		CX::Status         status;
+
+		if ((status = network.Init(INPUTS_COUNT, LAYERS_COUNT, LAYERS)))
+		{
+			NetworkFixture::Fill(&network, 1.0f / 256.0f);
+			for (;;)
+			{
+				if (!(status = N2::NET::BinaryFormat::SaveNeurons(&network, NEURONS_PATH)))
+				{
+					break;
+				}
+				if (!(status = N2::NET::BinaryFormat::SaveSynapses(&network, SYNAPSES_PATH)))
+				{
+					break;
+				}
+				if (!(status = N2::NET::BinaryFormat::LoadNeurons(&mapped, NEURONS_PATH)))
+				{
+					break;
+				}
+				if (!(status = N2::NET::BinaryFormat::MapSynapses(&mapped, SYNAPSES_PATH)))
+				{
+					break;
+				}
+				Check(pProvider, &network, &mapped);
+
+				break;
+			}
+			if (!status)
+			{
+				CX::Print(stdout, "MappedSynapsesTest : {1}\n", status.GetMsg());
+			}
+			mapped.Uninit();
+			remove(NEURONS_PATH);
+			remove(SYNAPSES_PATH);
+
+			status = network.Uninit();
+		}
+		else
+		{
+			CX::Print(stdout, "N2::NET::Network::Init : {1}\n", status.GetMsg());
+		}
+	}
+
+private:
+
+	typedef NetworkFixture::ValuesVector   ValuesVector;
+
+	static const CX::UInt32   SAMPLES_COUNT = 9;
+
+	MappedSynapsesTest()
+	{
+	}
+
+	~MappedSynapsesTest()
+	{
+	}
+
+	static CX::UInt32 GetReadOnlyCount(const N2::NET::Network *pNetwork)
+	{
+		const N2::NET::Synapses   *pSynapses;
+		CX::UInt32                cReadOnly = 0;
+
+		for (pSynapses = pNetwork->GetInputNeurons()->GetNextSynapses(); NULL != pSynapses;
+		     pSynapses = pSynapses->GetNextNeurons()->GetNextSynapses())
+		{
+			if (pSynapses->IsReadOnly())
+			{
+				cReadOnly++;
+			}
+		}
+
+		return cReadOnly;
+	}
+
+	//evaluates pCENetwork and counts the outputs that differ from the reference of pNetwork
+	static CX::Status Compare(N2::CE::INetwork *pCENetwork, const N2::NET::Network *pNetwork, CX::UInt32 *pcErrors)
+	{
+		CX::UInt32     cInputs  = pNetwork->GetInputNeurons()->GetNeuronsCount();
+		CX::UInt32     cOutputs = pNetwork->GetOutputNeurons()->GetNeuronsCount();
+		ValuesVector   vectorInputs;
+		ValuesVector   vectorOutputs(SAMPLES_COUNT * cOutputs, -1.0f);
+		ValuesVector   vectorExpected(SAMPLES_COUNT * cOutputs);
+		CX::Status     status;
+
+		NetworkFixture::FillInputs(&vectorInputs, cInputs, SAMPLES_COUNT);
+		NetworkFixture::Reference(pNetwork, SAMPLES_COUNT, &vectorInputs[0], &vectorExpected[0]);
+		if ((status = pCENetwork->Evaluate(SAMPLES_COUNT, &vectorInputs[0], &vectorOutputs[0])))
+		{
+			*pcErrors = NetworkFixture::CountErrors(vectorOutputs, vectorExpected, 1e-5f);
+		}
+
+		return status;
+	}
+
+	static void Check(N2::CE::IProvider *pProvider, N2::NET::Network *pNetwork, N2::NET::Network *pMapped)
+	{
+		N2::CE::INetwork    *pCENetwork;
+		N2::NET::Synapses   *pSynapses;
+		N2::NET::Synapses   *pMappedSynapses;
+		CX::UInt32          cLayers      = pNetwork->GetLayersCount();
+		CX::UInt32          cReadOnly    = GetReadOnlyCount(pMapped);
+		CX::Bool            bSame        = NetworkFixture::IsSame(pNetwork, pMapped);
+		CX::Bool            bSameSynced  = CX::False;
+		CX::Bool            bWritable    = CX::False;
+		CX::UInt32          cErrors      = 0;
+		CX::UInt32          cErrorsAfter = 0;
+		CX::Status          status;
+
+		if (!(status = NetworkFixture::Open(pProvider, NULL, pMapped, &pCENetwork)))
+		{
+			CX::Print(stdout, "MappedSynapsesTest : {1}\n", status.GetMsg());
+
+			return;
+		}
+		for (;;)
+		{
+			if (!(status = Compare(pCENetwork, pNetwork, &cErrors)))
+			{
+				break;
+			}
+			//writing into the read-only mapping would fault
+			if (!(status = pCENetwork->SyncFromCE()))
+			{
+				break;
+			}
+			bSameSynced = NetworkFixture::IsSame(pNetwork, pMapped);
+			//the first layer gets its own copy, then one weight and one bias change in both networks
+			pSynapses       = pNetwork->GetInputNeurons()->GetNextSynapses();
+			pMappedSynapses = pMapped->GetInputNeurons()->GetNextSynapses();
+			if (!(status = pMappedSynapses->MakeWritable()))
+			{
+				break;
+			}
+			bWritable = !pMappedSynapses->IsReadOnly();
+			pSynapses->GetWeights()[7] = pMappedSynapses->GetWeights()[7] = 0.75f;
+			pSynapses->GetBiases()[3]  = pMappedSynapses->GetBiases()[3] = -0.5f;
+			pMappedSynapses->MarkWeightsDirty(7, 1);
+			pMappedSynapses->MarkBiasesDirty(3, 1);
+			if (!(status = pCENetwork->SyncToCE()))
+			{
+				break;
+			}
+			status = Compare(pCENetwork, pNetwork, &cErrorsAfter);
+
+			break;
+		}
+		NetworkFixture::Close(pProvider, pCENetwork);
+		if (!status)
+		{
+			CX::Print(stdout, "MappedSynapsesTest : {1}\n", status.GetMsg());
+
+			return;
+		}
+		CX::Print(stdout, "MappedSynapsesTest (map) : {1} (values {2}, {3} of {4} layers read-only, {5} wrong outputs)\n",
+		          bSame && cLayers == cReadOnly && 0 == cErrors ? "passed" : "FAILED", bSame ? "match" : "differ",
+		          cReadOnly, cLayers, cErrors);
+		CX::Print(stdout, "MappedSynapsesTest (writable) : {1} (values {2} after SyncFromCE, layer {3}, {4} wrong "
+		          "outputs after the change)\n", bSameSynced && bWritable && 0 == cErrorsAfter ? "passed" : "FAILED",
+		          bSameSynced ? "match" : "differ", bWritable ? "writable" : "read-only", cErrorsAfter);
+	}
+
+};
@@ -0,0 +1,268 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+
+#include <stdio.h>
+#include "CX/Types.hpp"
+#include "CX/Status.hpp"
+#include "CX/Print.hpp"
+#include "N2/NET/Network.hpp"
+#include "N2/NET/ModelFormat.hpp"
+#include "N2/CE/IProvider.hpp"
+#include "N2/CL/Provider.hpp"
+#include "N2/CL/Config.hpp"
+#include "NetworkFixture.hpp"
+
+
+//a network using activations with args (SELU, ELU) and a per sample one (SoftMax) is saved in the v2 format, then 
+//loaded and mapped back: the topology and the values must match the saved network and the engine outputs must match 
+//a plain reference; a copy of the file with one flipped byte must be rejected by the checksums
+//on CL the softmax layer is also checked with the per-layer kernels (a batch of a tile or more) and with the 
+//hand-written ones (no generated kernels), both launch their own per sample softmax
+//layers with fewer activation args than their activation reads must be rejected
+class ModelFormatTest
+{
+public:
+
+	static void Run(N2::CE::IProvider *pProvider)
+	{
+		static const CX::UInt32       INPUTS_COUNT = 8;
+		static const N2::NET::Layer   LAYERS[]     = 
+		{
+			{ 16, N2::NET::Activation::SELU, 2, { 1.67326324f, 1.05070098f }, CX::True, 1.0f },
+			{ 16, N2::NET::Activation::ELU, 1, { 1.0f }, CX::False, 0.0f },
+			{  4, N2::NET::Activation::SoftMax, 0, { 0.0f }, CX::True, 1.0f }
+		};
+		static const CX::Size         LAYERS_COUNT = sizeof(LAYERS) / sizeof(LAYERS[0]);
+		static const CX::Char         MODEL_PATH[]     = "ModelFormatTest.n2m";
+		static const CX::Char         CORRUPTED_PATH[] = "ModelFormatTest.corrupted.n2m";
+
+		N2::NET::Network   network;
+		N2::NET::Network   loaded;
+		N2::NET::Network   mapped;
+		CX::Status         status;
+
+		if ((status = network.Init(INPUTS_COUNT, LAYERS_COUNT, LAYERS)))
+		{
+			NetworkFixture::Fill(&network, 1.0f / 512.0f);
+			if ((status = N2::NET::ModelFormat::Save(&network, MODEL_PATH)))
+			{
+				if ((status = N2::NET::ModelFormat::Load(&loaded, MODEL_PATH)))
+				{
+					Check(pProvider, NULL, &network, &loaded, SAMPLES_COUNT, "load");
+					if (NULL != dynamic_cast<N2::CL::Provider *>(pProvider))
+					{
+						CheckCL(dynamic_cast<N2::CL::Provider *>(pProvider), &network, &loaded);
+					}
+					loaded.Uninit();
+				}
+				else
+				{
+					CX::Print(stdout, "N2::NET::ModelFormat::Load : {1}\n", status.GetMsg());
+				}
+				if ((status = N2::NET::ModelFormat::Map(&mapped, MODEL_PATH, CX::True)))
+				{
+					Check(pProvider, NULL, &network, &mapped, SAMPLES_COUNT, "map");
+					mapped.Uninit();
+				}
+				else
+				{
+					CX::Print(stdout, "N2::NET::ModelFormat::Map : {1}\n", status.GetMsg());
+				}
+				CheckCorrupted(MODEL_PATH, CORRUPTED_PATH);
+				CheckActivationArgs();
+				remove(MODEL_PATH);
+			}
+			else
+			{
+				CX::Print(stdout, "N2::NET::ModelFormat::Save : {1}\n", status.GetMsg());
+			}
+
+			status = network.Uninit();
+		}
+		else
+		{
+			CX::Print(stdout, "N2::NET::Network::Init : {1}\n", status.GetMsg());
+		}
+	}
+
+private:
+
+	typedef NetworkFixture::ValuesVector   ValuesVector;
+
+	static const CX::UInt32   SAMPLES_COUNT       = 4;
+	//above the largest tile size
+	static const CX::UInt32   LARGE_SAMPLES_COUNT = 67;
+
+	ModelFormatTest()
+	{
+	}
+
+	~ModelFormatTest()
+	{
+	}
+
+	static void Check(N2::CE::IProvider *pProvider, const N2::CE::IConfig *pConfig, const N2::NET::Network *pNetwork, 
+	                  N2::NET::Network *pOther, CX::UInt32 cCount, const CX::Char *szName)
+	{
+		CX::UInt32     cInputs  = pNetwork->GetInputNeurons()->GetNeuronsCount();
+		CX::UInt32     cOutputs = pNetwork->GetOutputNeurons()->GetNeuronsCount();
+		ValuesVector   vectorInputs;
+		ValuesVector   vectorOutputs(cCount * cOutputs);
+		ValuesVector   vectorExpected(cCount * cOutputs);
+		CX::UInt32     cErrors;
+		CX::Status     status;
+
+		NetworkFixture::FillInputs(&vectorInputs, cInputs, cCount);
+		NetworkFixture::Reference(pNetwork, cCount, &vectorInputs[0], &vectorExpected[0]);
+		if (!(status = NetworkFixture::Evaluate(pProvider, pConfig, pOther, cCount, &vectorInputs[0], 
+		                                        &vectorOutputs[0])))
+		{
+			CX::Print(stdout, "ModelFormatTest ({1}) : {2}\n", szName, status.GetMsg());
+
+			return;
+		}
+		cErrors = NetworkFixture::CountErrors(vectorOutputs, vectorExpected, 1e-4f);
+		CX::Print(stdout, "ModelFormatTest ({1}) : {2} (topology and values {3}, {4} wrong outputs)\n", szName, 
+		          NetworkFixture::IsSame(pNetwork, pOther) && 0 == cErrors ? "passed" : "FAILED", 
+		          NetworkFixture::IsSame(pNetwork, pOther) ? "match" : "differ", cErrors);
+	}
+
+	static void CheckCL(N2::CL::Provider *pProvider, const N2::NET::Network *pNetwork, N2::NET::Network *pLoaded)
+	{
+		N2::CE::IConfig   *pConfig;
+
+		Check(pProvider, NULL, pNetwork, pLoaded, LARGE_SAMPLES_COUNT, "load, per-layer kernels");
+		if (NULL == (pConfig = pProvider->CreateConfig()))
+		{
+			CX::Print(stdout, "ModelFormatTest (no generated kernels) : failed to create the config\n");
+
+			return;
+		}
+		dynamic_cast<N2::CL::Config *>(pConfig)->SetGenerateKernels(CX::False);
+		Check(pProvider, pConfig, pNetwork, pLoaded, SAMPLES_COUNT, "load, no generated kernels");
+		Check(pProvider, pConfig, pNetwork, pLoaded, LARGE_SAMPLES_COUNT, "load, no generated kernels, large batch");
+		pProvider->DestroyConfig(pConfig);
+	}
+
+	//the last byte of the file is a bias of the last layer, only its section checksum can catch the change
+	static void CheckCorrupted(const CX::Char *szPath, const CX::Char *szCorruptedPath)
+	{
+		N2::NET::Network   network;
+		FILE               *pFile;
+		ValuesVector       vectorData;
+		CX::Byte           *pData;
+		long               cbSize;
+		CX::Bool           bLoadRejected;
+		CX::Bool           bMapRejected;
+
+		if (NULL == (pFile = fopen(szPath, "rb")))
+		{
+			CX::Print(stdout, "ModelFormatTest (checksum) : failed to open {1}\n", szPath);
+
+			return;
+		}
+		fseek(pFile, 0, SEEK_END);
+		cbSize = ftell(pFile);
+		fseek(pFile, 0, SEEK_SET);
+		vectorData.resize(cbSize / sizeof(CX::Float) + 1);
+		pData = (CX::Byte *)&vectorData[0];
+		fread(pData, 1, cbSize, pFile);
+		fclose(pFile);
+		pData[cbSize - 1] ^= 0x40;
+		if (NULL == (pFile = fopen(szCorruptedPath, "wb")))
+		{
+			CX::Print(stdout, "ModelFormatTest (checksum) : failed to create {1}\n", szCorruptedPath);
+
+			return;
+		}
+		fwrite(pData, 1, cbSize, pFile);
+		fclose(pFile);
+
+		bLoadRejected = !N2::NET::ModelFormat::Load(&network, szCorruptedPath);
+		network.Uninit();
+		bMapRejected = !N2::NET::ModelFormat::Map(&network, szCorruptedPath, CX::True);
+		network.Uninit();
+		remove(szCorruptedPath);
+
+		CX::Print(stdout, "ModelFormatTest (checksum) : {1} (load {2}, map {3})\n", 
+		          bLoadRejected && bMapRejected ? "passed" : "FAILED", 
+		          bLoadRejected ? "rejected" : "accepted", bMapRejected ? "rejected" : "accepted");
+	}
+
+	static void CheckActivationArgs()
+	{
+		//the first network is valid, the others have a layer with missing args
+		static const N2::NET::Layer   NETWORKS[][2] = 
+		{
+			{
+				{ 4, N2::NET::Activation::ELU, 1, { 1.0f }, CX::False, 0.0f },
+				{ 4, N2::NET::Activation::Identity, 0, { 0.0f }, CX::False, 0.0f }
+			},
+			{
+				{ 4, N2::NET::Activation::ELU, 0, { 0.0f }, CX::False, 0.0f },
+				{ 4, N2::NET::Activation::Identity, 0, { 0.0f }, CX::False, 0.0f }
+			},
+			{
+				{ 4, N2::NET::Activation::Identity, 0, { 0.0f }, CX::False, 0.0f },
+				{ 4, N2::NET::Activation::SELU, 1, { 1.67326324f }, CX::False, 0.0f }
+			},
+			{
+				{ 4, N2::NET::Activation::SRELU, 3, { 0.0f, 1.0f, 1.0f }, CX::False, 0.0f },
+				{ 4, N2::NET::Activation::Identity, 0, { 0.0f }, CX::False, 0.0f }
+			},
+			{
+				{ 4, N2::NET::Activation::Identity, 0, { 0.0f }, CX::False, 0.0f },
+				{ 4, N2::NET::Activation::SoftExponential, 0, { 0.0f }, CX::False, 0.0f }
+			}
+		};
+		static const CX::Size         NETWORKS_COUNT = sizeof(NETWORKS) / sizeof(NETWORKS[0]);
+
+		N2::NET::Network   network;
+		CX::Bool           bValidAccepted;
+		CX::UInt32         cAccepted;
+
+		bValidAccepted = network.Init(4, 2, NETWORKS[0]).IsOK();
+		network.Uninit();
+		cAccepted = 0;
+		for (CX::Size i = 1; i < NETWORKS_COUNT; i++)
+		{
+			if (network.Init(4, 2, NETWORKS[i]))
+			{
+				cAccepted++;
+			}
+			network.Uninit();
+		}
+		CX::Print(stdout, "ModelFormatTest (activation args) : {1} (valid layers {2}, {3} of {4} layers with missing "
+		          "args accepted)\n", bValidAccepted && 0 == cAccepted ? "passed" : "FAILED", 
+		          bValidAccepted ? "accepted" : "rejected", cAccepted, NETWORKS_COUNT - 1);
+	}
+
+};
@@ -0,0 +1,152 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+
+#include "CX/Types.hpp"
+#include "CX/Status.hpp"
+#include "CX/Print.hpp"
+#include "N2/NET/Network.hpp"
+#include "N2/CL/Provider.hpp"
+#include "N2/CL/MultiProvider.hpp"
+#include "N2/CL/MultiNetwork.hpp"
+#include "N2/CL/MultiConfig.hpp"
+#include "NetworkFixture.hpp"
+
+
+//the same batches are evaluated by a single CL network and by a MultiNetwork over the sub-devices of the default 
+//device (one per compute unit, CPU runtimes such as pocl support it): the stitched outputs must match; the batch 
+//sizes are repeated so the later splits follow the measured throughputs instead of the initial estimates
+class MultiNetworkTest
+{
+public:
+
+	static void Run(N2::CE::IProvider *pProvider)
+	{
+		static const CX::UInt32       INPUTS_COUNT   = 37;
+		static const N2::NET::Layer   LAYERS[]       = 
+		{
+			{ 130, N2::NET::Activation::TanH, 0, { 0.0f }, CX::True, 1.0f },
+			{  64, N2::NET::Activation::RELU, 0, { 0.0f }, CX::False, 0.0f },
+			{   9, N2::NET::Activation::Sigmoid, 0, { 0.0f }, CX::True, 1.0f }
+		};
+		static const CX::Size         LAYERS_COUNT   = sizeof(LAYERS) / sizeof(LAYERS[0]);
+		static const CX::UInt32       BATCH_SIZES[]  = { 1, 7, 1001, 1001, 1001, 3 };
+		static const CX::Size         BATCHES_COUNT  = sizeof(BATCH_SIZES) / sizeof(BATCH_SIZES[0]);
+
+		N2::CL::MultiProvider   multiProvider;
+		N2::CL::MultiConfig     multiConfig;
+		N2::CE::INetwork        *pMultiCENetwork;
+		N2::NET::Network        network;
+		N2::CE::INetwork        *pCENetwork;
+		CX::Status              status;
+
+		if ((status = network.Init(INPUTS_COUNT, LAYERS_COUNT, LAYERS)))
+		{
+			NetworkFixture::Fill(&network, 1.0f / 1024.0f);
+			multiConfig.SetPartition(N2::CL::MultiConfig::Partition_Equally, 1);
+			if ((status = NetworkFixture::Open(pProvider, NULL, &network, &pCENetwork)))
+			{
+				if ((status = NetworkFixture::Open(&multiProvider, &multiConfig, &network, &pMultiCENetwork)))
+				{
+					for (CX::Size i = 0; status && i < BATCHES_COUNT; i++)
+					{
+						status = Compare(pCENetwork, dynamic_cast<N2::CL::MultiNetwork *>(pMultiCENetwork), 
+						                 BATCH_SIZES[i]);
+					}
+					if (!status)
+					{
+						CX::Print(stdout, "MultiNetworkTest : {1}\n", status.GetMsg());
+					}
+
+					NetworkFixture::Close(&multiProvider, pMultiCENetwork);
+				}
+				else
+				{
+					CX::Print(stdout, "MultiNetworkTest (multi provider) : {1}\n", status.GetMsg());
+				}
+
+				NetworkFixture::Close(pProvider, pCENetwork);
+			}
+			else
+			{
+				CX::Print(stdout, "MultiNetworkTest (single provider) : {1}\n", status.GetMsg());
+			}
+
+			status = network.Uninit();
+		}
+		else
+		{
+			CX::Print(stdout, "N2::NET::Network::Init : {1}\n", status.GetMsg());
+		}
+	}
+
+private:
+
+	typedef NetworkFixture::ValuesVector   ValuesVector;
+
+	MultiNetworkTest()
+	{
+	}
+
+	~MultiNetworkTest()
+	{
+	}
+
+	static CX::Status Compare(N2::CE::INetwork *pCENetwork, N2::CL::MultiNetwork *pMultiNetwork, CX::UInt32 cCount)
+	{
+		CX::UInt32     cInputs  = pCENetwork->GetNetwork()->GetInputNeurons()->GetNeuronsCount();
+		CX::UInt32     cOutputs = pCENetwork->GetNetwork()->GetOutputNeurons()->GetNeuronsCount();
+		ValuesVector   vectorInputs;
+		ValuesVector   vectorExpected((CX::Size)cCount * cOutputs);
+		ValuesVector   vectorOutputs((CX::Size)cCount * cOutputs, -1.0f);
+		CX::UInt32     cErrors;
+		CX::Status     status;
+
+		NetworkFixture::FillInputs(&vectorInputs, cInputs, cCount);
+		if (!(status = pCENetwork->Evaluate(cCount, &vectorInputs[0], &vectorExpected[0])))
+		{
+			return status;
+		}
+		if (!(status = pMultiNetwork->Evaluate(cCount, &vectorInputs[0], &vectorOutputs[0])))
+		{
+			return status;
+		}
+		cErrors = NetworkFixture::CountErrors(vectorOutputs, vectorExpected, 1e-5f);
+		CX::Print(stdout, "MultiNetworkTest ({1} shards, batch of {2}) : {3} ({4} wrong outputs)\n", 
+		          pMultiNetwork->GetShardsCount(), cCount, 0 == cErrors ? "passed" : "FAILED", cErrors);
+		for (CX::UInt32 i = 0; i < pMultiNetwork->GetShardsCount(); i++)
+		{
+			CX::Print(stdout, "  shard {1} : {2:.0} samples/s\n", i, pMultiNetwork->GetShardThroughput(i));
+		}
+
+		return status;
+	}
+
+};
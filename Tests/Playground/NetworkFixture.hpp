@@ -0,0 +1,307 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+
+#include <string.h>
+#include <math.h>
+#include "CX/Types.hpp"
+#include "CX/Status.hpp"
+#include "CX/Vector.hpp"
+#include "N2/NET/Network.hpp"
+#include "N2/CE/IProvider.hpp"
+#include "CX/C/Platform/Windows/windows.h"
+
+
+//deterministic weights, biases and inputs, the plain reference forward pass, a network comparison, the engine 
+//network setup and a thread runner shared by the playground tests
+class NetworkFixture
+{
+public:
+
+	typedef CX::Vector<CX::Float>::Type   ValuesVector;
+
+	//the weights are multiples of fScale in [-100 * fScale, 100 * fScale) (powers of two keep them exact)
+	static void Fill(N2::NET::Network *pNetwork, CX::Float fScale)
+	{
+		N2::NET::Synapses   *pSynapses;
+		CX::UInt32          cLayer;
+
+		for (pSynapses = pNetwork->GetInputNeurons()->GetNextSynapses(), cLayer = 0; NULL != pSynapses; 
+		     pSynapses = pSynapses->GetNextNeurons()->GetNextSynapses(), cLayer++)
+		{
+			for (CX::UInt32 i = 0; i < pSynapses->GetWeightsCount(); i++)
+			{
+				pSynapses->GetWeights()[i] = (CX::Float)((CX::Int32)((i * 7919 + cLayer * 31) % 200) - 100) * fScale;
+			}
+			for (CX::UInt32 i = 0; i < pSynapses->GetBiasesCount(); i++)
+			{
+				pSynapses->GetBiases()[i] = (CX::Float)((i * 104729 + cLayer * 17) % 100) / 256.0f - 0.1953125f;
+			}
+			pSynapses->MarkAllDirty();
+		}
+	}
+
+	//every sample differs, so a sample written at the wrong offset shows
+	static void FillInputs(ValuesVector *pVectorInputs, CX::UInt32 cInputs, CX::UInt32 cCount)
+	{
+		pVectorInputs->resize((CX::Size)cCount * cInputs);
+		for (CX::Size i = 0; i < pVectorInputs->size(); i++)
+		{
+			(*pVectorInputs)[i] = (CX::Float)((i * 31 + i / cInputs) % 101) / 50.0f - 1.0f;
+		}
+	}
+
+	//plain forward pass of cCount samples, for the activations used by the tests
+	static void Reference(const N2::NET::Network *pNetwork, CX::UInt32 cCount, const CX::Float *inputs, 
+	                      CX::Float *outputs)
+	{
+		CX::UInt32   cInputs  = pNetwork->GetInputNeurons()->GetNeuronsCount();
+		CX::UInt32   cOutputs = pNetwork->GetOutputNeurons()->GetNeuronsCount();
+
+		for (CX::UInt32 i = 0; i < cCount; i++)
+		{
+			ReferenceSample(pNetwork, inputs + (CX::Size)i * cInputs, outputs + (CX::Size)i * cOutputs);
+		}
+	}
+
+	//outputs not within fTolerance (relative above 1)
+	static CX::UInt32 CountErrors(const ValuesVector &vectorOutputs, const ValuesVector &vectorExpected, 
+	                              CX::Float fTolerance)
+	{
+		CX::UInt32   cErrors = 0;
+
+		for (CX::Size i = 0; i < vectorOutputs.size(); i++)
+		{
+			if (!(fabs(vectorOutputs[i] - vectorExpected[i]) <= fTolerance * (1.0f + fabs(vectorExpected[i]))))
+			{
+				cErrors++;
+			}
+		}
+
+		return cErrors;
+	}
+
+	//same topology and same values (a saved and loaded network, for instance)
+	static CX::Bool IsSame(const N2::NET::Network *pNetwork, const N2::NET::Network *pOther)
+	{
+		const N2::NET::Synapses   *pSynapses;
+		const N2::NET::Synapses   *pOtherSynapses;
+		const N2::NET::Neurons    *pNeurons;
+		const N2::NET::Neurons    *pOtherNeurons;
+
+		if (pNetwork->GetLayersCount() != pOther->GetLayersCount() || 
+		    pNetwork->GetInputNeurons()->GetNeuronsCount() != pOther->GetInputNeurons()->GetNeuronsCount())
+		{
+			return CX::False;
+		}
+		for (pSynapses = pNetwork->GetInputNeurons()->GetNextSynapses(), 
+		     pOtherSynapses = pOther->GetInputNeurons()->GetNextSynapses(); 
+		     NULL != pSynapses && NULL != pOtherSynapses; 
+		     pSynapses = pSynapses->GetNextNeurons()->GetNextSynapses(), 
+		     pOtherSynapses = pOtherSynapses->GetNextNeurons()->GetNextSynapses())
+		{
+			pNeurons      = pSynapses->GetNextNeurons();
+			pOtherNeurons = pOtherSynapses->GetNextNeurons();
+			if (pNeurons->GetNeuronsCount() != pOtherNeurons->GetNeuronsCount() || 
+			    pNeurons->GetActivation() != pOtherNeurons->GetActivation() || 
+			    pNeurons->GetActivationArgsCount() != pOtherNeurons->GetActivationArgsCount() || 
+			    0 != memcmp(pNeurons->GetActivationArgs(), pOtherNeurons->GetActivationArgs(), 
+			                sizeof(CX::Float) * pNeurons->GetActivationArgsCount()))
+			{
+				return CX::False;
+			}
+			if (pSynapses->HasBias() != pOtherSynapses->HasBias() || 
+			    pSynapses->GetBias() != pOtherSynapses->GetBias() || 
+			    pSynapses->GetWeightsCount() != pOtherSynapses->GetWeightsCount() || 
+			    pSynapses->GetBiasesCount() != pOtherSynapses->GetBiasesCount() || 
+			    0 != memcmp(pSynapses->GetWeights(), pOtherSynapses->GetWeights(), 
+			                sizeof(CX::Float) * pSynapses->GetWeightsCount()) || 
+			    (0 < pSynapses->GetBiasesCount() && 
+			     0 != memcmp(pSynapses->GetBiases(), pOtherSynapses->GetBiases(), 
+			                 sizeof(CX::Float) * pSynapses->GetBiasesCount())))
+			{
+				return CX::False;
+			}
+		}
+
+		return (NULL == pSynapses && NULL == pOtherSynapses);
+	}
+
+	//inits the provider (with pConfig, which may be NULL) and an engine network for pNetwork
+	static CX::Status Open(N2::CE::IProvider *pProvider, const N2::CE::IConfig *pConfig, N2::NET::Network *pNetwork, 
+	                       N2::CE::INetwork **ppCENetwork)
+	{
+		CX::Status   status;
+
+		if (!(status = pProvider->Init(pConfig)))
+		{
+			return status;
+		}
+		if (NULL == (*ppCENetwork = pProvider->CreateNetwork()))
+		{
+			pProvider->Uninit();
+
+			return CX::Status(CX::Status_MemAllocFailed, "Failed to create the engine network");
+		}
+		if (!(status = (*ppCENetwork)->Init(pNetwork)))
+		{
+			pProvider->DestroyNetwork(*ppCENetwork);
+			*ppCENetwork = NULL;
+			pProvider->Uninit();
+
+			return status;
+		}
+
+		return CX::Status();
+	}
+
+	static void Close(N2::CE::IProvider *pProvider, N2::CE::INetwork *pCENetwork)
+	{
+		pCENetwork->Uninit();
+		pProvider->DestroyNetwork(pCENetwork);
+		pProvider->Uninit();
+	}
+
+	//Open, one Evaluate, Close
+	static CX::Status Evaluate(N2::CE::IProvider *pProvider, const N2::CE::IConfig *pConfig, 
+	                           N2::NET::Network *pNetwork, CX::UInt32 cCount, CX::Float *inputs, CX::Float *outputs)
+	{
+		N2::CE::INetwork   *pCENetwork;
+		CX::Status         status;
+
+		if ((status = Open(pProvider, pConfig, pNetwork, &pCENetwork)))
+		{
+			status = pCENetwork->Evaluate(cCount, inputs, outputs);
+
+			Close(pProvider, pCENetwork);
+		}
+
+		return status;
+	}
+
+	//runs pfnThread on cThreads threads at once, thread i gets (CX::Byte *)pArgs + i * cbArgSize
+	static CX::Status RunThreads(CX::UInt32 cThreads, LPTHREAD_START_ROUTINE pfnThread, void *pArgs, CX::Size cbArgSize)
+	{
+		CX::Vector<HANDLE>::Type   vectorThreads;
+		HANDLE                     hThread;
+		DWORD                      dwID;
+		CX::Status                 status;
+
+		for (CX::UInt32 i = 0; i < cThreads; i++)
+		{
+			if (NULL == (hThread = CreateThread(NULL, 0, pfnThread, (CX::Byte *)pArgs + i * cbArgSize, 0, &dwID)))
+			{
+				status = CX::Status(CX::Status_OperationFailed, "Failed to create thread {1}", i);
+
+				break;
+			}
+			vectorThreads.push_back(hThread);
+		}
+		for (CX::Size i = 0; i < vectorThreads.size(); i++)
+		{
+			WaitForSingleObject(vectorThreads[i], INFINITE);
+			CloseHandle(vectorThreads[i]);
+		}
+
+		return status;
+	}
+
+private:
+
+	NetworkFixture()
+	{
+	}
+
+	~NetworkFixture()
+	{
+	}
+
+	static void ReferenceSample(const N2::NET::Network *pNetwork, const CX::Float *inputs, CX::Float *outputs)
+	{
+		const N2::NET::Synapses   *pSynapses;
+		const N2::NET::Neurons    *pNeurons;
+		const CX::Float           *args;
+		ValuesVector              vectorPrev(inputs, inputs + pNetwork->GetInputNeurons()->GetNeuronsCount());
+		ValuesVector              vectorNext;
+		CX::Float                 fExpSum;
+
+		for (pSynapses = pNetwork->GetInputNeurons()->GetNextSynapses(); NULL != pSynapses; 
+		     pSynapses = pNeurons->GetNextSynapses())
+		{
+			pNeurons = pSynapses->GetNextNeurons();
+			args     = pNeurons->GetActivationArgs();
+			vectorNext.assign(pNeurons->GetNeuronsCount(), 0.0f);
+			fExpSum = 0.0f;
+			for (CX::Size i = 0; i < vectorNext.size(); i++)
+			{
+				for (CX::Size k = 0; k < vectorPrev.size(); k++)
+				{
+					vectorNext[i] += vectorPrev[k] * pSynapses->GetWeights()[k * vectorNext.size() + i];
+				}
+				if (pSynapses->HasBias())
+				{
+					vectorNext[i] += pSynapses->GetBias() * pSynapses->GetBiases()[i];
+				}
+				switch (pNeurons->GetActivation())
+				{
+					case N2::NET::Activation::Sigmoid : 
+						vectorNext[i] = 1.0f / (1.0f + exp(-vectorNext[i]));
+					break;
+					case N2::NET::Activation::TanH : 
+						vectorNext[i] = tanh(vectorNext[i]);
+					break;
+					case N2::NET::Activation::RELU : 
+						vectorNext[i] = (0.0f > vectorNext[i]) ? 0.0f : vectorNext[i];
+					break;
+					case N2::NET::Activation::SELU : 
+						vectorNext[i] = (0.0f > vectorNext[i]) ? args[1] * args[0] * (exp(vectorNext[i]) - 1.0f) : 
+						                                         args[1] * vectorNext[i];
+					break;
+					case N2::NET::Activation::ELU : 
+						vectorNext[i] = (0.0f > vectorNext[i]) ? args[0] * (exp(vectorNext[i]) - 1.0f) : vectorNext[i];
+					break;
+					case N2::NET::Activation::SoftMax : 
+						fExpSum += exp(vectorNext[i]);
+					break;
+				}
+			}
+			if (N2::NET::Activation::SoftMax == pNeurons->GetActivation())
+			{
+				for (CX::Size i = 0; i < vectorNext.size(); i++)
+				{
+					vectorNext[i] = exp(vectorNext[i]) / fExpSum;
+				}
+			}
+			vectorPrev.swap(vectorNext);
+		}
+		memcpy(outputs, &vectorPrev[0], sizeof(CX::Float) * vectorPrev.size());
+	}
+
+};
@@ -0,0 +1,272 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+
+#include <stdio.h>
+#include <string.h>
+#include "CX/Types.hpp"
+#include "CX/Status.hpp"
+#include "CX/Print.hpp"
+#include "CX/Vector.hpp"
+#include "N2/NET/Network.hpp"
+#include "N2/NET/ModelFormat.hpp"
+#include "N2/NET/ParallelCopy.hpp"
+#include "N2/NET/CRC32C.hpp"
+#include "N2/CE/IProvider.hpp"
+#include "NetworkFixture.hpp"
+
+
+//ParallelCopy must copy arrays of several chunks (and odd sizes) exactly and combine the chunk checksums into the one
+//of the whole array; a model with a layer larger than a chunk, loaded and mapped on several threads, must match the one
+//loaded on a single thread and the saved network, a byte flipped inside that layer must be caught by the combined
+//checksums and the engine outputs of the parallel load must match the plain reference of the saved network
+class ParallelLoadTest
+{
+public:
+
+	static void Run(N2::CE::IProvider *pProvider)
+	{
+		//the first layer weights take more than one chunk
+		static const CX::UInt32       INPUTS_COUNT = 1100;
+		static const N2::NET::Layer   LAYERS[]     =
+		{
+			{ 1024, N2::NET::Activation::TanH, 0, { 0.0f }, CX::True, 1.0f },
+			{   16, N2::NET::Activation::Sigmoid, 0, { 0.0f }, CX::True, 1.0f }
+		};
+		static const CX::Size         LAYERS_COUNT     = sizeof(LAYERS) / sizeof(LAYERS[0]);
+		static const CX::Char         MODEL_PATH[]     = "ParallelLoadTest.n2m";
+		static const CX::Char         CORRUPTED_PATH[] = "ParallelLoadTest.corrupted.n2m";
+
+		N2::NET::Network   network;
+		CX::Status         status;
+
+		CheckCopy();
+		if ((status = network.Init(INPUTS_COUNT, LAYERS_COUNT, LAYERS)))
+		{
+			NetworkFixture::Fill(&network, 1.0f / 65536.0f);
+			if ((status = N2::NET::ModelFormat::Save(&network, MODEL_PATH)))
+			{
+				CheckLoad(pProvider, &network, MODEL_PATH);
+				CheckCorrupted(MODEL_PATH, CORRUPTED_PATH);
+				remove(MODEL_PATH);
+			}
+			else
+			{
+				CX::Print(stdout, "N2::NET::ModelFormat::Save : {1}\n", status.GetMsg());
+			}
+
+			status = network.Uninit();
+		}
+		else
+		{
+			CX::Print(stdout, "N2::NET::Network::Init : {1}\n", status.GetMsg());
+		}
+	}
+
+private:
+
+	typedef NetworkFixture::ValuesVector   ValuesVector;
+
+	static const CX::UInt32   THREADS_COUNT = 4;
+	static const CX::UInt32   SAMPLES_COUNT = 3;
+
+	ParallelLoadTest()
+	{
+	}
+
+	~ParallelLoadTest()
+	{
+	}
+
+	//a copy of several chunks with a short last one, a tiny copy, a copy of exactly one chunk and a checksum only
+	static void CheckCopy()
+	{
+		static const CX::Size   SIZES[] =
+		{
+			2 * N2::NET::ParallelCopy::CHUNK_SIZE + 13, 5, N2::NET::ParallelCopy::CHUNK_SIZE,
+			N2::NET::ParallelCopy::CHUNK_SIZE + 7
+		};
+		static const CX::Size   TASKS_COUNT = sizeof(SIZES) / sizeof(SIZES[0]);
+
+		CX::Vector<CX::Byte>::Type            vectorSources[TASKS_COUNT];
+		CX::Vector<CX::Byte>::Type            vectorDests[TASKS_COUNT];
+		N2::NET::ParallelCopy::TasksVector    vectorTasks;
+		N2::NET::ParallelCopy::Task           task;
+		CX::UInt32                            cWrongCopies;
+		CX::UInt32                            cWrongChecksums;
+		CX::Status                            status;
+
+		for (CX::Size i = 0; i < TASKS_COUNT; i++)
+		{
+			vectorSources[i].resize(SIZES[i]);
+			for (CX::Size k = 0; k < SIZES[i]; k++)
+			{
+				vectorSources[i][k] = (CX::Byte)((k * 131 + k / 4099 + i * 7) & 0xFF);
+			}
+			//the last task only checksums
+			if (i + 1 < TASKS_COUNT)
+			{
+				vectorDests[i].assign(SIZES[i], 0);
+			}
+			task.pDest     = vectorDests[i].empty() ? NULL : &vectorDests[i][0];
+			task.pSource   = &vectorSources[i][0];
+			task.cbSize    = SIZES[i];
+			task.bChecksum = CX::True;
+			task.nChecksum = 0;
+			vectorTasks.push_back(task);
+		}
+		if (!(status = N2::NET::ParallelCopy::Run(&vectorTasks, THREADS_COUNT)))
+		{
+			CX::Print(stdout, "ParallelLoadTest (copy) : {1}\n", status.GetMsg());
+
+			return;
+		}
+		cWrongCopies    = 0;
+		cWrongChecksums = 0;
+		for (CX::Size i = 0; i < TASKS_COUNT; i++)
+		{
+			if (!vectorDests[i].empty() && 0 != memcmp(&vectorDests[i][0], &vectorSources[i][0], SIZES[i]))
+			{
+				cWrongCopies++;
+			}
+			if (vectorTasks[i].nChecksum != N2::NET::CRC32C::Compute(&vectorSources[i][0], SIZES[i]))
+			{
+				cWrongChecksums++;
+			}
+		}
+		CX::Print(stdout, "ParallelLoadTest (copy) : {1} ({2} tasks on {3} threads, {4} wrong copies, {5} wrong "
+		          "checksums)\n", 0 == cWrongCopies && 0 == cWrongChecksums ? "passed" : "FAILED", TASKS_COUNT,
+		          THREADS_COUNT, cWrongCopies, cWrongChecksums);
+	}
+
+	static void CheckLoad(N2::CE::IProvider *pProvider, const N2::NET::Network *pNetwork, const CX::Char *szPath)
+	{
+		N2::NET::Network   sequential;
+		N2::NET::Network   parallel;
+		N2::NET::Network   mapped;
+		CX::UInt32         cInputs  = pNetwork->GetInputNeurons()->GetNeuronsCount();
+		CX::UInt32         cOutputs = pNetwork->GetOutputNeurons()->GetNeuronsCount();
+		ValuesVector       vectorInputs;
+		ValuesVector       vectorOutputs(SAMPLES_COUNT * cOutputs, -1.0f);
+		ValuesVector       vectorExpected(SAMPLES_COUNT * cOutputs);
+		CX::Bool           bSequentialSame;
+		CX::Bool           bParallelSame;
+		CX::Bool           bMappedSame;
+		CX::UInt32         cErrors;
+		CX::Status         status;
+
+		for (;;)
+		{
+			if (!(status = N2::NET::ModelFormat::Load(&sequential, szPath, 1)))
+			{
+				break;
+			}
+			if (!(status = N2::NET::ModelFormat::Load(&parallel, szPath, THREADS_COUNT)))
+			{
+				break;
+			}
+			if (!(status = N2::NET::ModelFormat::Map(&mapped, szPath, CX::True, THREADS_COUNT)))
+			{
+				break;
+			}
+			bSequentialSame = NetworkFixture::IsSame(pNetwork, &sequential);
+			bParallelSame   = NetworkFixture::IsSame(&sequential, &parallel);
+			bMappedSame     = NetworkFixture::IsSame(&sequential, &mapped);
+			CX::Print(stdout, "ParallelLoadTest (load) : {1} (1 thread {2}, {3} threads {4}, verified map {5})\n",
+			          bSequentialSame && bParallelSame && bMappedSame ? "passed" : "FAILED",
+			          bSequentialSame ? "matches" : "differs", THREADS_COUNT, bParallelSame ? "match" : "differ",
+			          bMappedSame ? "matches" : "differs");
+			//the engines copy the layers on several threads too
+			NetworkFixture::FillInputs(&vectorInputs, cInputs, SAMPLES_COUNT);
+			NetworkFixture::Reference(pNetwork, SAMPLES_COUNT, &vectorInputs[0], &vectorExpected[0]);
+			if (!(status = NetworkFixture::Evaluate(pProvider, NULL, &parallel, SAMPLES_COUNT, &vectorInputs[0],
+			                                        &vectorOutputs[0])))
+			{
+				break;
+			}
+			cErrors = NetworkFixture::CountErrors(vectorOutputs, vectorExpected, 1e-5f);
+			CX::Print(stdout, "ParallelLoadTest (evaluate) : {1} ({2} wrong outputs)\n",
+			          0 == cErrors ? "passed" : "FAILED", cErrors);
+
+			break;
+		}
+		if (!status)
+		{
+			CX::Print(stdout, "ParallelLoadTest (load) : {1}\n", status.GetMsg());
+		}
+		mapped.Uninit();
+		parallel.Uninit();
+		sequential.Uninit();
+	}
+
+	//the byte in the middle of the file is a weight of the first layer, inside one of its chunks
+	static void CheckCorrupted(const CX::Char *szPath, const CX::Char *szCorruptedPath)
+	{
+		N2::NET::Network             network;
+		FILE                         *pFile;
+		CX::Vector<CX::Byte>::Type   vectorData;
+		long                         cbSize;
+		CX::Bool                     bLoadRejected;
+		CX::Bool                     bMapRejected;
+
+		if (NULL == (pFile = fopen(szPath, "rb")))
+		{
+			CX::Print(stdout, "ParallelLoadTest (checksum) : failed to open {1}\n", szPath);
+
+			return;
+		}
+		fseek(pFile, 0, SEEK_END);
+		cbSize = ftell(pFile);
+		fseek(pFile, 0, SEEK_SET);
+		vectorData.resize(cbSize);
+		fread(&vectorData[0], 1, cbSize, pFile);
+		fclose(pFile);
+		vectorData[cbSize / 2] ^= 0x01;
+		if (NULL == (pFile = fopen(szCorruptedPath, "wb")))
+		{
+			CX::Print(stdout, "ParallelLoadTest (checksum) : failed to create {1}\n", szCorruptedPath);
+
+			return;
+		}
+		fwrite(&vectorData[0], 1, cbSize, pFile);
+		fclose(pFile);
+
+		bLoadRejected = !N2::NET::ModelFormat::Load(&network, szCorruptedPath, THREADS_COUNT);
+		network.Uninit();
+		bMapRejected = !N2::NET::ModelFormat::Map(&network, szCorruptedPath, CX::True, THREADS_COUNT);
+		network.Uninit();
+		remove(szCorruptedPath);
+
+		CX::Print(stdout, "ParallelLoadTest (checksum) : {1} (load {2}, map {3})\n",
+		          bLoadRejected && bMapRejected ? "passed" : "FAILED",
+		          bLoadRejected ? "rejected" : "accepted", bMapRejected ? "rejected" : "accepted");
+	}
+
+};
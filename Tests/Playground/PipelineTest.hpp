@@ -0,0 +1,184 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+
+#include "CX/Types.hpp"
+#include "CX/Status.hpp"
+#include "CX/Print.hpp"
+#include "N2/NET/Network.hpp"
+#include "N2/SWMT/Provider.hpp"
+#include "N2/SWMT/Config.hpp"
+#include "N2/SWMT/Network.hpp"
+#include "N2/SWMT/Pipeline.hpp"
+#include "NetworkFixture.hpp"
+
+
+//several batches are submitted to a pipeline (one stage per layer) and waited for at once: the outputs must match a 
+//plain Evaluate of the same samples; the batch sizes are not multiples of the micro-batch sizes and the small queue 
+//depths keep the stages blocked on each other
+class PipelineTest
+{
+public:
+
+	static void Run(N2::CE::IProvider *pProvider)
+	{
+		static const CX::UInt32       INPUTS_COUNT   = 37;
+		static const N2::NET::Layer   LAYERS[]       = 
+		{
+			{ 64, N2::NET::Activation::TanH, 0, { 0.0f }, CX::True, 1.0f },
+			{ 48, N2::NET::Activation::RELU, 0, { 0.0f }, CX::False, 0.0f },
+			{ 32, N2::NET::Activation::Sigmoid, 0, { 0.0f }, CX::True, 1.0f },
+			{ 16, N2::NET::Activation::Identity, 0, { 0.0f }, CX::True, 1.0f },
+			{  9, N2::NET::Activation::Sigmoid, 0, { 0.0f }, CX::False, 0.0f }
+		};
+		static const CX::Size         LAYERS_COUNT   = sizeof(LAYERS) / sizeof(LAYERS[0]);
+
+		N2::SWMT::Provider   *pSWMTProvider = dynamic_cast<N2::SWMT::Provider *>(pProvider);
+		N2::CE::IConfig      *pConfig;
+		N2::NET::Network     network;
+		N2::CE::INetwork     *pCENetwork;
+		CX::Status           status;
+
+		if (NULL == pSWMTProvider)
+		{
+			CX::Print(stdout, "PipelineTest : the pipeline is SWMT only\n");
+
+			return;
+		}
+		if (NULL == (pConfig = pProvider->CreateConfig()))
+		{
+			CX::Print(stdout, "PipelineTest : failed to create the config\n");
+
+			return;
+		}
+		//a stage per layer and one thread left in the shared pool
+		dynamic_cast<N2::SWMT::Config *>(pConfig)->SetThreadsCount((CX::UInt32)LAYERS_COUNT + 1);
+		if ((status = network.Init(INPUTS_COUNT, LAYERS_COUNT, LAYERS)))
+		{
+			NetworkFixture::Fill(&network, 1.0f / 1024.0f);
+			if ((status = NetworkFixture::Open(pProvider, pConfig, &network, &pCENetwork)))
+			{
+				if ((status = Check(dynamic_cast<N2::SWMT::Network *>(pCENetwork), 1, 1)))
+				{
+					if ((status = Check(dynamic_cast<N2::SWMT::Network *>(pCENetwork), 5, 2)))
+					{
+						status = Check(dynamic_cast<N2::SWMT::Network *>(pCENetwork), 16, 4);
+					}
+				}
+				if (!status)
+				{
+					CX::Print(stdout, "PipelineTest : {1}\n", status.GetMsg());
+				}
+
+				NetworkFixture::Close(pProvider, pCENetwork);
+			}
+			else
+			{
+				CX::Print(stdout, "PipelineTest : {1}\n", status.GetMsg());
+			}
+
+			status = network.Uninit();
+		}
+		else
+		{
+			CX::Print(stdout, "N2::NET::Network::Init : {1}\n", status.GetMsg());
+		}
+		pProvider->DestroyConfig(pConfig);
+	}
+
+private:
+
+	typedef NetworkFixture::ValuesVector   ValuesVector;
+
+	PipelineTest()
+	{
+	}
+
+	~PipelineTest()
+	{
+	}
+
+	static CX::Status Check(N2::SWMT::Network *pNetwork, CX::UInt32 cMicroBatchSize, CX::UInt32 cQueueDepth)
+	{
+		static const CX::UInt32   BATCH_SIZES[] = { 1, 37, 203, 2 };
+		static const CX::Size     BATCHES_COUNT = sizeof(BATCH_SIZES) / sizeof(BATCH_SIZES[0]);
+
+		N2::SWMT::Pipeline   pipeline;
+		CX::UInt32           cInputs  = pNetwork->GetNetwork()->GetInputNeurons()->GetNeuronsCount();
+		CX::UInt32           cOutputs = pNetwork->GetNetwork()->GetOutputNeurons()->GetNeuronsCount();
+		CX::UInt32           cCount;
+		CX::UInt32           cOffset;
+		ValuesVector         vectorInputs;
+		ValuesVector         vectorExpected;
+		ValuesVector         vectorOutputs;
+		CX::UInt32           cErrors;
+		CX::Status           status;
+
+		cCount = 0;
+		for (CX::Size i = 0; i < BATCHES_COUNT; i++)
+		{
+			cCount += BATCH_SIZES[i];
+		}
+		NetworkFixture::FillInputs(&vectorInputs, cInputs, cCount);
+		vectorExpected.resize((CX::Size)cCount * cOutputs);
+		vectorOutputs.assign((CX::Size)cCount * cOutputs, -1.0f);
+		//the network is not evaluated directly while the pipeline is initialized
+		if (!(status = pNetwork->Evaluate(cCount, &vectorInputs[0], &vectorExpected[0])))
+		{
+			return status;
+		}
+		if (!(status = pipeline.Init(pNetwork, 0, cMicroBatchSize, cQueueDepth)))
+		{
+			return status;
+		}
+		cOffset = 0;
+		for (CX::Size i = 0; status && i < BATCHES_COUNT; i++)
+		{
+			status = pipeline.Submit(BATCH_SIZES[i], &vectorInputs[(CX::Size)cOffset * cInputs], 
+			                         &vectorOutputs[(CX::Size)cOffset * cOutputs]);
+			cOffset += BATCH_SIZES[i];
+		}
+		if (status)
+		{
+			status = pipeline.Wait();
+		}
+		if (status)
+		{
+			cErrors = NetworkFixture::CountErrors(vectorOutputs, vectorExpected, 1e-5f);
+			CX::Print(stdout, "PipelineTest ({1} stages, micro-batches of {2}, queue depth {3}) : {4} ({5} wrong "
+			          "outputs)\n", pipeline.GetStagesCount(), cMicroBatchSize, cQueueDepth, 
+			          0 == cErrors ? "passed" : "FAILED", cErrors);
+		}
+		pipeline.Uninit();
+
+		return status;
+	}
+
+};
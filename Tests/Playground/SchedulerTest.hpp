@@ -0,0 +1,263 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+
+#include "CX/Types.hpp"
+#include "CX/Status.hpp"
+#include "CX/Print.hpp"
+#include "N2/NET/Network.hpp"
+#include "N2/CL/OpenCL.hpp"
+#include "N2/CL/Provider.hpp"
+#include "N2/CL/Config.hpp"
+#include "N2/CL/Network.hpp"
+#include "N2/CL/Scheduler.hpp"
+#include "NetworkFixture.hpp"
+
+
+//several networks share the queues of one CL provider, each keeps more batches pending (EvaluateAsync) from its own
+//thread than its in flight cap and all of them have more batches in flight than the queues admit, so both the network
+//slots and the scheduler admission block; with in-order queues, a single out-of-order queue and a single in-order
+//queue, every output must match the plain reference of its network and no batch may stay admitted once all the
+//events completed
+class SchedulerTest
+{
+public:
+
+	static void Run(N2::CE::IProvider *pProvider)
+	{
+		//NETWORKS_COUNT * cMaxInFlight is above cQueues * Scheduler::QUEUE_DEPTH (an out-of-order queue counts as one)
+		static const Setup   SETUPS[] =
+		{
+			{ 2, 3, "two in-order queues" },
+			{ 0, 3, "out-of-order queue" },
+			{ 1, 2, "one in-order queue" }
+		};
+
+		if (NULL == dynamic_cast<N2::CL::Provider *>(pProvider))
+		{
+			CX::Print(stdout, "SchedulerTest : the shared queues are CL only\n");
+
+			return;
+		}
+		for (CX::Size i = 0; i < sizeof(SETUPS) / sizeof(SETUPS[0]); i++)
+		{
+			Check(dynamic_cast<N2::CL::Provider *>(pProvider), &SETUPS[i]);
+		}
+	}
+
+private:
+
+	typedef NetworkFixture::ValuesVector   ValuesVector;
+
+	static const CX::UInt32   NETWORKS_COUNT = 4;
+	static const CX::UInt32   ROUNDS_COUNT   = 24;
+	//batches pending per network, above the in flight caps
+	static const CX::UInt32   PENDING_COUNT  = 4;
+	//above the largest tile size
+	static const CX::UInt32   MAX_BATCH_SIZE = 40;
+
+	struct Setup
+	{
+		CX::UInt32       cQueues;
+		CX::UInt32       cMaxInFlight;
+		const CX::Char   *szName;
+	};
+
+	struct Caller
+	{
+		N2::NET::Network   network;
+		N2::CL::Network    *pCENetwork;
+		ValuesVector       vectorInputs;
+		ValuesVector       vectorExpected;
+		CX::UInt32         cErrors;
+		CX::Status         status;
+
+		Caller()
+		{
+			pCENetwork = NULL;
+			cErrors    = 0;
+		}
+	};
+
+	SchedulerTest()
+	{
+	}
+
+	~SchedulerTest()
+	{
+	}
+
+	static void Check(N2::CL::Provider *pProvider, const Setup *pSetup)
+	{
+		N2::CE::IConfig   *pConfig;
+		Caller            callers[NETWORKS_COUNT];
+		CX::UInt32        cOpened;
+		CX::UInt32        cErrors;
+		CX::UInt32        cAdmitted;
+		CX::Status        status;
+
+		if (NULL == (pConfig = pProvider->CreateConfig()))
+		{
+			CX::Print(stdout, "SchedulerTest ({1}) : failed to create the config\n", pSetup->szName);
+
+			return;
+		}
+		dynamic_cast<N2::CL::Config *>(pConfig)->SetQueuesCount(pSetup->cQueues);
+		dynamic_cast<N2::CL::Config *>(pConfig)->SetMaxInFlight(pSetup->cMaxInFlight);
+		if ((status = pProvider->Init(pConfig)))
+		{
+			for (cOpened = 0; status && cOpened < NETWORKS_COUNT; cOpened++)
+			{
+				status = Open(pProvider, cOpened, &callers[cOpened]);
+			}
+			if (status)
+			{
+				status = NetworkFixture::RunThreads(NETWORKS_COUNT, &SchedulerTest::CallerThread, callers,
+				                                    sizeof(Caller));
+			}
+			cErrors = 0;
+			for (CX::UInt32 i = 0; i < cOpened; i++)
+			{
+				if (status && !callers[i].status)
+				{
+					status = callers[i].status;
+				}
+				cErrors += callers[i].cErrors;
+			}
+			//the admission slots are released by the completion callbacks, which may run a little after the waits
+			for (CX::UInt32 i = 0; i < 1000 && 0 < (cAdmitted = pProvider->GetScheduler()->GetInFlightCount()); i++)
+			{
+				Sleep(1);
+			}
+			for (CX::UInt32 i = 0; i < cOpened; i++)
+			{
+				if (NULL != callers[i].pCENetwork)
+				{
+					callers[i].pCENetwork->Uninit();
+					pProvider->DestroyNetwork(callers[i].pCENetwork);
+				}
+				callers[i].network.Uninit();
+			}
+			if (status)
+			{
+				CX::Print(stdout, "SchedulerTest ({1}) : {2} ({3} wrong outputs, {4} batches still admitted)\n",
+				          pSetup->szName, 0 == cErrors && 0 == cAdmitted ? "passed" : "FAILED", cErrors, cAdmitted);
+			}
+			else
+			{
+				CX::Print(stdout, "SchedulerTest ({1}) : {2}\n", pSetup->szName, status.GetMsg());
+			}
+
+			pProvider->Uninit();
+		}
+		else
+		{
+			CX::Print(stdout, "N2::CE::IProvider::Init : {1}\n", status.GetMsg());
+		}
+		pProvider->DestroyConfig(pConfig);
+	}
+
+	//the networks differ in size so their batches take different times
+	static CX::Status Open(N2::CL::Provider *pProvider, CX::UInt32 cIndex, Caller *pCaller)
+	{
+		N2::NET::Layer   layers[] =
+		{
+			{ 32 + cIndex * 16, N2::NET::Activation::TanH, 0, { 0.0f }, CX::True, 1.0f },
+			{ 3 + cIndex * 2, N2::NET::Activation::Sigmoid, 0, { 0.0f }, CX::True, 1.0f }
+		};
+		CX::UInt32       cInputs = 13 + cIndex * 5;
+		CX::Status       status;
+
+		if (!(status = pCaller->network.Init(cInputs, sizeof(layers) / sizeof(layers[0]), layers)))
+		{
+			return status;
+		}
+		NetworkFixture::Fill(&pCaller->network, 1.0f / 1024.0f);
+		NetworkFixture::FillInputs(&pCaller->vectorInputs, cInputs, MAX_BATCH_SIZE);
+		pCaller->vectorExpected.resize((CX::Size)MAX_BATCH_SIZE * layers[1].cNeuronsCount);
+		NetworkFixture::Reference(&pCaller->network, MAX_BATCH_SIZE, &pCaller->vectorInputs[0],
+		                          &pCaller->vectorExpected[0]);
+		if (NULL == (pCaller->pCENetwork = dynamic_cast<N2::CL::Network *>(pProvider->CreateNetwork())))
+		{
+			return CX::Status(CX::Status_MemAllocFailed, "Failed to create the engine network");
+		}
+
+		return pCaller->pCENetwork->Init(&pCaller->network);
+	}
+
+	//batch i goes to pending entry i % PENDING_COUNT, whose previous batch is waited for and checked first; a batch of
+	//cCount checks the first cCount references
+	static DWORD WINAPI CallerThread(void *pArg)
+	{
+		static const CX::UInt32   BATCH_SIZES[] = { 1, 9, MAX_BATCH_SIZE };
+
+		Caller         *pCaller = (Caller *)pArg;
+		CX::UInt32     cOutputs = pCaller->network.GetOutputNeurons()->GetNeuronsCount();
+		cl::Event      events[PENDING_COUNT];
+		CX::UInt32     counts[PENDING_COUNT];
+		ValuesVector   vectorOutputs[PENDING_COUNT];
+		ValuesVector   vectorExpected;
+		CX::UInt32     cEntry;
+
+		for (CX::UInt32 i = 0; i < ROUNDS_COUNT + PENDING_COUNT; i++)
+		{
+			cEntry = i % PENDING_COUNT;
+			if (NULL != events[cEntry]())
+			{
+				if (CL_SUCCESS != events[cEntry].wait())
+				{
+					if (pCaller->status)
+					{
+						pCaller->status = CX::Status(CX::Status_OperationFailed, "Failed to evaluate batch");
+					}
+				}
+				else
+				{
+					vectorExpected.assign(pCaller->vectorExpected.begin(),
+					                      pCaller->vectorExpected.begin() + (CX::Size)counts[cEntry] * cOutputs);
+					pCaller->cErrors += NetworkFixture::CountErrors(vectorOutputs[cEntry], vectorExpected, 1e-4f);
+				}
+				events[cEntry] = cl::Event();
+			}
+			//the last rounds only drain the pending batches
+			if (!pCaller->status || ROUNDS_COUNT <= i)
+			{
+				continue;
+			}
+			counts[cEntry] = BATCH_SIZES[i % 3];
+			vectorOutputs[cEntry].assign((CX::Size)counts[cEntry] * cOutputs, -1.0f);
+			pCaller->status = pCaller->pCENetwork->EvaluateAsync(counts[cEntry], &pCaller->vectorInputs[0],
+			                                                     &vectorOutputs[cEntry][0], &events[cEntry]);
+		}
+
+		return 0;
+	}
+
+};
@@ -0,0 +1,190 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+
+#include <stdio.h>
+#include "CX/Types.hpp"
+#include "CX/Status.hpp"
+#include "CX/Print.hpp"
+#include "N2/NET/Network.hpp"
+#include "N2/NET/ModelFormat.hpp"
+#include "N2/SWST/Provider.hpp"
+#include "N2/SWST/Config.hpp"
+#include "NetworkFixture.hpp"
+
+
+//a network is saved in the v2 format and mapped back, then evaluated by SWST with streamed weights (each layer over
+//the whole batch, in place in the mapping): the outputs must match the plain reference of the saved network for a
+//single sample and for batches, activations with args and per sample ones included; the streamed engine network must
+//not hold a copy of the weights (it is smaller than the one of a copying engine)
+class StreamedWeightsTest
+{
+public:
+
+	static void Run(N2::CE::IProvider *pProvider)
+	{
+		static const CX::UInt32       INPUTS_COUNT = 31;
+		static const N2::NET::Layer   LAYERS[]     =
+		{
+			{ 48, N2::NET::Activation::TanH, 0, { 0.0f }, CX::True, 1.0f },
+			{ 40, N2::NET::Activation::RELU, 0, { 0.0f }, CX::False, 0.0f },
+			{ 24, N2::NET::Activation::SELU, 2, { 1.67326324f, 1.05070098f }, CX::True, 1.0f },
+			{  5, N2::NET::Activation::SoftMax, 0, { 0.0f }, CX::True, 1.0f }
+		};
+		static const CX::Size         LAYERS_COUNT = sizeof(LAYERS) / sizeof(LAYERS[0]);
+		static const CX::Char         MODEL_PATH[] = "StreamedWeightsTest.n2m";
+
+		N2::NET::Network   network;
+		N2::NET::Network   mapped;
+		CX::Status         status;
+
+		if (NULL == dynamic_cast<N2::SWST::Provider *>(pProvider))
+		{
+			CX::Print(stdout, "StreamedWeightsTest : streamed weights are SWST only\n");
+
+			return;
+		}
+		if ((status = network.Init(INPUTS_COUNT, LAYERS_COUNT, LAYERS)))
+		{
+			NetworkFixture::Fill(&network, 1.0f / 512.0f);
+			for (;;)
+			{
+				if (!(status = N2::NET::ModelFormat::Save(&network, MODEL_PATH)))
+				{
+					break;
+				}
+				if (!(status = N2::NET::ModelFormat::Map(&mapped, MODEL_PATH)))
+				{
+					break;
+				}
+				Check(pProvider, &network, &mapped);
+
+				break;
+			}
+			if (!status)
+			{
+				CX::Print(stdout, "StreamedWeightsTest : {1}\n", status.GetMsg());
+			}
+			mapped.Uninit();
+			remove(MODEL_PATH);
+
+			status = network.Uninit();
+		}
+		else
+		{
+			CX::Print(stdout, "N2::NET::Network::Init : {1}\n", status.GetMsg());
+		}
+	}
+
+private:
+
+	typedef NetworkFixture::ValuesVector   ValuesVector;
+
+	static const CX::UInt32   MAX_BATCH_SIZE = 67;
+
+	StreamedWeightsTest()
+	{
+	}
+
+	~StreamedWeightsTest()
+	{
+	}
+
+	//inits the provider with streamed (bStream) or copied weights and an engine network for pMapped
+	static CX::Status Open(N2::CE::IProvider *pProvider, CX::Bool bStream, N2::NET::Network *pMapped,
+	                       N2::CE::INetwork **ppCENetwork)
+	{
+		N2::CE::IConfig   *pConfig;
+		CX::Status        status;
+
+		if (NULL == (pConfig = pProvider->CreateConfig()))
+		{
+			return CX::Status(CX::Status_MemAllocFailed, "Failed to create the config");
+		}
+		dynamic_cast<N2::SWST::Config *>(pConfig)->SetStreamWeights(bStream);
+		status = NetworkFixture::Open(pProvider, pConfig, pMapped, ppCENetwork);
+		pProvider->DestroyConfig(pConfig);
+
+		return status;
+	}
+
+	static void Check(N2::CE::IProvider *pProvider, const N2::NET::Network *pNetwork, N2::NET::Network *pMapped)
+	{
+		static const CX::UInt32   BATCH_SIZES[] = { 1, 7, MAX_BATCH_SIZE };
+
+		N2::CE::INetwork   *pCENetwork;
+		CX::UInt32         cInputs  = pNetwork->GetInputNeurons()->GetNeuronsCount();
+		CX::UInt32         cOutputs = pNetwork->GetOutputNeurons()->GetNeuronsCount();
+		ValuesVector       vectorInputs;
+		ValuesVector       vectorOutputs;
+		ValuesVector       vectorExpected;
+		CX::UInt32         cErrors;
+		CX::Size           cbStreamedSize;
+		CX::Size           cbCopiedSize;
+		CX::Status         status;
+
+		NetworkFixture::FillInputs(&vectorInputs, cInputs, MAX_BATCH_SIZE);
+		if (!(status = Open(pProvider, CX::True, pMapped, &pCENetwork)))
+		{
+			CX::Print(stdout, "StreamedWeightsTest : {1}\n", status.GetMsg());
+
+			return;
+		}
+		cbStreamedSize = pCENetwork->GetMemSize();
+		for (CX::Size i = 0; status && i < sizeof(BATCH_SIZES) / sizeof(BATCH_SIZES[0]); i++)
+		{
+			vectorOutputs.assign((CX::Size)BATCH_SIZES[i] * cOutputs, -1.0f);
+			vectorExpected.resize(vectorOutputs.size());
+			NetworkFixture::Reference(pNetwork, BATCH_SIZES[i], &vectorInputs[0], &vectorExpected[0]);
+			if ((status = pCENetwork->Evaluate(BATCH_SIZES[i], &vectorInputs[0], &vectorOutputs[0])))
+			{
+				cErrors = NetworkFixture::CountErrors(vectorOutputs, vectorExpected, 1e-5f);
+				CX::Print(stdout, "StreamedWeightsTest (batch of {1}) : {2} ({3} wrong outputs)\n", BATCH_SIZES[i],
+				          0 == cErrors ? "passed" : "FAILED", cErrors);
+			}
+		}
+		NetworkFixture::Close(pProvider, pCENetwork);
+		if (status)
+		{
+			if ((status = Open(pProvider, CX::False, pMapped, &pCENetwork)))
+			{
+				cbCopiedSize = pCENetwork->GetMemSize();
+				NetworkFixture::Close(pProvider, pCENetwork);
+				CX::Print(stdout, "StreamedWeightsTest (memory) : {1} (streamed {2} bytes, copied {3} bytes)\n",
+				          cbStreamedSize < cbCopiedSize ? "passed" : "FAILED", cbStreamedSize, cbCopiedSize);
+			}
+		}
+		if (!status)
+		{
+			CX::Print(stdout, "StreamedWeightsTest : {1}\n", status.GetMsg());
+		}
+	}
+
+};
@@ -0,0 +1,164 @@
+/* 
+ * N2
+ *
+ * https://github.com/draede/n2
+ * 
+ * Copyright (C) 2018 draede
+ *
+ * Released under the MIT License.
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+
+#include "CX/Types.hpp"
+#include "CX/Status.hpp"
+#include "CX/Print.hpp"
+#include "CX/Util/Timer.hpp"
+#include "N2/NET/Network.hpp"
+#include "N2/CL/Provider.hpp"
+#include "N2/CL/Config.hpp"
+#include "NetworkFixture.hpp"
+
+
+//the same batch is evaluated with the per-layer Compute kernels and with the tiled ones: the outputs must match and 
+//the time per batch of both is printed; the layer sizes and the batch size are not multiples of any tile size, so the 
+//padded edges of the tiles are covered
+class TiledComputeTest
+{
+public:
+
+	static void Run(N2::CE::IProvider *pProvider)
+	{
+		static const CX::UInt32       INPUTS_COUNT = 300;
+		static const N2::NET::Layer   LAYERS[]     = 
+		{
+			{ 1022, N2::NET::Activation::Identity, 0, { 0.0f }, CX::True, 1.0f },
+			{  250, N2::NET::Activation::Identity, 0, { 0.0f }, CX::False, 0.0f }
+		};
+		static const CX::Size         LAYERS_COUNT = sizeof(LAYERS) / sizeof(LAYERS[0]);
+
+		N2::CL::Provider   *pCLProvider = dynamic_cast<N2::CL::Provider *>(pProvider);
+		N2::NET::Network   network;
+		ValuesVector       vectorInputs;
+		ValuesVector       vectorUntiled;
+		ValuesVector       vectorTiled;
+		CX::Double         lfUntiledTime;
+		CX::Double         lfTiledTime;
+		CX::Double         lfFlops;
+		CX::UInt32         cErrors;
+		CX::Status         status;
+
+		if (NULL == pCLProvider)
+		{
+			CX::Print(stdout, "TiledComputeTest : the tiled kernels are CL only\n");
+
+			return;
+		}
+		if ((status = network.Init(INPUTS_COUNT, LAYERS_COUNT, LAYERS)))
+		{
+			NetworkFixture::Fill(&network, 1.0f / 4096.0f);
+			NetworkFixture::FillInputs(&vectorInputs, INPUTS_COUNT, SAMPLES_COUNT);
+			if ((status = Evaluate(pCLProvider, &network, CX::False, &vectorInputs, &vectorUntiled, &lfUntiledTime)))
+			{
+				status = Evaluate(pCLProvider, &network, CX::True, &vectorInputs, &vectorTiled, &lfTiledTime);
+			}
+			if (status)
+			{
+				cErrors = NetworkFixture::CountErrors(vectorTiled, vectorUntiled, 1e-4f);
+				lfFlops = 2.0 * SAMPLES_COUNT * (INPUTS_COUNT * LAYERS[0].cNeuronsCount + 
+				                                 LAYERS[0].cNeuronsCount * LAYERS[1].cNeuronsCount);
+				CX::Print(stdout, "TiledComputeTest (tile {1}) : {2} ({3} wrong outputs)\n", 
+				          pCLProvider->GetTileSize(), 0 == cErrors ? "passed" : "FAILED", cErrors);
+				CX::Print(stdout, "TiledComputeTest : untiled {1:.3} ms ({2:.2} GFLOP/s), tiled {3:.3} ms "
+				          "({4:.2} GFLOP/s) per batch of {5}\n", 
+				          lfUntiledTime * 1000.0, lfFlops / lfUntiledTime / 1e9, 
+				          lfTiledTime * 1000.0, lfFlops / lfTiledTime / 1e9, SAMPLES_COUNT);
+			}
+			else
+			{
+				CX::Print(stdout, "TiledComputeTest : {1}\n", status.GetMsg());
+			}
+
+			status = network.Uninit();
+		}
+		else
+		{
+			CX::Print(stdout, "N2::NET::Network::Init : {1}\n", status.GetMsg());
+		}
+	}
+
+private:
+
+	typedef NetworkFixture::ValuesVector   ValuesVector;
+
+	static const CX::UInt32   SAMPLES_COUNT = 250;
+	static const CX::UInt32   RUNS_COUNT    = 20;
+
+	TiledComputeTest()
+	{
+	}
+
+	~TiledComputeTest()
+	{
+	}
+
+	//one untimed run (its outputs are returned), then the average of RUNS_COUNT runs
+	static CX::Status Evaluate(N2::CL::Provider *pProvider, N2::NET::Network *pNetwork, CX::Bool bTiled, 
+	                           ValuesVector *pVectorInputs, ValuesVector *pVectorOutputs, CX::Double *plfTime)
+	{
+		N2::CE::IConfig    *pConfig;
+		N2::CL::Config     *pCLConfig;
+		N2::CE::INetwork   *pCENetwork;
+		CX::Util::Timer    timer;
+		CX::Status         status;
+
+		if (NULL == (pConfig = pProvider->CreateConfig()))
+		{
+			return CX::Status(CX::Status_MemAllocFailed, "Failed to create the config");
+		}
+		pCLConfig = dynamic_cast<N2::CL::Config *>(pConfig);
+		pCLConfig->SetTiledCompute(bTiled);
+		pCLConfig->SetGenerateKernels(CX::False);
+		pCLConfig->SetAutoTune(CX::False);
+		pVectorOutputs->resize(SAMPLES_COUNT * pNetwork->GetOutputNeurons()->GetNeuronsCount());
+		if ((status = NetworkFixture::Open(pProvider, pConfig, pNetwork, &pCENetwork)))
+		{
+			if ((status = pCENetwork->Evaluate(SAMPLES_COUNT, &(*pVectorInputs)[0], &(*pVectorOutputs)[0])))
+			{
+				ValuesVector   vectorOutputs(pVectorOutputs->size());
+
+				timer.ResetTimer();
+				for (CX::UInt32 i = 0; status && i < RUNS_COUNT; i++)
+				{
+					status = pCENetwork->Evaluate(SAMPLES_COUNT, &(*pVectorInputs)[0], &vectorOutputs[0]);
+				}
+				*plfTime = timer.GetElapsedTime() / RUNS_COUNT;
+			}
+
+			NetworkFixture::Close(pProvider, pCENetwork);
+		}
+		pProvider->DestroyConfig(pConfig);
+
+		return status;
+	}
+
+};